@@ -240,18 +240,50 @@ void Coordinator::runSync(Task* task)
 	syncWorker->setTask(task);
 	syncWorker->work(NULL);
 
-	// wait for all workers
+	waitWorkers(taskWorkers);
+}
+
+int Coordinator::runAsync(Task* task)
+{
+	fb_assert(m_asyncWorkers.isEmpty());
+
+	const int cntWorkers = setupWorkers(task->getMaxWorkers());
+
 	for (int i = 0; i < cntWorkers; i++)
 	{
-		WorkerAndThd& wt = taskWorkers[i];
-		if (wt.thread)
+		WorkerThread* thd = getThread();
+		if (!thd)
+			break;
+
+		Worker* w = getWorker();
+		m_asyncWorkers.push(WorkerAndThd(w, thd));
+
+		w->setTask(task);
+		thd->runWorker(w);
+	}
+
+	return m_asyncWorkers.getCount();
+}
+
+void Coordinator::waitAsync()
+{
+	waitWorkers(m_asyncWorkers);
+	m_asyncWorkers.clear();
+}
+
+void Coordinator::waitWorkers(HalfStaticArray<WorkerAndThd, 8>& taskWorkers)
+{
+	// wait for all workers
+	for (WorkerAndThd* wt = taskWorkers.begin(); wt < taskWorkers.end(); wt++)
+	{
+		if (wt->thread)
 		{
-			if (!wt.worker->isIdle())
-				wt.thread->waitForState(WorkerThread::IDLE, -1);
+			if (!wt->worker->isIdle())
+				wt->thread->waitForState(WorkerThread::IDLE, -1);
 
-			releaseThread(wt.thread);
+			releaseThread(wt->thread);
 		}
-		releaseWorker(wt.worker);
+		releaseWorker(wt->worker);
 	}
 }
 
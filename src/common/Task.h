@@ -116,13 +116,19 @@ public:
 		m_idleWorkers(*m_pool),
 		m_activeWorkers(*m_pool),
 		m_idleThreads(*m_pool),
-		m_activeThreads(*m_pool)
+		m_activeThreads(*m_pool),
+		m_asyncWorkers(*m_pool)
 	{}
 
 	~Coordinator();
 
 	void runSync(Task*);
 
+	// run task by worker threads only and return immediately, return number
+	// of started workers; caller must call waitAsync() before task is destroyed
+	int runAsync(Task*);
+	void waitAsync();
+
 private:
 	struct WorkerAndThd
 	{
@@ -143,6 +149,7 @@ private:
 	// determine how many workers needed, allocate max possible number
 	// of workers, make it all idle, return number of allocated workers
 	int setupWorkers(int count);
+	void waitWorkers(HalfStaticArray<WorkerAndThd, 8>& taskWorkers);
 	Worker* getWorker();
 	void releaseWorker(Worker*);
 
@@ -157,6 +164,7 @@ private:
 	// todo: move to thread pool
 	HalfStaticArray<WorkerThread*, 8> m_idleThreads;
 	HalfStaticArray<WorkerThread*, 8> m_activeThreads;
+	HalfStaticArray<WorkerAndThd, 8> m_asyncWorkers;
 };
 
 
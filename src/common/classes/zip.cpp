@@ -1,7 +1,7 @@
 /*
  *	PROGRAM:	Common class definition
  *	MODULE:		zip.cpp
- *	DESCRIPTION:	ZIP compression library loader.
+ *	DESCRIPTION:	ZIP and Zstandard compression libraries loader.
  *
  *  The contents of this file are subject to the Initial
  *  Developer's Public License Version 1.0 (the "License");
@@ -28,10 +28,10 @@
 #include "../common/classes/alloc.h"
 #include "../common/classes/zip.h"
 
-#ifdef HAVE_ZLIB_H
-
 using namespace Firebird;
 
+#ifdef HAVE_ZLIB_H
+
 ZLib::ZLib(Firebird::MemoryPool&)
 {
 #ifdef WIN_NT
@@ -74,3 +74,31 @@ void ZLib::freeFunc(void*, void* address)
 }
 
 #endif // HAVE_ZLIB_H
+
+ZStd::ZStd(Firebird::MemoryPool&)
+{
+#ifdef WIN_NT
+	Firebird::PathName name("libzstd.dll");
+#else
+	Firebird::PathName name("libzstd." SHRLIB_EXT ".1");
+#endif
+	z.reset(ModuleLoader::fixAndLoadModule(status, name));
+	if (z)
+		symbols();
+}
+
+void ZStd::symbols()
+{
+#define FB_ZSYMB(A) z->findSymbol(status, "ZSTD_" STRINGIZE(A), A); if (!A) { z.reset(NULL); return; }
+	FB_ZSYMB(createCCtx)
+	FB_ZSYMB(freeCCtx)
+	FB_ZSYMB(CCtx_setParameter)
+	FB_ZSYMB(compressStream2)
+	FB_ZSYMB(createDCtx)
+	FB_ZSYMB(freeDCtx)
+	FB_ZSYMB(decompressStream)
+	FB_ZSYMB(compressCCtx)
+	FB_ZSYMB(decompressDCtx)
+	FB_ZSYMB(isError)
+#undef FB_ZSYMB
+}
@@ -1,7 +1,7 @@
 /*
  *	PROGRAM:	Common class definition
  *	MODULE:		zip.h
- *	DESCRIPTION:	ZIP compression library loader.
+ *	DESCRIPTION:	ZIP and Zstandard compression libraries loader.
  *
  *  The contents of this file are subject to the Initial
  *  Developer's Public License Version 1.0 (the "License");
@@ -27,12 +27,12 @@
 #ifndef COMMON_ZIP_H
 #define COMMON_ZIP_H
 
-#ifdef HAVE_ZLIB_H
-#include <zlib.h>
-
 #include "../common/classes/auto.h"
 #include "../common/os/mod_loader.h"
 
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+
 namespace Firebird {
 	class ZLib
 	{
@@ -62,4 +62,60 @@ namespace Firebird {
 }
 #endif // HAVE_ZLIB_H
 
+namespace Firebird {
+	// Streaming and single block API of libzstd, declared here to not depend
+	// on its headers. It's a part of the stable ABI since zstd 1.4.0.
+
+	class ZStd
+	{
+	public:
+		struct CCtx;
+		struct DCtx;
+
+		struct InBuffer
+		{
+			const void* src;
+			size_t size;
+			size_t pos;
+		};
+
+		struct OutBuffer
+		{
+			void* dst;
+			size_t size;
+			size_t pos;
+		};
+
+		// ZSTD_cParameter and ZSTD_EndDirective values
+		static constexpr int COMPRESSION_LEVEL = 100;
+		static constexpr int CONTINUE = 0;
+		static constexpr int FLUSH = 1;
+
+		explicit ZStd(Firebird::MemoryPool&);
+
+		CCtx* (*createCCtx)();
+		size_t (*freeCCtx)(CCtx* cctx);
+		size_t (*CCtx_setParameter)(CCtx* cctx, int param, int value);
+		size_t (*compressStream2)(CCtx* cctx, OutBuffer* output, InBuffer* input, int endOp);
+		DCtx* (*createDCtx)();
+		size_t (*freeDCtx)(DCtx* dctx);
+		size_t (*decompressStream)(DCtx* dctx, OutBuffer* output, InBuffer* input);
+		size_t (*compressCCtx)(CCtx* cctx, void* dst, size_t dstCapacity,
+			const void* src, size_t srcSize, int level);
+		size_t (*decompressDCtx)(DCtx* dctx, void* dst, size_t dstCapacity,
+			const void* src, size_t srcSize);
+		unsigned (*isError)(size_t code);
+
+		operator bool() { return z.hasData(); }
+		bool operator!() { return !z.hasData(); }
+
+		ISC_STATUS_ARRAY status;
+
+	private:
+		AutoPtr<ModuleLoader::Module> z;
+
+		void symbols();
+	};
+}
+
 #endif // COMMON_ZIP_H
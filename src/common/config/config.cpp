@@ -137,6 +137,15 @@ const char*	GCPolicyCooperative	= "cooperative";
 const char*	GCPolicyBackground	= "background";
 const char*	GCPolicyCombined	= "combined";
 
+const char*	CachePolicyLRU		= "lru";
+const char*	CachePolicyWeighted	= "weighted";
+
+const char*	CacheNumaPolicyDefault		= "default";
+const char*	CacheNumaPolicyInterleave	= "interleave";
+
+const char*	WireCompressionZlib	= "zlib";
+const char*	WireCompressionZstd	= "zstd";
+
 ConfigValue Config::defaults[MAX_CONFIG_KEY];
 
 /******************************************************************************
@@ -379,6 +388,42 @@ void Config::checkValues()
 		}
 	}
 
+	strVal = values[KEY_CACHE_POLICY].strVal;
+	if (strVal)
+	{
+		NoCaseString cachePolicy(strVal);
+		if (cachePolicy != CachePolicyLRU &&
+			cachePolicy != CachePolicyWeighted)
+		{
+			// user-provided value is invalid - fail to default
+			values[KEY_CACHE_POLICY] = defaults[KEY_CACHE_POLICY];
+		}
+	}
+
+	strVal = values[KEY_CACHE_NUMA_POLICY].strVal;
+	if (strVal)
+	{
+		NoCaseString numaPolicy(strVal);
+		if (numaPolicy != CacheNumaPolicyDefault &&
+			numaPolicy != CacheNumaPolicyInterleave)
+		{
+			// user-provided value is invalid - fail to default
+			values[KEY_CACHE_NUMA_POLICY] = defaults[KEY_CACHE_NUMA_POLICY];
+		}
+	}
+
+	strVal = values[KEY_WIRE_COMPRESSION_TYPE].strVal;
+	if (strVal)
+	{
+		NoCaseString compressionType(strVal);
+		if (compressionType != WireCompressionZlib &&
+			compressionType != WireCompressionZstd)
+		{
+			// user-provided value is invalid - fail to default
+			values[KEY_WIRE_COMPRESSION_TYPE] = defaults[KEY_WIRE_COMPRESSION_TYPE];
+		}
+	}
+
 	strVal = values[KEY_WIRE_CRYPT].strVal;
 	if (strVal)
 	{
@@ -424,6 +469,27 @@ void Config::checkValues()
 
 	checkIntForLoBound(KEY_PARALLEL_WORKERS, 1, true);
 	checkIntForHiBound(KEY_PARALLEL_WORKERS, values[KEY_MAX_PARALLEL_WORKERS].intVal, false);
+
+	checkIntForLoBound(KEY_READ_AHEAD_PAGES, 0, true);
+	checkIntForHiBound(KEY_READ_AHEAD_PAGES, 1024, false);
+
+	checkIntForLoBound(KEY_FLUSH_BATCH_SIZE, 0, true);
+	checkIntForHiBound(KEY_FLUSH_BATCH_SIZE, 256, false);
+
+	// zstd levels from ZSTD_minCLevel() to ZSTD_maxCLevel()
+	checkIntForLoBound(KEY_PAGE_COMPRESSION_LEVEL, -131072, false);
+	checkIntForHiBound(KEY_PAGE_COMPRESSION_LEVEL, 22, false);
+
+	checkIntForLoBound(KEY_FETCH_BATCH_BUFFER, 0, true);
+	checkIntForHiBound(KEY_FETCH_BATCH_BUFFER, 64 * 1024 * 1024, false);
+
+	checkIntForLoBound(KEY_CACHE_HUGE_PAGE_SIZE, 0, true);
+	{
+		// huge page size should be a power of two
+		const SINT64 hugePageSize = values[KEY_CACHE_HUGE_PAGE_SIZE].intVal;
+		if (hugePageSize & (hugePageSize - 1))
+			values[KEY_CACHE_HUGE_PAGE_SIZE] = defaults[KEY_CACHE_HUGE_PAGE_SIZE];
+	}
 }
 
 
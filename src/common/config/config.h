@@ -78,6 +78,15 @@ extern const char*	GCPolicyCooperative;
 extern const char*	GCPolicyBackground;
 extern const char*	GCPolicyCombined;
 
+extern const char*	CachePolicyLRU;
+extern const char*	CachePolicyWeighted;
+
+extern const char*	CacheNumaPolicyDefault;
+extern const char*	CacheNumaPolicyInterleave;
+
+extern const char*	WireCompressionZlib;
+extern const char*	WireCompressionZstd;
+
 inline constexpr int WIRE_CRYPT_DISABLED = 0;
 inline constexpr int WIRE_CRYPT_ENABLED = 1;
 inline constexpr int WIRE_CRYPT_REQUIRED = 2;
@@ -187,6 +196,16 @@ enum ConfigKey
 	KEY_MAX_PARALLEL_WORKERS,
 	KEY_OPTIMIZE_FOR_FIRST_ROWS,
 	KEY_ALLOW_UPDATE_OVERWRITE,
+	KEY_READ_AHEAD_PAGES,
+	KEY_FLUSH_BATCH_SIZE,
+	KEY_CACHE_POLICY,
+	KEY_CACHE_HUGE_PAGE_SIZE,
+	KEY_CACHE_NUMA_POLICY,
+	KEY_TEMP_COMPRESSION,
+	KEY_WIRE_COMPRESSION_TYPE,
+	KEY_WIRE_COMPRESSION_LEVEL,
+	KEY_FETCH_BATCH_BUFFER,
+	KEY_PAGE_COMPRESSION_LEVEL,
 	MAX_CONFIG_KEY		// keep it last
 };
 
@@ -300,7 +319,17 @@ inline constexpr ConfigEntry entries[MAX_CONFIG_KEY] =
 	{TYPE_INTEGER,	"ParallelWorkers",			true,	1},
 	{TYPE_INTEGER,	"MaxParallelWorkers",		true,	1},
 	{TYPE_BOOLEAN,	"OptimizeForFirstRows",		false,	false},
-	{TYPE_BOOLEAN,	"AllowUpdateOverwrite",		false,	true}
+	{TYPE_BOOLEAN,	"AllowUpdateOverwrite",		false,	true},
+	{TYPE_INTEGER,	"ReadAheadPages",			false,	0},			// pages
+	{TYPE_INTEGER,	"FlushBatchSize",			false,	0},			// pages
+	{TYPE_STRING,	"CachePolicy",				false,	"lru"},		// page cache replacement policy
+	{TYPE_INTEGER,	"CacheHugePageSize",		false,	0},			// bytes
+	{TYPE_STRING,	"CacheNumaPolicy",			false,	"default"},	// placement of page cache memory
+	{TYPE_BOOLEAN,	"TempCompression",			false,	false},
+	{TYPE_STRING,	"WireCompressionType",		false,	"zlib"},
+	{TYPE_INTEGER,	"WireCompressionLevel",		false,	0},
+	{TYPE_INTEGER,	"FetchBatchBuffer",			false,	0},			// bytes
+	{TYPE_INTEGER,	"PageCompressionLevel",		false,	0}
 };
 
 
@@ -623,6 +652,36 @@ public:
 	CONFIG_GET_PER_DB_BOOL(getOptimizeForFirstRows, KEY_OPTIMIZE_FOR_FIRST_ROWS);
 
 	CONFIG_GET_PER_DB_BOOL(getAllowUpdateOverwrite, KEY_ALLOW_UPDATE_OVERWRITE);
+
+	// Number of data pages to read ahead during sequential scans
+	CONFIG_GET_PER_DB_KEY(ULONG, getReadAheadPages, KEY_READ_AHEAD_PAGES, getInt);
+
+	// Number of pages written by cache flush between disk synchronizations when forced writes are on
+	CONFIG_GET_PER_DB_KEY(ULONG, getFlushBatchSize, KEY_FLUSH_BATCH_SIZE, getInt);
+
+	// Page cache replacement policy
+	CONFIG_GET_PER_DB_STR(getCachePolicy, KEY_CACHE_POLICY);
+
+	// Size of huge pages to back the page cache with, zero - do not use huge pages
+	CONFIG_GET_PER_DB_KEY(FB_UINT64, getCacheHugePageSize, KEY_CACHE_HUGE_PAGE_SIZE, getInt);
+
+	// Placement of page cache memory on NUMA nodes
+	CONFIG_GET_PER_DB_STR(getCacheNumaPolicy, KEY_CACHE_NUMA_POLICY);
+
+	// Compress temporary space written to disk
+	CONFIG_GET_PER_DB_BOOL(getTempCompression, KEY_TEMP_COMPRESSION);
+
+	// Compression algorithm requested by the client, zlib or zstd
+	CONFIG_GET_PER_DB_STR(getWireCompressionType, KEY_WIRE_COMPRESSION_TYPE);
+
+	// Compression level of the outgoing stream, zero - default of the algorithm
+	CONFIG_GET_PER_DB_KEY(int, getWireCompressionLevel, KEY_WIRE_COMPRESSION_LEVEL, getInt);
+
+	// Size of the rows sent in a single fetch batch, zero - fixed batches
+	CONFIG_GET_PER_DB_KEY(unsigned int, getFetchBatchBuffer, KEY_FETCH_BATCH_BUFFER, getInt);
+
+	// Compression level of data and blob pages written to disk, zero - do not compress
+	CONFIG_GET_PER_DB_KEY(int, getPageCompressionLevel, KEY_PAGE_COMPRESSION_LEVEL, getInt);
 };
 
 // Implementation of interface to access master configuration file
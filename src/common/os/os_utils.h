@@ -88,6 +88,16 @@ namespace os_utils
 	void setCloseOnExec(int fd);	// posix only
 	FILE* fopen(const char* pathname, const char* mode);
 
+	// allocate memory backed by large (huge) pages of given size, round size
+	// up to the large page size, return NULL if large pages are not available
+	void* allocLargePages(size_t& size, size_t pageSize);
+	void releaseLargePages(void* block, size_t size);
+	// hint OS to back memory with transparent large pages, if supported
+	void adviseLargePages(void* block, size_t size);
+	// spread not yet touched pages of memory over all NUMA nodes,
+	// return false if there is single node or OS does not support it
+	bool interleaveMemory(void* block, size_t size);
+
 	// return a binary string that uniquely identifies the file
 #ifdef WIN_NT
 	void getUniqueFileId(HANDLE fd, Firebird::UCharBuffer& id);
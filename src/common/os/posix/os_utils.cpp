@@ -86,6 +86,10 @@
 
 #include <stdio.h>
 
+#ifdef LINUX
+#include <sys/syscall.h>
+#endif
+
 using namespace Firebird;
 
 namespace os_utils
@@ -371,6 +375,110 @@ FILE* fopen(const char* pathname, const char* mode)
 	return f;
 }
 
+void* allocLargePages(size_t& size, size_t pageSize)
+{
+#if defined(MAP_HUGETLB) && defined(MAP_ANONYMOUS)
+	fb_assert(pageSize && (pageSize & (pageSize - 1)) == 0);
+
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+
+#ifdef MAP_HUGE_SHIFT
+	int log2 = 0;
+	while ((size_t(1) << log2) < pageSize)
+		log2++;
+
+	flags |= log2 << MAP_HUGE_SHIFT;
+#endif
+
+	const size_t alignedSize = FB_ALIGN(size, pageSize);
+
+	void* const result = os_utils::mmap(NULL, alignedSize, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if (result == MAP_FAILED)
+		return NULL;
+
+	size = alignedSize;
+	return result;
+#else
+	return NULL;
+#endif
+}
+
+void releaseLargePages(void* block, size_t size)
+{
+	munmap(block, size);
+}
+
+void adviseLargePages(void* block, size_t size)
+{
+#ifdef MADV_HUGEPAGE
+	const size_t osPageSize = getpagesize();
+	char* const begin = FB_ALIGN((char*) block, osPageSize);
+	char* const end = (char*) block + size;
+
+	if (end > begin)
+		madvise(begin, (end - begin) & ~(osPageSize - 1), MADV_HUGEPAGE);
+#endif
+}
+
+bool interleaveMemory(void* block, size_t size)
+{
+#if defined(LINUX) && defined(SYS_mbind)
+	const int MPOL_INTERLEAVE_MODE = 3;		// MPOL_INTERLEAVE from numaif.h
+	const unsigned MAX_NODES = 1024;
+	const unsigned LONG_BITS = sizeof(unsigned long) * 8;
+
+	// Get online NUMA nodes as a list of ranges, i.e. "0-1,3"
+
+	unsigned long nodeMask[MAX_NODES / LONG_BITS];
+	memset(nodeMask, 0, sizeof(nodeMask));
+	unsigned nodeCount = 0;
+
+	FILE* const online = os_utils::fopen("/sys/devices/system/node/online", "r");
+	if (!online)
+		return false;
+
+	char buffer[256];
+	const bool read = fgets(buffer, sizeof(buffer), online);
+	fclose(online);
+
+	if (!read)
+		return false;
+
+	for (const char* p = buffer; *p >= '0' && *p <= '9'; )
+	{
+		char* next;
+		const unsigned first = strtoul(p, &next, 10);
+		unsigned last = first;
+
+		if (*next == '-')
+			last = strtoul(next + 1, &next, 10);
+
+		for (unsigned node = first; node <= last && node < MAX_NODES; node++)
+		{
+			nodeMask[node / LONG_BITS] |= 1UL << (node % LONG_BITS);
+			nodeCount++;
+		}
+
+		p = (*next == ',') ? next + 1 : next;
+	}
+
+	if (nodeCount < 2)
+		return false;
+
+	const size_t osPageSize = getpagesize();
+	char* const begin = FB_ALIGN((char*) block, osPageSize);
+	char* const end = (char*) block + size;
+
+	if (end <= begin)
+		return false;
+
+	return syscall(SYS_mbind, begin, (end - begin) & ~(osPageSize - 1), MPOL_INTERLEAVE_MODE,
+		nodeMask, MAX_NODES + 1, 0) == 0;
+#else
+	return false;
+#endif
+}
+
 static void makeUniqueFileId(const struct STAT& statistics, UCharBuffer& id)
 {
 	const size_t len1 = sizeof(statistics.st_dev);
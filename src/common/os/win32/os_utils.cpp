@@ -408,6 +408,41 @@ FILE* fopen(const char* pathname, const char* mode)
 	return ::fopen(pathname, mode);
 }
 
+// Requires SeLockMemoryPrivilege to be granted to the process account
+void* allocLargePages(size_t& size, size_t pageSize)
+{
+	const size_t minimum = GetLargePageMinimum();
+	if (!minimum)
+		return NULL;
+
+	if (pageSize < minimum)
+		pageSize = minimum;
+
+	const size_t alignedSize = FB_ALIGN(size, pageSize);
+
+	void* const result = VirtualAlloc(NULL, alignedSize,
+		MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+
+	if (result)
+		size = alignedSize;
+
+	return result;
+}
+
+void releaseLargePages(void* block, size_t /*size*/)
+{
+	VirtualFree(block, 0, MEM_RELEASE);
+}
+
+void adviseLargePages(void* /*block*/, size_t /*size*/)
+{
+}
+
+bool interleaveMemory(void* /*block*/, size_t /*size*/)
+{
+	return false;
+}
+
 void getUniqueFileId(HANDLE fd, UCharBuffer& id)
 {
 	entryLoader.init();
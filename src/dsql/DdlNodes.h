@@ -2036,8 +2036,10 @@ public:
 		QualifiedName index;
 		QualifiedName relation;
 		Firebird::ObjectsArray<MetaName> columns;
+		Firebird::ObjectsArray<MetaName> includeColumns;
 		Firebird::TriState unique;
 		Firebird::TriState descending;
+		Firebird::TriState range;
 		Firebird::TriState inactive;
 		Firebird::TriState concurrently;
 		SSHORT type;
@@ -2084,10 +2086,12 @@ public:
 	QualifiedName name;
 	bool unique = false;
 	bool descending = false;
+	bool range = false;
 	bool active = true;
 	bool concurrently = false;
 	NestConst<RelationSourceNode> relation;
 	NestConst<ValueListNode> columns;
+	NestConst<ValueListNode> includeColumns;
 	NestConst<ValueSourceClause> computed;
 	NestConst<BoolSourceClause> partial;
 	bool createIfNotExistsOnly = false;
@@ -2167,7 +2171,16 @@ class SetStatisticsNode final : public DdlNode
 public:
 	SetStatisticsNode(MemoryPool& p, const QualifiedName& aName)
 		: DdlNode(p),
-		  indexName(p, aName)
+		  indexName(p, aName),
+		  tableName(p)
+	{
+	}
+
+	// SET STATISTICS TABLE: all indices and the column histograms of the table
+	SetStatisticsNode(MemoryPool& p, const QualifiedName& aTableName, bool /*table*/)
+		: DdlNode(p),
+		  indexName(p),
+		  tableName(p, aTableName)
 	{
 	}
 
@@ -2178,8 +2191,16 @@ public:
 
 	DdlNode* dsqlPass(DsqlCompilerScratch* dsqlScratch) override
 	{
-		dsqlScratch->qualifyExistingName(indexName, obj_index);
-		dsqlScratch->ddlSchema = indexName.schema;
+		if (tableName.object.hasData())
+		{
+			dsqlScratch->qualifyExistingName(tableName, obj_relation);
+			dsqlScratch->ddlSchema = tableName.schema;
+		}
+		else
+		{
+			dsqlScratch->qualifyExistingName(indexName, obj_index);
+			dsqlScratch->ddlSchema = indexName.schema;
+		}
 
 		return DdlNode::dsqlPass(dsqlScratch);
 	}
@@ -2190,18 +2211,25 @@ public:
 	}
 
 private:
+	void executeTable(thread_db* tdbb, DsqlCompilerScratch* dsqlScratch, jrd_tra* transaction);
 	void setStatisticsLocalTempIndex(thread_db* tdbb, DsqlCompilerScratch* dsqlScratch,
 		jrd_tra* transaction, LocalTemporaryTable* ltt, LocalTemporaryTable::Index* lttIndex);
 
 protected:
 	void putErrorPrefix(Firebird::Arg::StatusVector& statusVector) override
 	{
-		// ASF: using ALTER INDEX's code.
-		statusVector << Firebird::Arg::Gds(isc_dsql_alter_index_failed) << indexName.toQuotedString();
+		if (tableName.object.hasData())
+			statusVector << Firebird::Arg::Gds(isc_dsql_alter_table_failed) << tableName.toQuotedString();
+		else
+		{
+			// ASF: using ALTER INDEX's code.
+			statusVector << Firebird::Arg::Gds(isc_dsql_alter_index_failed) << indexName.toQuotedString();
+		}
 	}
 
 public:
 	QualifiedName indexName;
+	QualifiedName tableName;
 };
 
 
@@ -174,6 +174,9 @@ namespace
 				const auto node = FB_NEW_POOL(csb->csb_pool) RecordKeyNode(csb->csb_pool, blrOp);
 				node->recStream = stream;
 				stack.push(node);
+
+				if (blrOp == blr_record_version || blrOp == blr_record_version2)
+					csb_tail->csb_flags |= csb_record_version;
 			}
 		}
 	}
@@ -10447,6 +10450,10 @@ ValueExprNode* RecordKeyNode::pass1(thread_db* tdbb, CompilerScratch* csb)
 
 	markVariant(csb, recStream);
 
+	// Record version cannot be restored from the index key
+	if (blrOp == blr_record_version || blrOp == blr_record_version2)
+		csb->csb_rpt[recStream].csb_flags |= csb_record_version;
+
 	if (!csb->csb_rpt[recStream].csb_map)
 		return this;
 
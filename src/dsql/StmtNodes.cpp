@@ -6659,13 +6659,16 @@ StmtNode* ForNode::pass2(thread_db* tdbb, CompilerScratch* csb)
 	doPass2(tdbb, csb, stall.getAddress(), this);
 	ExprNode::doPass2(tdbb, csb, rse.getAddress());
 
+	const bool mainCursor = csb->csb_current_for_nodes.isEmpty() && !(marks & MARK_FOR_UPDATE) &&
+		!csb->csb_forCursorNames.exist(this) && !rse->hasWriteLock() && !rse->isScrollable();
+
 	csb->csb_current_for_nodes.push(this);
 	doPass2(tdbb, csb, statement.getAddress(), this);
 	csb->csb_current_for_nodes.pop();
 
 	// Finish up processing of record selection expressions.
 
-	RecordSource* const rsb = CMP_post_rse(tdbb, csb, rse.getObject());
+	RecordSource* const rsb = CMP_post_rse(tdbb, csb, rse.getObject(), mainCursor);
 
 	MetaName cursorName;
 	csb->csb_forCursorNames.get(this, cursorName);
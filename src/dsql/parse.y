@@ -1673,19 +1673,21 @@ create_clause
 			node->createIfNotExistsOnly = $2;
 			$$ = node;
 		}
-	| unique_opt order_direction INDEX if_not_exists_opt symbol_index_name index_active_opt ON simple_table_name
+	| unique_opt order_direction range_opt INDEX if_not_exists_opt symbol_index_name index_active_opt
+			ON simple_table_name
 			{
-				const auto node = newNode<CreateIndexNode>(*$5);
-				node->active = $6;
+				const auto node = newNode<CreateIndexNode>(*$6);
+				node->active = $7;
 				node->unique = $1;
 				node->descending = $2;
-				node->createIfNotExistsOnly = $4;
-				node->relation = $8;
+				node->range = $3;
+				node->createIfNotExistsOnly = $5;
+				node->relation = $9;
 				$$ = node;
 			}
-		index_definition(static_cast<CreateIndexNode*>($9))
+		index_definition(static_cast<CreateIndexNode*>($10))
 			{
-				$$ = $9;
+				$$ = $10;
 			}
 	| FUNCTION if_not_exists_opt function_clause
 		{
@@ -1920,12 +1922,19 @@ unique_opt
 	| UNIQUE			{ $$ = true; }
 	;
 
+%type <boolVal> range_opt
+range_opt
+	: /* nothing */		{ $$ = false; }
+	| RANGE				{ $$ = true; }
+	;
+
 %type index_definition(<createIndexNode>)
 index_definition($createIndexNode)
-	: index_column_expr($createIndexNode) index_condition_opt concurrently_opt
+	: index_column_expr($createIndexNode) index_include_opt index_condition_opt concurrently_opt
 		{
-			$createIndexNode->partial = $2;
-			$createIndexNode->concurrently = $3;
+			$createIndexNode->includeColumns = $2;
+			$createIndexNode->partial = $3;
+			$createIndexNode->concurrently = $4;
 		}
 	;
 
@@ -1943,6 +1952,14 @@ index_column_expr($createIndexNode)
 		}
 	;
 
+%type <valueListNode> index_include_opt
+index_include_opt
+	: /* nothing */
+		{ $$ = nullptr; }
+	| INCLUDE column_parens
+		{ $$ = $2; }
+	;
+
 %type <boolSourceClause> index_condition_opt
 index_condition_opt
 	: /* nothing */
@@ -6586,6 +6603,8 @@ table_list
 set_statistics
 	: SET STATISTICS INDEX symbol_index_name
 		{ $$ = newNode<SetStatisticsNode>(*$4); }
+	| SET STATISTICS TABLE symbol_table_name
+		{ $$ = newNode<SetStatisticsNode>(*$4, true); }
 	;
 
 %type <ddlNode> comment
@@ -0,0 +1,250 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		BCBHashTable.cpp
+ *	DESCRIPTION:	Page number to page buffer hash table of disk cache manager
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/BCBHashTable.h"
+#include "../common/classes/init.h"
+
+#ifdef HASH_USE_CDS_LIST
+#include "../jrd/InitCDSLib.h"
+#endif
+
+using namespace Firebird;
+
+// Given pointer a field in the block, find the block
+
+#define BLOCK(fld_ptr, type, fld) (type*)((SCHAR*) fld_ptr - offsetof(type, fld))
+
+
+#ifdef HASH_USE_CDS_LIST
+
+namespace
+{
+	InitInstance<Jrd::InitPool> initPool;
+}
+
+namespace Jrd
+{
+
+template <typename T>
+T* ListNodeAllocator<T>::allocate(std::size_t n)
+{
+	return static_cast<T*>(initPool().alloc(n * sizeof(T)));
+}
+
+template <typename T>
+void ListNodeAllocator<T>::deallocate(T* p, std::size_t /* n */)
+{
+	// It uses the correct pool stored within memory block itself
+	MemoryPool::globalFree(p);
+}
+
+} // namespace Jrd
+
+#endif // HASH_USE_CDS_LIST
+
+
+namespace Jrd
+{
+
+void BCBHashTable::resize(ULONG count)
+{
+	const ULONG old_count = m_count;
+	chain_type* const old_chains = m_chains;
+
+	chain_type* new_chains = FB_NEW_POOL(m_pool) chain_type[count];
+	m_count = count;
+	m_chains = new_chains;
+
+#ifndef HASH_USE_CDS_LIST
+	// Initialize all new new_chains
+	for (chain_type* que = new_chains; que < new_chains + count; que++)
+		QUE_INIT(*que);
+#endif
+
+	if (!old_chains)
+		return;
+
+	const chain_type* const old_end = old_chains + old_count;
+
+	// Move any active buffers from old hash table to new
+	for (chain_type* old_tail = old_chains; old_tail < old_end; old_tail++)
+	{
+#ifndef HASH_USE_CDS_LIST
+		while (QUE_NOT_EMPTY(*old_tail))
+		{
+			QUE que_inst = old_tail->que_forward;
+			BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_que);
+			QUE_DELETE(*que_inst);
+			QUE mod_que = &new_chains[hash(bdb->bdb_page)];
+			QUE_INSERT(*mod_que, *que_inst);
+		}
+#else
+		while (!old_tail->empty())
+		{
+			auto n = old_tail->begin();
+			old_tail->erase(n->first);				// bdb_page
+
+			chain_type* new_chain = &m_chains[hash(n->first)];
+			new_chain->insert(n->first, n->second);	// bdb_page, bdb
+		}
+#endif
+	}
+
+	delete[] old_chains;
+}
+
+void BCBHashTable::clear()
+{
+	if (!m_chains)
+		return;
+
+#ifdef HASH_USE_CDS_LIST
+	const chain_type* const end = m_chains + m_count;
+	for (chain_type* tail = m_chains; tail < end; tail++)
+		tail->clear();
+#endif
+
+	delete[] m_chains;
+	m_chains = nullptr;
+	m_count = 0;
+}
+
+BufferDesc* BCBHashTable::emplace(BufferDesc* bdb, const PageNumber& page, bool remove)
+{
+#ifndef HASH_USE_CDS_LIST
+	// Lock both old and new chains, always in the same order to avoid deadlocks.
+	// Page number of the buffer is changed here, while both chains are locked,
+	// else concurrent emplace() could miss the buffer and put another one for
+	// the same page. bdb is exclusively latched by the caller, so its old page
+	// number is stable.
+
+	const ULONG slot = hash(page);
+	const ULONG oldSlot = remove ? hash(bdb->bdb_page) : slot;
+
+	Firebird::SyncObject* sync1 = &getSync(slot);
+	Firebird::SyncObject* sync2 = &getSync(oldSlot);
+	if (sync1 > sync2)
+		std::swap(sync1, sync2);
+
+	Firebird::SyncLockGuard guard1(sync1, Firebird::SYNC_EXCLUSIVE, FB_FUNCTION);
+	Firebird::Sync guard2(sync2, FB_FUNCTION);
+	if (sync2 != sync1)
+		guard2.lock(Firebird::SYNC_EXCLUSIVE);
+
+	que& mod_que = m_chains[slot];
+	BufferDesc* bdb2 = findInChain(mod_que, page);
+	if (!bdb2)
+	{
+		if (remove)
+			QUE_DELETE(bdb->bdb_que);
+
+		QUE_INSERT(mod_que, bdb->bdb_que);
+		bdb->bdb_page = page;
+	}
+	return bdb2;
+#else // HASH_USE_CDS_LIST
+
+	BufferDesc* bdb2 = nullptr;
+	BdbList& list = m_chains[hash(page)];
+
+/*
+	// Original libcds have no update(key, value), use this code with it
+
+	auto ret = list.update(page, [bdb, &bdb2](bool bNew, BdbList::value_type& val)
+		{
+			if (bNew)
+				val.second = bdb;
+			else
+				while (!(bdb2 = val.second))
+					cds::backoff::pause();
+		},
+		true);
+*/
+
+	auto ret = list.update(page, bdb, [&bdb2](bool bNew, BdbList::value_type& val)
+		{
+			// someone might have put a page buffer in the chain concurrently, so
+			// we store it for the further investigation
+			if (!bNew)
+				bdb2 = val.second;
+		},
+		true);
+	fb_assert(ret.first);
+
+	// if we have inserted the page buffer that we found (empty or oldest)
+	if (bdb2 == nullptr)
+	{
+		fb_assert(ret.second);
+#ifdef DEV_BUILD
+		auto p1 = list.get(page);
+		fb_assert(!p1.empty() && p1->first == page && p1->second == bdb);
+#endif
+
+		if (remove)
+		{
+			// remove the page buffer from old hash slot
+			const PageNumber oldPage = bdb->bdb_page;
+			BdbList& oldList = m_chains[hash(oldPage)];
+
+#ifdef DEV_BUILD
+			p1 = oldList.get(oldPage);
+			fb_assert(!p1.empty() && p1->first == oldPage && p1->second == bdb);
+#endif
+
+			const bool ok = oldList.erase(oldPage);
+			fb_assert(ok);
+
+#ifdef DEV_BUILD
+			p1 = oldList.get(oldPage);
+			fb_assert(p1.empty() || p1->second != bdb);
+#endif
+		}
+
+#ifdef DEV_BUILD
+		p1 = list.get(page);
+		fb_assert(!p1.empty() && p1->first == page && p1->second == bdb);
+#endif
+	}
+	return bdb2;
+#endif
+}
+
+void BCBHashTable::remove(BufferDesc* bdb)
+{
+#ifndef HASH_USE_CDS_LIST
+	Firebird::SyncLockGuard guard(&getSync(hash(bdb->bdb_page)), Firebird::SYNC_EXCLUSIVE, FB_FUNCTION);
+	QUE_DELETE(bdb->bdb_que);
+#else
+	BdbList& list = m_chains[hash(bdb->bdb_page)];
+
+#ifdef DEV_BUILD
+	auto p = list.get(bdb->bdb_page);
+	fb_assert(!p.empty() && p->first == bdb->bdb_page && p->second == bdb);
+#endif
+
+	list.erase(bdb->bdb_page);
+#endif
+}
+
+} // namespace Jrd
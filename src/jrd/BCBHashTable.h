@@ -0,0 +1,185 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		BCBHashTable.h
+ *	DESCRIPTION:	Page number to page buffer hash table of disk cache manager
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_BCB_HASH_TABLE_H
+#define JRD_BCB_HASH_TABLE_H
+
+#include "../common/classes/SyncObject.h"
+#include "../jrd/cch.h"
+#include "../jrd/que.h"
+
+#ifndef CDS_UNAVAILABLE
+// Use lock-free lists in hash table implementation
+#define HASH_USE_CDS_LIST
+#endif
+
+#ifdef HASH_USE_CDS_LIST
+#include <cds/container/michael_kvlist_dhp.h>
+#endif
+
+namespace Jrd
+{
+
+#ifdef HASH_USE_CDS_LIST
+
+template <typename T>
+class ListNodeAllocator
+{
+public:
+	typedef T value_type;
+
+	ListNodeAllocator() {};
+
+	template <class U>
+	constexpr ListNodeAllocator(const ListNodeAllocator<U>&) noexcept {}
+
+	T* allocate(std::size_t n);
+	void deallocate(T* p, std::size_t n);
+
+private:
+};
+
+struct BdbTraits : public cds::container::michael_list::traits
+{
+	typedef ListNodeAllocator<int> allocator;
+	//typedef std::less<PageNumber> compare;
+};
+
+typedef cds::container::MichaelKVList<cds::gc::DHP, PageNumber, BufferDesc*, BdbTraits> BdbList;
+
+#endif // HASH_USE_CDS_LIST
+
+
+// Hash table is safe to use concurrently, except of resize() and clear().
+// With lock-free lists every chain is accessed with no locks at all. Else,
+// chains are guarded by a set of sync objects, each one protects every
+// SYNC_STRIPES'th chain, thus lookups of different pages rarely meet at
+// the same sync object.
+// Note, the page buffer found could be reassigned to another page at any
+// moment, caller should check bdb_page after latching the buffer.
+
+class BCBHashTable
+{
+#ifdef HASH_USE_CDS_LIST
+	using chain_type = BdbList;
+#else
+	using chain_type = que;
+
+	static constexpr ULONG SYNC_STRIPES = 64;
+#endif
+
+public:
+	BCBHashTable(MemoryPool& pool, ULONG count) :
+		m_pool(pool),
+		m_count(0),
+		m_chains(nullptr)
+	{
+		resize(count);
+	}
+
+	~BCBHashTable()
+	{
+		clear();
+	}
+
+	void resize(ULONG count);
+	void clear();
+
+	BufferDesc* find(const PageNumber& page) const;
+
+	// tries to put bdb into hash slot by page
+	// if succeed, removes bdb from old slot, if necessary, and returns NULL
+	// else, returns BufferDesc that is currently occupies target slot
+	BufferDesc* emplace(BufferDesc* bdb, const PageNumber& page, bool remove);
+
+	void remove(BufferDesc* bdb);
+private:
+	ULONG hash(const PageNumber& pageno) const
+	{
+		return pageno.getPageNum() % m_count;
+	}
+
+#ifndef HASH_USE_CDS_LIST
+	Firebird::SyncObject& getSync(ULONG slot) const
+	{
+		return m_syncs[slot % SYNC_STRIPES];
+	}
+
+	BufferDesc* findInChain(const que& chain, const PageNumber& page) const;
+
+	mutable Firebird::SyncObject m_syncs[SYNC_STRIPES];
+#endif
+
+	MemoryPool& m_pool;
+	ULONG m_count;
+	chain_type* m_chains;
+};
+
+
+#ifndef HASH_USE_CDS_LIST
+
+inline BufferDesc* BCBHashTable::findInChain(const que& chain, const PageNumber& page) const
+{
+	for (QUE que_inst = chain.que_forward; que_inst != &chain; que_inst = que_inst->que_forward)
+	{
+		BufferDesc* bdb = (BufferDesc*) ((SCHAR*) que_inst - offsetof(BufferDesc, bdb_que));
+		if (bdb->bdb_page == page)
+			return bdb;
+	}
+
+	return nullptr;
+}
+
+#endif
+
+inline BufferDesc* BCBHashTable::find(const PageNumber& page) const
+{
+	const ULONG slot = hash(page);
+	auto& list = m_chains[slot];
+
+#ifndef HASH_USE_CDS_LIST
+	Firebird::SyncLockGuard guard(&getSync(slot), Firebird::SYNC_SHARED, FB_FUNCTION);
+	return findInChain(list, page);
+
+#else // HASH_USE_CDS_LIST
+	auto ptr = list.get(page);
+	if (!ptr.empty())
+	{
+		fb_assert(ptr->second != nullptr);
+#ifdef DEV_BUILD
+		// Original libcds have no update(key, value), use this code with it,
+		// see also comment in get_buffer()
+		while (ptr->second == nullptr)
+			cds::backoff::pause();
+#endif
+		if (ptr->second->bdb_page == page)
+			return ptr->second;
+	}
+
+	return nullptr;
+#endif
+}
+
+} // namespace Jrd
+
+#endif // JRD_BCB_HASH_TABLE_H
@@ -218,6 +218,8 @@ namespace Jrd
 		}
 
 		delete dbb_tip_cache;
+		delete dbb_local_locks;
+		delete dbb_open_ranges;
 		delete dbb_monitoring_data;
 		delete dbb_backup_manager;
 		delete dbb_crypto_manager;
@@ -877,6 +879,8 @@ namespace Jrd
 		dbb_gc_fini(*p, garbage_collector, THREAD_medium),
 		dbb_stats(*p),
 		dbb_lock_owner_id(getLockOwnerId()),
+		dbb_local_locks(NULL),
+		dbb_open_ranges(NULL),
 		dbb_tip_cache(NULL),
 		dbb_creation_date(Firebird::TimeZoneUtil::getCurrentGmtTimeStamp()),
 		dbb_external_file_directory_list(NULL),
@@ -896,6 +900,12 @@ namespace Jrd
 
 		dbb_internal.grow(irq_MAX);
 		dbb_dyn_req.grow(drq_MAX);
+
+		if (shared)
+		{
+			dbb_local_locks = FB_NEW_POOL(*p) LocalLockTable(*p);
+			dbb_open_ranges = FB_NEW_POOL(*p) OpenRangeTable(*p);
+		}
 	}
 
 	bool Database::GlobalObjectHolder::incTempCacheUsage(FB_SIZE_T size)
@@ -97,6 +97,7 @@ class KeywordsMap;
 class MetadataCache;
 class ExtEngineManager;
 class RelationPermanent;
+class OpenRangeTable;
 
 // Flags to indicate normal internal requests vs. dyn internal requests
 // IRQ_REQUESTS & DYN_REQUESTS are depecated
@@ -132,6 +133,7 @@ inline constexpr ULONG DBB_shared					= 0x100000L;	// Database object is shared
 inline constexpr ULONG DBB_restoring				= 0x200000L;	// Database restore is in progress
 inline constexpr ULONG DBB_rescan_pages				= 0x400000L;	// Rescan pages after TIP cache creation
 inline constexpr ULONG DBB_dropping					= 0x800000L;	// Drop database is in progress
+inline constexpr ULONG DBB_page_compression			= 0x1000000L;	// Pages may be written compressed
 
 //
 // dbb_ast_flags
@@ -438,6 +440,8 @@ public:
 	ULONG dbb_sweep_interval;			// Transactions between sweep
 	const ULONG dbb_lock_owner_id;		// ID for the lock manager
 	SLONG dbb_lock_owner_handle;		// Handle for the lock manager
+	LocalLockTable* dbb_local_locks;	// Locks granted without the lock manager (SuperServer)
+	OpenRangeTable* dbb_open_ranges;	// Block range summaries kept in memory (SuperServer)
 
 	USHORT unflushed_writes;			// unflushed writes
 	time_t last_flushed_write;			// last flushed write time
@@ -23,6 +23,7 @@
 #include "../common/classes/alloc.h"
 #include "../jrd/GarbageCollector.h"
 #include "../jrd/tra.h"
+#include <algorithm>
 
 using namespace Jrd;
 using namespace Firebird;
@@ -33,6 +34,7 @@ namespace Jrd {
 void GarbageCollector::RelationData::clear()
 {
 	m_pages.clear();
+	m_count = 0;
 }
 
 
@@ -58,6 +60,7 @@ TraNumber GarbageCollector::RelationData::addPage(const ULONG pageno, const TraN
 		return findTran;
 
 	m_pages.add(PageTran(pageno, tranid));
+	m_count++;
 	return tranid;
 }
 
@@ -76,6 +79,7 @@ void GarbageCollector::RelationData::swept(const TraNumber oldest_snapshot, Page
 				PBM_SET(&m_pool, bm, pages.current().pageno);
 			}
 			next = pages.fastRemove();
+			m_count--;
 		}
 		else
 			next = pages.getNext();
@@ -125,19 +129,26 @@ PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &
 {
 	SyncLockGuard shGuard(&m_sync, SYNC_SHARED, "GarbageCollector::getPages");
 
-	if (m_relations.isEmpty())
+	// Relations having more pages to collect go first, so the longest
+	// chains of back versions are removed before the others
+
+	HalfStaticArray<RelationData*, 16> candidates;
+
+	for (FB_SIZE_T pos = 0; pos < m_relations.getCount(); pos++)
 	{
-		m_nextRelID = 0;
-		return NULL;
+		if (m_relations[pos]->getCount())
+			candidates.add(m_relations[pos]);
 	}
 
-	FB_SIZE_T pos;
-	if (!m_relations.find(m_nextRelID, pos) && (pos == m_relations.getCount()))
-		pos = 0;
+	std::stable_sort(candidates.begin(), candidates.end(),
+		[](const RelationData* a, const RelationData* b)
+		{
+			return a->getCount() > b->getCount();
+		});
 
-	for (; pos < m_relations.getCount(); pos++)
+	for (RelationData** iter = candidates.begin(); iter < candidates.end(); iter++)
 	{
-		RelationData* relData = m_relations[pos];
+		RelationData* relData = *iter;
 		SyncLockGuard syncData(&relData->m_sync, SYNC_EXCLUSIVE, "GarbageCollector::getPages");
 
 		PageBitmap* bm = NULL;
@@ -146,16 +157,34 @@ PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &
 		if (bm)
 		{
 			relID = relData->getRelID();
-			m_nextRelID = relID + 1;
 			return bm;
 		}
 	}
 
-	m_nextRelID = 0;
 	return NULL;
 }
 
 
+void GarbageCollector::returnPages(const USHORT relID, PageBitmap* pages, const TraNumber tranid)
+{
+	// Pages taken by getPages() but not handled, put them back with the given
+	// transaction number to return them again by the next getPages() call
+
+	if (!pages || !pages->getFirst())
+		return;
+
+	Sync syncGC(&m_sync, "GarbageCollector::returnPages");
+	RelationData* relData = getRelData(syncGC, relID, true);
+
+	SyncLockGuard syncData(&relData->m_sync, SYNC_EXCLUSIVE, "GarbageCollector::returnPages");
+	syncGC.unlock();
+
+	do {
+		relData->addPage(pages->current(), tranid);
+	} while (pages->getNext());
+}
+
+
 void GarbageCollector::removeRelation(const USHORT relID)
 {
 	Sync syncGC(&m_sync, "GarbageCollector::removeRelation");
@@ -192,6 +221,25 @@ void GarbageCollector::sweptRelation(const TraNumber oldest_snapshot, const USHO
 }
 
 
+void GarbageCollector::getBacklog(ULONG& relations, FB_UINT64& pages)
+{
+	SyncLockGuard shGuard(&m_sync, SYNC_SHARED, "GarbageCollector::getBacklog");
+
+	relations = 0;
+	pages = 0;
+
+	for (FB_SIZE_T pos = 0; pos < m_relations.getCount(); pos++)
+	{
+		// Counter is read without the relation lock, it's good enough for statistics
+		if (const ULONG count = m_relations[pos]->getCount())
+		{
+			relations++;
+			pages += count;
+		}
+	}
+}
+
+
 GarbageCollector::RelationData* GarbageCollector::getRelData(Sync &sync, const USHORT relID,
 	bool allowCreate)
 {
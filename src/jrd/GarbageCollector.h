@@ -39,15 +39,17 @@ class GarbageCollector
 {
 public:
 	GarbageCollector(MemoryPool& p, Database* dbb)
-	  : m_pool(p), m_relations(m_pool), m_nextRelID(0)
+	  : m_pool(p), m_relations(m_pool)
 	{}
 
 	~GarbageCollector();
 
 	TraNumber addPage(const USHORT relID, const ULONG pageno, const TraNumber tranid);
 	PageBitmap* getPages(const TraNumber oldest_snapshot, USHORT &relID);
+	void returnPages(const USHORT relID, PageBitmap* pages, const TraNumber tranid);
 	void removeRelation(const USHORT relID);
 	void sweptRelation(const TraNumber oldest_snapshot, const USHORT relID);
+	void getBacklog(ULONG& relations, FB_UINT64& pages);
 
 private:
 	struct PageTran
@@ -77,7 +79,7 @@ private:
 	{
 	public:
 		explicit RelationData(MemoryPool& p, USHORT relID)
-			: m_pool(p), m_pages(p), m_relID(relID)
+			: m_pool(p), m_pages(p), m_relID(relID), m_count(0)
 		{}
 
 		~RelationData()
@@ -94,6 +96,11 @@ private:
 			return m_relID;
 		}
 
+		ULONG getCount() const
+		{
+			return m_count;
+		}
+
 		static inline const USHORT generate(const RelationData* item)
 		{
 			return item->m_relID;
@@ -105,6 +112,7 @@ private:
 		Firebird::SyncObject m_sync;
 		PageTranMap m_pages;
 		USHORT m_relID;
+		ULONG m_count;		// number of pages in m_pages
 	};
 
 	typedef	Firebird::SortedArray<
@@ -118,7 +126,6 @@ private:
 	Firebird::MemoryPool& m_pool;
 	Firebird::SyncObject m_sync;
 	RelGarbageArray m_relations;
-	USHORT m_nextRelID;
 };
 
 } // namespace Jrd
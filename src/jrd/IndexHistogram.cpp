@@ -0,0 +1,267 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		IndexHistogram.cpp
+ *	DESCRIPTION:	Distribution of index keys for the optimizer
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../jrd/IndexHistogram.h"
+#include <algorithm>
+#include <string.h>
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	// Stored image: version, root page, key type, count of keys, sample interval,
+	// count of samples and the samples themselves, each prefixed by its length.
+	// Numbers are little-endian to not depend on the platform.
+
+	constexpr UCHAR STORE_VERSION = 1;
+	constexpr ULONG HEADER_LENGTH = 1 + 4 + 2 + 8 + 8 + 4;
+
+	void putNumber(UCharBuffer& buffer, FB_UINT64 value, unsigned length)
+	{
+		for (unsigned i = 0; i < length; i++)
+			buffer.add((UCHAR) (value >> (i * 8)));
+	}
+
+	FB_UINT64 getNumber(const UCHAR*& ptr, unsigned length)
+	{
+		FB_UINT64 value = 0;
+
+		for (unsigned i = 0; i < length; i++)
+			value |= (FB_UINT64) *ptr++ << (i * 8);
+
+		return value;
+	}
+
+	bool lessKey(const Array<UCHAR>* key1, const Array<UCHAR>* key2)
+	{
+		const FB_SIZE_T length = MIN(key1->getCount(), key2->getCount());
+
+		if (const int result = memcmp(key1->begin(), key2->begin(), length))
+			return result < 0;
+
+		return key1->getCount() < key2->getCount();
+	}
+}
+
+
+void IndexHistogram::add(const UCHAR* key, USHORT length)
+{
+	if (m_count++ % m_interval)
+		return;
+
+	// The sample is full, keep every second key of it and take keys twice rarer
+
+	if (m_offsets.getCount() == MIN_SAMPLES * 2)
+	{
+		ULONG target = 0;
+
+		for (unsigned n = 0; n < m_offsets.getCount(); n += 2)
+		{
+			const Bound sample = getSample(n);
+
+			m_offsets[n / 2] = target;
+			memmove(m_data.begin() + target, sample.data, sample.length);
+			target += sample.length;
+		}
+
+		m_offsets.shrink(MIN_SAMPLES);
+		m_data.shrink(target);
+		m_interval *= 2;
+
+		// The current key stays in the sample only if it fits the new interval
+
+		if ((m_count - 1) % m_interval)
+			return;
+	}
+
+	m_offsets.add(m_data.getCount());
+	m_data.add(key, length);
+}
+
+
+void IndexHistogram::store(UCharBuffer& buffer) const
+{
+	buffer.clear();
+
+	putNumber(buffer, STORE_VERSION, 1);
+	putNumber(buffer, m_root, 4);
+	putNumber(buffer, m_keyType, 2);
+	putNumber(buffer, m_count, 8);
+	putNumber(buffer, m_interval, 8);
+	putNumber(buffer, m_offsets.getCount(), 4);
+
+	for (unsigned n = 0; n < m_offsets.getCount(); n++)
+	{
+		const Bound sample = getSample(n);
+
+		putNumber(buffer, sample.length, 2);
+		buffer.add(sample.data, sample.length);
+	}
+}
+
+
+bool IndexHistogram::load(const UCHAR* data, ULONG length)
+{
+	const UCHAR* ptr = data;
+	const UCHAR* const end = data + length;
+
+	if (length < HEADER_LENGTH || getNumber(ptr, 1) != STORE_VERSION)
+		return false;
+
+	const ULONG root = (ULONG) getNumber(ptr, 4);
+	const USHORT keyType = (USHORT) getNumber(ptr, 2);
+	const FB_UINT64 count = getNumber(ptr, 8);
+	const FB_UINT64 interval = getNumber(ptr, 8);
+	const ULONG samples = (ULONG) getNumber(ptr, 4);
+
+	if (!interval || samples > MIN_SAMPLES * 2)
+		return false;
+
+	m_data.clear();
+	m_offsets.clear();
+
+	for (ULONG n = 0; n < samples; n++)
+	{
+		if (end - ptr < 2)
+			return false;
+
+		const USHORT sampleLength = (USHORT) getNumber(ptr, 2);
+
+		if (end - ptr < sampleLength)
+			return false;
+
+		m_offsets.add(m_data.getCount());
+		m_data.add(ptr, sampleLength);
+		ptr += sampleLength;
+	}
+
+	if (ptr != end)
+		return false;
+
+	m_root = root;
+	m_keyType = keyType;
+	m_count = count;
+	m_interval = interval;
+
+	return true;
+}
+
+
+unsigned IndexHistogram::countSamples(const Bound& lower, const Bound& upper, bool upperPrefix) const
+{
+	// Samples are sorted, so find the first sample not less than the lower bound
+	// and the first sample greater than the upper one
+
+	unsigned first = 0;
+
+	if (lower.data)
+	{
+		unsigned high = m_offsets.getCount();
+
+		while (first < high)
+		{
+			const unsigned mid = (first + high) / 2;
+
+			if (compare(getSample(mid), lower, false) < 0)
+				first = mid + 1;
+			else
+				high = mid;
+		}
+	}
+
+	unsigned last = m_offsets.getCount();
+
+	if (upper.data)
+	{
+		unsigned low = first;
+
+		while (low < last)
+		{
+			const unsigned mid = (low + last) / 2;
+
+			if (compare(getSample(mid), upper, upperPrefix) <= 0)
+				low = mid + 1;
+			else
+				last = mid;
+		}
+	}
+
+	return (last > first) ? last - first : 0;
+}
+
+
+int IndexHistogram::compare(const Bound& sample, const Bound& key, bool prefix)
+{
+	// Index keys are compared byte-wise, the shorter key goes first
+
+	const USHORT length = MIN(sample.length, key.length);
+
+	if (const int result = memcmp(sample.data, key.data, length))
+		return result;
+
+	if (sample.length == key.length || (prefix && sample.length > key.length))
+		return 0;
+
+	return (sample.length < key.length) ? -1 : 1;
+}
+
+
+void IndexHistogram::Sampler::add(const UCHAR* key, USHORT length)
+{
+	// Reservoir sampling: the n-th key replaces a random sampled one with probability MAX_KEYS / n
+
+	m_count++;
+
+	if (m_keys.getCount() < MAX_KEYS)
+	{
+		m_keys.add().assign(key, length);
+		return;
+	}
+
+	m_random ^= m_random >> 12;
+	m_random ^= m_random << 25;
+	m_random ^= m_random >> 27;
+
+	const FB_UINT64 pos = (m_random * 0x2545F4914F6CDD1D) % m_count;
+
+	if (pos < MAX_KEYS)
+		m_keys[(FB_SIZE_T) pos].assign(key, length);
+}
+
+
+void IndexHistogram::Sampler::build(IndexHistogram* histogram)
+{
+	HalfStaticArray<const Array<UCHAR>*, MAX_KEYS> keys(getPool());
+
+	for (const auto& key : m_keys)
+		keys.add(&key);
+
+	std::sort(keys.begin(), keys.end(), lessKey);
+
+	for (const auto key : keys)
+		histogram->add(key->begin(), (USHORT) key->getCount());
+}
@@ -0,0 +1,155 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		IndexHistogram.h
+ *	DESCRIPTION:	Distribution of index keys for the optimizer
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef JRD_INDEX_HISTOGRAM_H
+#define JRD_INDEX_HISTOGRAM_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/objects_array.h"
+#include "../common/classes/RefCounted.h"
+
+namespace Jrd {
+
+// Equi-depth histogram of the index keys: the keys taken at equal distances
+// while the whole index is walked in the key order, i.e. when it's created or
+// its statistics are recalculated. The sample interval doubles every time the
+// sample grows twice over the desired size, so the total count of keys doesn't
+// need to be known in advance. Frequent key values occupy many samples, which
+// makes the histogram a most-common-values list as well.
+// The same histogram describes a non-indexed column too, then its keys are made
+// as if the column was the only segment of an ascending index.
+
+class IndexHistogram : public Firebird::RefCounted, public Firebird::PermanentStorage
+{
+public:
+	static constexpr unsigned MIN_SAMPLES = 256;
+
+	struct Bound
+	{
+		Bound() = default;
+
+		Bound(const UCHAR* aData, USHORT aLength)
+			: data(aData), length(aLength)
+		{}
+
+		const UCHAR* data = nullptr;	// no bound if null
+		USHORT length = 0;
+	};
+
+	explicit IndexHistogram(MemoryPool& pool)
+		: PermanentStorage(pool),
+		  m_data(pool),
+		  m_offsets(pool)
+	{}
+
+	// Keys must be added in the index order
+	void add(const UCHAR* key, USHORT length);
+
+	// Serialize the histogram to be stored in RDB$HISTOGRAM and restore it back,
+	// false is returned if the stored image is not recognized
+	void store(Firebird::UCharBuffer& buffer) const;
+	bool load(const UCHAR* data, ULONG length);
+
+	// Count samples within the bounds (inclusive). If upperPrefix is set, the upper
+	// bound also includes all keys having it as a prefix, e.g. for STARTING WITH or
+	// when the bound is made of the leading segments of the compound index.
+	unsigned countSamples(const Bound& lower, const Bound& upper, bool upperPrefix) const;
+
+	unsigned getSampleCount() const
+	{
+		return m_offsets.getCount();
+	}
+
+	FB_UINT64 getKeyCount() const
+	{
+		return m_count;
+	}
+
+	// Root page of the index this histogram was built for
+	ULONG getRoot() const
+	{
+		return m_root;
+	}
+
+	void setRoot(ULONG root)
+	{
+		m_root = root;
+	}
+
+	// Index key type of the column (idx_itype) the histogram was built for
+	USHORT getKeyType() const
+	{
+		return m_keyType;
+	}
+
+	void setKeyType(USHORT keyType)
+	{
+		m_keyType = keyType;
+	}
+
+	// Random sample of the keys coming in any order, e.g. while the table is read.
+	// The sampled keys are sorted to make the histogram when they're all seen.
+	class Sampler : public Firebird::PermanentStorage
+	{
+	public:
+		static constexpr unsigned MAX_KEYS = MIN_SAMPLES * 8;
+
+		explicit Sampler(MemoryPool& pool)
+			: PermanentStorage(pool),
+			  m_keys(pool)
+		{}
+
+		void add(const UCHAR* key, USHORT length);
+		void build(IndexHistogram* histogram);
+
+	private:
+		FB_UINT64 m_count = 0;
+		FB_UINT64 m_random = 0x9E3779B97F4A7C15;
+		Firebird::ObjectsArray<Firebird::Array<UCHAR> > m_keys;
+	};
+
+private:
+	Bound getSample(unsigned n) const
+	{
+		const ULONG end = (n + 1 < m_offsets.getCount()) ? m_offsets[n + 1] : m_data.getCount();
+		return Bound(m_data.begin() + m_offsets[n], end - m_offsets[n]);
+	}
+
+	static int compare(const Bound& sample, const Bound& key, bool prefix);
+
+	ULONG m_root = 0;
+	USHORT m_keyType = 0;
+	FB_UINT64 m_count = 0;
+	FB_UINT64 m_interval = 1;
+	Firebird::Array<UCHAR> m_data;
+	Firebird::Array<ULONG> m_offsets;
+};
+
+// Histograms of the table columns, indexed by field id
+typedef Firebird::ObjectsArray<Firebird::RefPtr<IndexHistogram> > ColumnHistogramList;
+
+} // namespace Jrd
+
+#endif // JRD_INDEX_HISTOGRAM_H
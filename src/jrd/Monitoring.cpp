@@ -26,6 +26,7 @@
 #include "../common/classes/fb_string.h"
 #include "../jrd/jrd.h"
 #include "../jrd/cch.h"
+#include "../jrd/GarbageCollector.h"
 #include "../jrd/ids.h"
 #include "../jrd/ini.h"
 #include "../jrd/nbak.h"
@@ -1031,6 +1032,30 @@ void Monitoring::putDatabase(thread_db* tdbb, SnapshotData::DumpRecord& record)
 
 	record.storeInteger(f_mon_db_repl_mode, dbb->dbb_replica_mode);
 
+	// page cache statistics, merged from the attachments when they dumped their state
+	{ // scope
+		MutexLockGuard guard(dbb->dbb_stats_mutex, FB_FUNCTION);
+		const RuntimeStatistics& stats = dbb->dbb_stats;
+
+		record.storeInteger(f_mon_db_data_fetches, stats.getFetches(CachePageClass::DATA));
+		record.storeInteger(f_mon_db_data_reads, stats.getReads(CachePageClass::DATA));
+		record.storeInteger(f_mon_db_index_fetches, stats.getFetches(CachePageClass::INDEX));
+		record.storeInteger(f_mon_db_index_reads, stats.getReads(CachePageClass::INDEX));
+		record.storeInteger(f_mon_db_pointer_fetches, stats.getFetches(CachePageClass::POINTER));
+		record.storeInteger(f_mon_db_pointer_reads, stats.getReads(CachePageClass::POINTER));
+	}
+
+	// backlog of the background garbage collector
+	if (GarbageCollector* const gc = dbb->dbb_garbage_collector)
+	{
+		ULONG relations = 0;
+		FB_UINT64 pages = 0;
+		gc->getBacklog(relations, pages);
+
+		record.storeInteger(f_mon_db_gc_tables, relations);
+		record.storeInteger(f_mon_db_gc_pages, pages);
+	}
+
 	// statistics
 	const int stat_id = fb_utils::genUniqueId();
 	record.storeGlobalId(f_mon_db_stat_id, getGlobalId(stat_id));
@@ -0,0 +1,224 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		PageCompression.cpp
+ *	DESCRIPTION:	Compression of data and blob pages on disk
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#include "firebird.h"
+#include "../jrd/PageCompression.h"
+#include "../common/classes/array.h"
+#include "../common/classes/init.h"
+#include "../common/classes/locks.h"
+#include "../common/classes/zip.h"
+#include <string.h>
+
+using namespace Firebird;
+using namespace Jrd;
+using namespace Ods;
+
+
+struct PageCompression::Workspace
+{
+	Workspace()
+		: buffer(FB_ALIGN(space, SPARSE_BLOCK))
+	{}
+
+	ZStd::CCtx* cctx = nullptr;
+	ZStd::DCtx* dctx = nullptr;
+	UCHAR* const buffer;	// aligned for direct I/O
+	UCHAR space[MAX_PAGE_SIZE + SPARSE_BLOCK];
+};
+
+namespace
+{
+	// Workspaces are cached to not recreate zstd contexts for every page
+
+	class Codec
+	{
+	public:
+		static constexpr FB_SIZE_T MAX_CACHED = 32;
+
+		explicit Codec(MemoryPool& pool)
+			: zstd(pool), workspaces(pool)
+		{}
+
+		~Codec()
+		{
+			while (workspaces.hasData())
+				destroy(workspaces.pop());
+		}
+
+		void destroy(PageCompression::Workspace* workspace)
+		{
+			if (workspace->cctx)
+				zstd.freeCCtx(workspace->cctx);
+
+			if (workspace->dctx)
+				zstd.freeDCtx(workspace->dctx);
+
+			delete workspace;
+		}
+
+		ZStd zstd;
+		Mutex mutex;
+		HalfStaticArray<PageCompression::Workspace*, MAX_CACHED> workspaces;
+	};
+
+	InitInstance<Codec> codec;
+}
+
+
+PageCompression::Image::Image(const pag* page, ULONG pageSize, int level)
+	: m_workspace(nullptr), m_data(page), m_length(pageSize)
+{
+	if (!level || pageSize <= SPARSE_BLOCK ||
+		(page->pag_type != pag_data && page->pag_type != pag_blob) ||
+		(page->pag_flags & crypted_page))
+	{
+		return;
+	}
+
+	Workspace* const workspace = acquire(true);
+	if (!workspace)
+		return;
+
+	// The compressed page must release at least one block of disk space,
+	// so don't let zstd produce anything longer
+
+	const auto source = reinterpret_cast<const UCHAR*>(page) + sizeof(pag);
+	UCHAR* const target = workspace->buffer + sizeof(pag);
+	const ULONG limit = pageSize - SPARSE_BLOCK - sizeof(pag);
+
+	const size_t length = codec().zstd.compressCCtx(workspace->cctx,
+		target, limit, source, pageSize - sizeof(pag), level);
+
+	if (codec().zstd.isError(length))
+	{
+		release(workspace);
+		return;
+	}
+
+	memcpy(workspace->buffer, page, sizeof(pag));
+
+	const auto header = reinterpret_cast<pag*>(workspace->buffer);
+	header->pag_flags |= compressed_page;
+	header->pag_reserved = (USHORT) length;
+
+	m_length = FB_ALIGN(sizeof(pag) + length, SPARSE_BLOCK);
+	memset(target + length, 0, m_length - sizeof(pag) - length);
+
+	m_workspace = workspace;
+	m_data = workspace->buffer;
+}
+
+PageCompression::Image::~Image()
+{
+	if (m_workspace)
+		release(m_workspace);
+}
+
+bool PageCompression::unpack(pag* page, ULONG pageSize)
+{
+	if (!isPacked(page))
+		return true;
+
+	const ULONG length = page->pag_reserved;
+	if (length > pageSize - sizeof(pag))
+		return false;
+
+	Workspace* const workspace = acquire(false);
+	if (!workspace)
+		return false;
+
+	UCHAR* const target = reinterpret_cast<UCHAR*>(page) + sizeof(pag);
+	memcpy(workspace->buffer, target, length);
+
+	const size_t result = codec().zstd.decompressDCtx(workspace->dctx,
+		target, pageSize - sizeof(pag), workspace->buffer, length);
+
+	release(workspace);
+
+	if (codec().zstd.isError(result) || result != pageSize - sizeof(pag))
+		return false;
+
+	page->pag_flags &= ~compressed_page;
+	page->pag_reserved = 0;
+
+	return true;
+}
+
+bool PageCompression::isAvailable()
+{
+	return codec().zstd;
+}
+
+PageCompression::Workspace* PageCompression::acquire(bool compress)
+{
+	Codec& instance = codec();
+
+	if (!instance.zstd)
+		return nullptr;
+
+	Workspace* workspace = nullptr;
+
+	{	// scope
+		MutexLockGuard guard(instance.mutex, FB_FUNCTION);
+
+		if (instance.workspaces.hasData())
+			workspace = instance.workspaces.pop();
+	}
+
+	if (!workspace)
+		workspace = FB_NEW_POOL(*getDefaultMemoryPool()) Workspace;
+
+	if (compress ? !workspace->cctx : !workspace->dctx)
+	{
+		if (compress)
+			workspace->cctx = instance.zstd.createCCtx();
+		else
+			workspace->dctx = instance.zstd.createDCtx();
+
+		if (compress ? !workspace->cctx : !workspace->dctx)
+		{
+			release(workspace);
+			return nullptr;
+		}
+	}
+
+	return workspace;
+}
+
+void PageCompression::release(Workspace* workspace)
+{
+	Codec& instance = codec();
+
+	{	// scope
+		MutexLockGuard guard(instance.mutex, FB_FUNCTION);
+
+		if (instance.workspaces.getCount() < Codec::MAX_CACHED)
+		{
+			instance.workspaces.push(workspace);
+			return;
+		}
+	}
+
+	instance.destroy(workspace);
+}
@@ -0,0 +1,99 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		PageCompression.h
+ *	DESCRIPTION:	Compression of data and blob pages on disk
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef JRD_PAGE_COMPRESSION_H
+#define JRD_PAGE_COMPRESSION_H
+
+#include "../jrd/ods.h"
+
+namespace Jrd {
+
+// Data and blob pages may be stored compressed by zstd in the database file.
+// The page header stays as is, except the compressed_page flag, while the rest
+// of the page is replaced by its compressed image, pag_reserved keeping the
+// image length. The image is padded with zeroes up to SPARSE_BLOCK, the disk
+// space after it is expected to be released by the caller (see PIO_write).
+// Pages are decompressed right after they're read, so nothing above the
+// physical I/O layer ever sees them compressed.
+
+class PageCompression
+{
+public:
+	// Compression contexts and a page buffer, reused by all databases
+	struct Workspace;
+
+	// Granularity of the disk space released after a compressed page
+	static constexpr ULONG SPARSE_BLOCK = 4096;
+
+	// Page image to be written to disk
+	class Image
+	{
+	public:
+		// The page is compressed if level is not zero and it's worth doing,
+		// otherwise the image is the page itself
+		Image(const Ods::pag* page, ULONG pageSize, int level);
+		~Image();
+
+		const void* begin() const
+		{
+			return m_data;
+		}
+
+		// Number of bytes to write, the rest of the page may be released
+		ULONG getLength() const
+		{
+			return m_length;
+		}
+
+		bool isPacked() const
+		{
+			return m_workspace != nullptr;
+		}
+
+	private:
+		Workspace* m_workspace;
+		const void* m_data;
+		ULONG m_length;
+	};
+
+	static bool isPacked(const Ods::pag* page)
+	{
+		return (page->pag_type == pag_data || page->pag_type == pag_blob) &&
+			(page->pag_flags & Ods::compressed_page);
+	}
+
+	// Decompress the page read from disk in place, return false if it can't be done
+	static bool unpack(Ods::pag* page, ULONG pageSize);
+
+	// Check whether zstd library is loaded
+	static bool isAvailable();
+
+private:
+	static Workspace* acquire(bool compress);
+	static void release(Workspace* workspace);
+};
+
+} // namespace Jrd
+
+#endif // JRD_PAGE_COMPRESSION_H
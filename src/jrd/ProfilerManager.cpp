@@ -104,9 +104,8 @@ namespace
 		tempLock.setKey(attachmentId);
 
 		// Check if attachment is alive.
-		if (LCK_lock(tdbb, &tempLock, LCK_EX, LCK_NO_WAIT))
+		if (LCK_probe(tdbb, &tempLock, LCK_EX))
 		{
-			LCK_release(tdbb, &tempLock);
 			(Arg::Gds(isc_random) << "Cannot start remote profile session - attachment is not active").raise();
 		}
 
@@ -130,7 +130,8 @@ RelationPermanent::RelationPermanent(thread_db* tdbb, MemoryPool& p, MetaId id,
 	  rel_pages_base(p),
 	  rel_pages_free(nullptr),
 	  rel_file(nullptr),
-	  rel_clear_deps(p)
+	  rel_clear_deps(p),
+	  rel_histograms(p)
 {
 	rel_partners_lock = FB_NEW_RPT(getPool(), 0)
 		Lock(tdbb, sizeof(SLONG), LCK_rel_partners, this, partners_ast_relation);
@@ -666,6 +667,30 @@ Cached::Index* RelationPermanent::ensureIndex(thread_db* tdbb, MetaId id)
 }
 
 
+RefPtr<IndexHistogram> RelationPermanent::getColumnHistogram(thread_db* tdbb, USHORT id)
+{
+	MutexLockGuard guard(rel_histograms_mutex, FB_FUNCTION);
+
+	if (!rel_histograms_loaded)
+	{
+		// Flag is set in advance as the loading request is optimized too
+		rel_histograms_loaded = true;
+		loadColumnHistograms(tdbb);
+	}
+
+	return (id < rel_histograms.getCount()) ? rel_histograms[id] : RefPtr<IndexHistogram>();
+}
+
+
+void RelationPermanent::resetColumnHistograms()
+{
+	MutexLockGuard guard(rel_histograms_mutex, FB_FUNCTION);
+
+	rel_histograms.clear();
+	rel_histograms_loaded = false;
+}
+
+
 PageNumber RelationPermanent::getIndexRootPage(thread_db* tdbb)
 {
 /**************************************
@@ -1080,7 +1105,7 @@ void RelationPages::free(RelationPages*& nextFree)
 	if (rel_pages)
 		rel_pages->clear();
 
-	rel_index_root = rel_data_pages = 0;
+	rel_index_root = rel_data_pages = rel_visible_pages = 0;
 	rel_slot_space = rel_pri_data_space = rel_sec_data_space = 0;
 	rel_last_free_pri_dp = rel_last_free_blb_dp = 0;
 	rel_instance_id = 0;
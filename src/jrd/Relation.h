@@ -25,6 +25,7 @@
 #include "../jrd/vec.h"
 #include <optional>
 #include "../jrd/btr.h"
+#include "../jrd/IndexHistogram.h"
 #include "../jrd/lck.h"
 #include "../jrd/pag.h"
 #include "../jrd/val.h"
@@ -320,6 +321,7 @@ public:
 
 	ULONG rel_index_root;		// index root page number
 	ULONG rel_data_pages;		// count of relation data pages
+	ULONG rel_visible_pages;	// count of all visible data pages, counted with rel_data_pages
 	ULONG rel_slot_space;		// lowest pointer page with slot space
 	ULONG rel_pri_data_space;	// lowest pointer page with primary data page space
 	ULONG rel_sec_data_space;	// lowest pointer page with secondary data page space
@@ -329,7 +331,7 @@ public:
 
 	RelationPages(Firebird::MemoryPool& pool)
 		: rel_pages(NULL), rel_instance_id(0),
-		  rel_index_root(0), rel_data_pages(0), rel_slot_space(0),
+		  rel_index_root(0), rel_data_pages(0), rel_visible_pages(0), rel_slot_space(0),
 		  rel_pri_data_space(0), rel_sec_data_space(0),
 		  rel_last_free_pri_dp(0), rel_last_free_blb_dp(0),
 		  rel_pg_space_id(DB_PAGE_SPACE), rel_next_free(NULL),
@@ -533,9 +535,32 @@ public:
 		idp_formatNumber = fmt;
 	}
 
+	// Histogram is read from RDB$INDICES when requested the first time
+	Firebird::RefPtr<IndexHistogram> getHistogram(thread_db* tdbb)
+	{
+		Firebird::MutexLockGuard guard(idp_histogram_mutex, FB_FUNCTION);
+
+		if (!idp_histogram_loaded)
+		{
+			// Flag is set in advance as the loading request may use this index
+			idp_histogram_loaded = true;
+			idp_histogram = loadHistogram(tdbb);
+		}
+
+		return idp_histogram;
+	}
+
+	void setHistogram(IndexHistogram* histogram)
+	{
+		Firebird::MutexLockGuard guard(idp_histogram_mutex, FB_FUNCTION);
+		idp_histogram = histogram;
+		idp_histogram_loaded = true;
+	}
+
 private:
 	void refreshIndexCode(thread_db* tdbb, Cached::Relation* relation,
 		index_desc* idx, const Ods::index_root_page::irt_repeat* irt_desc);
+	Firebird::RefPtr<IndexHistogram> loadHistogram(thread_db* tdbb);		// impl. in met.epp
 
 	Firebird::Mutex		idp_code_mutex;			// Delays concurrent threads till the end of code refresh
 
@@ -547,6 +572,10 @@ private:
 	bid					idp_condition_bid;
 	BoolExprNode*		idp_condition = nullptr;			// node tree for index condition
 	Statement*			idp_condition_statement = nullptr;	// statement for index condition evaluation
+
+	Firebird::Mutex		idp_histogram_mutex;
+	Firebird::RefPtr<IndexHistogram> idp_histogram;		// keys distribution, if collected
+	bool				idp_histogram_loaded = false;
 };
 
 
@@ -841,6 +870,8 @@ public:
 	{
 		if (erase)
 			dropTempPages(tdbb);
+
+		resetColumnHistograms();
 	}
 
 	// void makeLocks(thread_db* tdbb, Cached::Relation* relation);		// hvlad: not implemented
@@ -980,6 +1011,12 @@ public:
 	// Lists of FK partners should be updated on next update
 	void checkPartners(thread_db* tdbb);
 
+	// Histograms of the columns collected by SET STATISTICS TABLE,
+	// read from RDB$RELATION_FIELDS when requested the first time
+	// and reread after the commit of a new relation version
+	Firebird::RefPtr<IndexHistogram> getColumnHistogram(thread_db* tdbb, USHORT id);
+	void resetColumnHistograms();
+
 	// On commit of relation dependencies of global field to be cleaned ...
 	void removeDependsFrom(const QualifiedName& globField);
 	//			... will be removed
@@ -1033,6 +1070,12 @@ private:
 	ExternalFile* rel_file;
 
 	Firebird::Array<QualifiedName> rel_clear_deps;
+
+	void loadColumnHistograms(thread_db* tdbb);		// impl. in met.epp
+
+	ColumnHistogramList rel_histograms;			// indexed by field id
+	Firebird::Mutex rel_histograms_mutex;
+	bool rel_histograms_loaded = false;
 };
 
 
@@ -43,6 +43,9 @@ void RuntimeStatistics::adjust(const RuntimeStatistics& baseStats, const Runtime
 	for (size_t i = 0; i < GLOBAL_ITEMS; ++i)
 		values[i] += newStats.values[i] - baseStats.values[i];
 
+	for (size_t i = 0; i < CLASS_TOTAL_ITEMS; ++i)
+		classValues[i] += newStats.classValues[i] - baseStats.classValues[i];
+
 	if (baseStats.pageChgNumber != newStats.pageChgNumber)
 	{
 		pageChgNumber++;
@@ -69,6 +72,14 @@ void RuntimeStatistics::adjustPageStats(RuntimeStatistics& baseStats, const Runt
 		values[i] += delta;
 		baseStats.values[i] += delta;
 	}
+
+	for (size_t i = 0; i < CLASS_TOTAL_ITEMS; ++i)
+	{
+		const SINT64 delta = newStats.classValues[i] - baseStats.classValues[i];
+
+		classValues[i] += delta;
+		baseStats.classValues[i] += delta;
+	}
 }
 
 template <class Counts>
@@ -117,6 +128,9 @@ void RuntimeStatistics::setToDiff(const RuntimeStatistics& newStats)
 	for (size_t i = 0; i < GLOBAL_ITEMS; i++)
 		values[i] = newStats.values[i] - values[i];
 
+	for (size_t i = 0; i < CLASS_TOTAL_ITEMS; i++)
+		classValues[i] = newStats.classValues[i] - classValues[i];
+
 	for (const auto& newCounts : newStats.pageCounters)
 	{
 		const auto pageSpaceId = newCounts.getGroupId();
@@ -53,6 +53,19 @@ enum class PageStatType
 	TOTAL_ITEMS
 };
 
+// Classes of pages accounted separately in cache statistics
+
+enum class CachePageClass
+{
+	DATA = 0,	// data and blob pages
+	INDEX,		// b-tree and index root pages
+	POINTER,	// pointer pages
+	OTHER,
+	TOTAL_ITEMS
+};
+
+inline constexpr size_t CACHE_PAGE_CLASSES = static_cast<size_t>(CachePageClass::TOTAL_ITEMS);
+
 enum class RecordStatType
 {
 	SEQ_READS = 0,
@@ -77,6 +90,8 @@ class RuntimeStatistics : protected Firebird::AutoStorage
 {
 	static constexpr size_t PAGE_TOTAL_ITEMS = static_cast<size_t>(PageStatType::TOTAL_ITEMS);
 	static constexpr size_t RECORD_TOTAL_ITEMS = static_cast<size_t>(RecordStatType::TOTAL_ITEMS);
+	// Fetches and then reads of every class of pages
+	static constexpr size_t CLASS_TOTAL_ITEMS = 2 * CACHE_PAGE_CLASSES;
 
 public:
 	// Number of globally counted items.
@@ -310,6 +325,7 @@ public:
 		  tableCounters(getPool(), other.tableCounters)
 	{
 		memcpy(values, other.values, sizeof(values));
+		memcpy(classValues, other.classValues, sizeof(classValues));
 
 		pageCounters = other.pageCounters;
 		tableCounters = other.tableCounters;
@@ -325,6 +341,7 @@ public:
 		  tableCounters(getPool(), other.tableCounters)
 	{
 		memcpy(values, other.values, sizeof(values));
+		memcpy(classValues, other.classValues, sizeof(classValues));
 
 		pageCounters = other.pageCounters;
 		tableCounters = other.tableCounters;
@@ -339,6 +356,7 @@ public:
 	void reset()
 	{
 		memset(values, 0, sizeof(values));
+		memset(classValues, 0, sizeof(classValues));
 
 		pageCounters.reset();
 		tableCounters.reset();
@@ -367,6 +385,26 @@ public:
 		}
 	}
 
+	SINT64 getFetches(const CachePageClass pageClass) const
+	{
+		return classValues[static_cast<size_t>(pageClass)];
+	}
+
+	SINT64 getReads(const CachePageClass pageClass) const
+	{
+		return classValues[CACHE_PAGE_CLASSES + static_cast<size_t>(pageClass)];
+	}
+
+	void bumpValue(const CachePageClass pageClass, bool read)
+	{
+		++allChgNumber;
+		const auto index = static_cast<size_t>(pageClass);
+		++classValues[index];
+
+		if (read)
+			++classValues[CACHE_PAGE_CLASSES + index];
+	}
+
 	const SINT64& operator[](const RecordStatType type) const
 	{
 		const auto index = static_cast<size_t>(type);
@@ -413,6 +451,7 @@ public:
 		if (allChgNumber != other.allChgNumber)
 		{
 			memcpy(values, other.values, sizeof(values));
+			memcpy(classValues, other.classValues, sizeof(classValues));
 			allChgNumber = other.allChgNumber;
 
 			if (pageChgNumber != other.pageChgNumber)
@@ -471,6 +510,7 @@ public:
 
 private:
 	SINT64 values[GLOBAL_ITEMS];
+	SINT64 classValues[CLASS_TOTAL_ITEMS];
 	PageCounters pageCounters;
 	TableCounters tableCounters;
 
@@ -154,6 +154,9 @@ Statement::Statement(thread_db* tdbb, MemoryPool* p, CompilerScratch* csb)
 			if (tail->csb_flags & csb_skip_locked)
 				rpb->rpb_stream_flags |= RPB_s_skipLocked;
 
+			if (tail->csb_flags & csb_index_only)
+				rpb->rpb_stream_flags |= RPB_s_index_only;
+
 			rpb->rpb_relation = tail->csb_relation;
 			if (rpb->rpb_relation())
 				fb_assert(resources->relations.knownResource(rpb->rpb_relation()));
@@ -46,6 +46,17 @@ namespace
 {
 	constexpr size_t MIN_TEMP_BLOCK_SIZE = 64 * 1024;
 
+	// Packed blocks are compressed by chunks of this size, slots for them
+	// in the temp files are aligned to 1/8 of chunk
+	constexpr ULONG PACKED_CHUNK_SIZE = MIN_TEMP_BLOCK_SIZE;
+	constexpr ULONG PACKED_SLOT_ALIGN = PACKED_CHUNK_SIZE / 8;
+
+	// Spilled data is compressed by the fastest zstd mode, it's
+	// written once and read back at most a few times
+	constexpr int PACKED_LEVEL = 1;
+
+	InitInstance<ZStd> zstd;
+
 	class TempCacheLimitGuard
 	{
 	public:
@@ -129,6 +140,219 @@ FB_SIZE_T TempSpace::FileBlock::write(offset_t offset, const void* buffer, FB_SI
 	return file->write(offset, buffer, length);
 }
 
+//
+// Compressed on-disk block class
+//
+
+TempSpace::PackedBlock::PackedBlock(TempSpace* owner, Block* tail, size_t length)
+	: Block(tail, 0), space(owner),
+	  chunks(owner->pool), current(owner->pool), packBuffer(owner->pool),
+	  currentIndex(MAX_ULONG), currentDirty(false),
+	  cctx(nullptr), dctx(nullptr),
+	  extentFile(NULL), extentSeek(0), extentSize(0)
+{
+	current.getBuffer(PACKED_CHUNK_SIZE);
+	packBuffer.getBuffer(PACKED_CHUNK_SIZE);
+
+	extend(length);
+}
+
+TempSpace::PackedBlock::~PackedBlock()
+{
+	if (cctx)
+		zstd().freeCCtx(cctx);
+
+	if (dctx)
+		zstd().freeDCtx(dctx);
+}
+
+void TempSpace::PackedBlock::extend(size_t length)
+{
+	fb_assert(length % PACKED_CHUNK_SIZE == 0);
+
+	Chunk chunk;
+	chunk.file = NULL;
+	chunk.seek = 0;
+	chunk.capacity = 0;
+	chunk.length = 0;
+	chunk.packed = false;
+
+	for (size_t i = 0; i < length / PACKED_CHUNK_SIZE; i++)
+		chunks.add(chunk);
+
+	size += length;
+	space->packedSize += length;
+}
+
+FB_SIZE_T TempSpace::PackedBlock::read(offset_t offset, void* buffer, FB_SIZE_T length)
+{
+	if (offset + length > size)
+	{
+		length = size - offset;
+	}
+
+	UCHAR* p = static_cast<UCHAR*>(buffer);
+
+	for (FB_SIZE_T l = length; l;)
+	{
+		const ULONG index = offset / PACKED_CHUNK_SIZE;
+		const ULONG chunkOffset = offset % PACKED_CHUNK_SIZE;
+		const FB_SIZE_T n = MIN(l, PACKED_CHUNK_SIZE - chunkOffset);
+
+		if (n == PACKED_CHUNK_SIZE && index != currentIndex)
+		{
+			// whole chunk is unpacked directly into the caller's buffer
+			fetch(index, p);
+		}
+		else
+		{
+			load(index);
+			memcpy(p, current.begin() + chunkOffset, n);
+		}
+
+		p += n;
+		l -= n;
+		offset += n;
+	}
+
+	return length;
+}
+
+FB_SIZE_T TempSpace::PackedBlock::write(offset_t offset, const void* buffer, FB_SIZE_T length)
+{
+	if (offset + length > size)
+	{
+		length = size - offset;
+	}
+
+	const UCHAR* p = static_cast<const UCHAR*>(buffer);
+
+	for (FB_SIZE_T l = length; l;)
+	{
+		const ULONG index = offset / PACKED_CHUNK_SIZE;
+		const ULONG chunkOffset = offset % PACKED_CHUNK_SIZE;
+		const FB_SIZE_T n = MIN(l, PACKED_CHUNK_SIZE - chunkOffset);
+
+		if (n == PACKED_CHUNK_SIZE && index != currentIndex)
+		{
+			// whole chunk is packed directly from the caller's buffer
+			store(index, p);
+		}
+		else
+		{
+			load(index);
+			memcpy(current.begin() + chunkOffset, p, n);
+			currentDirty = true;
+		}
+
+		p += n;
+		l -= n;
+		offset += n;
+	}
+
+	return length;
+}
+
+// Make given chunk the current one, storing the previous one if it was changed
+void TempSpace::PackedBlock::load(ULONG index)
+{
+	if (index == currentIndex)
+		return;
+
+	if (currentDirty)
+	{
+		store(currentIndex, current.begin());
+		currentDirty = false;
+	}
+
+	currentIndex = MAX_ULONG;
+	fetch(index, current.begin());
+	currentIndex = index;
+}
+
+void TempSpace::PackedBlock::fetch(ULONG index, UCHAR* data)
+{
+	const Chunk& chunk = chunks[index];
+
+	if (!chunk.length)
+	{
+		memset(data, 0, PACKED_CHUNK_SIZE);
+		return;
+	}
+
+	if (!chunk.packed)
+	{
+		fb_assert(chunk.length == PACKED_CHUNK_SIZE);
+		chunk.file->read(chunk.seek, data, PACKED_CHUNK_SIZE);
+		return;
+	}
+
+	chunk.file->read(chunk.seek, packBuffer.begin(), chunk.length);
+
+	// Chunks are packed only when zstd is loaded, so it's available here
+
+	if (!dctx && !(dctx = zstd().createDCtx()))
+		BadAlloc::raise();
+
+	const size_t length = zstd().decompressDCtx(dctx, data, PACKED_CHUNK_SIZE,
+		packBuffer.begin(), chunk.length);
+
+	if (zstd().isError(length) || length != PACKED_CHUNK_SIZE)
+		status_exception::raise(Arg::Gds(isc_random) << "Corrupted compressed temporary space");
+}
+
+void TempSpace::PackedBlock::store(ULONG index, const UCHAR* data)
+{
+	Chunk& chunk = chunks[index];
+
+	ULONG length = PACKED_CHUNK_SIZE;
+	bool packed = false;
+
+	// Chunk is stored as is if zstd is not available or if it doesn't
+	// get smaller by at least one unit of slot alignment
+
+	if (zstd() && (cctx || (cctx = zstd().createCCtx())))
+	{
+		const size_t result = zstd().compressCCtx(cctx, packBuffer.begin(),
+			PACKED_CHUNK_SIZE - PACKED_SLOT_ALIGN, data, PACKED_CHUNK_SIZE, PACKED_LEVEL);
+
+		if (!zstd().isError(result))
+		{
+			length = (ULONG) result;
+			packed = true;
+		}
+	}
+
+	if (length > chunk.capacity)
+	{
+		// A chunk which doesn't fit into its slot any more gets the slot of
+		// full chunk size, so it's never moved again. The old slot is left
+		// unused until the temp space is released.
+
+		const ULONG capacity = chunk.capacity ?
+			PACKED_CHUNK_SIZE : FB_ALIGN(length, PACKED_SLOT_ALIGN);
+
+		if (capacity > extentSize)
+		{
+			extentFile = space->setupFile(minBlockSize);
+			extentSeek = extentFile->getSize() - minBlockSize;
+			extentSize = minBlockSize;
+			space->packedFileUsage += minBlockSize;
+		}
+
+		chunk.file = extentFile;
+		chunk.seek = extentSeek;
+		chunk.capacity = capacity;
+
+		extentSeek += capacity;
+		extentSize -= capacity;
+	}
+
+	chunk.file->write(chunk.seek, packed ? packBuffer.begin() : data, length);
+	chunk.length = length;
+	chunk.packed = packed;
+}
+
 //
 // FreeSegmentBySize class
 //
@@ -201,7 +425,8 @@ TempSpace::Segment* TempSpace::FreeSegmentBySize::getSegment(FB_SIZE_T size)
 TempSpace::TempSpace(MemoryPool& p, const PathName& prefix, bool dynamic)
 		: pool(p), filePrefix(p, prefix),
 		  logicalSize(0), physicalSize(0), localCacheUsage(0),
-		  head(NULL), tail(NULL), tempFiles(p),
+		  packedSize(0), packedFileUsage(0),
+		  head(NULL), tail(NULL), packedTail(NULL), tempFiles(p),
 		  initialBuffer(p), initiallyDynamic(dynamic),
 		  freeSegments(p), freeSegmentsBySize(p)
 {
@@ -415,6 +640,19 @@ void TempSpace::extend(FB_SIZE_T size)
 			}
 		}
 
+		if (!block && GET_DBB()->dbb_config->getTempCompression())
+		{
+			// allocate compressed block, its space in the temp file
+			// is allocated when the data is written
+			if (packedTail && packedTail == tail)
+			{
+				fb_assert(!initialSize);
+				packedTail->extend(size);
+				return;
+			}
+			block = packedTail = FB_NEW_POOL(pool) PackedBlock(this, tail, size);
+		}
+
 		if (!block)
 		{
 			// allocate block in the temp file
@@ -734,7 +972,7 @@ bool TempSpace::validate(offset_t& free) const
 	for (FB_SIZE_T i = 0; i < tempFiles.getCount(); i++)
 		disk += tempFiles[i]->getSize();
 
-	return ((initialBuffer.getCount() + localCacheUsage + disk) == physicalSize);
+	return ((initialBuffer.getCount() + localCacheUsage + packedSize + disk - packedFileUsage) == physicalSize);
 }
 
 
@@ -30,6 +30,7 @@
 #include "../common/config/dir_list.h"
 #include "../common/classes/init.h"
 #include "../common/classes/tree.h"
+#include "../common/classes/zip.h"
 
 class TempSpace : public Firebird::File
 {
@@ -173,6 +174,60 @@ private:
 		offset_t seek;
 	};
 
+	// Temp file block keeping its contents compressed by fixed size chunks.
+	// Every chunk occupies its own slot in the file, so random access is
+	// still possible, the last accessed chunk is kept uncompressed in memory.
+	class PackedBlock : public Block
+	{
+	public:
+		PackedBlock(TempSpace* owner, Block* tail, size_t length);
+
+		~PackedBlock();
+
+		FB_SIZE_T read(offset_t offset, void* buffer, FB_SIZE_T length) override;
+		FB_SIZE_T write(offset_t offset, const void* buffer, FB_SIZE_T length) override;
+
+		UCHAR* inMemory(offset_t /*offset*/, size_t /*a_size*/) const noexcept override
+		{
+			return NULL;
+		}
+
+		bool sameFile(const Firebird::TempFile* /*aFile*/) const noexcept override
+		{
+			return false;
+		}
+
+		void extend(size_t length);
+
+	private:
+		struct Chunk
+		{
+			Firebird::TempFile* file;
+			offset_t seek;
+			ULONG capacity;		// size of the slot in the file
+			ULONG length;		// length of the stored data, zero if never written
+			bool packed;		// false if data is stored as is
+		};
+
+		void load(ULONG index);
+		void fetch(ULONG index, UCHAR* data);
+		void store(ULONG index, const UCHAR* data);
+
+		TempSpace* const space;
+		Firebird::Array<Chunk> chunks;
+		Firebird::Array<UCHAR> current;		// uncompressed contents of the last used chunk
+		Firebird::Array<UCHAR> packBuffer;
+		ULONG currentIndex;
+		bool currentDirty;
+		Firebird::ZStd::CCtx* cctx;
+		Firebird::ZStd::DCtx* dctx;
+
+		// file space reserved for the slots not allocated yet
+		Firebird::TempFile* extentFile;
+		offset_t extentSeek;
+		offset_t extentSize;
+	};
+
 	Block* findBlock(offset_t& offset) const;
 	Firebird::TempFile* setupFile(FB_SIZE_T size);
 
@@ -221,8 +276,11 @@ private:
 	offset_t logicalSize;
 	offset_t physicalSize;
 	offset_t localCacheUsage;
+	offset_t packedSize;		// logical size of packed blocks
+	offset_t packedFileUsage;	// space taken by packed blocks in temp files
 	Block* head;
 	Block* tail;
+	PackedBlock* packedTail;	// last packed block, it's extended while it's the tail
 	Firebird::Array<Firebird::TempFile*> tempFiles;
 	Firebird::Array<UCHAR> initialBuffer;
 	bool initiallyDynamic;
@@ -195,6 +195,9 @@ USHORT IndexNode::getNodeSize(bool leafNode) const
 	else if (isEndBucket) {
 		internalFlags = BTN_END_BUCKET_FLAG;
 	}
+	else if (hasPayload(leafNode)) {
+		internalFlags = BTN_PAYLOAD_FLAG;
+	}
 	else if (length == 0)
 	{
 		if (prefix == 0) {
@@ -296,6 +299,14 @@ USHORT IndexNode::getNodeSize(bool leafNode) const
 	}
 
 	result += length;
+
+	if (internalFlags == BTN_PAYLOAD_FLAG)
+	{
+		// Size needed for payload length and payload
+		result += (payloadLength & 0xFF80) ? 2 : 1;
+		result += payloadLength;
+	}
+
 	return result;
 }
 
@@ -416,14 +427,20 @@ UCHAR* IndexNode::writeNode(UCHAR* pagePointer, bool leafNode, bool withData)
 	// are zero) we don't store the length and prefix
 	// information. This will save at least 2 bytes per node.
 
+	// Payload is stored right after the data with its length in front
+	const USHORT payloadSize = !hasPayload(leafNode) ? 0 :
+		((payloadLength & 0xFF80) ? 2 : 1) + payloadLength;
+
 	if (!withData)
 	{
 		// First move data so we can't override it.
 		// For older structure node was always the same, but length
 		// from new structure depends on the values.
-		const USHORT offset = getNodeSize(leafNode) - length;
+		// Payload read from the page follows the data, so it's moved together.
+		fb_assert(!payloadSize || payload + payloadLength == data + length + payloadSize);
+		const USHORT offset = getNodeSize(leafNode) - length - payloadSize;
 		pagePointer += offset; // set pointer to right position
-		memmove(pagePointer, data, length);
+		memmove(pagePointer, data, length + payloadSize);
 		pagePointer -= offset; // restore pointer to original position
 	}
 
@@ -435,6 +452,9 @@ UCHAR* IndexNode::writeNode(UCHAR* pagePointer, bool leafNode, bool withData)
 	else if (isEndBucket) {
 		internalFlags = BTN_END_BUCKET_FLAG;
 	}
+	else if (hasPayload(leafNode)) {
+		internalFlags = BTN_PAYLOAD_FLAG;
+	}
 	else if (length == 0)
 	{
 		if (prefix == 0) {
@@ -633,5 +653,32 @@ UCHAR* IndexNode::writeNode(UCHAR* pagePointer, bool leafNode, bool withData)
 	}
 	pagePointer += length;
 
+	if (internalFlags == BTN_PAYLOAD_FLAG)
+	{
+		if (withData)
+		{
+			// Write payload length, maximum 14 bits
+			number = payloadLength;
+			tmp = (number & 0x7F);
+			number >>= 7;
+			if (number > 0) {
+				tmp |= 0x80;
+			}
+			*pagePointer++ = tmp;
+			if (number > 0)
+			{
+				tmp = (number & 0x7F);
+				*pagePointer++ = tmp;
+			}
+
+			// Payload may be read from the same page
+			memmove(pagePointer, payload, payloadLength);
+			pagePointer += payloadLength;
+		}
+		else {
+			pagePointer += payloadSize;
+		}
+	}
+
 	return pagePointer;
 }
@@ -42,7 +42,7 @@ inline constexpr int BTN_END_BUCKET_FLAG				= 2;
 inline constexpr int BTN_ZERO_PREFIX_ZERO_LENGTH_FLAG	= 3;
 inline constexpr int BTN_ZERO_LENGTH_FLAG				= 4;
 inline constexpr int BTN_ONE_LENGTH_FLAG				= 5;
-//inline constexpr int BTN_ZERO_PREFIX_ONE_LENGTH_FLAG	= 6;
+inline constexpr int BTN_PAYLOAD_FLAG					= 6;	// leaf node followed by payload
 //inline constexpr int BTN_GET_MORE_FLAGS	= 7;
 
 // Firebird B-tree nodes
@@ -59,6 +59,8 @@ struct IndexNode
 	RecordNumber recordNumber;	// record number
 	bool isEndBucket;
 	bool isEndLevel;
+	UCHAR* payload = nullptr;	// non-key (INCLUDE) values, leaf nodes only
+	USHORT payloadLength = 0;	// length of payload
 
 	static USHORT computePrefix(const UCHAR* prevString, USHORT prevLength,
 								const UCHAR* string, USHORT length);
@@ -77,6 +79,18 @@ struct IndexNode
 		return !memcmp(this->data, data + this->prefix, this->length);
 	}
 
+	bool payloadEqual(USHORT length, const UCHAR* data) const
+	{
+		return length == payloadLength && (!length || !memcmp(payload, data, length));
+	}
+
+	// Only the regular leaf nodes carry payload, it's never stored
+	// in the END_BUCKET markers and at the upper levels
+	bool hasPayload(bool leafNode) const
+	{
+		return leafNode && payloadLength && !isEndBucket && !isEndLevel;
+	}
+
 	void setEndBucket()
 	{
 		this->isEndBucket = true;
@@ -91,6 +105,8 @@ struct IndexNode
 		this->length = 0;
 		this->pageNumber = 0;
 		this->recordNumber.setValue(0);
+		this->payload = nullptr;
+		this->payloadLength = 0;
 	}
 
 	void setNode(USHORT prefix = 0, USHORT length = 0,
@@ -103,6 +119,8 @@ struct IndexNode
 		this->length = length;
 		this->recordNumber = recordNumber;
 		this->pageNumber = pageNumber;
+		this->payload = nullptr;
+		this->payloadLength = 0;
 	}
 
 	USHORT getNodeSize(bool leafNode) const;
@@ -132,6 +150,8 @@ struct IndexNode
 
 		isEndLevel = (internalFlags == BTN_END_LEVEL_FLAG);
 		isEndBucket = (internalFlags == BTN_END_BUCKET_FLAG);
+		payload = nullptr;
+		payloadLength = 0;
 
 		// If this is a END_LEVEL marker then we're done
 		if (isEndLevel)
@@ -260,6 +280,21 @@ struct IndexNode
 		data = localPointer;
 		localPointer += length;
 
+		if (internalFlags == BTN_PAYLOAD_FLAG)
+		{
+			// Get payload length and pointer where payload starts
+			tmp = *localPointer++;
+			payloadLength = (tmp & 0x7F);
+			if (tmp & 0x80)
+			{
+				tmp = *localPointer++;
+				payloadLength |= (tmp & 0x7F) << 7; // We get 14 bits at this point
+			}
+
+			payload = localPointer;
+			localPointer += payloadLength;
+		}
+
 		return localPointer;
 	}
 
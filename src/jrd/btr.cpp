@@ -62,6 +62,7 @@
 #include "../jrd/met_proto.h"
 #include "../jrd/mov_proto.h"
 #include "../jrd/pag_proto.h"
+#include "../jrd/rng_proto.h"
 #include "../jrd/tra_proto.h"
 #include "../jrd/tpc_proto.h"
 #include "../dsql/DdlNodes.h"
@@ -228,9 +229,11 @@ static void compress(thread_db*, const dsc*, const SSHORT scale, temporary_key*,
 					 USHORT, bool, USHORT, bool*);
 static USHORT compress_root(thread_db*, index_root_page*);
 static void copy_key(const temporary_mini_key*, temporary_mini_key*);
+static bool decodable_segment(USHORT, const dsc*);
+static bool decode_segment(const UCHAR*, USHORT, USHORT, dsc*);
 static contents delete_node(thread_db*, WIN*, UCHAR*);
 static void delete_tree(thread_db*, MetaId, MetaId, PageNumber, PageNumber);
-static ULONG fast_load(thread_db*, IndexCreation&, SelectivityList&);
+static ULONG fast_load(thread_db*, IndexCreation&, SelectivityList&, IndexHistogram*);
 
 static const index_root_page* fetch_root(thread_db*, WIN*, const RelationPermanent*, const RelationPages*);
 static UCHAR* find_node_start_point(btree_page*, temporary_key*, UCHAR*, USHORT*,
@@ -274,6 +277,14 @@ enum class ModifyIrtRepeatValue
 	Deleted		// index was deleted, descriptor was modified, page lock was released
 };
 
+// Ask the page cache to read ahead the right sibling of the leaf page being scanned
+
+inline void readAheadSibling(thread_db* tdbb, const WIN& window, const btree_page* page)
+{
+	if (page->btr_level == 0 && page->btr_sibling)
+		CCH_read_ahead(tdbb, window.win_page.getPageSpaceID(), &page->btr_sibling, 1);
+}
+
 class Flags
 {
 public:
@@ -402,11 +413,7 @@ bool BtrPageGCLock::isPageGCAllowed(thread_db* tdbb, const PageNumber& page)
 
 	ThreadStatusGuard temp_status(tdbb);
 
-	if (!LCK_lock(tdbb, &lock, LCK_write, LCK_NO_WAIT))
-		return false;
-
-	LCK_release(tdbb, &lock);
-	return true;
+	return LCK_probe(tdbb, &lock, LCK_write);
 }
 
 // IndexErrorContext class
@@ -699,6 +706,7 @@ idx_e IndexKey::compose(Record* record, bool skipNewFormat)
 	auto tail = m_index->idx_rpt;
 	m_key.key_flags = 0;
 	m_key.key_nulls = 0;
+	m_payload.clear();
 
 	const bool descending = (m_index->idx_flags & idx_descending);
 
@@ -827,6 +835,42 @@ idx_e IndexKey::compose(Record* record, bool skipNewFormat)
 
 		if (descending)
 			BTR_complement_key(&m_key);
+
+		// Non-key columns are stored as is in the leaf node payload,
+		// see INCLUDE_OVERHEAD. Partial keys used for lookups have none.
+
+		if (m_index->idx_include_count && m_segments == m_index->idx_count)
+		{
+			tail = m_index->idx_rpt + m_index->idx_count;
+
+			for (USHORT n = 0; n < m_index->idx_include_count; n++, tail++)
+			{
+				fb_assert(tail->idx_itype == idx_include);
+
+				if (!EVL_field(m_relation, record, tail->idx_field, &desc))
+				{
+					m_payload.add(dtype_unknown);
+					continue;
+				}
+
+				USHORT length = desc.dsc_length;
+				if (desc.dsc_dtype == dtype_varying)
+					length = sizeof(USHORT) + reinterpret_cast<const vary*>(desc.dsc_address)->vary_length;
+
+				const FB_SIZE_T offset = m_payload.getCount();
+				if (offset + INCLUDE_OVERHEAD + length >= maxKeyLength)
+					return idx_e_keytoobig;
+
+				UCHAR* p = m_payload.getBuffer(offset + INCLUDE_OVERHEAD + length) + offset;
+				*p++ = desc.dsc_dtype;
+				*p++ = (UCHAR) desc.dsc_scale;
+				memcpy(p, &desc.dsc_sub_type, sizeof(USHORT));
+				p += sizeof(USHORT);
+				memcpy(p, &desc.dsc_length, sizeof(USHORT));
+				p += sizeof(USHORT);
+				memcpy(p, desc.dsc_address, length);
+			}
+		}
 	}
 	catch (const Exception& ex)
 	{
@@ -1325,6 +1369,49 @@ void BTR_complement_key(temporary_key* key)
 }
 
 
+bool BTR_covers_fields(const index_desc* idx, const Format* format, UInt32Bitmap* fields)
+{
+/**************************************
+ *
+ *	B T R _ c o v e r s _ f i e l d s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check if all the given fields of a record may be taken from
+ *	the keys of an index, so the record itself isn't needed.
+ *
+ **************************************/
+	if (idx->idx_flags & (idx_expression | idx_descending))
+		return false;
+
+	// Segments of other fields are skipped when the key is decoded
+
+	UInt32Bitmap::Accessor accessor(fields);
+
+	if (accessor.getFirst())
+	{
+		do
+		{
+			const ULONG id = accessor.current();
+			const USHORT count = idx->idx_count + idx->idx_include_count;
+			USHORT n = 0;
+
+			while (n < count && idx->idx_rpt[n].idx_field != id)
+				n++;
+
+			if (n == count || id >= format->fmt_count ||
+				!decodable_segment(idx->idx_rpt[n].idx_itype, &format->fmt_desc[id]))
+			{
+				return false;
+			}
+		} while (accessor.getNext());
+	}
+
+	return true;
+}
+
+
 void BTR_create(thread_db* tdbb,
 				IndexCreation& creation,
 				SelectivityList& selectivity)
@@ -1347,8 +1434,21 @@ void BTR_create(thread_db* tdbb,
 	jrd_rel* const relation = creation.relation;
 	index_desc* const idx = creation.index;
 
+	const auto idp = relation->getPermanent()->ensureIndex(tdbb, idx->idx_id);
+	RefPtr<IndexHistogram> histogram;
+
 	// Now that the index id has been checked out, create the index.
-	idx->idx_root = fast_load(tdbb, creation, selectivity);
+	if (idx->idx_flags & idx_range)
+	{
+		// Block range index has neither key distribution nor selectivity
+		idx->idx_root = RNG_create(tdbb, creation);
+		selectivity.grow(idx->idx_count);
+	}
+	else
+	{
+		histogram = FB_NEW_POOL(idp->getPool()) IndexHistogram(idp->getPool());
+		idx->idx_root = fast_load(tdbb, creation, selectivity, histogram);
+	}
 
 	if (creation.isConcurrently())
 		creation.lockWrites(LCK_WAIT);
@@ -1384,6 +1484,162 @@ void BTR_create(thread_db* tdbb,
 	update_selectivity(root, idx->idx_id, selectivity);
 
 	CCH_RELEASE(tdbb, &window);
+
+	if (histogram)
+	{
+		histogram->setRoot(idx->idx_root);
+		idp->setHistogram(histogram);
+	}
+}
+
+
+bool BTR_decode_key(const index_desc* idx, const temporary_key* key,
+					const UCHAR* payload, USHORT payloadLength, Record* record)
+{
+/**************************************
+ *
+ *	B T R _ d e c o d e _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Restore the indexed fields of a record from an index key
+ *	and the payload of its leaf node. Other fields are set to NULL.
+ *	Only the indices accepted by BTR_covers_fields() are expected
+ *	here, return false if the key still cannot be decoded.
+ *
+ **************************************/
+	const Format* const format = record->getFormat();
+	record->nullify();
+
+	// Compound keys are split into the groups of STUFF_COUNT bytes, each
+	// group prefixed by the segment marker. NULL segments have no groups.
+	// Segments go one after another, so their data is collected in a row.
+
+	UCHAR buffer[MAX_KEY];
+	USHORT offsets[MAX_INDEX_SEGMENTS];
+	USHORT lengths[MAX_INDEX_SEGMENTS];
+	memset(lengths, 0, sizeof(lengths));
+
+	if (idx->idx_count == 1)
+	{
+		if (key->key_length > sizeof(buffer))
+			return false;
+
+		memcpy(buffer, key->key_data, key->key_length);
+		offsets[0] = 0;
+		lengths[0] = key->key_length;
+	}
+	else
+	{
+		const UCHAR* p = key->key_data;
+		const UCHAR* const end = p + key->key_length;
+		USHORT last = 0;
+		USHORT total = 0;
+
+		while (p < end)
+		{
+			const UCHAR marker = *p++;
+
+			if (!marker || marker > idx->idx_count)
+				return false;
+
+			const USHORT n = idx->idx_count - marker;
+			const USHORT length = MIN(STUFF_COUNT, end - p);
+
+			if (n < last || total + length > sizeof(buffer))
+				return false;
+
+			if (!lengths[n])
+				offsets[n] = total;
+
+			memcpy(buffer + total, p, length);
+			lengths[n] += length;
+			total += length;
+			last = n;
+			p += length;
+		}
+	}
+
+	for (USHORT n = 0; n < idx->idx_count; n++)
+	{
+		const USHORT id = idx->idx_rpt[n].idx_field;
+
+		if (id >= format->fmt_count)
+			return false;
+
+		// Fields not accepted by BTR_covers_fields() are not used, leave them NULL
+
+		if (!lengths[n] || !decodable_segment(idx->idx_rpt[n].idx_itype, &format->fmt_desc[id]))
+			continue;
+
+		dsc desc = format->fmt_desc[id];
+		desc.dsc_address = record->getData() + (IPTR) desc.dsc_address;
+
+		if (!decode_segment(buffer + offsets[n], lengths[n], idx->idx_rpt[n].idx_itype, &desc))
+			return false;
+
+		record->clearNull(id);
+	}
+
+	// Non-key columns are stored as is, see INCLUDE_OVERHEAD.
+	// Values stored with another field format cannot be used.
+
+	const UCHAR* p = payload;
+	const UCHAR* const end = payload + payloadLength;
+
+	for (USHORT n = idx->idx_count; n < idx->idx_count + idx->idx_include_count; n++)
+	{
+		const USHORT id = idx->idx_rpt[n].idx_field;
+
+		if (id >= format->fmt_count || p >= end)
+			return false;
+
+		if (*p == dtype_unknown)
+		{
+			p++;
+			continue;
+		}
+
+		if (end - p < INCLUDE_OVERHEAD)
+			return false;
+
+		dsc desc = format->fmt_desc[id];
+
+		USHORT subType, length;
+		memcpy(&subType, p + 2, sizeof(USHORT));
+		memcpy(&length, p + 2 + sizeof(USHORT), sizeof(USHORT));
+
+		if (p[0] != desc.dsc_dtype || (SCHAR) p[1] != desc.dsc_scale ||
+			(SSHORT) subType != desc.dsc_sub_type || length != desc.dsc_length)
+		{
+			return false;
+		}
+
+		p += INCLUDE_OVERHEAD;
+
+		if (desc.dsc_dtype == dtype_varying)
+		{
+			USHORT varyLength;
+			if (end - p < (ptrdiff_t) sizeof(USHORT))
+				return false;
+
+			memcpy(&varyLength, p, sizeof(USHORT));
+			length = sizeof(USHORT) + varyLength;
+
+			if (length > desc.dsc_length)
+				return false;
+		}
+
+		if (end - p < length)
+			return false;
+
+		memcpy(record->getData() + (IPTR) desc.dsc_address, p, length);
+		record->clearNull(id);
+		p += length;
+	}
+
+	return true;
 }
 
 
@@ -1697,15 +1953,21 @@ bool BTR_description(thread_db* tdbb, Cached::Relation* relation, const index_ro
 
 	// pick up field ids and type descriptions for each of the fields
 	const UCHAR* ptr = (UCHAR*) root + irt_desc->irt_desc;
+	// non-key columns follow the key segments, irt_keys counts them both
 	index_desc::idx_repeat* idx_desc = idx->idx_rpt;
-	for (int i = 0; i < idx->idx_count; i++, idx_desc++)
+	idx->idx_include_count = 0;
+	for (int i = 0; i < irt_desc->irt_keys; i++, idx_desc++)
 	{
 		const irtd* key_descriptor = (irtd*) ptr;
 		idx_desc->idx_field = key_descriptor->irtd_field;
 		idx_desc->idx_itype = key_descriptor->irtd_itype;
 		idx_desc->idx_selectivity = key_descriptor->irtd_selectivity;
 		ptr += sizeof(irtd);
+
+		if (idx_desc->idx_itype == idx_include)
+			idx->idx_include_count++;
 	}
+	idx->idx_count -= idx->idx_include_count;
 	idx->idx_selectivity = idx->idx_rpt[idx->idx_count - 1].idx_selectivity;
 
 	ISC_STATUS error = 0;
@@ -1927,6 +2189,8 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 			skipLowerKey = false;
 		}
 
+		readAheadSibling(tdbb, window, page);
+
 		if (retrieval->irb_upper_count)
 		{
 			// if there is an upper bound, scan the index pages looking for it
@@ -1934,6 +2198,7 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 						skipLowerKey, *lower, forceInclFlag))
 			{
 				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
+				readAheadSibling(tdbb, window, page);
 				pointer = page->btr_nodes + page->btr_jump_size;
 				prefix = 0;
 			}
@@ -1986,6 +2251,7 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 				}
 
 				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
+				readAheadSibling(tdbb, window, page);
 				endPointer = (UCHAR*) page + page->btr_length;
 				pointer = page->btr_nodes + page->btr_jump_size;
 				pointer = node.readNode(pointer, true);
@@ -2201,6 +2467,8 @@ void BTR_insert(thread_db* tdbb, WIN* root_window, index_insertion* insertion)
 		propagate.iib_number.setValue(split_page);
 		propagate.iib_descriptor->idx_root = window.win_page.getPageNum();
 		propagate.iib_key = &key;
+		propagate.iib_payload = nullptr;
+		propagate.iib_payload_length = 0;
 		propagate.iib_btr_level = root_level + 1;
 
 		temporary_key ret_key;
@@ -2452,6 +2720,31 @@ USHORT BTR_key_length(thread_db* tdbb, jrd_rel* relation, index_desc* idx)
 }
 
 
+USHORT BTR_payload_length(thread_db* tdbb, jrd_rel* relation, const index_desc* idx)
+{
+/**************************************
+ *
+ *	B T R _ p a y l o a d _ l e n g t h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compute the maximum length of the non-key
+ *	columns stored in the leaf nodes of an index.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	const Format* format = relation->currentFormat(tdbb);
+	ULONG length = 0;
+
+	for (USHORT n = idx->idx_count; n < idx->idx_count + idx->idx_include_count; n++)
+		length += INCLUDE_OVERHEAD + format->fmt_desc[idx->idx_rpt[n].idx_field].dsc_length;
+
+	return (USHORT) MIN(length, MAX_USHORT);
+}
+
+
 bool BTR_lookup(thread_db* tdbb, Cached::Relation* relation, MetaId id, index_desc* buffer,
 				  RelationPages* relPages)
 {
@@ -2877,6 +3170,8 @@ void BTR_merge_index(thread_db* tdbb, jrd_tra* transaction, jrd_rel* relation, i
 			const bool deleted = node.recordNumber.getValue() & 1;
 
 			insertion.iib_number.setValue(recno);
+			insertion.iib_payload = node.payload;
+			insertion.iib_payload_length = node.payloadLength;
 			insertion.iib_btr_level = 0;
 			insertion.iib_duplicates = nullptr;
 
@@ -3370,7 +3665,7 @@ void BTR_reserve_slot(thread_db* tdbb, IndexCreation& creation)
 
 	for (int retry = 0; retry < 3; ++retry)
 	{
-		len = idx->idx_count * sizeof(irtd);
+		len = (idx->idx_count + idx->idx_include_count) * sizeof(irtd);
 
 		space = dbb->dbb_page_size;
 		slot = NULL;
@@ -3447,8 +3742,8 @@ void BTR_reserve_slot(thread_db* tdbb, IndexCreation& creation)
 
 	idx->idx_id = slot - root->irt_rpt;
 	slot->irt_desc = space;
-	fb_assert(idx->idx_count <= MAX_UCHAR);
-	slot->irt_keys = (UCHAR) idx->idx_count;
+	fb_assert(idx->idx_count + idx->idx_include_count <= MAX_UCHAR);
+	slot->irt_keys = (UCHAR) (idx->idx_count + idx->idx_include_count);
 	slot->irt_flags = idx->idx_flags;
 
 	switch (creation.createMethod)
@@ -3521,7 +3816,26 @@ void BTR_selectivity(thread_db* tdbb, Cached::Relation* relation, MetaId id, Sel
 
 	ULONG page = root->irt_rpt[id].getRoot();
 	const bool descending = (root->irt_rpt[id].irt_flags & irt_descending);
-	const ULONG segments = root->irt_rpt[id].irt_keys;
+	// non-key columns have no selectivity of their own
+	ULONG segments = 0;
+	const irtd* key_descriptor = (const irtd*) ((const UCHAR*) root + root->irt_rpt[id].irt_desc);
+	for (ULONG i = 0; i < root->irt_rpt[id].irt_keys; i++, key_descriptor++)
+	{
+		if (key_descriptor->irtd_itype != idx_include)
+			segments++;
+	}
+
+	// Block range index has no leaf level to walk
+	if (root->irt_rpt[id].irt_flags & irt_range)
+	{
+		CCH_RELEASE(tdbb, &window);
+		selectivity.grow(segments);
+		return;
+	}
+
+	const auto idp = relation->ensureIndex(tdbb, id);
+	RefPtr<IndexHistogram> histogram(FB_NEW_POOL(idp->getPool()) IndexHistogram(idp->getPool()));
+	histogram->setRoot(page);
 
 	window.win_flags = WIN_large_scan;
 	window.win_scans = 1;
@@ -3661,6 +3975,7 @@ void BTR_selectivity(thread_db* tdbb, Cached::Relation* relation, MetaId id, Sel
 			// keep the key value current for comparison with the next key
 			key.key_length = l;
 			memcpy(key.key_data + node.prefix, node.data, node.length);
+			histogram->add(key.key_data, key.key_length);
 			pointer = node.readNode(pointer, true);
 		}
 
@@ -3690,6 +4005,8 @@ void BTR_selectivity(thread_db* tdbb, Cached::Relation* relation, MetaId id, Sel
 	CCH_MARK(tdbb, &window);
 	update_selectivity(write_root, id, selectivity);
 	CCH_RELEASE(tdbb, &window);
+
+	idp->setHistogram(histogram);
 }
 
 
@@ -3840,6 +4157,8 @@ static ULONG add_node(thread_db* tdbb,
 	propagate.iib_relation = insertion->iib_relation;
 	propagate.iib_duplicates = NULL;
 	propagate.iib_key = new_key;
+	propagate.iib_payload = nullptr;
+	propagate.iib_payload_length = 0;
 
 	// now loop through the sibling pages trying to find the appropriate
 	// place to put the pointer to the lower level page--remember that the
@@ -4485,6 +4804,180 @@ static void copy_key(const temporary_mini_key* in, temporary_mini_key* out)
 }
 
 
+static bool decodable_segment(USHORT itype, const dsc* desc)
+{
+/**************************************
+ *
+ *	d e c o d a b l e _ s e g m e n t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check if a key segment made by compress() can be converted
+ *	back into the exact field value.
+ *
+ **************************************/
+	switch (itype)
+	{
+	case idx_numeric:
+		// Doubles keep the integers exactly, but not the scaled values
+		return ((desc->dsc_dtype == dtype_short || desc->dsc_dtype == dtype_long) && !desc->dsc_scale) ||
+			desc->dsc_dtype == dtype_real || desc->dsc_dtype == dtype_double;
+
+	case idx_sql_date:
+		return desc->dsc_dtype == dtype_sql_date;
+
+	case idx_sql_time:
+		return desc->dsc_dtype == dtype_sql_time;
+
+	case idx_timestamp:
+		return desc->dsc_dtype == dtype_timestamp;
+
+	case idx_boolean:
+		return desc->dsc_dtype == dtype_boolean;
+
+	case idx_include:
+		return true;
+	}
+
+	return false;
+}
+
+
+static bool decode_segment(const UCHAR* data, USHORT length, USHORT itype, dsc* desc)
+{
+/**************************************
+ *
+ *	d e c o d e _ s e g m e n t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Reverse compress() for an ascending key segment: restore the
+ *	trailing zeros, undo the sign bit manipulations and store the
+ *	value into the field.
+ *
+ **************************************/
+	UCHAR bytes[sizeof(double)];
+	USHORT size;
+
+	switch (itype)
+	{
+	case idx_numeric:
+	case idx_timestamp:
+		size = sizeof(double);
+		break;
+
+	case idx_sql_date:
+	case idx_sql_time:
+		size = sizeof(ULONG);
+		break;
+
+	case idx_boolean:
+		size = sizeof(UCHAR);
+		break;
+
+	default:
+		return false;
+	}
+
+	// Segments of a compound key are padded with zeros up to STUFF_COUNT bytes
+
+	while (length > size && !data[length - 1])
+		length--;
+
+	if (length > size)
+		return false;
+
+	memset(bytes, 0, sizeof(bytes));
+	memcpy(bytes, data, length);
+
+	// Negative doubles are complemented as a whole, other values have the sign bit flipped
+
+	if (itype == idx_numeric && !(bytes[0] & 0x80))
+	{
+		for (USHORT i = 0; i < size; i++)
+			bytes[i] = ~bytes[i];
+	}
+	else
+		bytes[0] ^= 0x80;
+
+	// Key bytes go in the big-endian order
+
+	FB_UINT64 value = 0;
+	for (USHORT i = 0; i < size; i++)
+		value = (value << 8) | bytes[i];
+
+	switch (itype)
+	{
+	case idx_numeric:
+		{
+			double number;
+			memcpy(&number, &value, sizeof(number));
+
+			switch (desc->dsc_dtype)
+			{
+			case dtype_short:
+				if (number < MIN_SSHORT || number > MAX_SSHORT)
+					return false;
+				*(SSHORT*) desc->dsc_address = (SSHORT) number;
+				break;
+
+			case dtype_long:
+				if (number < MIN_SLONG || number > MAX_SLONG)
+					return false;
+				*(SLONG*) desc->dsc_address = (SLONG) number;
+				break;
+
+			case dtype_real:
+				*(float*) desc->dsc_address = (float) number;
+				break;
+
+			case dtype_double:
+				*(double*) desc->dsc_address = number;
+				break;
+
+			default:
+				return false;
+			}
+		}
+		break;
+
+	case idx_timestamp:
+		{
+			const SINT64 ticks = NoThrowTimeStamp::SECONDS_PER_DAY * ISC_TIME_SECONDS_PRECISION;
+			SINT64 date = (SINT64) value / ticks;
+			SINT64 time = (SINT64) value % ticks;
+
+			if (time < 0)
+			{
+				time += ticks;
+				date--;
+			}
+
+			ISC_TIMESTAMP* const timestamp = (ISC_TIMESTAMP*) desc->dsc_address;
+			timestamp->timestamp_date = (ISC_DATE) date;
+			timestamp->timestamp_time = (ISC_TIME) time;
+		}
+		break;
+
+	case idx_sql_date:
+		*(ISC_DATE*) desc->dsc_address = (ISC_DATE) (SLONG) (ULONG) value;
+		break;
+
+	case idx_sql_time:
+		*(ISC_TIME*) desc->dsc_address = (ISC_TIME) value;
+		break;
+
+	case idx_boolean:
+		*(UCHAR*) desc->dsc_address = value ? 1 : 0;
+		break;
+	}
+
+	return true;
+}
+
+
 static contents delete_node(thread_db* tdbb, WIN* window, UCHAR* pointer)
 {
 /**************************************
@@ -4539,6 +5032,14 @@ static contents delete_node(thread_db* tdbb, WIN* window, UCHAR* pointer)
 	memcpy(tempData + length, nextNode.data, nextNode.length);
 	newNextLength += nextNode.length;
 
+	// The rebuilt node may overlap its own payload, save it too
+	HalfStaticArray<UCHAR, MAX_KEY> payloadBuf;
+	if (nextNode.payloadLength)
+	{
+		nextNode.payload = (UCHAR*) memcpy(payloadBuf.getBuffer(nextNode.payloadLength),
+			nextNode.payload, nextNode.payloadLength);
+	}
+
 	// Update the page prefix total.
 	page->btr_prefix_total -= (removingNode.prefix + (nextNode.prefix - newNextPrefix));
 
@@ -4804,6 +5305,14 @@ static void delete_tree(thread_db* tdbb,
 		window.win_page = next;
 		btree_page* page = (btree_page*) CCH_FETCH(tdbb, &window, LCK_write, 0);
 
+		// Block range index has its own page layout
+		if (page->btr_header.pag_type == pag_range && next.getPageNum() == down)
+		{
+			CCH_RELEASE(tdbb, &window);
+			RNG_delete(tdbb, rel_id, idx_id, next, prior);
+			return;
+		}
+
 		// do a little defensive programming--if any of these conditions
 		// are true we have a damaged pointer, so just stop deleting. At
 		// the same time, allow updates of indexes with id > 255 even though
@@ -4847,7 +5356,8 @@ static void delete_tree(thread_db* tdbb,
 
 static ULONG fast_load(thread_db* tdbb,
 					   IndexCreation& creation,
-					   SelectivityList& selectivity)
+					   SelectivityList& selectivity,
+					   IndexHistogram* histogram)
 {
 /**************************************
  *
@@ -4953,6 +5463,7 @@ static ULONG fast_load(thread_db* tdbb,
 		bool duplicate = false;
 
 		IndexNode tempNode;
+		HalfStaticArray<UCHAR, MAX_KEY> lastPayload(pool);
 
 		// Detect the case when set of duplicate keys contains more then one key
 		// from primary record version. It breaks the unique constraint and must
@@ -4972,6 +5483,7 @@ static ULONG fast_load(thread_db* tdbb,
 				break;
 
 			index_sort_record* isr = (index_sort_record*) (record + key_length);
+			UCHAR* const payload = (UCHAR*) isr + sizeof(index_sort_record);
 			count++;
 			record += nullIndLen;
 
@@ -4993,6 +5505,8 @@ static ULONG fast_load(thread_db* tdbb,
 			newNode.setNode(prefix, isr->isr_key_length - prefix,
 						    RecordNumber(isr->isr_record_number));
 			newNode.data = record + prefix;
+			newNode.payload = payload;
+			newNode.payloadLength = isr->isr_payload_length;
 
 			// If the length of the new node will cause us to overflow the bucket,
 			// form a new bucket.
@@ -5002,6 +5516,7 @@ static ULONG fast_load(thread_db* tdbb,
 				// mark the end of the previous page
 				const RecordNumber lastRecordNumber = previousNode.recordNumber;
 				previousNode.readNode(previousNode.nodePointer, true);
+				lastPayload.assign(previousNode.payload, previousNode.payloadLength);
 				previousNode.setEndBucket();
 				pointer = previousNode.writeNode(previousNode.nodePointer, true, false);
 				bucket->btr_length = pointer - (UCHAR*) bucket;
@@ -5067,6 +5582,8 @@ static ULONG fast_load(thread_db* tdbb,
 				IndexNode splitNode;
 				splitNode.setNode(0, leafKey->key_length, lastRecordNumber);
 				splitNode.data = leafKey->key_data;
+				splitNode.payload = lastPayload.begin();
+				splitNode.payloadLength = (USHORT) lastPayload.getCount();
 				pointer = splitNode.writeNode(pointer, true);
 				previousNode = splitNode;
 
@@ -5205,6 +5722,7 @@ static ULONG fast_load(thread_db* tdbb,
 			// Remember the last key inserted to compress the next one.
 			leafKey->key_length = isr->isr_key_length;
 			memcpy(leafKey->key_data, record, leafKey->key_length);
+			histogram->add(leafKey->key_data, leafKey->key_length);
 
 			if (leafLevel->newAreaPointer < pointer)
 			{
@@ -6563,6 +7081,8 @@ static contents garbage_collect(thread_db* tdbb, WIN* window, ULONG parent_numbe
 	leftNode.setNode(prefix, gcNode.length - prefix, gcNode.recordNumber,
 				     gcNode.pageNumber, gcNode.isEndBucket, gcNode.isEndLevel);
 	leftNode.data = gcNode.data + prefix;
+	leftNode.payload = gcNode.payload;
+	leftNode.payloadLength = gcNode.payloadLength;
 	leftPointer = leftNode.writeNode(leftPointer, leafPage);
 
 	// Update page-size.
@@ -7032,7 +7552,12 @@ static ULONG insert_node(thread_db* tdbb,
 	IndexNode newNode;
 	newNode.setNode(prefix, key->key_length - prefix, newRecordNumber);
 	newNode.data = key->key_data + prefix;
-	if (!leafPage)
+	if (leafPage)
+	{
+		newNode.payload = const_cast<UCHAR*>(insertion->iib_payload);
+		newNode.payloadLength = insertion->iib_payload_length;
+	}
+	else
 		newNode.pageNumber = insertion->iib_number.getValue();
 
 	// Compute the delta between current and new page.
@@ -7082,7 +7607,7 @@ static ULONG insert_node(thread_db* tdbb,
 		// If we're adding a node at the end we don't want that a page
 		// splits in the middle, but at the end. We can never be sure
 		// that this will happen, but at least give it a bigger chance.
-		ensureEndInsert = 6 + key->key_length;
+		ensureEndInsert = 6 + key->key_length + (leafPage ? insertion->iib_payload_length : 0);
 	}
 
 	// Get the total size of the jump nodes currently in use.
@@ -7221,7 +7746,7 @@ static ULONG insert_node(thread_db* tdbb,
 		splitpoint = node.readNode(newNode.nodePointer, leafPage);
 		IndexNode dummyNode = newNode;
 		dummyNode.setEndBucket();
-		const USHORT deltaSize = dummyNode.getNodeSize(leafPage) - newNode.getNodeSize(leafPage);
+		const int deltaSize = dummyNode.getNodeSize(leafPage) - newNode.getNodeSize(leafPage);
 		if (endOfPage && ((splitpoint + jumpersNewSize - jumpersOriginalSize) <=
 			(UCHAR*) newBucket + dbb->dbb_page_size - deltaSize))
 		{
@@ -7303,7 +7828,7 @@ static ULONG insert_node(thread_db* tdbb,
 		splitpoint = newNode.readNode(newNode.nodePointer, leafPage);
 		IndexNode dummyNode = newNode;
 		dummyNode.setEndBucket();
-		const USHORT deltaSize = dummyNode.getNodeSize(leafPage) - newNode.getNodeSize(leafPage);
+		const int deltaSize = dummyNode.getNodeSize(leafPage) - newNode.getNodeSize(leafPage);
 		if (endOfPage && ((UCHAR*) splitpoint <= (UCHAR*) newBucket + dbb->dbb_page_size - deltaSize))
 		{
 			midpoint = splitpoint;
@@ -7350,6 +7875,8 @@ static ULONG insert_node(thread_db* tdbb,
 	newNode.setNode(0, new_key->key_length, node.recordNumber, node.pageNumber);
 	// Return first record number on split page to caller.
 	newNode.data = new_key->key_data;
+	newNode.payload = node.payload;
+	newNode.payloadLength = node.payloadLength;
 	*new_record_number = newNode.recordNumber;
 	const USHORT firstSplitNodeSize = newNode.getNodeSize(leafPage);
 
@@ -7772,9 +8299,13 @@ static contents remove_leaf_node(thread_db* tdbb, index_insertion* insertion, WI
 	ULONG pages = 0;
 	while (true)
 	{
-		// if we find the right one, quit
-		if (insertion->iib_number == node.recordNumber && !node.isEndBucket && !node.isEndLevel)
+		// if we find the right one, quit; the same record may have
+		// several nodes with the same key but different non-key values
+		if (insertion->iib_number == node.recordNumber && !node.isEndBucket && !node.isEndLevel &&
+			node.payloadEqual(insertion->iib_payload_length, insertion->iib_payload))
+		{
 			break;
+		}
 
 		if (node.isEndLevel)
 		{
@@ -8084,8 +8615,9 @@ void update_selectivity(index_root_page* root, MetaId id, const SelectivityList&
 	//const Database* dbb = GET_DBB();
 
 	index_root_page::irt_repeat* irt_desc = &root->irt_rpt[id];
-	const USHORT idx_count = irt_desc->irt_keys;
-	fb_assert(selectivity.getCount() == idx_count);
+	// non-key columns follow the key segments and keep no selectivity
+	const USHORT idx_count = selectivity.getCount();
+	fb_assert(idx_count <= irt_desc->irt_keys);
 
 	// dimitr: per-segment selectivities exist only for ODS11 and above
 	irtd* key_descriptor = (irtd*) ((UCHAR*) root + irt_desc->irt_desc);
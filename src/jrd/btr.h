@@ -94,6 +94,7 @@ struct index_desc
 	MetaId	idx_primary_index;				// id for primary key partner index
 	MetaId	idx_primary_relation;			// id for primary key partner relation
 	USHORT	idx_count;						// number of keys
+	USHORT	idx_include_count;				// number of non-key (INCLUDE) columns following the keys
 	dep		idx_foreign_dep;				// foreign key partner
 	ValueExprNode* idx_expression_node;		// node tree for indexed expression
 	dsc		idx_expression_desc;			// descriptor for expression result
@@ -134,6 +135,13 @@ inline constexpr int idx_decimal		= 10;
 inline constexpr int idx_sql_time_tz	= 11;
 inline constexpr int idx_timestamp_tz	= 12;
 inline constexpr int idx_bcd			= 13;	// 128-bit Integer support
+inline constexpr int idx_include		= 14;	// Non-key (INCLUDE) column, stored in the leaf payload
+
+// Non-key columns are stored one after another in the payload of the leaf nodes.
+// Each column is its descriptor (dtype, scale, sub_type, length) followed by
+// the data, or the single zero byte (dtype_unknown) for NULL.
+
+inline constexpr USHORT INCLUDE_OVERHEAD	= 2 * sizeof(UCHAR) + 2 * sizeof(USHORT);
 
 // idx_itype space for future expansion
 inline constexpr int idx_first_intl_string	= 64;	// .. MAX (short) Range of computed key strings
@@ -149,6 +157,7 @@ inline constexpr int idx_primary		= 0x08;
 inline constexpr int idx_expression		= 0x10;
 inline constexpr int idx_condition		= 0x20;
 inline constexpr int idx_complementary	= 0x40;
+inline constexpr int idx_range			= 0x80;
 
 // these flags are for idx_runtime_flags
 
@@ -167,6 +176,8 @@ struct index_insertion
 	index_desc*	iib_descriptor;		// index descriptor
 	jrd_rel*	iib_relation;		// relation block
 	temporary_key*	iib_key;		// varying string for insertion
+	const UCHAR* iib_payload;		// non-key values stored in the leaf node
+	USHORT iib_payload_length;		// length of payload
 	RecordBitmap* iib_duplicates;	// spare bit map of duplicates
 	jrd_tra*	iib_transaction;	// insertion transaction
 	BtrPageGCLock*	iib_dont_gc_lock;	// lock to prevent removal of splitted page
@@ -211,6 +222,7 @@ struct index_sort_record
 	SINT64 isr_record_number;
 	USHORT isr_key_length;
 	USHORT isr_flags;
+	USHORT isr_payload_length;	// payload follows the sort record
 };
 #pragma pack()
 
@@ -290,6 +302,58 @@ inline constexpr int irb_force_upper	= irb_exclude_upper;
 
 typedef Firebird::HalfStaticArray<float, 4> SelectivityList;
 
+// Intervals of record numbers (inclusive) which may contain the records
+// matching the block range index retrieval, in ascending order
+
+struct RecordRange
+{
+	SINT64 lower;
+	SINT64 upper;
+};
+
+typedef Firebird::HalfStaticArray<RecordRange, 16> RecordRangeList;
+
+// Summaries of the block ranges being filled by the appending inserts, one per
+// block range index (SuperServer only). While the range is open its entry on the
+// summary page matches any key and the inserted keys widen the summary kept here.
+// It's written to the page when the inserts move to the next range, by sweep and
+// at database shutdown.
+
+class OpenRangeTable
+{
+public:
+	enum State : UCHAR
+	{
+		RANGE_OPEN,			// summary is widened in memory
+		RANGE_STALE,		// range was left open before, it stays unbounded
+		RANGE_CLOSED		// summary is widened on the page
+	};
+
+	class Range
+	{
+	public:
+		explicit Range(MemoryPool& p)
+			: entry(p)
+		{}
+
+		ULONG number = 0;			// number of the range
+		USHORT keyLength = 0;		// rng_key_length of the index
+		State state = RANGE_CLOSED;
+		Firebird::HalfStaticArray<UCHAR, 256> entry;	// Ods::range_entry of the open range
+	};
+
+	explicit OpenRangeTable(MemoryPool& p)
+		: pool(p),
+		  ranges(p)
+	{}
+
+	~OpenRangeTable();
+
+	MemoryPool& pool;
+	Firebird::Mutex mutex;
+	Firebird::GenericMap<Firebird::Pair<Firebird::NonPooled<ULONG, Range*> > > ranges;	// by index root page
+};
+
 class BtrPageGCLock : public Lock
 {
 	// This class assumes that the static part of the lock key (Lock::lck_key)
@@ -349,6 +413,7 @@ struct IndexCreation
 	PartitionedSort* sort;
 	sort_key_def* key_desc;
 	USHORT key_length;
+	USHORT payload_length;
 	USHORT nullIndLen;
 	SINT64 dup_recno;
 	Firebird::AtomicCounter duplicates;
@@ -450,7 +515,8 @@ public:
 	IndexKey(thread_db* tdbb, jrd_rel* relation, index_desc* idx)
 		: m_tdbb(tdbb), m_relation(relation), m_index(idx),
 		  m_keyType((idx->idx_flags & idx_unique) ? INTL_KEY_UNIQUE : INTL_KEY_SORT),
-		  m_segments(idx->idx_count), m_expression(m_localExpression)
+		  m_segments(idx->idx_count), m_payload(*tdbb->getDefaultPool()),
+		  m_expression(m_localExpression)
 	{
 		fb_assert(m_index->idx_count);
 	}
@@ -458,7 +524,8 @@ public:
 	IndexKey(thread_db* tdbb, jrd_rel* relation, index_desc* idx, AutoIndexExpression& expr)
 		: m_tdbb(tdbb), m_relation(relation), m_index(idx),
 		  m_keyType((idx->idx_flags & idx_unique) ? INTL_KEY_UNIQUE : INTL_KEY_SORT),
-		  m_segments(idx->idx_count), m_expression(expr)
+		  m_segments(idx->idx_count), m_payload(*tdbb->getDefaultPool()),
+		  m_expression(expr)
 	{
 		fb_assert(m_index->idx_count);
 	}
@@ -466,7 +533,8 @@ public:
 	IndexKey(thread_db* tdbb, jrd_rel* relation, index_desc* idx,
 			 USHORT keyType, USHORT segments)
 		: m_tdbb(tdbb), m_relation(relation), m_index(idx),
-		  m_keyType(keyType), m_segments(segments), m_expression(m_localExpression)
+		  m_keyType(keyType), m_segments(segments), m_payload(*tdbb->getDefaultPool()),
+		  m_expression(m_localExpression)
 	{
 		fb_assert(m_index->idx_count && m_segments && m_segments <= m_index->idx_count);
 	}
@@ -474,14 +542,16 @@ public:
 	IndexKey(thread_db* tdbb, jrd_rel* relation, index_desc* idx,
 			 USHORT keyType, USHORT segments, AutoIndexExpression& expr)
 		: m_tdbb(tdbb), m_relation(relation), m_index(idx),
-		  m_keyType(keyType), m_segments(segments), m_expression(expr)
+		  m_keyType(keyType), m_segments(segments), m_payload(*tdbb->getDefaultPool()),
+		  m_expression(expr)
 	{
 		fb_assert(m_index->idx_count && m_segments && m_segments <= m_index->idx_count);
 	}
 
 	IndexKey(const IndexKey& other)
 		: m_tdbb(other.m_tdbb), m_relation(other.m_relation), m_index(other.m_index),
-		  m_keyType(other.m_keyType), m_segments(other.m_segments), m_expression(other.m_expression)
+		  m_keyType(other.m_keyType), m_segments(other.m_segments),
+		  m_payload(*other.m_tdbb->getDefaultPool()), m_expression(other.m_expression)
 	{
 	}
 
@@ -513,6 +583,30 @@ public:
 		return memcmp(m_key.key_data, other.m_key.key_data, m_key.key_length);
 	}
 
+	// Values of the non-key (INCLUDE) columns, they're stored in the leaf node
+	// after the key and don't take part in the key ordering
+
+	const UCHAR* getPayload() const
+	{
+		return m_payload.begin();
+	}
+
+	USHORT getPayloadLength() const
+	{
+		return (USHORT) m_payload.getCount();
+	}
+
+	void setPayload(const UCHAR* data, USHORT length)
+	{
+		m_payload.assign(data, length);
+	}
+
+	bool samePayload(const IndexKey& other) const
+	{
+		return m_payload.getCount() == other.m_payload.getCount() &&
+			!memcmp(m_payload.begin(), other.m_payload.begin(), m_payload.getCount());
+	}
+
 	// Return ordinal number of the first NULL segment
 	USHORT getNullSegment() const
 	{
@@ -536,6 +630,7 @@ private:
 	const USHORT m_keyType;
 	const USHORT m_segments;
 	temporary_key m_key;
+	Firebird::HalfStaticArray<UCHAR, 128> m_payload;
 	AutoIndexExpression& m_expression;
 	AutoIndexExpression m_localExpression;
 };
@@ -34,7 +34,9 @@ void	BTR_all(Jrd::thread_db*, Jrd::Cached::Relation*, Jrd::IndexDescList&, Jrd::
 bool	BTR_activate_index(Jrd::thread_db*, Jrd::Cached::Relation*, MetaId);
 bool	BTR_cleanup_index(Jrd::thread_db*, const Jrd::QualifiedName&, Jrd::jrd_tra*, MetaId);
 void	BTR_complement_key(Jrd::temporary_key*);
+bool	BTR_covers_fields(const Jrd::index_desc*, const Jrd::Format*, Jrd::UInt32Bitmap*);
 void	BTR_create(Jrd::thread_db*, Jrd::IndexCreation&, Jrd::SelectivityList&);
+bool	BTR_decode_key(const Jrd::index_desc*, const Jrd::temporary_key*, const UCHAR*, USHORT, Jrd::Record*);
 bool	BTR_delete_index(Jrd::thread_db*, Jrd::win*, MetaId, bool);
 void	BTR_delete_tree(Jrd::thread_db*, USHORT, USHORT, Jrd::PageNumber);
 bool	BTR_description(Jrd::thread_db*, Jrd::Cached::Relation*, const Ods::index_root_page*, Jrd::index_desc*,
@@ -59,6 +61,7 @@ void	BTR_merge_index(Jrd::thread_db* tdbb, Jrd::jrd_tra* transaction, Jrd::jrd_r
 	Jrd::index_desc* idx, Jrd::PageNumber srcRootPage);
 bool	BTR_next_index(Jrd::thread_db*, Jrd::Cached::Relation*, Jrd::jrd_tra*, Jrd::index_desc*, Jrd::win*,
 					   Jrd::RelationPages* = nullptr);
+USHORT	BTR_payload_length(Jrd::thread_db*, Jrd::jrd_rel*, const Jrd::index_desc*);
 void	BTR_remove(Jrd::thread_db*, Jrd::win*, Jrd::index_insertion*);
 void	BTR_reserve_slot(Jrd::thread_db*, Jrd::IndexCreation&);
 void	BTR_selectivity(Jrd::thread_db*, Jrd::Cached::Relation*, MetaId, Jrd::SelectivityList&);
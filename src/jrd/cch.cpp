@@ -61,20 +61,11 @@
 #include "../common/config/config.h"
 #include "../common/classes/ClumpletWriter.h"
 #include "../common/classes/MsgPrint.h"
+#include "../common/os/os_utils.h"
 #include "../jrd/CryptoManager.h"
 #include "../common/utils_proto.h"
 #include "../jrd/PageToBufferMap.h"
-
-#ifndef CDS_UNAVAILABLE
-// Use lock-free lists in hash table implementation
-#define HASH_USE_CDS_LIST
-#endif
-
-
-#ifdef HASH_USE_CDS_LIST
-#include <cds/container/michael_kvlist_dhp.h>
-#include "../jrd/InitCDSLib.h"
-#endif
+#include "../jrd/BCBHashTable.h"
 
 
 using namespace Jrd;
@@ -128,6 +119,7 @@ enum LatchState
 };
 
 static void adjust_scan_count(WIN* window, bool mustRead);
+static void adjust_lru_weight(thread_db* tdbb, WIN* window, bool mustRead);
 static int blocking_ast_bdb(void*);
 #ifdef CACHE_READER
 static void prefetch_epilogue(Prefetch*, FbStatusVector *);
@@ -150,7 +142,7 @@ static void purgePrecedence(BufferControl*, BufferDesc*);
 static SSHORT related(BufferDesc*, const BufferDesc*, SSHORT, const ULONG);
 static int write_buffer(thread_db*, BufferDesc*, const PageNumber, const bool, FbStatusVector* const,
 	const bool);
-static bool write_page(thread_db*, BufferDesc*, FbStatusVector* const, const bool);
+static bool write_page(thread_db*, BufferDesc*, FbStatusVector* const, const bool, const bool = false);
 static bool set_diff_page(thread_db*, BufferDesc*);
 static void clear_dirty_flag_and_nbak_state(thread_db*, BufferDesc*);
 
@@ -208,85 +200,6 @@ constexpr int PRE_SEARCH_LIMIT	= 256;
 constexpr int PRE_EXISTS		= -1;
 constexpr int PRE_UNKNOWN		= -2;
 
-namespace Jrd
-{
-
-#ifdef HASH_USE_CDS_LIST
-
-template <typename T>
-class ListNodeAllocator
-{
-public:
-	typedef T value_type;
-
-	ListNodeAllocator() {};
-
-	template <class U>
-	constexpr ListNodeAllocator(const ListNodeAllocator<U>&) noexcept {}
-
-	T* allocate(std::size_t n);
-	void deallocate(T* p, std::size_t n);
-
-private:
-};
-
-struct BdbTraits : public cds::container::michael_list::traits
-{
-	typedef ListNodeAllocator<int> allocator;
-	//typedef std::less<PageNumber> compare;
-};
-
-typedef cds::container::MichaelKVList<cds::gc::DHP, PageNumber, BufferDesc*, BdbTraits> BdbList;
-
-#endif // HASH_USE_CDS_LIST
-
-
-class BCBHashTable
-{
-#ifdef HASH_USE_CDS_LIST
-	using chain_type = BdbList;
-#else
-	using chain_type = que;
-#endif
-
-public:
-	BCBHashTable(MemoryPool& pool, ULONG count) :
-		m_pool(pool),
-		m_count(0),
-		m_chains(nullptr)
-	{
-		resize(count);
-	}
-
-	~BCBHashTable()
-	{
-		clear();
-	}
-
-	void resize(ULONG count);
-	void clear();
-
-	BufferDesc* find(const PageNumber& page) const;
-
-	// tries to put bdb into hash slot by page
-	// if succeed, removes bdb from old slot, if necessary, and returns NULL
-	// else, returns BufferDesc that is currently occupies target slot
-	BufferDesc* emplace(BufferDesc* bdb, const PageNumber& page, bool remove);
-
-	void remove(BufferDesc* bdb);
-private:
-	ULONG hash(const PageNumber& pageno) const
-	{
-		return pageno.getPageNum() % m_count;
-	}
-
-	MemoryPool& m_pool;
-	ULONG m_count;
-	chain_type* m_chains;
-};
-
-}
-
 
 void CCH_clean_page(thread_db* tdbb, PageNumber page)
 {
@@ -311,11 +224,6 @@ void CCH_clean_page(thread_db* tdbb, PageNumber page)
 	BufferControl* bcb = dbb->dbb_bcb;
 	BufferDesc* bdb = NULL;
 	{
-#ifndef HASH_USE_CDS_LIST
-		Sync bcbSync(&bcb->bcb_syncObject, "CCH_clean_page");
-		bcbSync.lock(SYNC_SHARED);
-#endif
-
 		bdb = bcb->bcb_hashTable->find(page);
 		if (!bdb)
 			return;
@@ -760,6 +668,7 @@ pag* CCH_fake(thread_db* tdbb, WIN* window, int wait)
 	bdb->bdb_flags &= BDB_lru_chained;	// yes, clear all except BDB_lru_chained
 	bdb->bdb_flags |= (BDB_writer | BDB_faked);
 	bdb->bdb_scan_count = 0;
+	bdb->bdb_lru_weight = 0;
 
 	if (!(bcb->bcb_flags & BCB_exclusive))
 		lock_buffer(tdbb, bdb, LCK_WAIT, pag_undefined);
@@ -827,6 +736,7 @@ pag* CCH_fetch(thread_db* tdbb, WIN* window, int lock_type, SCHAR page_type, int
 	}
 
 	adjust_scan_count(window, lockState == lsLocked);
+	adjust_lru_weight(tdbb, window, lockState == lsLocked);
 
 	// Validate the fetched page matches the expected type
 
@@ -1118,14 +1028,6 @@ void CCH_forget_page(thread_db* tdbb, WIN* window)
 	}
 
 	// remove from hash table and put into empty list
-#ifndef HASH_USE_CDS_LIST
-	{
-		SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_EXCLUSIVE, FB_FUNCTION);
-		bcb->bcb_hashTable->remove(bdb);
-		QUE_INSERT(bcb->bcb_empty, bdb->bdb_que);
-		bcb->bcb_inuse--;
-	}
-#else
 	bcb->bcb_hashTable->remove(bdb);
 
 	{
@@ -1133,7 +1035,6 @@ void CCH_forget_page(thread_db* tdbb, WIN* window)
 		QUE_INSERT(bcb->bcb_empty, bdb->bdb_que);
 		bcb->bcb_inuse--;
 	}
-#endif
 
 	bdb->bdb_flags = 0;
 
@@ -1184,6 +1085,11 @@ void CCH_fini(thread_db* tdbb)
 	while (bcb->bcb_memory.hasData())
 		bcb->bcb_bufferpool->deallocate(bcb->bcb_memory.pop());
 
+	for (const auto& blk : bcb->bcb_largeBlocks)
+		os_utils::releaseLargePages(blk.m_memory, blk.m_size);
+
+	bcb->bcb_largeBlocks.clear();
+
 	BufferControl::destroy(bcb);
 	dbb->dbb_bcb = NULL;
 }
@@ -1419,15 +1325,7 @@ void CCH_get_related(thread_db* tdbb, PageNumber page, PagesArray &lowPages)
 	Database* dbb = tdbb->getDatabase();
 	BufferControl* bcb = dbb->dbb_bcb;
 
-#ifndef HASH_USE_CDS_LIST
-	Sync bcbSync(&bcb->bcb_syncObject, "CCH_get_related");
-	bcbSync.lock(SYNC_SHARED);
-#endif
-
 	BufferDesc* bdb = bcb->bcb_hashTable->find(page);
-#ifndef HASH_USE_CDS_LIST
-	bcbSync.unlock();
-#endif
 
 	if (bdb)
 	{
@@ -1543,6 +1441,7 @@ pag* CCH_handoff(thread_db*	tdbb, WIN* window, ULONG page, int lock, SCHAR page_
 	}
 
 	adjust_scan_count(window, must_read == lsLocked);
+	adjust_lru_weight(tdbb, window, must_read == lsLocked);
 
 	// Validate the fetched page matches the expected type
 
@@ -1610,8 +1509,15 @@ void CCH_init(thread_db* tdbb, ULONG number)
 
 	dbb->dbb_bcb = bcb;
 	bcb->bcb_page_size = dbb->dbb_page_size;
+	bcb->bcb_read_ahead = dbb->dbb_config->getReadAheadPages();
+	bcb->bcb_flush_batch = dbb->dbb_config->getFlushBatchSize();
 	bcb->bcb_database = dbb;
 	bcb->bcb_flags = shared ? BCB_exclusive : 0;
+	if (NoCaseString(dbb->dbb_config->getCachePolicy()) == CachePolicyWeighted)
+		bcb->bcb_flags |= BCB_weighted_lru;
+	bcb->bcb_huge_page_size = dbb->dbb_config->getCacheHugePageSize();
+	if (NoCaseString(dbb->dbb_config->getCacheNumaPolicy()) == CacheNumaPolicyInterleave)
+		bcb->bcb_flags |= BCB_numa_interleave;
 	//bcb->bcb_flags = BCB_exclusive;	// TODO detect real state using LM
 
 	QUE_INIT(bcb->bcb_in_use);
@@ -1635,6 +1541,21 @@ void CCH_init(thread_db* tdbb, ULONG number)
 			 tdbb->getAttachment()->att_filename.c_str(), bcb->bcb_count, count);
 	}
 
+	// Report what memory was actually obtained if special placement was requested.
+
+	if (bcb->bcb_huge_page_size)
+	{
+		gds__log("Database: %s\n\t%ld of %ld page buffers allocated in huge pages of %ld KB",
+			 tdbb->getAttachment()->att_filename.c_str(), bcb->bcb_huge_buffers, bcb->bcb_count,
+			 (ULONG) (bcb->bcb_huge_page_size / 1024));
+	}
+
+	if (bcb->bcb_flags & BCB_numa_interleave)
+	{
+		gds__log("Database: %s\n\t%ld of %ld page buffers interleaved over NUMA nodes",
+			 tdbb->getAttachment()->att_filename.c_str(), bcb->bcb_numa_buffers, bcb->bcb_count);
+	}
+
 	if (dbb->dbb_lock->lck_logical != LCK_EX)
 		dbb->dbb_ast_flags |= DBB_assert_locks;
 }
@@ -1939,6 +1860,47 @@ bool CCH_prefetch_pages(thread_db* tdbb)
 #endif // CACHE_READER
 
 
+void CCH_read_ahead(thread_db* tdbb, USHORT pageSpaceId, const ULONG* pages, FB_SIZE_T count)
+{
+/**************************************
+ *
+ *	C C H _ r e a d _ a h e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Given a vector of pages which a sequential scan is going
+ *	to fetch soon, ask the physical layer to start reading
+ *	those of them which are not in the cache yet. It's just
+ *	a hint, nothing is latched or read into the buffers here.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
+
+	if (!bcb->bcb_read_ahead || !count)
+		return;
+
+	const auto pageSpace = dbb->dbb_page_manager.findPageSpace(pageSpaceId);
+	if (!pageSpace || !pageSpace->file)
+		return;
+
+	// Keep the missing pages sorted, this allows the physical
+	// layer to coalesce adjacent pages into a single request
+
+	SortedArray<ULONG, InlineStorage<ULONG, 64> > missing;
+	for (const ULONG* const end = pages + count; pages < end; pages++)
+	{
+		if (*pages && !bcb->bcb_hashTable->find(PageNumber(pageSpaceId, *pages)))
+			missing.add(*pages);
+	}
+
+	if (missing.hasData())
+		PIO_prefetch(tdbb, pageSpace->file, missing.begin(), missing.getCount());
+}
+
+
 bool set_diff_page(thread_db* tdbb, BufferDesc* bdb)
 {
 	Database* const dbb = tdbb->getDatabase();
@@ -2589,6 +2551,74 @@ static void adjust_scan_count(WIN* window, bool mustRead)
 }
 
 
+static void adjust_lru_weight(thread_db* tdbb, WIN* window, bool mustRead)
+{
+/**************************************
+ *
+ *	a d j u s t _ l r u _ w e i g h t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Account page fetch in the cache statistics
+ *	of the attachment, see Attachment::mergeStats().
+ *
+ *	With weighted LRU policy, a page used again after it
+ *	was read gets a few chances to survive the LRU tail,
+ *	depending on its type. Large scans and garbage collector
+ *	touch a lot of pages once, don't let them promote pages.
+ *
+ **************************************/
+	BufferDesc* const bdb = window->win_bdb;
+	BufferControl* const bcb = bdb->bdb_bcb;
+	const SCHAR pageType = bdb->bdb_buffer->pag_type;
+
+	CachePageClass pageClass;
+	UCHAR weight;
+
+	switch (pageType)
+	{
+	case pag_data:
+	case pag_blob:
+		pageClass = CachePageClass::DATA;
+		weight = 1;
+		break;
+
+	case pag_index:
+	case pag_range:
+		pageClass = CachePageClass::INDEX;
+		weight = 2;
+		break;
+
+	case pag_root:
+		pageClass = CachePageClass::INDEX;
+		weight = 3;
+		break;
+
+	case pag_pointer:
+		pageClass = CachePageClass::POINTER;
+		weight = 3;
+		break;
+
+	default:
+		pageClass = CachePageClass::OTHER;
+		weight = 3;
+		break;
+	}
+
+	tdbb->bumpStats(pageClass, mustRead);
+
+	if (!(bcb->bcb_flags & BCB_weighted_lru) || mustRead ||
+		(window->win_flags & (WIN_large_scan | WIN_garbage_collector)))
+	{
+		return;
+	}
+
+	if (bdb->bdb_lru_weight < weight)
+		bdb->bdb_lru_weight = weight;
+}
+
+
 static int blocking_ast_bdb(void* ast_object)
 {
 /**************************************
@@ -2782,6 +2812,162 @@ extern "C" {
 } // extern C
 
 
+namespace
+{
+	// Pages written by flushPages() with deferred disk synchronization.
+	// Every such page stays latched and IO locked, and its lower precedence
+	// relationships are not cleared, until the database file is synchronized.
+	// Thus nobody is able to change the page, or to write a page which must be
+	// written after it, before the page is really on disk.
+	class DeferredWrites
+	{
+	public:
+		DeferredWrites(thread_db* tdbb, jrd_file* file, ULONG limit)
+			: m_tdbb(tdbb),
+			  m_file(file),
+			  m_limit(limit),
+			  m_bdbs(*tdbb->getDefaultPool())
+		{ }
+
+		~DeferredWrites()
+		{
+			try
+			{
+				FbLocalStatus status;
+				complete(&status);
+			}
+			catch (const Exception&)
+			{} // no-op
+		}
+
+		bool isEmpty() const
+		{
+			return m_bdbs.isEmpty();
+		}
+
+		// Latch page avoiding waits while holding pages of incomplete batch
+		void addRef(BufferDesc* bdb, SyncType syncType)
+		{
+			if (m_bdbs.isEmpty() || !bdb->addRefConditional(m_tdbb, syncType))
+			{
+				sync();
+				bdb->addRef(m_tdbb, syncType);
+			}
+		}
+
+		bool write(BufferDesc* bdb);
+		void sync();
+
+	private:
+		bool complete(FbStatusVector* status);
+
+		thread_db* const m_tdbb;
+		jrd_file* const m_file;
+		const ULONG m_limit;
+		HalfStaticArray<BufferDesc*, 64> m_bdbs;
+	};
+
+	// Write shared latched page with no higher precedence pages without
+	// waiting for the disk. Return false if the page should be written
+	// the usual way. If page is added to the batch, its latch is owned
+	// by the batch since now.
+	bool DeferredWrites::write(BufferDesc* bdb)
+	{
+		thread_db* const tdbb = m_tdbb;
+		Database* const dbb = tdbb->getDatabase();
+
+		if (!m_limit ||
+			bdb->bdb_page.getPageSpaceID() != DB_PAGE_SPACE ||
+			bdb->bdb_page == HEADER_PAGE_NUMBER ||
+			!(bdb->bdb_flags & BDB_dirty) ||
+			(bdb->bdb_flags & BDB_marked) ||
+			QUE_NOT_EMPTY(bdb->bdb_higher) ||
+			dbb->dbb_backup_manager->getState() != Ods::hdr_nbak_normal)
+		{
+			return false;
+		}
+
+		if (m_bdbs.isEmpty() || !bdb->lockIOConditional(tdbb))
+		{
+			sync();
+			bdb->lockIO(tdbb);
+		}
+
+		if (!(bdb->bdb_flags & BDB_dirty) || (bdb->bdb_flags & BDB_marked) ||
+			QUE_NOT_EMPTY(bdb->bdb_higher))
+		{
+			// Page was written by someone else meanwhile
+			bdb->unLockIO(tdbb);
+			return false;
+		}
+
+		// Set the flag before the dirty one is reset to not let
+		// check_precedence miss the relationship with the page.
+		bdb->bdb_flags |= BDB_sync_pending;
+
+		FbStatusVector* const status = tdbb->tdbb_status_vector;
+		if (!write_page(tdbb, bdb, status, false, true))
+		{
+			bdb->bdb_flags &= ~BDB_sync_pending;
+			bdb->unLockIO(tdbb);
+
+			FbLocalStatus localStatus;
+			complete(&localStatus);
+			CCH_unwind(tdbb, true);
+		}
+
+		m_bdbs.add(bdb);
+
+		if (m_bdbs.getCount() >= m_limit)
+			sync();
+
+		return true;
+	}
+
+	// Synchronize batch with the disk
+	void DeferredWrites::sync()
+	{
+		if (!complete(m_tdbb->tdbb_status_vector))
+			CCH_unwind(m_tdbb, true);
+	}
+
+	bool DeferredWrites::complete(FbStatusVector* status)
+	{
+		if (m_bdbs.isEmpty())
+			return true;
+
+		thread_db* const tdbb = m_tdbb;
+		Database* const dbb = tdbb->getDatabase();
+
+		const bool result = PIO_sync(tdbb, m_file, status);
+		if (!result)
+			dbb->dbb_flags |= DBB_suspend_bgio;
+
+		for (BufferDesc** iter = m_bdbs.begin(); iter < m_bdbs.end(); ++iter)
+		{
+			BufferDesc* const bdb = *iter;
+
+			// Latches could be already released by CCH_unwind
+			if (!bdb->ourIOLock())
+				continue;
+
+			bdb->bdb_flags &= ~BDB_sync_pending;
+			if (!result)
+				bdb->bdb_flags |= BDB_io_error;
+
+			bdb->unLockIO(tdbb);
+			if (result)
+				clear_precedence(tdbb, bdb);
+
+			bdb->release(tdbb, !(bdb->bdb_flags & BDB_dirty));
+		}
+
+		m_bdbs.clear();
+		return result;
+	}
+} // namespace
+
+
 // Write array of pages to disk in efficient order.
 // First, sort pages by their numbers to make writes physically ordered and
 // thus faster. At every iteration of while loop write pages which have no high
@@ -2789,6 +2975,9 @@ extern "C" {
 // no such pages (i.e. all of not written yet pages have high precedence pages)
 // then write them all at last iteration (of course write_buffer will also check
 // for precedence before write).
+// With forced writes on, pages written at the same iteration are independent of
+// each other, so they could be written without waiting for the disk and then
+// synchronized at once, see DeferredWrites.
 static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, FB_SIZE_T count)
 {
 	FbStatusVector* const status = tdbb->tdbb_status_vector;
@@ -2796,6 +2985,14 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 	const bool release_flag = (flush_flag & FLUSH_RLSE) != 0;
 	const bool write_thru = release_flag;
 
+	Database* const dbb = tdbb->getDatabase();
+	const PageSpace* const pageSpace = dbb->dbb_page_manager.findPageSpace(DB_PAGE_SPACE);
+	jrd_file* const file = pageSpace->file;
+
+	const bool deferSync = !release_flag && !dbb->dbb_shadow &&
+		(file->fil_flags & FIL_force_write) && count > 1;
+	DeferredWrites deferred(tdbb, file, deferSync ? dbb->dbb_bcb->bcb_flush_batch : 0);
+
 	qsort(begin, count, sizeof(BufferDesc*), cmpBdbs);
 
 	MarkIterator<BufferDesc*> iter(begin, count);
@@ -2813,7 +3010,7 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 			if (!bdb)
 				continue;
 
-			bdb->addRef(tdbb, release_flag ? SYNC_EXCLUSIVE : SYNC_SHARED);
+			deferred.addRef(bdb, release_flag ? SYNC_EXCLUSIVE : SYNC_SHARED);
 
 			BufferControl* bcb = bdb->bdb_bcb;
 			if (!writeAll)
@@ -2827,8 +3024,18 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 						BUGCHECK(210);	// msg 210 page in use during flush
 				}
 
+				if (!writeAll && deferred.write(bdb))
+				{
+					// latch is released by deferred
+					iter.mark();
+					found = true;
+					written++;
+					continue;
+				}
+
 				if (!all_flag || bdb->bdb_flags & (BDB_db_dirty | BDB_dirty))
 				{
+					deferred.sync();
 					if (!write_buffer(tdbb, bdb, bdb->bdb_page, write_thru, status, true))
 						CCH_unwind(tdbb, true);
 				}
@@ -2850,6 +3057,9 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 			}
 		}
 
+		// pages of the next iteration could depend on the written ones
+		deferred.sync();
+
 		if (!found)
 			writeAll = true;
 
@@ -3227,15 +3437,7 @@ static void check_precedence(thread_db* tdbb, WIN* window, PageNumber page)
 
 	// Start by finding the buffer containing the high priority page
 
-#ifndef HASH_USE_CDS_LIST
-	Sync bcbSync(&bcb->bcb_syncObject, FB_FUNCTION);
-	bcbSync.lock(SYNC_SHARED);
-#endif
-
 	BufferDesc* high = bcb->bcb_hashTable->find(page);
-#ifndef HASH_USE_CDS_LIST
-	bcbSync.unlock();
-#endif
 
 	if (!high)
 		return;
@@ -3243,7 +3445,7 @@ static void check_precedence(thread_db* tdbb, WIN* window, PageNumber page)
 	// Found the higher precedence buffer.  If it's not dirty, don't sweat it.
 	// If it's the same page, ditto.
 
-	if (!(high->bdb_flags & BDB_dirty) || (high->bdb_page == window->win_page))
+	if (!(high->bdb_flags & (BDB_dirty | BDB_sync_pending)) || (high->bdb_page == window->win_page))
 		return;
 
 	BufferDesc* low = window->win_bdb;
@@ -3703,6 +3905,15 @@ static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
 		if (oldest->bdb_use_count || !oldest->addRefConditional(tdbb, SYNC_EXCLUSIVE))
 			continue;
 
+		// Give re-referenced page another chance, see adjust_lru_weight()
+		if ((bcb->bcb_flags & BCB_weighted_lru) && oldest->bdb_lru_weight)
+		{
+			oldest->bdb_lru_weight--;
+			oldest->release(tdbb, true);
+			recentlyUsed(oldest);
+			continue;
+		}
+
 		/*if (!writeable(oldest))
 		{
 			oldest->release(tdbb, true);
@@ -3840,12 +4051,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 		while (!bdb)
 		{
 			// try to get already existing buffer
-			{
-#ifndef HASH_USE_CDS_LIST
-				SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_SHARED, FB_FUNCTION);
-#endif
-				bdb = bcb->bcb_hashTable->find(page);
-			}
+			bdb = bcb->bcb_hashTable->find(page);
 
 			if (bdb)
 			{
@@ -3916,9 +4122,6 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 			BufferDesc* bdb2 = nullptr;
 
 			{
-#ifndef HASH_USE_CDS_LIST
-				SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_EXCLUSIVE, FB_FUNCTION);
-#endif
 				bdb2 = bcb->bcb_hashTable->emplace(bdb, page, !is_empty);
 				if (!bdb2)
 				{
@@ -3926,13 +4129,10 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 					bdb->bdb_flags &= BDB_lru_chained; // yes, clear all except BDB_lru_chained
 					bdb->bdb_flags |= BDB_read_pending;
 					bdb->bdb_scan_count = 0;
+					bdb->bdb_lru_weight = 0;
 					if (bdb->bdb_lock)
 						bdb->bdb_lock->lck_logical = LCK_none;
 
-#ifndef HASH_USE_CDS_LIST
-					bcbSync.unlock();
-#endif
-
 					if (!(bdb->bdb_flags & BDB_lru_chained))
 					{
 						Sync syncLRU(&bcb->bcb_syncLRU, FB_FUNCTION);
@@ -4248,6 +4448,9 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 	const size_t lock_size = (bcb->bcb_flags & BCB_exclusive) ? 0 :
 		FB_ALIGN(sizeof(Lock) + lock_key_extra, alignof(Lock));
 
+	const bool interleave = (bcb->bcb_flags & BCB_numa_interleave);
+	bool inHugePages = false;
+
 	while (number)
 	{
 		if (!memory)
@@ -4258,7 +4461,7 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 
 			while (true)
 			{
-				const size_t memory_size = (sizeof(BufferDesc) + lock_size + page_size) * (to_alloc + 1);
+				size_t memory_size = (sizeof(BufferDesc) + lock_size + page_size) * (to_alloc + 1);
 
 				fb_assert(memory_size > 0);
 				if (memory_size < MIN_BUFFER_SEGMENT)
@@ -4267,10 +4470,38 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 					return buffers;
 				}
 
+				// Try huge pages first, unless the block is smaller than a single huge page.
+				// Pages are not touched yet, so NUMA policy could still be applied to them.
+
+				if (bcb->bcb_huge_page_size && memory_size >= bcb->bcb_huge_page_size)
+				{
+					memory = (UCHAR*) os_utils::allocLargePages(memory_size, bcb->bcb_huge_page_size);
+
+					if (memory)
+					{
+						BufferControl::LargeBlock largeBlock;
+						largeBlock.m_memory = memory;
+						largeBlock.m_size = memory_size;
+						bcb->bcb_largeBlocks.push(largeBlock);
+
+						memory_end = memory + memory_size;
+						inHugePages = true;
+						break;
+					}
+				}
+
 				try
 				{
 					memory = (UCHAR*) bcb->bcb_bufferpool->allocate(memory_size);
 					memory_end = memory + memory_size;
+					inHugePages = false;
+
+					// Huge pages are requested but not available - let OS
+					// use transparent huge pages for the block, if it can
+					if (bcb->bcb_huge_page_size)
+						os_utils::adviseLargePages(memory, memory_size);
+
+					bcb->bcb_memory.push(memory);
 					break;
 				}
 				catch (Firebird::BadAlloc&)
@@ -4282,7 +4513,15 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 					to_alloc >>= 1;
 				}
 			}
-			bcb->bcb_memory.push(memory);
+
+			// Spread the block over NUMA nodes before it is touched first time
+			const bool interleaved = interleave &&
+				os_utils::interleaveMemory(memory, memory_end - memory);
+
+			if (inHugePages)
+				bcb->bcb_huge_buffers += to_alloc;
+			if (interleaved)
+				bcb->bcb_numa_buffers += to_alloc;
 
 			tail = (BufferDesc*) FB_ALIGN(memory, alignof(BufferDesc));
 
@@ -4860,7 +5099,8 @@ static int write_buffer(thread_db* tdbb,
 }
 
 
-static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const status, const bool inAst)
+static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const status, const bool inAst,
+	const bool deferSync)
 {
 /**************************************
  *
@@ -4871,6 +5111,8 @@ static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const s
  * Functional description
  *	Do actions required when writing a database page,
  *	including journaling, shadowing.
+ *	If deferSync is set, caller is responsible to call
+ *	PIO_sync before anything may depend on the page.
  *
  **************************************/
 
@@ -4989,15 +5231,16 @@ static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const s
 				class Pio : public CryptoManager::IOCallback
 				{
 				public:
-					Pio(jrd_file* f, BufferDesc* b, bool ast, bool tp, PageSpace* ps)
-						: file(f), bdb(b), inAst(ast), isTempPage(tp), pageSpace(ps)
+					Pio(jrd_file* f, BufferDesc* b, bool ast, bool tp, PageSpace* ps, bool ds)
+						: file(f), bdb(b), inAst(ast), isTempPage(tp), deferSync(ds), pageSpace(ps)
 					{ }
 
 					bool callback(thread_db* tdbb, FbStatusVector* status, Ods::pag* page)
 					{
 						Database* dbb = tdbb->getDatabase();
 
-						while (!PIO_write(tdbb, file, bdb, page, status))
+						while (!(deferSync ? PIO_write_deferred(tdbb, file, bdb, page, status) :
+											 PIO_write(tdbb, file, bdb, page, status)))
 						{
 							if (isTempPage || !CCH_rollover_to_shadow(tdbb, dbb, file, inAst))
 							{
@@ -5026,10 +5269,11 @@ static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const s
 					BufferDesc* bdb;
 					bool inAst;
 					bool isTempPage;
+					bool deferSync;
 					PageSpace* pageSpace;
 				};
 
-				Pio io(pageSpace->file, bdb, inAst, isTempPage, pageSpace);
+				Pio io(pageSpace->file, bdb, inAst, isTempPage, pageSpace, deferSync);
 				result = dbb->dbb_crypto_manager->write(tdbb, status, page, &io);
 				if (!result && (bdb->bdb_flags & BDB_io_error))
 				{
@@ -5287,6 +5531,21 @@ void BufferDesc::lockIO(thread_db* tdbb)
 }
 
 
+bool BufferDesc::lockIOConditional(thread_db* tdbb)
+{
+	if (!bdb_syncIO.lockConditional(SYNC_EXCLUSIVE, FB_FUNCTION))
+		return false;
+
+	fb_assert(!bdb_io_locks && bdb_io != tdbb || bdb_io_locks && bdb_io == tdbb);
+
+	bdb_io = tdbb;
+	bdb_io->registerBdb(this);
+	++bdb_io_locks;
+	++bdb_use_count;
+	return true;
+}
+
+
 void BufferDesc::unLockIO(thread_db* tdbb)
 {
 	fb_assert(bdb_io && bdb_io == tdbb);
@@ -5304,225 +5563,7 @@ void BufferDesc::unLockIO(thread_db* tdbb)
 }
 
 
-namespace Jrd {
-
-/// class BCBHashTable
-
-void BCBHashTable::resize(ULONG count)
-{
-	const ULONG old_count = m_count;
-	chain_type* const old_chains = m_chains;
-
-	chain_type* new_chains = FB_NEW_POOL(m_pool) chain_type[count];
-	m_count = count;
-	m_chains = new_chains;
-
-#ifndef HASH_USE_CDS_LIST
-	// Initialize all new new_chains
-	for (chain_type* que = new_chains; que < new_chains + count; que++)
-		QUE_INIT(*que);
-#endif
-
-	if (!old_chains)
-		return;
-
-	const chain_type* const old_end = old_chains + old_count;
-
-	// Move any active buffers from old hash table to new
-	for (chain_type* old_tail = old_chains; old_tail < old_end; old_tail++)
-	{
-#ifndef HASH_USE_CDS_LIST
-		while (QUE_NOT_EMPTY(*old_tail))
-		{
-			QUE que_inst = old_tail->que_forward;
-			BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_que);
-			QUE_DELETE(*que_inst);
-			QUE mod_que = &new_chains[hash(bdb->bdb_page)];
-			QUE_INSERT(*mod_que, *que_inst);
-		}
-#else
-		while (!old_tail->empty())
-		{
-			auto n = old_tail->begin();
-			old_tail->erase(n->first);				// bdb_page
-
-			chain_type* new_chain = &m_chains[hash(n->first)];
-			new_chain->insert(n->first, n->second);	// bdb_page, bdb
-		}
-#endif
-	}
-
-	delete[] old_chains;
-}
-
-void BCBHashTable::clear()
-{
-	if (!m_chains)
-		return;
-
 #ifdef HASH_USE_CDS_LIST
-	const chain_type* const end = m_chains + m_count;
-	for (chain_type* tail = m_chains; tail < end; tail++)
-		tail->clear();
-#endif
-
-	delete[] m_chains;
-	m_chains = nullptr;
-	m_count = 0;
-}
-
-inline BufferDesc* BCBHashTable::find(const PageNumber& page) const
-{
-	auto& list = m_chains[hash(page)];
-
-#ifndef HASH_USE_CDS_LIST
-	QUE que_inst = list.que_forward;
-	for (; que_inst != &list; que_inst = que_inst->que_forward)
-	{
-		BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_que);
-		if (bdb->bdb_page == page)
-			return bdb;
-	}
-
-#else // HASH_USE_CDS_LIST
-	auto ptr = list.get(page);
-	if (!ptr.empty())
-	{
-		fb_assert(ptr->second != nullptr);
-#ifdef DEV_BUILD
-		// Original libcds have no update(key, value), use this code with it,
-		// see also comment in get_buffer()
-		while (ptr->second == nullptr)
-			cds::backoff::pause();
-#endif
-		if (ptr->second->bdb_page == page)
-			return ptr->second;
-	}
-#endif
-
-	return nullptr;
-}
-
-inline BufferDesc* BCBHashTable::emplace(BufferDesc* bdb, const PageNumber& page, bool remove)
-{
-#ifndef HASH_USE_CDS_LIST
-	// bcb_syncObject should be locked in EX mode
-
-	BufferDesc* bdb2 = find(page);
-	if (!bdb2)
-	{
-		if (remove)
-			QUE_DELETE(bdb->bdb_que);
-
-		que& mod_que = m_chains[hash(page)];
-		QUE_INSERT(mod_que, bdb->bdb_que);
-	}
-	return bdb2;
-#else // HASH_USE_CDS_LIST
-
-	BufferDesc* bdb2 = nullptr;
-	BdbList& list = m_chains[hash(page)];
-
-/*
-	// Original libcds have no update(key, value), use this code with it
-
-	auto ret = list.update(page, [bdb, &bdb2](bool bNew, BdbList::value_type& val)
-		{
-			if (bNew)
-				val.second = bdb;
-			else
-				while (!(bdb2 = val.second))
-					cds::backoff::pause();
-		},
-		true);
-*/
-
-	auto ret = list.update(page, bdb, [&bdb2](bool bNew, BdbList::value_type& val)
-		{
-			// someone might have put a page buffer in the chain concurrently, so
-			// we store it for the further investigation
-			if (!bNew)
-				bdb2 = val.second;
-		},
-		true);
-	fb_assert(ret.first);
-
-	// if we have inserted the page buffer that we found (empty or oldest)
-	if (bdb2 == nullptr)
-	{
-		fb_assert(ret.second);
-#ifdef DEV_BUILD
-		auto p1 = list.get(page);
-		fb_assert(!p1.empty() && p1->first == page && p1->second == bdb);
-#endif
-
-		if (remove)
-		{
-			// remove the page buffer from old hash slot
-			const PageNumber oldPage = bdb->bdb_page;
-			BdbList& oldList = m_chains[hash(oldPage)];
-
-#ifdef DEV_BUILD
-			p1 = oldList.get(oldPage);
-			fb_assert(!p1.empty() && p1->first == oldPage && p1->second == bdb);
-#endif
-
-			const bool ok = oldList.erase(oldPage);
-			fb_assert(ok);
-
-#ifdef DEV_BUILD
-			p1 = oldList.get(oldPage);
-			fb_assert(p1.empty() || p1->second != bdb);
-#endif
-		}
-
-#ifdef DEV_BUILD
-		p1 = list.get(page);
-		fb_assert(!p1.empty() && p1->first == page && p1->second == bdb);
-#endif
-	}
-	return bdb2;
-#endif
-}
-
-
-void BCBHashTable::remove(BufferDesc* bdb)
-{
-#ifndef HASH_USE_CDS_LIST
-	QUE_DELETE(bdb->bdb_que);
-#else
-	BdbList& list = m_chains[hash(bdb->bdb_page)];
-
-#ifdef DEV_BUILD
-	auto p = list.get(bdb->bdb_page);
-	fb_assert(!p.empty() && p->first == bdb->bdb_page && p->second == bdb);
-#endif
-
-	list.erase(bdb->bdb_page);
-#endif
-}
-
-
-}; // namespace Jrd
-
-
-#ifdef HASH_USE_CDS_LIST
-
-static InitInstance<InitPool> initPool;
-
-
-template <typename T>
-T* ListNodeAllocator<T>::allocate(std::size_t n)
-{
-	return static_cast<T*>(initPool().alloc(n * sizeof(T)));
-}
-
-template <typename T>
-void ListNodeAllocator<T>::deallocate(T* p, std::size_t /* n */)
-{
-	// It uses the correct pool stored within memory block itself
-	MemoryPool::globalFree(p);
-}
 
 void suspend()
 {
@@ -82,7 +82,8 @@ class BufferControl : public pool_alloc<type_bcb>
 		  bcb_memory_stats(&parentStats),
 		  bcb_memory(p),
 		  bcb_writer_fini(p, cache_writer, THREAD_medium),
-		  bcb_bdbBlocks(p)
+		  bcb_bdbBlocks(p),
+		  bcb_largeBlocks(p)
 	{
 		bcb_database = NULL;
 		QUE_INIT(bcb_in_use);
@@ -98,6 +99,11 @@ class BufferControl : public pool_alloc<type_bcb>
 		bcb_prec_walk_mark = 0;
 		bcb_page_size = 0;
 		bcb_page_incarnation = 0;
+		bcb_read_ahead = 0;
+		bcb_flush_batch = 0;
+		bcb_huge_page_size = 0;
+		bcb_huge_buffers = 0;
+		bcb_numa_buffers = 0;
 		bcb_hashTable = nullptr;
 #ifdef SUPERSERVER_V2
 		bcb_prefetch = NULL;
@@ -135,6 +141,11 @@ public:
 	ULONG		bcb_prec_walk_mark;	// mark value used in precedence graph walk
 	ULONG		bcb_page_size;		// Database page size in bytes
 	ULONG		bcb_page_incarnation;	// Cache page incarnation counter
+	ULONG		bcb_read_ahead;		// Number of pages to read ahead during sequential scans
+	ULONG		bcb_flush_batch;	// Number of forced writes to batch per disk sync at flush
+	size_t		bcb_huge_page_size;	// Size of huge pages to allocate buffers in, zero if not used
+	ULONG		bcb_huge_buffers;	// Number of buffers allocated in huge pages
+	ULONG		bcb_numa_buffers;	// Number of buffers interleaved over NUMA nodes
 
 	Firebird::SyncObject	bcb_syncObject;
 	Firebird::SyncObject	bcb_syncDirtyBdbs;
@@ -172,6 +183,14 @@ public:
 		ULONG m_count;
 	};
 	Firebird::Array<BDBBlock>	bcb_bdbBlocks;		// all allocated BufferDesc's
+
+	// block of memory allocated in huge pages directly from OS
+	struct LargeBlock
+	{
+		UCHAR* m_memory;
+		size_t m_size;
+	};
+	Firebird::Array<LargeBlock>	bcb_largeBlocks;
 };
 
 inline constexpr int BCB_keep_pages		= 1;	// set during btc_flush(), pages not removed from dirty binary tree
@@ -184,6 +203,8 @@ inline constexpr int BCB_reader_active	= 32;	// cache reader not blocked on even
 #endif
 inline constexpr int BCB_free_pending	= 64;	// request cache writer to free pages
 inline constexpr int BCB_exclusive		= 128;	// there is only BCB in whole system
+inline constexpr int BCB_weighted_lru	= 256;	// re-referenced pages get extra chances at LRU tail
+inline constexpr int BCB_numa_interleave	= 512;	// spread buffers memory over NUMA nodes
 
 
 // BufferDesc -- Buffer descriptor block
@@ -211,6 +232,7 @@ public:
 		bdb_writers = 0;
 		bdb_io_locks = 0;
 		bdb_scan_count = 0;
+		bdb_lru_weight = 0;
 		bdb_difference_page = 0;
 		bdb_prec_walk_mark = 0;
 	}
@@ -221,6 +243,7 @@ public:
 	void release(thread_db* tdbb, bool repost);
 
 	void lockIO(thread_db*);
+	bool lockIOConditional(thread_db*);
 	void unLockIO(thread_db*);
 
 	bool isLocked() const
@@ -265,6 +288,7 @@ public:
 	SSHORT		bdb_writers;					// Number of recursively taken exclusive locks
 	SSHORT		bdb_io_locks;					// Number of recursively taken IO locks
 	Firebird::AtomicCounter	bdb_scan_count;		// concurrent sequential scans
+	std::atomic<UCHAR>		bdb_lru_weight;		// chances left to survive LRU tail, see BCB_weighted_lru
 	ULONG       bdb_difference_page;			// Number of page in difference file, NBAK
 	ULONG		bdb_prec_walk_mark;				// mark value used in precedence graph walk
 };
@@ -291,6 +315,7 @@ inline constexpr int BDB_prefetch			= 0x4000;	// page has been prefetched but no
 inline constexpr int BDB_no_blocking_ast	= 0x8000;	// No blocking AST registered with page lock
 inline constexpr int BDB_lru_chained		= 0x10000;	// buffer is in pending LRU chain
 inline constexpr int BDB_nbak_state_lock	= 0x20000;	// nbak state lock should be released after buffer is written
+inline constexpr int BDB_sync_pending		= 0x40000;	// page is written but not yet synchronized to disk
 
 // bdb_ast_flags
 
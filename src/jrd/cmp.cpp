@@ -607,7 +607,7 @@ void CMP_post_procedure_access(thread_db* tdbb, CompilerScratch* csb, Cached::Pr
 }
 
 
-RecordSource* CMP_post_rse(thread_db* tdbb, CompilerScratch* csb, RseNode* rse)
+RecordSource* CMP_post_rse(thread_db* tdbb, CompilerScratch* csb, RseNode* rse, bool mainCursor)
 {
 /**************************************
  *
@@ -617,13 +617,15 @@ RecordSource* CMP_post_rse(thread_db* tdbb, CompilerScratch* csb, RseNode* rse)
  *
  * Functional description
  *	Perform actual optimization of an RseNode and clear activity.
+ *	Main cursor is the top level one, not nested into other loops
+ *	and not used for positioned updates.
  *
  **************************************/
 	SET_TDBB(tdbb);
 
 	fb_assert(csb->csb_currentCursorId);
 
-	const auto rsb = Optimizer::compile(tdbb, csb, rse);
+	const auto rsb = Optimizer::compile(tdbb, csb, rse, mainCursor);
 
 	// Mark all the substreams as inactive
 
@@ -59,7 +59,7 @@ void CMP_post_access(Jrd::thread_db*, Jrd::CompilerScratch*, const Jrd::MetaName
 					 const Jrd::MetaName& = {});
 
 void CMP_post_procedure_access(Jrd::thread_db*, Jrd::CompilerScratch*, Jrd::Cached::Procedure*);
-Jrd::RecordSource* CMP_post_rse(Jrd::thread_db*, Jrd::CompilerScratch*, Jrd::RseNode*);
+Jrd::RecordSource* CMP_post_rse(Jrd::thread_db*, Jrd::CompilerScratch*, Jrd::RseNode*, bool = false);
 void CMP_release(Jrd::thread_db*, Jrd::Request*);
 
 #endif // JRD_CMP_PROTO_H
@@ -215,6 +215,11 @@ inline constexpr SSHORT IDX_NOT_VALIDATED	= 0x02;		// Unique not validated
 
 inline constexpr SSHORT IDX_UNIQUE_NOT_VALIDATED = IDX_UNIQUE | IDX_NOT_VALIDATED;
 
+// RDB$INDICES.RDB$INDEX_TYPE values
+inline constexpr SSHORT IDX_TYPE_ASCENDING	= 0;
+inline constexpr SSHORT IDX_TYPE_DESCENDING	= 1;
+inline constexpr SSHORT IDX_TYPE_RANGE		= 2;		// Block range (min/max summary) index, ascending
+
 
 inline constexpr USHORT SQL_MATCH_1_CHAR	= '_';
 inline constexpr USHORT SQL_MATCH_ANY_CHARS	= '%';
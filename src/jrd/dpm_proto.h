@@ -55,6 +55,7 @@ namespace Ods
 	struct data_page;
 }
 
+bool	DPM_all_visible(Jrd::thread_db*, Jrd::record_param*);
 Ods::pag* DPM_allocate(Jrd::thread_db*, Jrd::win*);
 void	DPM_backout(Jrd::thread_db*, Jrd::record_param*);
 void	DPM_backout_mark(Jrd::thread_db*, Jrd::record_param*, const Jrd::jrd_tra*);
@@ -62,6 +63,7 @@ double	DPM_cardinality(Jrd::thread_db*, Jrd::jrd_rel*, const Jrd::Format*);
 bool	DPM_chain(Jrd::thread_db*, Jrd::record_param*, Jrd::record_param*);
 void	DPM_create_relation(Jrd::thread_db*, Jrd::Cached::Relation*);
 ULONG	DPM_data_pages(Jrd::thread_db*, Jrd::Cached::Relation*);
+ULONG	DPM_visible_pages(Jrd::thread_db*, Jrd::Cached::Relation*);
 void	DPM_delete(Jrd::thread_db*, Jrd::record_param*, ULONG);
 void	DPM_delete_relation(Jrd::thread_db*, Jrd::RelationPermanent*);
 USHORT	DPM_reserve_pages(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::win*);
@@ -243,6 +243,8 @@ enum drq_type_t
 	drq_l_rel_con,			// lookup relation constraint
 	drq_l_rel_fld_name,		// lookup relation field name
 	drq_g_nxt_package_id,	// lookup next package ID
+	drq_m_tab_statistics,	// modify table indices (set statistics)
+	drq_m_rfr_histogram,	// modify column histogram
 
 	drq_MAX
 };
@@ -63,6 +63,7 @@
 #include "../jrd/met.h"
 #include "../jrd/mov_proto.h"
 #include "../jrd/ProtectRelations.h"
+#include "../jrd/rng_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/tpc_proto.h"
 #include "../jrd/tra_proto.h"
@@ -82,6 +83,9 @@ static bool duplicate_key(const UCHAR*, const UCHAR*, void*);
 static PageNumber get_root_page(thread_db*, Cached::Relation*);
 static idx_e insert_key(thread_db*, jrd_rel*, Record*, jrd_tra*, WIN *, index_insertion*, IndexErrorContext&);
 
+// Count of data pages read to build histograms of the columns
+static constexpr ULONG COLUMN_SAMPLE_PAGES = 1024;
+
 
 void IDX_check_access(thread_db* tdbb, CompilerScratch* csb, Cached::Relation* view, Cached::Relation* relation)
 {
@@ -227,11 +231,13 @@ public:
 	{
 		key() {}
 
-		explicit key(const temporary_key* temp) :
-			m_data(temp->key_data),
-			m_length(temp->key_length),
-			m_flags(temp->key_flags),
-			m_nulls(temp->key_nulls)
+		explicit key(IndexKey& indexKey) :
+			m_data(indexKey->key_data),
+			m_length(indexKey->key_length),
+			m_flags(indexKey->key_flags),
+			m_nulls(indexKey->key_nulls),
+			m_payload(indexKey.getPayload()),
+			m_payloadLength(indexKey.getPayloadLength())
 		{
 		}
 
@@ -239,52 +245,62 @@ public:
 		USHORT m_length = 0;
 		USHORT m_flags = 0;
 		USHORT m_nulls = 0;		// nulls bitmap, see temporary_key
+		const UCHAR* m_payload = nullptr;	// non-key values, see IndexKey
+		USHORT m_payloadLength = 0;
 
+		static int compare(const UCHAR* data1, USHORT length1, const UCHAR* data2, USHORT length2)
+		{
+			const auto cmp = memcmp(data1, data2, MIN(length1, length2));
+			return cmp ? cmp : int(length1) - int(length2);
+		}
+
+		// The same key with other non-key values is a distinct index entry
 		bool operator >(const key& other) const
 		{
-			const auto len = MIN(m_length, other.m_length);
-			const auto cmp = memcmp(m_data, other.m_data, len);
-			if (cmp > 0)
-				return true;
-			if (cmp < 0)
-				return false;
-			return m_length > other.m_length;
+			const auto cmp = compare(m_data, m_length, other.m_data, other.m_length);
+			if (cmp)
+				return cmp > 0;
+			return compare(m_payload, m_payloadLength, other.m_payload, other.m_payloadLength) > 0;
 		}
 
-		void copyTo(temporary_key* temp) const
+		void copyTo(IndexKey& indexKey) const
 		{
-			temp->key_length = m_length;
-			temp->key_flags = m_flags;
-			temp->key_nulls = m_nulls;
-			memcpy(temp->key_data, m_data, m_length);
+			indexKey->key_length = m_length;
+			indexKey->key_flags = m_flags;
+			indexKey->key_nulls = m_nulls;
+			memcpy(indexKey->key_data, m_data, m_length);
+			indexKey.setPayload(m_payload, m_payloadLength);
 		}
 	};
 
 	// Returns true if key were not present in the set and was added
-	bool put(temporary_key* temp, key** pKey = nullptr)
+	bool put(IndexKey& indexKey, key** pKey = nullptr)
 	{
 		FB_SIZE_T pos;
-		key tmpKey(temp);
+		key tmpKey(indexKey);
 
 		const bool found = m_keys.find(tmpKey, pos);
 		if (!found)
 		{
 			const UCHAR* const buff = m_buffer.begin();
-			const UCHAR* p = m_buffer.end();
+			const FB_SIZE_T offset = m_buffer.getCount();
 
 			m_buffer.append(tmpKey.m_data, tmpKey.m_length);
-			tmpKey.m_data = p;
-			m_keys.insert(pos, tmpKey);
+			m_buffer.append(tmpKey.m_payload, tmpKey.m_payloadLength);
+			tmpKey.m_data = m_buffer.begin() + offset;
+			tmpKey.m_payload = tmpKey.m_data + tmpKey.m_length;
 
 			// if buffer was reallocated, recalculate pointers in keys
 			if (buff != m_buffer.begin())
 			{
 				for (auto& k : m_keys)
 				{
-					const auto offset = k.m_data - buff;
-					k.m_data = m_buffer.begin() + offset;
+					k.m_data = m_buffer.begin() + (k.m_data - buff);
+					k.m_payload = m_buffer.begin() + (k.m_payload - buff);
 				}
 			}
+
+			m_keys.insert(pos, tmpKey);
 		}
 
 		if (pKey)
@@ -294,10 +310,10 @@ public:
 	}
 
 	// Returns true if key was present in the set and was removed
-	bool remove(const temporary_key* temp)
+	bool remove(IndexKey& indexKey)
 	{
 		FB_SIZE_T pos;
-		key tmpKey(temp);
+		key tmpKey(indexKey);
 
 		if (m_keys.find(tmpKey, pos))
 		{
@@ -321,9 +337,9 @@ public:
 		return nullptr;
 	}
 
-	key* find(const temporary_key* temp)
+	key* find(IndexKey& indexKey)
 	{
-		key tmpKey(temp);
+		key tmpKey(indexKey);
 		return find(&tmpKey);
 	}
 
@@ -687,7 +703,7 @@ public:
 
 				m_sort = FB_NEW_POOL(m_tra->tra_sorts.getPool())
 							Sort(att->att_database, &m_tra->tra_sorts,
-								 creation->key_length + sizeof(index_sort_record),
+								 creation->key_length + sizeof(index_sort_record) + creation->payload_length,
 								 2, 1, creation->key_desc, callback, callback_arg);
 
 				creation->sort->addPartition(m_sort);
@@ -995,8 +1011,11 @@ bool IndexCreateTask::handler(WorkItem& _item)
 				}
 			}
 
-			if ((result == idx_e_ok) && (key->key_length > m_creation->key_length))
+			if ((result == idx_e_ok) && (key->key_length > m_creation->key_length ||
+				key.getPayloadLength() > m_creation->payload_length))
+			{
 				result = idx_e_keytoobig;
+			}
 
 			if (result != idx_e_ok)
 				context.raise(tdbb, result, record);
@@ -1044,9 +1063,13 @@ bool IndexCreateTask::handler(WorkItem& _item)
 			isr->isr_record_number = primary.rpb_number.getValue();
 			isr->isr_key_length = k.m_length;
 			isr->isr_flags = (k.m_flags & key_secondary) ? ISR_secondary : 0;
+			isr->isr_payload_length = k.m_payloadLength;
 
 			if (k.m_nulls == (1 << idx->idx_count) - 1)
 				isr->isr_flags |= ISR_null;
+
+			// non-key values follow the sort record, see fast_load
+			memcpy(p + sizeof(index_sort_record), k.m_payload, k.m_payloadLength);
 		}
 
 		if (m_stop)
@@ -1184,7 +1207,10 @@ void IDX_create_index(thread_db* tdbb,
 	const int nullIndLen = !isDescending && (idx->idx_count == 1) ? 1 : 0;
 	const USHORT key_length = ROUNDUP(BTR_key_length(tdbb, relation, idx) + nullIndLen, sizeof(SINT64));
 
-	if (key_length >= dbb->getMaxIndexKeyLength())
+	// Non-key columns stored in the leaf nodes are limited the same way
+	const USHORT payload_length = BTR_payload_length(tdbb, relation, idx);
+
+	if (key_length >= dbb->getMaxIndexKeyLength() || payload_length >= dbb->getMaxIndexKeyLength())
 	{
 		ERR_post(Arg::Gds(isc_no_meta_update) <<
 				 Arg::Gds(isc_keytoobig) << index_name.toQuotedString());
@@ -1204,6 +1230,7 @@ void IDX_create_index(thread_db* tdbb,
 	creation.transaction = transaction;
 	creation.sort = NULL;
 	creation.key_length = key_length;
+	creation.payload_length = payload_length;
 	creation.nullIndLen = nullIndLen;
 	creation.dup_recno = -1;
 	creation.duplicates.setValue(0);
@@ -1485,6 +1512,10 @@ void IDX_garbage_collect(thread_db* tdbb, record_param* rpb, RecordStack& going,
 	{
 		if (BTR_description(tdbb, getPermanent(rpb->rpb_relation), root, &idx, id))
 		{
+			// Block range summaries are never narrowed
+			if (idx.idx_flags & idx_range)
+				continue;
+
 			const bool isComplementary = (idx.idx_flags & irt_complementary) == irt_complementary;
 			const IndexCreation* creation = tdbb->tdbb_indexCreation;
 
@@ -1566,6 +1597,8 @@ void IDX_garbage_collect(thread_db* tdbb, record_param* rpb, RecordStack& going,
 
 				goingKey->copyTo(key);
 				insertion.iib_key = key;
+				insertion.iib_payload = key.getPayload();
+				insertion.iib_payload_length = key.getPayloadLength();
 
 				const auto recno = rpb->rpb_number.getValue();
 
@@ -1674,7 +1707,10 @@ void IDX_modify(thread_db* tdbb,
 
 		expression.reset();
 
-		if (newKey == orgKey)
+		// Changed non-key values need a new index entry too
+		const bool keyChanged = (newKey != orgKey);
+
+		if (!keyChanged && newKey.samePayload(orgKey))
 		{
 			// The new record satisfies index condition, check old record too:
 			// if it does not satisfies condition, key should be inserted into index.
@@ -1695,13 +1731,15 @@ void IDX_modify(thread_db* tdbb,
 		}
 
 		insertion.iib_key = newKey;
+		insertion.iib_payload = newKey.getPayload();
+		insertion.iib_payload_length = newKey.getPayloadLength();
 		if ( (error_code = insert_key(tdbb, new_rpb->rpb_relation, new_rpb->rpb_record,
 										transaction, &window, &insertion, context)) )
 		{
 			context.raise(tdbb, error_code, new_rpb->rpb_record);
 		}
 
-		if (idx.idx_flags & (idx_primary | idx_unique))
+		if (keyChanged && (idx.idx_flags & (idx_primary | idx_unique)))
 			new_rpb->rpb_runtime_flags |= RPB_uk_updated;
 	}
 }
@@ -1872,6 +1910,114 @@ void IDX_statistics(thread_db* tdbb, Cached::Relation* relation, USHORT id, Sele
 }
 
 
+void IDX_column_statistics(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction,
+	ColumnHistogramList& histograms)
+{
+/**************************************
+ *
+ *	I D X _ c o l u m n _ s t a t i s t i c s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a sample of the data pages building
+ *	histograms of the stored columns.
+ *
+ **************************************/
+
+	SET_TDBB(tdbb);
+	const auto dbb = tdbb->getDatabase();
+	const auto perm = relation->getPermanent();
+	MemoryPool& pool = *tdbb->getDefaultPool();
+
+	histograms.clear();
+
+	// Every column is keyed as the single segment of an ascending index
+
+	const Format* const format = relation->currentFormat(tdbb);
+	const vec<jrd_fld*>* const fields = relation->rel_fields;
+
+	Array<index_desc> indices(pool);
+	ObjectsArray<IndexHistogram::Sampler> samplers(pool);
+
+	for (USHORT id = 0; id < format->fmt_count; id++)
+	{
+		const dsc& desc = format->fmt_desc[id];
+		const jrd_fld* const field = (fields && id < fields->count()) ? (*fields)[id] : nullptr;
+
+		if (!field || field->fld_computation || !desc.dsc_dtype ||
+			desc.isBlob() || desc.dsc_dtype == dtype_array)
+		{
+			continue;
+		}
+
+		index_desc& idx = indices.add();
+		memset(&idx, 0, sizeof(idx));
+
+		idx.idx_id = idx_invalid;
+		idx.idx_count = 1;
+		idx.idx_state = irt_normal;
+		idx.idx_rpt[0].idx_field = id;
+		idx.idx_rpt[0].idx_itype = DFW_assign_index_type(tdbb, relation->getName(), desc.dsc_dtype,
+			desc.isText() ? desc.getTextType() : ttype_none);
+
+		samplers.add();
+	}
+
+	if (indices.isEmpty())
+		return;
+
+	// Read records of every n-th data page, at most COLUMN_SAMPLE_PAGES of them
+
+	const ULONG dataPages = relation->getPages(tdbb)->rel_pages->count() * dbb->dbb_dp_per_pp;
+	const ULONG step = MAX(dataPages / COLUMN_SAMPLE_PAGES, 1);
+
+	record_param rpb;
+	rpb.rpb_relation = relation;
+	rpb.rpb_record = nullptr;
+	rpb.getWindow(tdbb).win_flags = WIN_large_scan;
+	rpb.rpb_org_scans = perm->rel_scan_count++;
+
+	Cleanup cleanAfterScan([&]
+	{
+		delete rpb.rpb_record;
+		--perm->rel_scan_count;
+	});
+
+	for (ULONG sequence = 0; sequence < dataPages; sequence += step)
+	{
+		rpb.rpb_number.setValue((SINT64) sequence * dbb->dbb_max_records - 1);
+
+		while (VIO_next_record(tdbb, &rpb, transaction, &pool, DPM_next_data_page))
+		{
+			for (FB_SIZE_T i = 0; i < indices.getCount(); i++)
+			{
+				IndexKey key(tdbb, relation, &indices[i]);
+
+				if (key.compose(rpb.rpb_record) == idx_e_ok)
+					samplers[i].add(key->key_data, key->key_length);
+			}
+		}
+
+		JRD_reschedule(tdbb);
+	}
+
+	for (FB_SIZE_T i = 0; i < indices.getCount(); i++)
+	{
+		const USHORT id = indices[i].idx_rpt[0].idx_field;
+
+		while (histograms.getCount() <= id)
+			histograms.add(RefPtr<IndexHistogram>());
+
+		RefPtr<IndexHistogram> histogram(FB_NEW_POOL(perm->getPool()) IndexHistogram(perm->getPool()));
+		histogram->setKeyType(indices[i].idx_rpt[0].idx_itype);
+		samplers[i].build(histogram);
+
+		histograms[id] = histogram;
+	}
+}
+
+
 void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 {
 /**************************************
@@ -1936,6 +2082,8 @@ void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 		expression.reset();
 
 		insertion.iib_key = key;
+		insertion.iib_payload = key.getPayload();
+		insertion.iib_payload_length = key.getPayloadLength();
 
 		if ( (error_code = insert_key(tdbb, rpb->rpb_relation, rpb->rpb_record, transaction,
 									  &window, &insertion, context)) )
@@ -2394,6 +2542,8 @@ static idx_e check_partner_index(thread_db* tdbb,
 			insertion.iib_duplicates = bitmap;
 			insertion.iib_transaction = transaction;
 			insertion.iib_btr_level = 0;
+			insertion.iib_payload = nullptr;
+			insertion.iib_payload_length = 0;
 
 			result = check_duplicates(tdbb, record, idx, &insertion, relation);
 			if (idx->idx_flags & (idx_primary | idx_unique))
@@ -2479,6 +2629,13 @@ static idx_e insert_key(thread_db* tdbb,
 	idx_e result = idx_e_ok;
 	index_desc* idx = insertion->iib_descriptor;
 
+	// Block range index only widens the summary of the record's range
+	if (idx->idx_flags & idx_range)
+	{
+		RNG_insert(tdbb, window_ptr, insertion);
+		return result;
+	}
+
 	// Insert the key into the index.  If the index is unique, btr will keep track of duplicates.
 
 	const bool isComplementary = (idx->idx_flags & irt_complementary);
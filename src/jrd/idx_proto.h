@@ -26,6 +26,7 @@
 
 #include "../jrd/btr.h"
 #include "../jrd/exe.h"
+#include "../jrd/IndexHistogram.h"
 #include "../jrd/req.h"
 
 namespace Jrd
@@ -52,6 +53,7 @@ void IDX_garbage_collect(Jrd::thread_db*, Jrd::record_param*, Jrd::RecordStack&,
 void IDX_modify(Jrd::thread_db*, Jrd::record_param*, Jrd::record_param*, Jrd::jrd_tra*);
 void IDX_modify_check_constraints(Jrd::thread_db*, Jrd::record_param*, Jrd::record_param*, Jrd::jrd_tra*);
 void IDX_statistics(Jrd::thread_db*, Jrd::Cached::Relation*, USHORT, Jrd::SelectivityList&);
+void IDX_column_statistics(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::jrd_tra*, Jrd::ColumnHistogramList&);
 void IDX_store(Jrd::thread_db*, Jrd::record_param*, Jrd::jrd_tra*);
 void IDX_modify_flag_uk_modified(Jrd::thread_db*, Jrd::record_param*, Jrd::record_param*, Jrd::jrd_tra*);
 bool IDX_validate_unique(Jrd::thread_db* tdbb, Jrd::jrd_rel* relation, MetaId id);
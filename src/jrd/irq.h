@@ -178,6 +178,8 @@ enum irq_type_t
 	irq_index_scan,			// scan index for caching
 	irq_index_id_erase,		// cleanup index ID
 	irq_l_index_cnstrt,     // lookup index for constraint
+	irq_l_idx_histogram,	// lookup histogram of index keys
+	irq_l_rfr_histograms,	// lookup histograms of relation columns
 
 	irq_MAX
 };
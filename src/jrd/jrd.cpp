@@ -96,6 +96,7 @@
 #include "../jrd/mov_proto.h"
 #include "../jrd/pag_proto.h"
 #include "../jrd/par_proto.h"
+#include "../jrd/rng_proto.h"
 #include "../jrd/os/pio_proto.h"
 #include "../jrd/scl_proto.h"
 #include "../jrd/sdw_proto.h"
@@ -1835,6 +1836,8 @@ JAttachment* JProvider::internalAttach(CheckStatusWrapper* user_status, const ch
 				// but before any real work is done
 				SDW_init(tdbb, options.dpb_activate_shadow, options.dpb_delete_shadow);
 
+				PAG_set_page_compression(tdbb);
+
 				// Initialize TIP cache. We do this late to give SDW a chance to
 				// work while we read states for all interesting transactions
 				dbb->dbb_tip_cache = TipCache::create(tdbb);
@@ -3128,6 +3131,8 @@ JAttachment* JProvider::createDatabase(CheckStatusWrapper* user_status, const ch
 			if (options.dpb_set_no_reserve)
 				PAG_set_no_reserve(tdbb, options.dpb_no_reserve);
 
+			PAG_set_page_compression(tdbb);
+
 			fb_assert(attachment->att_user);	// set by UserId::sclInit()
 			INI_format(tdbb, options.dpb_set_db_charset);
 
@@ -8138,6 +8143,9 @@ bool JRD_shutdown_database(Database* dbb, const unsigned flags)
 #endif
 		if (flags & SHUT_DBB_RELEASE_POOLS)
 			TRA_update_counters(tdbb, dbb);
+
+		// Summaries of the block ranges being filled are kept in memory
+		RNG_flush(tdbb);
 	}
 	catch (const Exception&)
 	{
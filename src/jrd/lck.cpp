@@ -70,6 +70,14 @@ static bool internal_compatible(Lock*, const Lock*, USHORT);
 static void internal_dequeue(thread_db*, Lock*);
 static USHORT internal_downgrade(thread_db*, CheckStatusWrapper*, Lock*);
 static bool internal_enqueue(thread_db*, CheckStatusWrapper*, Lock*, USHORT, SSHORT, bool);
+static bool local_compatible(const LocalLockTable::Entry*, USHORT, const Lock*);
+static bool local_convert(thread_db*, CheckStatusWrapper*, Lock*, USHORT, SSHORT);
+static void local_dequeue(thread_db*, Lock*);
+static USHORT local_downgrade(thread_db*, CheckStatusWrapper*, Lock*);
+static void local_enqueue(thread_db*, CheckStatusWrapper*, Lock*, USHORT, SSHORT);
+static bool local_escalate(thread_db*, CheckStatusWrapper*, LocalLockTable::Entry*);
+static LocalLockTable::Key local_key(Lock*);
+static void local_remove(LocalLockTable::Partition&, const LocalLockTable::Key&, LocalLockTable::Entry*);
 static SLONG get_owner_handle(thread_db* tdbb, enum lck_t lock_type);
 static lck_owner_t get_owner_type(enum lck_t lock_type);
 
@@ -164,6 +172,8 @@ inline void ENQUEUE(thread_db* tdbb, CheckStatusWrapper* statusVector, Lock* loc
 {
 	if (lock->lck_compatible)
 		internal_enqueue(tdbb, statusVector, lock, level, wait, false);
+	else if (LocalLockTable::eligible(lock))
+		local_enqueue(tdbb, statusVector, lock, level, wait);
 	else
 		enqueue(tdbb, statusVector, lock, level, wait);
 }
@@ -172,9 +182,13 @@ inline bool CONVERT(thread_db* tdbb, CheckStatusWrapper* statusVector, Lock* loc
 {
 	Database* const dbb = tdbb->getDatabase();
 
-	return lock->lck_compatible ?
-		internal_enqueue(tdbb, statusVector, lock, level, wait, true) :
-		dbb->lockManager()->convert(LockManagerEngineCallbacks(tdbb), statusVector, lock->lck_id, level,
+	if (lock->lck_compatible)
+		return internal_enqueue(tdbb, statusVector, lock, level, wait, true);
+
+	if (LocalLockTable::eligible(lock))
+		return local_convert(tdbb, statusVector, lock, level, wait);
+
+	return dbb->lockManager()->convert(LockManagerEngineCallbacks(tdbb), statusVector, lock->lck_id, level,
 			wait, lock->lck_ast, lock->lck_object);
 }
 
@@ -184,6 +198,8 @@ inline void DEQUEUE(thread_db* tdbb, Lock* lock)
 
 	if (lock->lck_compatible)
 		internal_dequeue(tdbb, lock);
+	else if (LocalLockTable::eligible(lock))
+		local_dequeue(tdbb, lock);
 	else
 		dbb->lockManager()->dequeue(lock->lck_id);
 }
@@ -196,7 +212,9 @@ inline USHORT DOWNGRADE(thread_db* tdbb, Lock* lock)
 
 	USHORT ret = lock->lck_compatible ?
 		internal_downgrade(tdbb, &statusVector, lock) :
-		dbb->lockManager()->downgrade(LockManagerEngineCallbacks(tdbb), &statusVector, lock->lck_id);
+		LocalLockTable::eligible(lock) ?
+			local_downgrade(tdbb, &statusVector, lock) :
+			dbb->lockManager()->downgrade(LockManagerEngineCallbacks(tdbb), &statusVector, lock->lck_id);
 
 	fb_assert(statusVector.isEmpty());
 
@@ -756,6 +774,70 @@ bool LCK_lock_opt(thread_db* tdbb, Lock* lock, USHORT level, SSHORT wait)
 }
 
 
+bool LCK_probe(thread_db* tdbb, Lock* lock, USHORT level)
+{
+/**************************************
+ *
+ *	L C K _ p r o b e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check whether a lock could be granted at the given level
+ *	without waiting, but don't take it. This is a cheaper
+ *	replacement for the no-wait LCK_lock() immediately
+ *	followed by LCK_release(), as the lock manager doesn't
+ *	need to create and then destroy the lock.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	fb_assert(LCK_CHECK_LOCK(lock));
+	fb_assert(lock->lck_physical == LCK_none);
+
+	// Compatible locks are granted from the attachment's own table
+	if (lock->lck_compatible)
+	{
+		if (!LCK_lock(tdbb, lock, level, LCK_NO_WAIT))
+			return false;
+
+		LCK_release(tdbb, lock);
+		return true;
+	}
+
+	Database* const dbb = tdbb->getDatabase();
+
+	if (LocalLockTable::eligible(lock))
+	{
+		const LocalLockTable::Key key = local_key(lock);
+		LocalLockTable::Partition& partition = dbb->dbb_local_locks->getPartition(key);
+		MutexLockGuard guard(partition.mutex, FB_FUNCTION);
+
+		LocalLockTable::Entry* const* const entry = partition.entries.get(key);
+
+		if (!entry)
+			return true;
+
+		if (!(*entry)->escalated)
+		{
+			if (local_compatible(*entry, level, NULL))
+				return true;
+
+			(Arg::Gds(isc_lock_conflict)).copyTo(tdbb->tdbb_status_vector);
+			return false;
+		}
+	}
+
+	if (dbb->lockManager()->probe(lock->lck_type, lock->getKeyPtr(), lock->lck_length,
+			level, lock->lck_owner_handle))
+	{
+		return true;
+	}
+
+	(Arg::Gds(isc_lock_conflict)).copyTo(tdbb->tdbb_status_vector);
+	return false;
+}
+
+
 LOCK_DATA_T LCK_query_data(thread_db* tdbb, enum lck_t lock_type, USHORT aggregate)
 {
 /**************************************
@@ -794,6 +876,21 @@ LOCK_DATA_T LCK_read_data(thread_db* tdbb, Lock* lock)
 
 	fb_assert(LCK_CHECK_LOCK(lock));
 
+	if (LocalLockTable::eligible(lock))
+	{
+		const LocalLockTable::Key key = local_key(lock);
+		LocalLockTable::Partition& partition = dbb->dbb_local_locks->getPartition(key);
+		MutexLockGuard guard(partition.mutex, FB_FUNCTION);
+
+		LocalLockTable::Entry* const* const entry = partition.entries.get(key);
+
+		if (!entry)
+			return 0;
+
+		if (!(*entry)->escalated)
+			return (*entry)->data;
+	}
+
 	const LOCK_DATA_T data =
 		dbb->lockManager()->readData2(lock->lck_type,
 									 lock->getKeyPtr(), lock->lck_length,
@@ -884,6 +981,21 @@ void LCK_write_data(thread_db* tdbb, Lock* lock, LOCK_DATA_T data)
 
 	fb_assert(LCK_CHECK_LOCK(lock));
 
+	if (LocalLockTable::eligible(lock))
+	{
+		const LocalLockTable::Key key = local_key(lock);
+		LocalLockTable::Partition& partition = dbb->dbb_local_locks->getPartition(key);
+		MutexLockGuard guard(partition.mutex, FB_FUNCTION);
+
+		if (lock->lck_id == LocalLockTable::LOCAL_LOCK_ID)
+		{
+			LocalLockTable::Entry* const* const entry = partition.entries.get(key);
+			fb_assert(entry);
+			(*entry)->data = lock->lck_data = data;
+			return;
+		}
+	}
+
 	dbb->lockManager()->writeData(lock->lck_id, data);
 	lock->lck_data = data;
 
@@ -1474,6 +1586,357 @@ static bool internal_enqueue(thread_db* tdbb, CheckStatusWrapper* statusVector,
 	return lock->lck_id ? true : false;
 }
 
+static bool local_compatible(const LocalLockTable::Entry* entry, USHORT level, const Lock* lock)
+{
+/**************************************
+ *
+ *	l o c a l _ c o m p a t i b l e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check whether the given level is compatible with all
+ *	the local holders of the entry except the lock itself.
+ *
+ **************************************/
+
+	for (const auto& holder : entry->holders)
+	{
+		if (holder.lock != lock && !compatibility[holder.level][level])
+			return false;
+	}
+
+	return true;
+}
+
+
+static bool local_convert(thread_db* tdbb, CheckStatusWrapper* statusVector, Lock* lock,
+	USHORT level, SSHORT wait)
+{
+/**************************************
+ *
+ *	l o c a l _ c o n v e r t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Convert a lock from the local lock table. If the new level
+ *	conflicts with other holders, pass the key to the lock manager.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+
+	{ // scope
+		const LocalLockTable::Key key = local_key(lock);
+		LocalLockTable::Partition& partition = dbb->dbb_local_locks->getPartition(key);
+		MutexLockGuard guard(partition.mutex, FB_FUNCTION);
+
+		if (lock->lck_id == LocalLockTable::LOCAL_LOCK_ID)
+		{
+			LocalLockTable::Entry* const entry = *partition.entries.get(key);
+
+			if (local_compatible(entry, level, lock))
+			{
+				for (auto& holder : entry->holders)
+				{
+					if (holder.lock == lock)
+						holder.level = level;
+				}
+
+				return true;
+			}
+
+			if (wait == LCK_NO_WAIT)
+			{
+				(Arg::Gds(isc_lock_conflict)).copyTo(statusVector);
+				return false;
+			}
+
+			if (!local_escalate(tdbb, statusVector, entry))
+				return false;
+		}
+	}
+
+	return dbb->lockManager()->convert(LockManagerEngineCallbacks(tdbb), statusVector, lock->lck_id, level,
+		wait, lock->lck_ast, lock->lck_object);
+}
+
+
+static void local_dequeue(thread_db* tdbb, Lock* lock)
+{
+/**************************************
+ *
+ *	l o c a l _ d e q u e u e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Release a lock granted either locally or by
+ *	the lock manager after the key was escalated.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+
+	const LocalLockTable::Key key = local_key(lock);
+	LocalLockTable::Partition& partition = dbb->dbb_local_locks->getPartition(key);
+	MutexLockGuard guard(partition.mutex, FB_FUNCTION);
+
+	LocalLockTable::Entry* const entry = *partition.entries.get(key);
+
+	if (lock->lck_id == LocalLockTable::LOCAL_LOCK_ID)
+	{
+		for (FB_SIZE_T i = 0; i < entry->holders.getCount(); i++)
+		{
+			if (entry->holders[i].lock == lock)
+			{
+				entry->holders.remove(i);
+				break;
+			}
+		}
+	}
+	else
+	{
+		fb_assert(entry->escalated && entry->requests);
+		dbb->lockManager()->dequeue(lock->lck_id);
+		entry->requests--;
+	}
+
+	local_remove(partition, key, entry);
+}
+
+
+static USHORT local_downgrade(thread_db* tdbb, CheckStatusWrapper* statusVector, Lock* lock)
+{
+/**************************************
+ *
+ *	l o c a l _ d o w n g r a d e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Nobody waits for a locally granted lock,
+ *	thus there is nothing to downgrade it to.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+
+	{ // scope
+		const LocalLockTable::Key key = local_key(lock);
+		LocalLockTable::Partition& partition = dbb->dbb_local_locks->getPartition(key);
+		MutexLockGuard guard(partition.mutex, FB_FUNCTION);
+
+		if (lock->lck_id == LocalLockTable::LOCAL_LOCK_ID)
+			return lock->lck_physical;
+	}
+
+	return dbb->lockManager()->downgrade(LockManagerEngineCallbacks(tdbb), statusVector, lock->lck_id);
+}
+
+
+static void local_enqueue(thread_db* tdbb, CheckStatusWrapper* statusVector, Lock* lock,
+	USHORT level, SSHORT wait)
+{
+/**************************************
+ *
+ *	l o c a l _ e n q u e u e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Grant a lock from the local lock table if it's compatible
+ *	with the local holders. Otherwise move the holders into the
+ *	lock manager and wait there, unless the key is already served
+ *	by the lock manager. A no-wait conflict is reported at once.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+
+	const LocalLockTable::Key key = local_key(lock);
+	LocalLockTable::Partition& partition = dbb->dbb_local_locks->getPartition(key);
+
+	{ // scope
+		MutexLockGuard guard(partition.mutex, FB_FUNCTION);
+
+		LocalLockTable::Entry* entry = NULL;
+		if (!partition.entries.get(key, entry))
+		{
+			entry = FB_NEW_POOL(*dbb->dbb_permanent) LocalLockTable::Entry(*dbb->dbb_permanent);
+			entry->data = lock->lck_data;
+			partition.entries.put(key, entry);
+		}
+
+		if (!entry->escalated)
+		{
+			if (local_compatible(entry, level, NULL))
+			{
+				const LocalLockTable::Holder holder = {lock, (UCHAR) level};
+				entry->holders.add(holder);
+				lock->lck_id = LocalLockTable::LOCAL_LOCK_ID;
+				return;
+			}
+
+			if (wait == LCK_NO_WAIT || !local_escalate(tdbb, statusVector, entry))
+			{
+				if (wait == LCK_NO_WAIT)
+					(Arg::Gds(isc_lock_conflict)).copyTo(statusVector);
+
+				lock->lck_id = 0;
+				lock->lck_physical = lock->lck_logical = LCK_none;
+				return;
+			}
+		}
+
+		entry->requests++;
+	}
+
+	enqueue(tdbb, statusVector, lock, level, wait);
+
+	if (!lock->lck_id)
+	{
+		MutexLockGuard guard(partition.mutex, FB_FUNCTION);
+
+		LocalLockTable::Entry* const entry = *partition.entries.get(key);
+		fb_assert(entry->escalated && entry->requests);
+		entry->requests--;
+		local_remove(partition, key, entry);
+	}
+}
+
+
+static bool local_escalate(thread_db* tdbb, CheckStatusWrapper* statusVector, LocalLockTable::Entry* entry)
+{
+/**************************************
+ *
+ *	l o c a l _ e s c a l a t e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Register the local holders of the key in the lock manager
+ *	on behalf of their owners, so the conflicting request may
+ *	wait for them there. The holders are compatible with each
+ *	other and nobody else has the key in the lock table, thus
+ *	they all are granted without waiting.
+ *
+ **************************************/
+	LockManager* const lockMgr = tdbb->getDatabase()->lockManager();
+
+	for (FB_SIZE_T i = 0; i < entry->holders.getCount(); i++)
+	{
+		Lock* const lock = entry->holders[i].lock;
+
+		const SLONG id = lockMgr->enqueue(LockManagerEngineCallbacks(tdbb), statusVector, 0,
+			lock->lck_type, lock->getKeyPtr(), lock->lck_length, entry->holders[i].level,
+			NULL, NULL, i ? lock->lck_data : entry->data, LCK_NO_WAIT, lock->lck_owner_handle);
+
+		if (!id)
+		{
+			// Lock table is exhausted, keep the key local
+			while (i--)
+			{
+				Lock* const registered = entry->holders[i].lock;
+				lockMgr->dequeue(registered->lck_id);
+				registered->lck_id = LocalLockTable::LOCAL_LOCK_ID;
+			}
+
+			return false;
+		}
+
+		lock->lck_id = id;
+	}
+
+	entry->requests += entry->holders.getCount();
+	entry->holders.clear();
+	entry->escalated = true;
+
+	return true;
+}
+
+
+static LocalLockTable::Key local_key(Lock* lock)
+{
+/**************************************
+ *
+ *	l o c a l _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Build the local lock table key.
+ *
+ **************************************/
+	fb_assert(lock->lck_length <= Lock::KEY_STATIC_SIZE);
+
+	LocalLockTable::Key key;
+	key.value = lock->getKey();
+	key.type = lock->lck_type;
+
+	return key;
+}
+
+
+static void local_remove(LocalLockTable::Partition& partition, const LocalLockTable::Key& key,
+	LocalLockTable::Entry* entry)
+{
+/**************************************
+ *
+ *	l o c a l _ r e m o v e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Forget the key when nobody holds or waits for it anymore.
+ *	Escalated key becomes local again at this point.
+ *
+ **************************************/
+	if (entry->holders.hasData() || entry->requests)
+		return;
+
+	partition.entries.remove(key);
+	delete entry;
+}
+
+
+LocalLockTable::LocalLockTable(MemoryPool& p)
+	: m_pool(p)
+{
+	for (auto& partition : m_partitions)
+		partition = FB_NEW_POOL(m_pool) Partition(m_pool);
+}
+
+LocalLockTable::~LocalLockTable()
+{
+	for (auto partition : m_partitions)
+	{
+		GenericMap<Pair<NonPooled<Key, Entry*> > >::Accessor accessor(&partition->entries);
+
+		for (bool found = accessor.getFirst(); found; found = accessor.getNext())
+			delete accessor.current()->second;
+
+		delete partition;
+	}
+}
+
+bool LocalLockTable::eligible(const Lock* lock)
+{
+	// Only the short-living locks without blocking ASTs and
+	// without aggregated data are served locally
+
+	if (!lock->lck_dbb->dbb_local_locks || lock->lck_ast)
+		return false;
+
+	switch (lock->lck_type)
+	{
+	case LCK_btr_dont_gc:
+	case LCK_record_gc:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+
 Lock::Lock(thread_db* tdbb, USHORT length, lck_t type, void* object, lock_ast_t ast)
 :	lck_dbb(tdbb->getDatabase()),
  	lck_attachment(NULL),
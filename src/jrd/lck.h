@@ -34,6 +34,8 @@
 
 #include "../jrd/Attachment.h"
 #include "../common/classes/auto.h"
+#include "../common/classes/GenericMap.h"
+#include "../common/classes/locks.h"
 
 namespace Jrd {
 
@@ -192,6 +194,80 @@ public:
 	}
 };
 
+// Process-local table of the short-living locks without ASTs. SuperServer
+// is the only process working with the database, thus such locks may be
+// granted without the lock manager while all their owners are compatible.
+// The first conflicting waiter moves the local holders into the lock
+// manager, which then serves the key until its last request is released.
+
+class LocalLockTable
+{
+public:
+	static const SLONG LOCAL_LOCK_ID = -1;		// lck_id of the locally granted lock
+
+	struct Key
+	{
+		SINT64 value;
+		lck_t type;
+
+		bool operator<(const Key& other) const
+		{
+			return (type != other.type) ? type < other.type : value < other.value;
+		}
+
+		bool operator>(const Key& other) const
+		{
+			return other < *this;
+		}
+	};
+
+	struct Holder
+	{
+		Lock* lock;
+		UCHAR level;
+	};
+
+	class Entry
+	{
+	public:
+		explicit Entry(MemoryPool& p)
+			: holders(p)
+		{}
+
+		Firebird::HalfStaticArray<Holder, 4> holders;	// locks granted locally
+		ULONG requests = 0;			// requests passed to the lock manager
+		LOCK_DATA_T data = 0;		// lock data while the key is local
+		bool escalated = false;		// lock manager serves the key
+	};
+
+	class Partition
+	{
+	public:
+		explicit Partition(MemoryPool& p)
+			: entries(p)
+		{}
+
+		Firebird::Mutex mutex;
+		Firebird::GenericMap<Firebird::Pair<Firebird::NonPooled<Key, Entry*> > > entries;
+	};
+
+	explicit LocalLockTable(MemoryPool& p);
+	~LocalLockTable();
+
+	static bool eligible(const Lock* lock);
+
+	Partition& getPartition(const Key& key)
+	{
+		return *m_partitions[(ULONG) (key.value ^ (key.value >> 29)) % PARTITIONS];
+	}
+
+private:
+	static const unsigned PARTITIONS = 16;
+
+	MemoryPool& m_pool;
+	Partition* m_partitions[PARTITIONS];
+};
+
 } // namespace Jrd
 
 void	LCK_assert(Jrd::thread_db*, Jrd::Lock*);
@@ -203,6 +279,7 @@ void	LCK_fini(Jrd::thread_db*, Jrd::lck_owner_t);
 void	LCK_init(Jrd::thread_db*, Jrd::lck_owner_t);
 bool	LCK_lock(Jrd::thread_db*, Jrd::Lock*, USHORT, SSHORT);
 bool	LCK_lock_opt(Jrd::thread_db*, Jrd::Lock*, USHORT, SSHORT);
+bool	LCK_probe(Jrd::thread_db*, Jrd::Lock*, USHORT);
 LOCK_DATA_T LCK_query_data(Jrd::thread_db*, Jrd::lck_t, USHORT);
 LOCK_DATA_T LCK_read_data(Jrd::thread_db*, Jrd::Lock*);
 void	LCK_release(Jrd::thread_db*, Jrd::Lock*);
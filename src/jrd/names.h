@@ -513,3 +513,15 @@ NAME("MON$CHAR_LENGTH", nam_mon_char_length)
 NAME("MON$COLLATION_ID", nam_mon_collate_id)
 
 NAME("RDB$AGGREGATE_FLAG", nam_aggregate_flag)
+
+NAME("MON$DATA_PAGE_FETCHES", nam_mon_data_fetches)
+NAME("MON$DATA_PAGE_READS", nam_mon_data_reads)
+NAME("MON$INDEX_PAGE_FETCHES", nam_mon_index_fetches)
+NAME("MON$INDEX_PAGE_READS", nam_mon_index_reads)
+NAME("MON$POINTER_PAGE_FETCHES", nam_mon_pointer_fetches)
+NAME("MON$POINTER_PAGE_READS", nam_mon_pointer_reads)
+NAME("MON$GC_BACKLOG_TABLES", nam_mon_gc_tables)
+NAME("MON$GC_BACKLOG_PAGES", nam_mon_gc_pages)
+
+NAME("RDB$HISTOGRAM", nam_histogram)
+NAME("RDB$INCLUDE_FLAG", nam_include_flag)
@@ -133,7 +133,8 @@ inline constexpr USHORT ODS_CURRENT13	= 1;
 // Minor versions for ODS 14
 
 inline constexpr USHORT ODS_CURRENT14_0	= 0;	// Firebird 6.0 features
-inline constexpr USHORT ODS_CURRENT14	= 0;
+inline constexpr USHORT ODS_CURRENT14_1	= 1;	// Compressed data and blob pages
+inline constexpr USHORT ODS_CURRENT14	= 1;
 
 // useful ODS macros. These are currently used to flag the version of the
 // system triggers and system indices in ini.e
@@ -156,6 +157,7 @@ inline constexpr USHORT ODS_12_0	= ENCODE_ODS(ODS_VERSION12, 0);
 inline constexpr USHORT ODS_13_0	= ENCODE_ODS(ODS_VERSION13, 0);
 inline constexpr USHORT ODS_13_1	= ENCODE_ODS(ODS_VERSION13, 1);
 inline constexpr USHORT ODS_14_0	= ENCODE_ODS(ODS_VERSION14, 0);
+inline constexpr USHORT ODS_14_1	= ENCODE_ODS(ODS_VERSION14, 1);
 
 inline constexpr USHORT ODS_FIREBIRD_FLAG = 0x8000;
 
@@ -186,6 +188,9 @@ inline constexpr USHORT ODS_CURRENT = ODS_CURRENT14;		// The highest defined min
 inline constexpr USHORT ODS_CURRENT_VERSION = ODS_14_0;		// Current ODS version in use which includes
 															// both major and minor ODS versions!
 
+inline constexpr USHORT ODS_CREATED = ODS_CURRENT14_0;		// Minor version of the new databases, the higher
+															// ones are set when their features are used
+
 
 //const USHORT USER_REL_INIT_ID_ODS8	= 31;	// ODS < 9 ( <= 8.2)
 inline constexpr USHORT USER_DEF_REL_INIT_ID = 128;	// ODS >= 9
@@ -229,7 +234,8 @@ inline constexpr SCHAR pag_index			= 7;		// Index (B-tree) page
 inline constexpr SCHAR pag_blob				= 8;		// Blob data page
 inline constexpr SCHAR pag_ids				= 9;		// Gen-ids
 inline constexpr SCHAR pag_scns				= 10;		// SCN's inventory page
-inline constexpr SCHAR pag_max				= 10;		// Max page type
+inline constexpr SCHAR pag_range			= 11;		// Block range index page
+inline constexpr SCHAR pag_max				= 11;		// Max page type
 
 // Pre-defined page numbers
 
@@ -254,19 +260,23 @@ namespace Ods {
 inline constexpr bool pag_crypt_page[pag_max + 1] = {false, false, false,
 													 false, false, true,	// data
 													 false, true, true,		// index, blob
-													 true, false};			// generators
+													 true, false, true};	// generators, ranges
 
 // pag_flags for any page type
 
 inline constexpr UCHAR crypted_page	= 0x80;		// Page on disk is encrypted (in memory cache it always isn't)
 
+// pag_flags for data and blob pages
+
+inline constexpr UCHAR compressed_page	= 0x40;		// Page on disk is compressed (in memory cache it always isn't)
+
 // Basic page header
 
 struct pag
 {
 	UCHAR pag_type;
 	UCHAR pag_flags;
-	USHORT pag_reserved;		// not used but anyway present because of alignment rules
+	USHORT pag_reserved;		// length of compressed page contents on disk, otherwise not used
 	ULONG pag_generation;
 	ULONG pag_scn;
 	ULONG pag_pageno;			// for validation
@@ -351,6 +361,63 @@ static_assert(offsetof(struct btree_page, btr_nodes) == 39, "btr_nodes offset mi
 //const UCHAR btr_jump_info			= 16;	// AB: 2003-index-structure enhancement
 inline constexpr UCHAR btr_released			= 32;	// Page was released from b-tree
 
+// Block range index page. Root of the index is the directory page holding
+// numbers of the summary pages, directory pages are chained by rng_next.
+// Summary page keeps the lowest and the highest keys stored in each range
+// of RANGE_DATA_PAGES data pages of the relation, in the order of ranges.
+
+struct range_page
+{
+	pag rng_header;
+	ULONG rng_next;				// next directory page
+	ULONG rng_sequence;			// sequence number of the page in its level
+	USHORT rng_relation;		// relation id for consistency
+	USHORT rng_id;				// index id for consistency
+	USHORT rng_count;			// number of entries on page
+	USHORT rng_key_length;		// length reserved for every key of the summary
+	UCHAR rng_level;			// 1 - directory page, 0 - summary page
+	UCHAR rng_pad[3];
+	ULONG rng_data[1];			// summary page numbers or summary entries
+};
+
+static_assert(sizeof(struct range_page) == 40, "struct range_page size mismatch");
+static_assert(offsetof(struct range_page, rng_header) == 0, "rng_header offset mismatch");
+static_assert(offsetof(struct range_page, rng_next) == 16, "rng_next offset mismatch");
+static_assert(offsetof(struct range_page, rng_sequence) == 20, "rng_sequence offset mismatch");
+static_assert(offsetof(struct range_page, rng_relation) == 24, "rng_relation offset mismatch");
+static_assert(offsetof(struct range_page, rng_id) == 26, "rng_id offset mismatch");
+static_assert(offsetof(struct range_page, rng_count) == 28, "rng_count offset mismatch");
+static_assert(offsetof(struct range_page, rng_key_length) == 30, "rng_key_length offset mismatch");
+static_assert(offsetof(struct range_page, rng_level) == 32, "rng_level offset mismatch");
+static_assert(offsetof(struct range_page, rng_data) == 36, "rng_data offset mismatch");
+
+#define RNG_SIZE static_cast<FB_SIZE_T>(offsetof(Ods::range_page, rng_data[0]))
+
+// Summary of the range, followed by the lowest and the highest keys,
+// both of them padded to rng_key_length
+
+struct range_entry
+{
+	USHORT rne_flags;
+	USHORT rne_low_length;		// length of the lowest key
+	USHORT rne_high_length;		// length of the highest key
+	UCHAR rne_data[1];
+};
+
+static_assert(offsetof(struct range_entry, rne_flags) == 0, "rne_flags offset mismatch");
+static_assert(offsetof(struct range_entry, rne_low_length) == 2, "rne_low_length offset mismatch");
+static_assert(offsetof(struct range_entry, rne_high_length) == 4, "rne_high_length offset mismatch");
+static_assert(offsetof(struct range_entry, rne_data) == 6, "rne_data offset mismatch");
+
+#define RNE_SIZE static_cast<FB_SIZE_T>(offsetof(Ods::range_entry, rne_data[0]))
+
+// rne_flags
+inline constexpr USHORT rne_used		= 0x01;		// Keys of the range are stored
+inline constexpr USHORT rne_unbounded	= 0x02;		// Key didn't fit the summary, range matches any key
+inline constexpr USHORT rne_open		= 0x04;		// Range is being filled, its summary is kept in memory
+
+inline constexpr ULONG RANGE_DATA_PAGES	= 128;		// Data pages per range
+
 // Data Page
 
 struct data_page
@@ -386,6 +453,7 @@ inline constexpr UCHAR dpg_large		= 0x04;		// Large object is on page
 inline constexpr UCHAR dpg_swept		= 0x08;		// Sweep has nothing to do on this page
 inline constexpr UCHAR dpg_secondary	= 0x10;		// Primary record versions not stored on this page
 													// Set in dpm.epp's extend_relation() but never tested.
+inline constexpr UCHAR dpg_all_visible	= 0x20;		// All records on page are visible to every transaction
 
 
 // Index root page
@@ -485,6 +553,7 @@ inline constexpr USHORT irt_primary			= 0x08;
 inline constexpr USHORT irt_expression		= 0x10;
 inline constexpr USHORT irt_condition		= 0x20;
 inline constexpr USHORT irt_complementary	= 0x40;		// temp index used by concurrent index creation
+inline constexpr USHORT irt_range			= 0x80;		// block range index, irt_root points to range pages
 
 
 /*
@@ -790,6 +859,9 @@ inline constexpr USHORT hdr_no_reserve			= 0x8;		// 8	don't reserve space for ve
 inline constexpr USHORT hdr_SQL_dialect_3		= 0x10;		// 16	database SQL dialect 3
 inline constexpr USHORT hdr_read_only			= 0x20;		// 32	Database is ReadOnly. If not set, DB is RW
 inline constexpr USHORT hdr_encrypted			= 0x40;		// 64	Database is encrypted
+inline constexpr USHORT hdr_page_compression	= 0x80;		// 128	Data and blob pages may be stored compressed,
+															//		ODS minor is ODS_CURRENT14_1 or higher
+inline constexpr USHORT hdr_known_flags			= 0xFF;		// All flags above, others are not supported
 
 // Values for backup mode
 inline constexpr UCHAR hdr_nbak_normal			= 0;			// Normal mode. Changes are simply written to main files
@@ -909,6 +981,7 @@ inline constexpr UCHAR ppg_dp_swept			= 0x04;		// Sweep has nothing to do on dat
 inline constexpr UCHAR ppg_dp_secondary		= 0x08;		// Primary record versions not stored on data page
 inline constexpr UCHAR ppg_dp_empty			= 0x10;		// Data page is empty
 inline constexpr UCHAR ppg_dp_reserved		= 0x20;		// Slot is reserved for bulk insert
+inline constexpr UCHAR ppg_dp_all_visible	= 0x40;		// All records on data page are visible to every transaction
 
 inline constexpr UCHAR PPG_DP_ALL_BITS	= (1 << PPG_DP_BITS_NUM) - 1;
 
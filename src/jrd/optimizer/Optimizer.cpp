@@ -58,6 +58,7 @@
 #include "../jrd/cch_proto.h"
 #include "../jrd/cmp_proto.h"
 #include "../jrd/cvt2_proto.h"
+#include "../jrd/dfw_proto.h"
 #include "../jrd/dpm_proto.h"
 #include "../common/dsc_proto.h"
 #include "../jrd/err_proto.h"
@@ -1237,6 +1238,267 @@ double Optimizer::getDependentSelectivity()
 }
 
 
+//
+// Estimate selectivity of a single boolean, using the column histogram if it's available
+// and the hardcoded reduction factors otherwise.
+//
+
+double Optimizer::getSelectivity(const BoolExprNode* node) const
+{
+	auto factor = REDUCE_SELECTIVITY_FACTOR_OTHER;
+
+	if (const auto notNode = nodeAs<NotBoolNode>(node))
+	{
+		factor = MAXIMUM_SELECTIVITY - getSelectivity(notNode->arg);
+	}
+	else if (const auto binaryNode = nodeAs<BinaryBoolNode>(node))
+	{
+		const auto selectivity1 = getSelectivity(binaryNode->arg1);
+		const auto selectivity2 = getSelectivity(binaryNode->arg2);
+
+		if (binaryNode->blrOp == blr_and)
+			factor = selectivity1 * selectivity2;
+		else if (binaryNode->blrOp == blr_or)
+			factor = selectivity1 + selectivity2 - selectivity1 * selectivity2;
+		else
+			fb_assert(false);
+	}
+	else if (const auto listNode = nodeAs<InListBoolNode>(node))
+	{
+		factor = REDUCE_SELECTIVITY_FACTOR_EQUALITY * listNode->list->items.getCount();
+	}
+	else if (getColumnSelectivity(node, factor))
+	{
+		// estimated by the histogram
+	}
+	else if (nodeIs<MissingBoolNode>(node))
+	{
+		factor = REDUCE_SELECTIVITY_FACTOR_EQUALITY;
+	}
+	else if (const auto cmpNode = nodeAs<ComparativeBoolNode>(node))
+	{
+		switch (cmpNode->blrOp)
+		{
+		case blr_eql:
+		case blr_equiv:
+			factor = REDUCE_SELECTIVITY_FACTOR_EQUALITY;
+			break;
+
+		case blr_gtr:
+		case blr_geq:
+			factor = REDUCE_SELECTIVITY_FACTOR_GREATER;
+			break;
+
+		case blr_lss:
+		case blr_leq:
+			factor = REDUCE_SELECTIVITY_FACTOR_LESS;
+			break;
+
+		case blr_between:
+			factor = REDUCE_SELECTIVITY_FACTOR_BETWEEN;
+			break;
+
+		case blr_starting:
+			factor = REDUCE_SELECTIVITY_FACTOR_STARTING;
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	if (!factor)
+		factor = DEFAULT_SELECTIVITY;
+
+	return MIN(factor, MAXIMUM_SELECTIVITY);
+}
+
+
+//
+// Estimate selectivity of a column compared with literals (or checked for NULL)
+// by the histogram collected with SET STATISTICS TABLE.
+//
+
+bool Optimizer::getColumnSelectivity(const BoolExprNode* node, double& selectivity) const
+{
+	const FieldNode* field = nullptr;
+	const ValueExprNode* values[2] = {nullptr, nullptr};
+	UCHAR blrOp = blr_missing;
+
+	if (const auto missingNode = nodeAs<MissingBoolNode>(node))
+	{
+		field = nodeAs<FieldNode>(missingNode->arg);
+	}
+	else if (const auto cmpNode = nodeAs<ComparativeBoolNode>(node))
+	{
+		blrOp = cmpNode->blrOp;
+
+		switch (blrOp)
+		{
+		case blr_eql:
+		case blr_equiv:
+		case blr_gtr:
+		case blr_geq:
+		case blr_lss:
+		case blr_leq:
+		case blr_between:
+		case blr_starting:
+			break;
+
+		default:
+			return false;
+		}
+
+		field = nodeAs<FieldNode>(cmpNode->arg1);
+		values[0] = cmpNode->arg2;
+		values[1] = cmpNode->arg3;
+
+		if (!field && blrOp != blr_between && blrOp != blr_starting)
+		{
+			// Literal on the left side, swap the comparison
+
+			field = nodeAs<FieldNode>(cmpNode->arg2);
+			values[0] = cmpNode->arg1;
+
+			switch (blrOp)
+			{
+			case blr_gtr:
+				blrOp = blr_lss;
+				break;
+
+			case blr_geq:
+				blrOp = blr_leq;
+				break;
+
+			case blr_lss:
+				blrOp = blr_gtr;
+				break;
+
+			case blr_leq:
+				blrOp = blr_geq;
+				break;
+			}
+		}
+
+		for (const auto value : values)
+		{
+			const auto literal = nodeAs<LiteralNode>(value);
+
+			if (value && (!literal || literal->litDesc.isNull()))
+				return false;
+		}
+	}
+
+	if (!field || field->fieldStream >= csb->csb_n_stream)
+		return false;
+
+	const auto& relation = csb->csb_rpt[field->fieldStream].csb_relation;
+
+	// Histograms of the system tables are never collected
+
+	if (!relation || relation()->isSystem() || relation()->isView() || relation()->isVirtual())
+		return false;
+
+	const auto format = CMP_format(tdbb, csb, field->fieldStream);
+
+	if (field->fieldId >= format->fmt_count)
+		return false;
+
+	const dsc& desc = format->fmt_desc[field->fieldId];
+
+	if (!desc.dsc_dtype || desc.isBlob() || desc.dsc_dtype == dtype_array)
+		return false;
+
+	const auto histogram = relation()->getColumnHistogram(tdbb, field->fieldId);
+
+	if (!histogram || !histogram->getSampleCount())
+		return false;
+
+	index_desc idx;
+	memset(&idx, 0, sizeof(idx));
+	idx.idx_count = 1;
+	idx.idx_rpt[0].idx_field = field->fieldId;
+
+	temporary_key lowerKey, upperKey;
+	IndexHistogram::Bound lower, upper;
+	const bool starting = (blrOp == blr_starting);
+
+	try
+	{
+		idx.idx_rpt[0].idx_itype = DFW_assign_index_type(tdbb, relation()->getName(), desc.dsc_dtype,
+			desc.isText() ? desc.getTextType() : ttype_none);
+
+		// Column type was changed since the histogram was built
+		if (histogram->getKeyType() != idx.idx_rpt[0].idx_itype)
+			return false;
+
+		const USHORT keyType = starting ? INTL_KEY_PARTIAL : INTL_KEY_SORT;
+		const SSHORT scale = (desc.dsc_dtype == dtype_int64 || desc.dsc_dtype == dtype_int128) ?
+			desc.dsc_scale : 0;
+
+		if (blrOp == blr_missing)
+		{
+			BTR_make_null_key(tdbb, &idx, &lowerKey);
+			lower = upper = IndexHistogram::Bound(lowerKey.key_data, lowerKey.key_length);
+		}
+		else
+		{
+			if (BTR_make_key(tdbb, 1, &values[0], &scale, &idx, &lowerKey, keyType, nullptr) != idx_e_ok)
+				return false;
+
+			const IndexHistogram::Bound key(lowerKey.key_data, lowerKey.key_length);
+
+			switch (blrOp)
+			{
+			case blr_gtr:
+			case blr_geq:
+				lower = key;
+				break;
+
+			case blr_lss:
+			case blr_leq:
+				upper = key;
+				break;
+
+			case blr_between:
+				if (BTR_make_key(tdbb, 1, &values[1], &scale, &idx, &upperKey, keyType, nullptr) != idx_e_ok)
+					return false;
+
+				lower = key;
+				upper = IndexHistogram::Bound(upperKey.key_data, upperKey.key_length);
+				break;
+
+			default:
+				lower = upper = key;
+				break;
+			}
+		}
+	}
+	catch (const Exception&)
+	{
+		// Conversion errors are left to be reported at execution
+		return false;
+	}
+
+	const unsigned count = histogram->countSamples(lower, upper, starting);
+	const double samples = histogram->getSampleCount();
+
+	if (blrOp == blr_eql || blrOp == blr_equiv || blrOp == blr_missing)
+	{
+		// A value found in a single sample may be a rare one as well,
+		// so only frequent values override the default selectivity
+
+		selectivity = (count > 1) ? count / samples :
+			MIN(REDUCE_SELECTIVITY_FACTOR_EQUALITY, MAXIMUM_SELECTIVITY / samples);
+	}
+	else
+		selectivity = MAX(count, 0.5) / samples;
+
+	selectivity = MIN(selectivity, MAXIMUM_SELECTIVITY);
+	return true;
+}
+
+
 //
 // Estimate overall selectivity for a list of conjuncts.
 // Booleans are usually inter-dependent in practice and simple multiplication results to a very low selectivity value,
@@ -1244,7 +1506,7 @@ double Optimizer::getDependentSelectivity()
 // See also explanation in the middle of Retrieval::makeInversion().
 //
 
-double Optimizer::estimateSelectivity(const BooleanList& filters, double cardinality, unsigned priorConjuncts)
+double Optimizer::estimateSelectivity(const BooleanList& filters, double cardinality, unsigned priorConjuncts) const
 {
 	// Get selectivities and order them
 	SortedArray<double, InlineStorage<double, OPT_STATIC_ITEMS> > selectivities;
@@ -1796,10 +2058,14 @@ SortedStream* Optimizer::generateSort(const StreamList& streams,
 		{
 			const auto* relation = csb->csb_rpt[item.stream].csb_relation();
 
+			// Records restored from the index keys cannot be refetched
+			// as they don't have the record version
+
 			if (relation &&
 				!relation->getExtFile() &&
 				!relation->isView() &&
-				!relation->isVirtual())
+				!relation->isVirtual() &&
+				!(csb->csb_rpt[item.stream].csb_flags & csb_index_only))
 			{
 				item.desc = nullptr;
 				--fieldCount;
@@ -3063,6 +3329,7 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 
 	RecordSource* rsb = nullptr;
 	InversionNode* inversion = nullptr;
+	InversionNode* blockRange = nullptr;
 	BoolExprNode* condition = nullptr;
 	Array<DbKeyRangeNode*> dbkeyRanges;
 	double scanSelectivity = MAXIMUM_SELECTIVITY;
@@ -3146,8 +3413,44 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 
 			navigation->setInversion(inversion, condition);
 
+			// When the index holds all the fields taken from the stream, the records
+			// may be restored from the index keys, skipping the data pages which are
+			// known to be visible to every transaction
+
+			if (isIndexOnly(stream, navigation->getIndex()))
+			{
+				navigation->setIndexOnly();
+				tail->csb_flags |= csb_index_only;
+			}
+
 			rsb = navigation;
 		}
+
+		// The same requires an index walk instead of a bitmap, so it's done for
+		// a single index retrieval only and if the walk is clearly cheaper
+
+		if (!rsb && inversion && !condition &&
+			inversion->type == InversionNode::TYPE_INDEX &&
+			isIndexOnly(stream, &inversion->retrieval->irb_desc) &&
+			isIndexOnlyCheaper(tail->csb_cardinality * scanSelectivity,
+				DPM_data_pages(tdbb, relation()), DPM_visible_pages(tdbb, relation())))
+		{
+			const auto idx = &inversion->retrieval.getObject()->irb_desc;
+			const USHORT keyLength = ROUNDUP(BTR_key_length(tdbb, relation(tdbb), idx), sizeof(SLONG));
+
+			const auto scan = FB_NEW_POOL(getPool()) IndexTableScan(csb, alias, stream, relation,
+				inversion, keyLength, scanSelectivity);
+
+			scan->setIndexOnly(false);
+			tail->csb_flags |= csb_index_only;
+			rsb = scan;
+		}
+
+		// Without an index retrieval, the block range index may still limit
+		// the full scan to the data pages possibly holding the matching records
+
+		if (!rsb && !inversion && dbkeyRanges.isEmpty())
+			blockRange = retrieval.getBlockRange();
 	}
 
 	if (outerFlag)
@@ -3197,7 +3500,7 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 
 	if (rsb)
 	{
-		filterSelectivity = Optimizer::estimateSelectivity(filters, rsb->getCardinality());
+		filterSelectivity = estimateSelectivity(filters, rsb->getCardinality());
 	}
 	else
 	{
@@ -3218,7 +3521,7 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 		}
 		else
 		{
-			rsb = FB_NEW_POOL(getPool()) FullTableScan(csb, alias, stream, relation, dbkeyRanges);
+			rsb = FB_NEW_POOL(getPool()) FullTableScan(csb, alias, stream, relation, dbkeyRanges, blockRange);
 
 			if (boolean)
 				csb->csb_rpt[stream].csb_flags |= csb_unmatched;
@@ -3229,6 +3532,24 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 }
 
 
+//
+// Check if the stream may be restored from the keys of the given index
+//
+
+bool Optimizer::isIndexOnly(StreamType stream, const index_desc* idx) const
+{
+	const auto tail = &csb->csb_rpt[stream];
+
+	// Records to be modified or locked must be read, the same
+	// if their versions (transaction numbers) are referenced
+
+	if ((tail->csb_flags & (csb_update | csb_record_version)) || rse->hasWriteLock())
+		return false;
+
+	return BTR_covers_fields(idx, CMP_format(tdbb, csb, stream), tail->csb_fields);
+}
+
+
 //
 // Compose a filter including all computable booleans
 //
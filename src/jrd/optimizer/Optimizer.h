@@ -61,6 +61,12 @@ inline constexpr double REDUCE_SELECTIVITY_FACTOR_ANY = 0.5;
 inline constexpr double COST_FACTOR_MEMCOPY = 0.5;
 inline constexpr double COST_FACTOR_HASHING = 0.5;
 inline constexpr double COST_FACTOR_QUICKSORT = 0.1;
+// Visibility check of a data page looks at its (likely cached) pointer page
+inline constexpr double COST_FACTOR_VISIBILITY_CHECK = 0.1;
+// Index only walk replaces the bitmap scan if it's at least that cheaper
+inline constexpr double INDEX_ONLY_COST_MARGIN = 2.0;
+// Block range index narrows the full scan if it's at least that cheaper
+inline constexpr double BLOCK_RANGE_COST_MARGIN = 2.0;
 
 inline constexpr double MAXIMUM_SELECTIVITY = 1.0;
 inline constexpr double DEFAULT_SELECTIVITY = 0.1;
@@ -390,73 +396,8 @@ public:
 		return statement ? statement->getPlan(tdbb, detailed) : "";
 	}
 
-	static double getSelectivity(const BoolExprNode* node)
-	{
-		auto factor = REDUCE_SELECTIVITY_FACTOR_OTHER;
-
-		if (const auto notNode = nodeAs<NotBoolNode>(node))
-		{
-			factor = MAXIMUM_SELECTIVITY - getSelectivity(notNode->arg);
-		}
-		else if (const auto binaryNode = nodeAs<BinaryBoolNode>(node))
-		{
-			const auto selectivity1 = getSelectivity(binaryNode->arg1);
-			const auto selectivity2 = getSelectivity(binaryNode->arg2);
-
-			if (binaryNode->blrOp == blr_and)
-				factor = selectivity1 * selectivity2;
-			else if (binaryNode->blrOp == blr_or)
-				factor = selectivity1 + selectivity2 - selectivity1 * selectivity2;
-			else
-				fb_assert(false);
-		}
-		else if (const auto listNode = nodeAs<InListBoolNode>(node))
-		{
-			factor = REDUCE_SELECTIVITY_FACTOR_EQUALITY * listNode->list->items.getCount();
-		}
-		else if (nodeIs<MissingBoolNode>(node))
-		{
-			factor = REDUCE_SELECTIVITY_FACTOR_EQUALITY;
-		}
-		else if (const auto cmpNode = nodeAs<ComparativeBoolNode>(node))
-		{
-			switch (cmpNode->blrOp)
-			{
-			case blr_eql:
-			case blr_equiv:
-				factor = REDUCE_SELECTIVITY_FACTOR_EQUALITY;
-				break;
-
-			case blr_gtr:
-			case blr_geq:
-				factor = REDUCE_SELECTIVITY_FACTOR_GREATER;
-				break;
-
-			case blr_lss:
-			case blr_leq:
-				factor = REDUCE_SELECTIVITY_FACTOR_LESS;
-				break;
-
-			case blr_between:
-				factor = REDUCE_SELECTIVITY_FACTOR_BETWEEN;
-				break;
-
-			case blr_starting:
-				factor = REDUCE_SELECTIVITY_FACTOR_STARTING;
-				break;
-
-			default:
-				break;
-			}
-		}
-
-		if (!factor)
-			factor = DEFAULT_SELECTIVITY;
-
-		return MIN(factor, MAXIMUM_SELECTIVITY);
-	}
-
-	static double estimateSelectivity(const BooleanList& filters, double cardinality = 0, unsigned priorConjuncts = 0);
+	double getSelectivity(const BoolExprNode* node) const;
+	double estimateSelectivity(const BooleanList& filters, double cardinality = 0, unsigned priorConjuncts = 0) const;
 
 	double getDependentSelectivity();
 
@@ -488,7 +429,39 @@ public:
 		return selectivity;
 	}
 
-	static RecordSource* compile(thread_db* tdbb, CompilerScratch* csb, RseNode* rse)
+	// Index only walk fetches the records in the index order and checks
+	// the visibility of every one of them, while the bitmap scan reads
+	// every data page once. The walk is worth it if most of the pages
+	// are all visible, thus their records are restored from the keys.
+	static bool isIndexOnlyCheaper(double records, double dataPages, double visiblePages)
+	{
+		if (records <= 0 || dataPages <= 0)
+			return false;
+
+		const double bitmapCost = MIN(records, dataPages);
+
+		const double hiddenShare = 1.0 - MIN(visiblePages, dataPages) / dataPages;
+		const double indexOnlyCost = records * (COST_FACTOR_VISIBILITY_CHECK + hiddenShare);
+
+		return indexOnlyCost * INDEX_ONLY_COST_MARGIN < bitmapCost;
+	}
+
+	// Block range index reads its summary pages and then the whole ranges of
+	// data pages, at least one of them. Assuming the records are stored in
+	// the key order, it's worth it if most of the table is skipped.
+	static bool isBlockRangeCheaper(double dataPages, double summaryPages, double selectivity)
+	{
+		if (dataPages <= Ods::RANGE_DATA_PAGES)
+			return false;
+
+		const double rangeCost = summaryPages +
+			MAX(dataPages * selectivity, (double) Ods::RANGE_DATA_PAGES);
+
+		return rangeCost * BLOCK_RANGE_COST_MARGIN < dataPages;
+	}
+
+	static RecordSource* compile(thread_db* tdbb, CompilerScratch* csb, RseNode* rse,
+		bool mainCursor = false)
 	{
 		bool firstRows = false;
 
@@ -502,7 +475,14 @@ public:
 			firstRows = attachment->att_opt_first_rows.valueOr(defaultFirstRows);
 		}
 
-		return Optimizer(tdbb, csb, rse, firstRows).compile(nullptr);
+		const auto rsb = Optimizer(tdbb, csb, rse, firstRows).compile(nullptr);
+
+		// The driving table of the main cursor may be read by parallel workers,
+		// unless only first rows are wanted. Nested streams stay serial.
+		if (mainCursor && !firstRows && !(csb->csb_g_flags & csb_internal))
+			rsb->markParallel();
+
+		return rsb;
 	}
 
 	~Optimizer();
@@ -612,9 +592,11 @@ private:
 						   RiverList& rivers,
 						   SortNode** sortClause,
 						   const PlanNode* planClause);
+	bool getColumnSelectivity(const BoolExprNode* node, double& selectivity) const;
 	bool getEquiJoinKeys(NestConst<ValueExprNode>& node1,
 						 NestConst<ValueExprNode>& node2,
 						 bool needCast);
+	bool isIndexOnly(StreamType stream, const index_desc* idx) const;
 	BoolExprNode* makeInferenceNode(BoolExprNode* boolean,
 									ValueExprNode* arg1,
 									ValueExprNode* arg2);
@@ -740,12 +722,12 @@ struct InversionCandidate
 	Firebird::Array<DbKeyRangeNode*> dbkeyRanges;
 	SortedStreamList dependentFromStreams;
 
-	void applyFilters(double cardinality)
+	void applyFilters(const Optimizer* optimizer, double cardinality)
 	{
 		fb_assert(selectivity == matchSelectivity);
 		fb_assert(filterSelectivity == MAXIMUM_SELECTIVITY);
 		const auto matchCount = (unsigned) matches.getCount();
-		filterSelectivity = Optimizer::estimateSelectivity(filters, cardinality, matchCount);
+		filterSelectivity = optimizer->estimateSelectivity(filters, cardinality, matchCount);
 		selectivity *= filterSelectivity;
 	}
 };
@@ -771,6 +753,7 @@ public:
 
 	InversionCandidate* getInversion();
 	IndexTableScan* getNavigation();
+	InversionNode* getBlockRange();
 
 protected:
 	void analyzeNavigation(const InversionCandidateList& inversions);
@@ -782,6 +765,7 @@ protected:
 	InversionNode* composeInversion(InversionNode* node1, InversionNode* node2,
 		InversionNode::Type node_type) const;
 	const Firebird::string& getAlias();
+	bool getHistogramSelectivity(const IndexScratch& scratch, double& selectivity) const;
 	void getInversionCandidates(InversionCandidateList& inversions,
 		IndexScratchList& indexScratches, unsigned scope) const;
 	InversionNode* makeIndexScanNode(IndexScratch* indexScratch) const;
@@ -813,6 +797,7 @@ private:
 	const bool setConjunctionsMatched;
 	Firebird::string alias;
 	IndexScratchList indexScratches;
+	IndexScratchList rangeScratches;
 	InversionCandidateList inversionCandidates;
 	Firebird::AutoPtr<InversionCandidate> finalCandidate;
 	Firebird::AutoPtr<InversionCandidate> navigationCandidate;
@@ -47,6 +47,7 @@
 #include "../jrd/met_proto.h"
 #include "../jrd/mov_proto.h"
 #include "../jrd/par_proto.h"
+#include "../jrd/rng_proto.h"
 
 #include "../jrd/optimizer/Optimizer.h"
 
@@ -152,6 +153,7 @@ Retrieval::Retrieval(thread_db* aTdbb, Optimizer* opt, StreamType streamNumber,
 	  setConjunctionsMatched(!costOnly),
 	  alias(getPool()),
 	  indexScratches(getPool()),
+	  rangeScratches(getPool()),
 	  inversionCandidates(getPool())
 {
 	const auto dbb = tdbb->getDatabase();
@@ -170,6 +172,15 @@ Retrieval::Retrieval(thread_db* aTdbb, Optimizer* opt, StreamType streamNumber,
 
 		index.idx_fraction = MAXIMUM_SELECTIVITY;
 
+		// Block range index doesn't deliver record numbers,
+		// it may only narrow the full table scan
+		if (index.idx_flags & idx_range)
+		{
+			IndexScratch scratch(getPool(), &index);
+			rangeScratches.add(scratch);
+			continue;
+		}
+
 		if ((index.idx_flags & idx_condition) && !checkIndexCondition(index, matches))
 			continue;
 
@@ -240,6 +251,95 @@ const string& Retrieval::getAlias()
 	return alias;
 }
 
+//
+// Find the block range index which limits the full table scan
+// to the ranges of data pages possibly holding the matching records
+//
+
+InversionNode* Retrieval::getBlockRange()
+{
+	if (!createIndexScanNodes || !relation || relation()->getExtFile() || relation()->isVirtual())
+		return nullptr;
+
+	auto iter = optimizer->getConjuncts(outerFlag, innerFlag);
+
+	for (const auto& rangeScratch : rangeScratches)
+	{
+		const auto idx = rangeScratch.index;
+
+		if (idx->idx_runtime_flags & idx_plan_dont_use)
+			continue;
+
+		// Order of the keys is more precise than the equivalence class,
+		// so the summaries cannot be compared with the search keys
+
+		const USHORT iType = idx->idx_rpt[0].idx_itype;
+
+		if (iType >= idx_first_intl_string)
+		{
+			const auto textType = INTL_texttype_lookup(tdbb, INTL_INDEX_TO_TEXT(iType));
+
+			if (textType->getFlags() & TEXTTYPE_SEPARATE_UNIQUE)
+				continue;
+		}
+
+		// Matched booleans stay unused, they re-check every record read
+
+		IndexScratch scratch(getPool(), rangeScratch);
+
+		for (iter.rewind(); iter.hasData(); ++iter)
+		{
+			if (!(iter & Optimizer::CONJUNCT_USED) &&
+				!(iter->nodFlags & ExprNode::FLAG_RESIDUAL) &&
+				iter->computable(csb, stream, true))
+			{
+				matchBoolean(&scratch, iter, 1);
+			}
+		}
+
+		double selectivity = MAXIMUM_SELECTIVITY;
+
+		switch (scratch.segments[0].scanType)
+		{
+			case segmentScanEqual:
+				scratch.lowerCount = scratch.upperCount = 1;
+				selectivity = REDUCE_SELECTIVITY_FACTOR_EQUALITY;
+				break;
+
+			case segmentScanBetween:
+				scratch.lowerCount = scratch.upperCount = 1;
+				selectivity = REDUCE_SELECTIVITY_FACTOR_BETWEEN;
+				break;
+
+			case segmentScanGreater:
+				scratch.lowerCount = 1;
+				selectivity = REDUCE_SELECTIVITY_FACTOR_GREATER;
+				break;
+
+			case segmentScanLess:
+				scratch.upperCount = 1;
+				selectivity = REDUCE_SELECTIVITY_FACTOR_LESS;
+				break;
+
+			default:
+				continue;
+		}
+
+		// Summaries give no key distribution, so the default selectivity
+		// of the matched condition estimates the part of ranges to read
+
+		const ULONG dataPages = DPM_data_pages(tdbb, relation());
+		const ULONG summaryPages = RNG_summary_pages(tdbb, relation(tdbb), idx, dataPages);
+
+		if (!Optimizer::isBlockRangeCheaper(dataPages, summaryPages, selectivity))
+			continue;
+
+		return makeIndexScanNode(&scratch);
+	}
+
+	return nullptr;
+}
+
 InversionCandidate* Retrieval::getInversion()
 {
 	if (finalCandidate)
@@ -361,7 +461,7 @@ InversionCandidate* Retrieval::getInversion()
 	}
 
 	const auto streamCardinality = csb->csb_rpt[stream].csb_cardinality;
-	invCandidate->applyFilters(streamCardinality);
+	invCandidate->applyFilters(optimizer, streamCardinality);
 
 	// Double check whether navigational walk is preferrable to the external sort
 	if (navigationCandidate)
@@ -949,6 +1049,101 @@ bool Retrieval::checkIndexExpression(const index_desc* idx, ValueExprNode* node)
 		node->containsStream(stream, true);
 }
 
+bool Retrieval::getHistogramSelectivity(const IndexScratch& scratch, double& selectivity) const
+{
+	// Estimate the share of index keys matching the literal bounds of the first
+	// segment, using the histogram collected along with the index statistics
+
+	const auto idx = scratch.index;
+	const auto& segment = scratch.segments[0];
+
+	if (!relation || scratch.usePartialKey || scratch.useMultiStartingKeys)
+		return false;
+
+	const bool equality =
+		(segment.scanType == segmentScanEqual || segment.scanType == segmentScanEquivalent);
+	const bool starting = (segment.scanType == segmentScanStarting);
+
+	if (!equality && !starting &&
+		segment.scanType != segmentScanBetween &&
+		segment.scanType != segmentScanLess &&
+		segment.scanType != segmentScanGreater)
+	{
+		return false;
+	}
+
+	if ((segment.lowerValue && !nodeIs<LiteralNode>(segment.lowerValue)) ||
+		(segment.upperValue && !nodeIs<LiteralNode>(segment.upperValue)))
+	{
+		return false;
+	}
+
+	const auto idp = relation()->lookupIndex(tdbb, idx->idx_id, CacheFlag::AUTOCREATE);
+	const auto histogram = idp ? idp->getHistogram(tdbb) : RefPtr<IndexHistogram>();
+
+	if (!histogram || histogram->getRoot() != idx->idx_root || !histogram->getSampleCount())
+		return false;
+
+	const USHORT keyType = starting ? INTL_KEY_PARTIAL :
+		(idx->idx_flags & idx_unique) ? INTL_KEY_UNIQUE : INTL_KEY_SORT;
+
+	temporary_key lowerKey, upperKey;
+	IndexHistogram::Bound lower, upper;
+
+	try
+	{
+		if (segment.lowerValue)
+		{
+			if (BTR_make_key(tdbb, 1, &segment.lowerValue, &segment.scale, idx,
+					&lowerKey, keyType, nullptr) != idx_e_ok)
+			{
+				return false;
+			}
+
+			lower = IndexHistogram::Bound(lowerKey.key_data, lowerKey.key_length);
+		}
+
+		if (segment.upperValue)
+		{
+			if (BTR_make_key(tdbb, 1, &segment.upperValue, &segment.scale, idx,
+					&upperKey, keyType, nullptr) != idx_e_ok)
+			{
+				return false;
+			}
+
+			upper = IndexHistogram::Bound(upperKey.key_data, upperKey.key_length);
+		}
+	}
+	catch (const Exception&)
+	{
+		// Conversion errors are left to be reported at execution
+		return false;
+	}
+
+	if (idx->idx_flags & idx_descending)
+		std::swap(lower, upper);
+
+	// Key of the first segment is a prefix of the whole compound key
+	const bool prefix = starting || (idx->idx_count > 1);
+
+	const unsigned count = histogram->countSamples(lower, upper, prefix);
+	const double samples = histogram->getSampleCount();
+
+	if (equality)
+	{
+		// A value found in a single sample may be a rare one as well,
+		// so only frequent values override the average selectivity
+
+		selectivity = (count > 1) ? count / samples :
+			MIN(idx->idx_rpt[0].idx_selectivity, MAXIMUM_SELECTIVITY / samples);
+	}
+	else
+		selectivity = MAX(count, 0.5) / samples;
+
+	selectivity = MIN(selectivity, MAXIMUM_SELECTIVITY);
+	return true;
+}
+
 void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 									   IndexScratchList& fromIndexScratches,
 									   unsigned scope) const
@@ -980,6 +1175,8 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 			bool unique = false;
 			unsigned listCount = 0;
 			auto maxSelectivity = scratch.selectivity;
+			double histogramSelectivity = 0;
+			double skewFactor = 1;
 
 			for (unsigned j = 0; j < scratch.segments.getCount(); j++)
 			{
@@ -1025,6 +1222,17 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 				if (useDefaultSelectivity)
 					selectivity = MAX(scratch.selectivity * DEFAULT_SELECTIVITY, minSelectivity);
 
+				// If the first segment is matched against literals, its selectivity can be
+				// estimated from the distribution of the index keys. Then the selectivity of
+				// the following segments is skewed the same way as the first one is.
+				if (j == 0)
+				{
+					if (!useDefaultSelectivity && getHistogramSelectivity(scratch, histogramSelectivity))
+						skewFactor = histogramSelectivity / selectivity;
+				}
+				else if (skewFactor != 1)
+					selectivity = MIN(selectivity * skewFactor, scratch.selectivity);
+
 				if (scanType == segmentScanList)
 				{
 					if (listCount) // we cannot have more than one list matched to an index
@@ -1050,6 +1258,10 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 					scratch.nonFullMatchedSegments = idx->idx_count - (j + 1);
 					// Add matches for this segment to the main matches list
 					matches.join(segment.matches);
+
+					if (histogramSelectivity && j == 0)
+						selectivity = histogramSelectivity;
+
 					scratch.selectivity = selectivity;
 
 					// An equality scan for any unique index cannot retrieve more
@@ -1122,11 +1334,16 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 								break;
 						}
 
-						// Adjust the compound selectivity using the reduce factor.
-						// It should be better than the previous segment but worse
-						// than a full match.
-						const double diffSelectivity = scratch.selectivity - selectivity;
-						selectivity += (diffSelectivity * factor);
+						if (histogramSelectivity && j == 0)
+							selectivity = histogramSelectivity;
+						else
+						{
+							// Adjust the compound selectivity using the reduce factor.
+							// It should be better than the previous segment but worse
+							// than a full match.
+							const double diffSelectivity = scratch.selectivity - selectivity;
+							selectivity += (diffSelectivity * factor);
+						}
 						fb_assert(selectivity <= scratch.selectivity);
 						scratch.selectivity = selectivity;
 
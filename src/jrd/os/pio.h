@@ -42,6 +42,7 @@ class jrd_file : public pool_alloc_rpt<SCHAR, type_fil>
 {
 public:
 	int fil_desc;
+	int fil_batch_desc;			// Descriptor without O_SYNC, used for batched forced writes
 	Firebird::Mutex fil_mutex;
 	USHORT fil_flags;
 	SCHAR fil_string[1];		// Expanded file name
@@ -79,6 +80,7 @@ inline constexpr USHORT FIL_readonly		= 4;	// file opened in readonly mode
 inline constexpr USHORT FIL_sh_write		= 8;	// file opened in shared write mode
 inline constexpr USHORT FIL_no_fast_extend	= 16;	// file not supports fast extending
 inline constexpr USHORT FIL_raw_device		= 32;	// file is raw device
+inline constexpr USHORT FIL_no_sparse		= 64;	// file not supports releasing space inside it
 
 // Physical IO trace events
 
@@ -49,6 +49,7 @@ bool	PIO_header(Jrd::thread_db*, UCHAR*, unsigned);
 USHORT	PIO_init_data(Jrd::thread_db* tdbb, Jrd::jrd_file* file, Jrd::FbStatusVector* status_vector, ULONG startPage, USHORT initPages);
 Jrd::jrd_file*	PIO_open(Jrd::thread_db*, const Firebird::PathName&,
 						 const Firebird::PathName&);
+void	PIO_prefetch(Jrd::thread_db*, Jrd::jrd_file*, const ULONG*, FB_SIZE_T);
 bool	PIO_read(Jrd::thread_db*, Jrd::jrd_file*, Jrd::BufferDesc*, Ods::pag*, Jrd::FbStatusVector*);
 
 #ifdef SUPERSERVER_V2
@@ -66,7 +67,9 @@ inline bool PIO_on_raw_device(const Firebird::PathName&)
 	return false;
 }
 #endif
+bool	PIO_sync(Jrd::thread_db*, Jrd::jrd_file*, Jrd::FbStatusVector*);
 bool	PIO_write(Jrd::thread_db*, Jrd::jrd_file*, Jrd::BufferDesc*, Ods::pag*, Jrd::FbStatusVector*);
+bool	PIO_write_deferred(Jrd::thread_db*, Jrd::jrd_file*, Jrd::BufferDesc*, Ods::pag*, Jrd::FbStatusVector*);
 
 #endif // JRD_PIO_PROTO_H
 
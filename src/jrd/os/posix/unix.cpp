@@ -73,6 +73,7 @@
 #include "../jrd/lck.h"
 #include "../jrd/mov_proto.h"
 #include "../jrd/ods_proto.h"
+#include "../jrd/PageCompression.h"
 #include "../jrd/os/pio_proto.h"
 #include "../common/classes/init.h"
 #include "../common/os/os_utils.h"
@@ -138,6 +139,9 @@ static void lockDatabaseFile(int& desc, const bool shareMode, const bool tempora
 							 const char* fileName, ISC_STATUS operation);
 static bool unix_error(const TEXT*, const jrd_file*, ISC_STATUS, FbStatusVector* = NULL);
 static bool block_size_error(const jrd_file*, off_t, FbStatusVector* = NULL);
+static int get_compression_level(const Database*);
+static bool write_page(jrd_file*, int, BufferDesc*, const Ods::pag*, SLONG, int, FbStatusVector*);
+static bool punch_hole(jrd_file*, int, FB_UINT64, SLONG, FbStatusVector*);
 #if !(defined HAVE_PREAD && defined HAVE_PWRITE)
 static SLONG pread(int, SCHAR*, SLONG, SLONG);
 static SLONG pwrite(int, SCHAR*, SLONG, SLONG);
@@ -170,6 +174,8 @@ void PIO_close(jrd_file* file)
 		close(file->fil_desc);
 		file->fil_desc = -1;
 	}
+
+	maybeCloseFile(file->fil_batch_desc);
 }
 
 
@@ -422,6 +428,7 @@ void PIO_force_write(jrd_file* file, const bool forceWrite)
 #ifdef FCNTL_SYNC_BROKEN
 
 		maybeCloseFile(file->fil_desc);
+		maybeCloseFile(file->fil_batch_desc);
 
 		const bool readOnly = (file->fil_flags & FIL_readonly) != 0;
 		const bool notUseFSCache = (file->fil_flags & FIL_no_fs_cache) != 0;
@@ -751,6 +758,47 @@ jrd_file* PIO_open(thread_db* tdbb,
 }
 
 
+void PIO_prefetch(thread_db* tdbb, jrd_file* file, const ULONG* pages, FB_SIZE_T count)
+{
+/**************************************
+ *
+ *	P I O _ p r e f e t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Ask the operating system to start reading the given
+ *	(ascending) set of pages into its cache. Adjacent pages are
+ *	coalesced into a single request. The call doesn't wait for
+ *	the I/O to complete and errors are silently ignored.
+ *
+ **************************************/
+#ifdef POSIX_FADV_WILLNEED
+	if (file->fil_desc == -1 || (file->fil_flags & FIL_no_fs_cache) || !count)
+		return;
+
+	const FB_UINT64 size = tdbb->getDatabase()->dbb_page_size;
+
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
+
+	for (const ULONG* const end = pages + count; pages < end;)
+	{
+		const ULONG first = *pages++;
+		ULONG last = first;
+
+		while (pages < end && *pages == last + 1)
+			last = *pages++;
+
+		const FB_UINT64 offset = first * size;
+		const FB_UINT64 length = (last - first + 1) * size;
+
+		os_utils::posix_fadvise(file->fil_desc, LSEEK_OFFSET_CAST offset,
+			LSEEK_OFFSET_CAST length, POSIX_FADV_WILLNEED);
+	}
+#endif
+}
+
+
 bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page, FbStatusVector* status_vector)
 {
 /**************************************
@@ -784,6 +832,13 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 		if ((bytes = os_utils::pread(file->fil_desc, page, size, LSEEK_OFFSET_CAST offset)) == size)
 		{
 			// os_utils::posix_fadvise(file->desc, offset, size, POSIX_FADV_NOREUSE);
+
+			if (!PageCompression::unpack(page, size))
+			{
+				errno = EBADMSG;
+				return unix_error("decompress", file, isc_io_read_err, status_vector);
+			}
+
 			return true;
 		}
 
@@ -803,6 +858,42 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_sync(thread_db* tdbb, jrd_file* file, FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ s y n c
+ *
+ **************************************
+ *
+ * Functional description
+ *	Make sure that all pages written so far, in particular
+ *	by PIO_write_deferred(), have reached the disk. Unlike
+ *	PIO_flush, report an error if that's not possible.
+ *
+ **************************************/
+	if (file->fil_desc == -1)
+		return unix_error("fsync", file, isc_io_write_err, status_vector);
+
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
+
+	int rc;
+	do
+	{
+#ifdef HAVE_FDATASYNC
+		rc = fdatasync(file->fil_desc);
+#else
+		rc = fsync(file->fil_desc);
+#endif
+	} while (rc == -1 && SYSCALL_INTERRUPTED(errno));
+
+	if (rc == -1)
+		return unix_error("fsync", file, isc_io_write_err, status_vector);
+
+	return true;
+}
+
+
 bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page, FbStatusVector* status_vector)
 {
 /**************************************
@@ -815,10 +906,6 @@ bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
  *	Write a data page.  Oh wow.
  *
  **************************************/
-	int i;
-	SINT64 bytes;
-	FB_UINT64 offset;
-
 	if (file->fil_desc == -1)
 		return unix_error("write", file, isc_io_write_err, status_vector);
 
@@ -826,19 +913,165 @@ bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 
 	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
 
-	const SLONG size = dbb->dbb_page_size;
+	return write_page(file, file->fil_desc, bdb, page, dbb->dbb_page_size,
+		get_compression_level(dbb), status_vector);
+}
 
-	for (i = 0; i < IO_RETRY; i++)
+
+bool PIO_write_deferred(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
+	FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ w r i t e _ d e f e r r e d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write a data page without waiting for it to reach the disk
+ *	even if forced writes are enabled. The caller is responsible
+ *	for calling PIO_sync before anything may depend on the page.
+ *
+ **************************************/
+	if (!(file->fil_flags & FIL_force_write))
+		return PIO_write(tdbb, file, bdb, page, status_vector);
+
+	if (file->fil_batch_desc == -1)
+	{
+		MutexLockGuard guard(file->fil_mutex, FB_FUNCTION);
+
+		if (file->fil_batch_desc == -1)
+		{
+			const bool readOnly = (file->fil_flags & FIL_readonly) != 0;
+			const bool notUseFSCache = (file->fil_flags & FIL_no_fs_cache) != 0;
+
+			file->fil_batch_desc = openFile(file->fil_string, false, notUseFSCache, readOnly);
+			if (file->fil_batch_desc == -1)
+				return unix_error("open", file, isc_io_open_err, status_vector);
+		}
+	}
+
+	Database* const dbb = tdbb->getDatabase();
+
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
+
+	return write_page(file, file->fil_batch_desc, bdb, page, dbb->dbb_page_size,
+		get_compression_level(dbb), status_vector);
+}
+
+
+static int get_compression_level(const Database* dbb)
+{
+/**************************************
+ *
+ *	g e t _ c o m p r e s s i o n _ l e v e l
+ *
+ **************************************
+ *
+ * Functional description
+ *	Pages are compressed only if the database header
+ *	says it may contain compressed pages.
+ *
+ **************************************/
+	if (!(dbb->dbb_flags & DBB_page_compression))
+		return 0;
+
+	return dbb->dbb_config->getPageCompressionLevel();
+}
+
+
+static bool write_page(jrd_file* file, int desc, BufferDesc* bdb, const Ods::pag* page,
+					   SLONG size, int level, FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	w r i t e _ p a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write a page using given descriptor of the file.
+ *	If compression is requested and the page shrinks
+ *	enough, write the compressed image and release
+ *	the rest of the page space.
+ *
+ **************************************/
+	if (file->fil_flags & (FIL_no_sparse | FIL_raw_device))
+		level = 0;
+
+	const PageCompression::Image image(page, size, level);
+	const SLONG length = image.getLength();
+	FB_UINT64 offset;
+
+	for (int i = 0; i < IO_RETRY; i++)
 	{
 		if (!seek_file(file, bdb, &offset, status_vector))
 			return false;
 
-		if ((bytes = os_utils::pwrite(file->fil_desc, page, size, LSEEK_OFFSET_CAST offset)) == size)
+		const SINT64 bytes = os_utils::pwrite(desc, image.begin(), length, LSEEK_OFFSET_CAST offset);
+		if (bytes == length)
 		{
 			// os_utils::posix_fadvise(file->desc, offset, size, POSIX_FADV_DONTNEED);
+
+			if (length == size)
+				return true;
+
+			return punch_hole(file, desc, offset + length, size - length, status_vector);
+		}
+
+		if (bytes < 0 && !SYSCALL_INTERRUPTED(errno))
+			return unix_error("write", file, isc_io_write_err, status_vector);
+	}
+
+	return unix_error("write_retry", file, isc_io_write_err, status_vector);
+}
+
+
+static bool punch_hole(jrd_file* file, int desc, FB_UINT64 offset, SLONG length,
+					   FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	p u n c h _ h o l e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Release the disk space after a compressed page.
+ *	If the file system can't do it, fill the space
+ *	with zeros and don't compress pages anymore.
+ *
+ **************************************/
+#if defined(HAVE_LINUX_FALLOC_H) && defined(HAVE_FALLOCATE) && defined(FALLOC_FL_PUNCH_HOLE)
+	for (int i = 0; i < IO_RETRY; i++)
+	{
+		if (fallocate(desc, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+				LSEEK_OFFSET_CAST offset, length) == 0)
+		{
 			return true;
 		}
 
+		const int err = errno;
+		if (SYSCALL_INTERRUPTED(err))
+			continue;
+
+		if (err != EOPNOTSUPP && err != ENOSYS)
+			return unix_error("fallocate", file, isc_io_write_err, status_vector);
+
+		break;
+	}
+#endif
+
+	file->fil_flags |= FIL_no_sparse;
+
+	fb_assert(zeros().getSize() >= (FB_SIZE_T) length);
+
+	for (int i = 0; i < IO_RETRY; i++)
+	{
+		const SINT64 bytes = os_utils::pwrite(desc, zeros().getBuffer(), length, LSEEK_OFFSET_CAST offset);
+		if (bytes == length)
+			return true;
+
 		if (bytes < 0 && !SYSCALL_INTERRUPTED(errno))
 			return unix_error("write", file, isc_io_write_err, status_vector);
 	}
@@ -951,6 +1184,7 @@ static jrd_file* setup_file(Database* dbb, const PathName& file_name, int desc,
 	{
 		file = FB_NEW_RPT(*dbb->dbb_permanent, file_name.length() + 1) jrd_file();
 		file->fil_desc = desc;
+		file->fil_batch_desc = -1;
 		file->fil_flags = flags;
 		strcpy(file->fil_string, file_name.c_str());
 	}
@@ -48,6 +48,7 @@
 
 #include "../jrd/lck.h"
 #include "../jrd/mov_proto.h"
+#include "../jrd/PageCompression.h"
 #include "../jrd/os/pio_proto.h"
 #include "../common/classes/init.h"
 #include "../common/config/config.h"
@@ -532,6 +533,23 @@ jrd_file* PIO_open(thread_db* tdbb,
 }
 
 
+void PIO_prefetch(thread_db*, jrd_file*, const ULONG*, FB_SIZE_T)
+{
+/**************************************
+ *
+ *	P I O _ p r e f e t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Hint the operating system about pages to be read soon.
+ *	Windows has no cheap equivalent of the read-ahead advice,
+ *	so this is a no-op.
+ *
+ **************************************/
+}
+
+
 bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page, FbStatusVector* status_vector)
 {
 /**************************************
@@ -568,6 +586,15 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 	if (!ret || (size != actual_length))
 		return nt_error("ReadFile", file, isc_io_read_err, status_vector);
 
+	// Pages are never compressed here as there's no support for sparse files,
+	// but the database may come from another platform
+
+	if (!PageCompression::unpack(page, size))
+	{
+		SetLastError(ERROR_INVALID_DATA);
+		return nt_error("decompress", file, isc_io_read_err, status_vector);
+	}
+
 	return true;
 }
 
@@ -691,6 +718,24 @@ bool PIO_status(thread_db* tdbb, phys_io_blk* piob, FbStatusVector* status_vecto
 #endif
 
 
+bool PIO_sync(thread_db*, jrd_file*, FbStatusVector*)
+{
+/**************************************
+ *
+ *	P I O _ s y n c
+ *
+ **************************************
+ *
+ * Functional description
+ *	Make sure that pages written by PIO_write_deferred()
+ *	have reached the disk. As deferred writes are not
+ *	implemented on this platform, there is nothing to do.
+ *
+ **************************************/
+	return true;
+}
+
+
 bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page, FbStatusVector* status_vector)
 {
 /**************************************
@@ -731,6 +776,24 @@ bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_write_deferred(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
+	FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ w r i t e _ d e f e r r e d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write a data page without waiting for it to reach the disk.
+ *	Not implemented on this platform, do the regular write.
+ *
+ **************************************/
+	return PIO_write(tdbb, file, bdb, page, status_vector);
+}
+
+
 ULONG PIO_get_number_of_pages(const jrd_file* file, const USHORT pagesize)
 {
 /**************************************
@@ -95,6 +95,7 @@
 #include "../jrd/extds/ExtDS.h"
 #include "../common/classes/DbImplementation.h"
 #include "../jrd/CryptoManager.h"
+#include "../jrd/PageCompression.h"
 
 using namespace Jrd;
 using namespace Ods;
@@ -798,7 +799,7 @@ void PAG_format_header(thread_db* tdbb)
 	header->hdr_page_size = dbb->dbb_page_size;
 	header->hdr_ods_version = ODS_VERSION | ODS_FIREBIRD_FLAG;
 	DbImplementation::current.store(header);
-	header->hdr_ods_minor = ODS_CURRENT;
+	header->hdr_ods_minor = ODS_CREATED;
 	header->hdr_oldest_transaction = 1;
 	header->hdr_end = HDR_SIZE;
 	header->hdr_data[0] = HDR_end;
@@ -1031,6 +1032,9 @@ void PAG_header(thread_db* tdbb, bool info, const TriState newForceWrite)
 	if (header->hdr_flags & hdr_no_reserve)
 		dbb->dbb_flags |= DBB_no_reserve;
 
+	if (header->hdr_flags & hdr_page_compression)
+		dbb->dbb_flags |= DBB_page_compression;
+
 	const auto shutMode = (shut_mode_t) header->hdr_shutdown_mode;
 	dbb->dbb_shutdown_mode.store(shutMode, std::memory_order_relaxed);
 
@@ -1149,6 +1153,26 @@ void PAG_header_init(thread_db* tdbb)
 	if (!DbImplementation(header).compatible(DbImplementation::current))
 		ERR_post(Arg::Gds(isc_bad_db_format) << Arg::Str(attachment->att_filename));
 
+	// Refuse the database if it may use something this engine can't handle
+
+	if (header->hdr_flags & ~hdr_known_flags)
+	{
+		string msg;
+		msg.printf("Database %s has unknown header page flags 0x%X",
+			attachment->att_filename.c_str(), (unsigned) (header->hdr_flags & ~hdr_known_flags));
+
+		ERR_post(Arg::Gds(isc_random) << Arg::Str(msg));
+	}
+
+	if ((header->hdr_flags & hdr_page_compression) && !PageCompression::isAvailable())
+	{
+		string msg;
+		msg.printf("Database %s may contain compressed pages but zstd library is not available",
+			attachment->att_filename.c_str());
+
+		ERR_post(Arg::Gds(isc_random) << Arg::Str(msg));
+	}
+
 	if (header->hdr_page_size < MIN_PAGE_SIZE || header->hdr_page_size > MAX_PAGE_SIZE)
 		ERR_post(Arg::Gds(isc_bad_db_format) << Arg::Str(attachment->att_filename));
 
@@ -1502,6 +1526,51 @@ void PAG_set_no_reserve(thread_db* tdbb, bool flag)
 }
 
 
+void PAG_set_page_compression(thread_db* tdbb)
+{
+/**************************************
+ *
+ *	P A G _ s e t _ p a g e _ c o m p r e s s i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	If page compression is configured, mark the database
+ *	as possibly containing compressed pages. It's done
+ *	before the first compressed page is written, so the
+ *	engines that can't read them refuse the database.
+ *	Older engines of the same ODS ignore header flags,
+ *	so the ODS minor version is raised as well.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+#ifndef WIN_NT	// pages are never compressed there, see PIO_write
+	const auto dbb = tdbb->getDatabase();
+
+	if (((dbb->dbb_flags & DBB_page_compression) && dbb->dbb_minor_version >= ODS_CURRENT14_1) ||
+		(dbb->dbb_flags & DBB_read_only) ||
+		!dbb->dbb_config->getPageCompressionLevel() || !PageCompression::isAvailable())
+	{
+		return;
+	}
+
+	WIN window(HEADER_PAGE_NUMBER);
+	header_page* header = (header_page*) CCH_FETCH(tdbb, &window, LCK_write, pag_header);
+	CCH_MARK_MUST_WRITE(tdbb, &window);
+
+	header->hdr_flags |= hdr_page_compression;
+	dbb->dbb_flags |= DBB_page_compression;
+
+	if (header->hdr_ods_minor < ODS_CURRENT14_1)
+		header->hdr_ods_minor = ODS_CURRENT14_1;
+	dbb->dbb_minor_version = header->hdr_ods_minor;
+
+	CCH_RELEASE(tdbb, &window);
+#endif
+}
+
+
 void PAG_set_db_readonly(thread_db* tdbb, bool flag)
 {
 /*********************************************
@@ -56,6 +56,7 @@ void	PAG_release_pages(Jrd::thread_db* tdbb, USHORT pageSpaceID, int cntRelease,
 void	PAG_set_db_guid(Jrd::thread_db* tdbb, const Firebird::Guid&);
 void	PAG_set_force_write(Jrd::thread_db* tdbb, bool);
 void	PAG_set_no_reserve(Jrd::thread_db* tdbb, bool);
+void	PAG_set_page_compression(Jrd::thread_db* tdbb);
 void	PAG_set_db_readonly(Jrd::thread_db* tdbb, bool);
 void	PAG_set_db_replica(Jrd::thread_db* tdbb, ReplicaMode);
 void	PAG_set_db_SQL_dialect(Jrd::thread_db* tdbb, SSHORT);
@@ -123,6 +123,12 @@ void BaseAggWinStream<ThisType, NextType>::markRecursive()
 	m_next->markRecursive();
 }
 
+template <typename ThisType, typename NextType>
+void BaseAggWinStream<ThisType, NextType>::markParallel()
+{
+	m_next->markParallel();
+}
+
 template <typename ThisType, typename NextType>
 void BaseAggWinStream<ThisType, NextType>::invalidateRecords(Request* request) const
 {
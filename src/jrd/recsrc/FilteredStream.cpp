@@ -148,6 +148,11 @@ void FilteredStream::markRecursive()
 	m_next->markRecursive();
 }
 
+void FilteredStream::markParallel()
+{
+	m_next->markParallel();
+}
+
 void FilteredStream::findUsedStreams(StreamList& streams, bool expandAll) const
 {
 	m_next->findUsedStreams(streams, expandAll);
@@ -25,25 +25,622 @@
 #include "../jrd/evl_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/rlck_proto.h"
+#include "../jrd/rng_proto.h"
+#include "../jrd/tra.h"
+#include "../jrd/tra_proto.h"
+#include "../jrd/met.h"
 #include "../jrd/Attachment.h"
+#include "../jrd/WorkerAttachment.h"
+#include "../common/Task.h"
 
 #include "RecordSource.h"
 
+#include <atomic>
+
 using namespace Firebird;
 using namespace Jrd;
 
+namespace
+{
+	// Size of the batch of records passed from the scan worker to the requester
+	constexpr ULONG SCAN_BATCH_SIZE = 128 * 1024;
+
+	// Number of batches allocated per scan worker
+	constexpr ULONG SCAN_BATCHES_PER_WORKER = 4;
+
+	// Record fetched by the scan worker, followed by the record data if any
+	struct ScanRecord
+	{
+		SINT64 number;
+		TraNumber transaction;
+		ULONG length;		// length of the record data, zero if no data is passed
+		USHORT format;
+	};
+
+	constexpr ULONG SCAN_RECORD_SIZE = FB_ALIGN(sizeof(ScanRecord), FB_ALIGNMENT);
+}
+
+namespace Jrd
+{
+
+// Reads the relation by worker attachments, every work item is the set of data
+// pages of one pointer page. Workers see the same snapshot as the requester's
+// transaction (or request, for read consistency) and pass visible records to
+// the requester in batches. Order of records is not preserved.
+
+class TableScanTask : public Task
+{
+public:
+	TableScanTask(thread_db* tdbb, MemoryPool* pool, jrd_rel* relation,
+			record_param* rpb, CommitNumber snapshot);
+
+	virtual ~TableScanTask();
+
+	static TableScanTask* start(thread_db* tdbb, record_param* rpb);
+
+	bool handler(WorkItem& _item);
+	bool getWorkItem(WorkItem** pItem);
+	bool getResult(IStatus* status);
+	int getMaxWorkers();
+
+	bool getRecord(thread_db* tdbb, record_param* rpb, MemoryPool* pool);
+	void stop(thread_db* tdbb);
+
+private:
+	typedef Array<UCHAR> Batch;
+
+	class Item : public Task::WorkItem
+	{
+	public:
+		Item(TableScanTask* task, StableAttachmentPart* attStable)
+			: Task::WorkItem(task),
+			  m_inuse(false),
+			  m_attStable(attStable),
+			  m_tra(NULL),
+			  m_ppSequence(0)
+		{}
+
+		virtual ~Item()
+		{
+			Attachment* att = NULL;
+			{
+				AttSyncLockGuard guard(*m_attStable->getSync(), FB_FUNCTION);
+
+				att = m_attStable->getHandle();
+				if (!att)
+					return;
+				fb_assert(att->att_use_count > 0);
+			}
+
+			FbLocalStatus status;
+			if (m_tra)
+			{
+				BackgroundContextHolder tdbb(att->att_database, att, &status, FB_FUNCTION);
+				TRA_commit(tdbb, m_tra, false);
+			}
+
+			WorkerAttachment::releaseAttachment(&status, m_attStable);
+		}
+
+		bool init(thread_db* tdbb)
+		{
+			Attachment* const att = m_attStable->getHandle();
+
+			if (!att)
+			{
+				Arg::Gds(isc_bad_db_handle).copyTo(tdbb->tdbb_status_vector);
+				return false;
+			}
+
+			tdbb->setDatabase(att->att_database);
+			tdbb->setAttachment(att);
+
+			if (!m_tra)
+			{
+				try
+				{
+					const TableScanTask* const task = getTask();
+
+					WorkerContextHolder holder(tdbb, FB_FUNCTION);
+					m_tra = TRA_start(tdbb, task->m_tpb.getCount(), task->m_tpb.begin());
+				}
+				catch (const Exception& ex)
+				{
+					ex.stuffException(tdbb->tdbb_status_vector);
+					return false;
+				}
+			}
+
+			tdbb->setTransaction(m_tra);
+			return true;
+		}
+
+		TableScanTask* getTask() const
+		{
+			return reinterpret_cast<TableScanTask*> (m_task);
+		}
+
+		bool m_inuse;
+		RefPtr<StableAttachmentPart> m_attStable;
+		jrd_tra* m_tra;
+		ULONG m_ppSequence;
+	};
+
+	void setError(IStatus* status, bool stopTask)
+	{
+		const bool copyStatus = (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS);
+		if (!copyStatus && (!stopTask || m_stop))
+			return;
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		if (m_status.isSuccess() && copyStatus)
+			m_status.save(status);
+		if (stopTask)
+			m_stop = true;
+
+		m_readySem.release();
+	}
+
+	Batch* getFreeBatch(thread_db* tdbb);
+	void putReadyBatch(Batch* batch);
+	Batch* getReadyBatch(thread_db* tdbb);
+	void releaseBatch(Batch* batch);
+
+	MemoryPool* m_pool;
+	Database* m_dbb;
+	const USHORT m_relationId;
+	const USHORT m_streamFlags;
+	const USHORT m_winFlags;
+	const ULONG m_orgScans;
+	UCharBuffer m_tpb;
+
+	Mutex m_mutex;
+	HalfStaticArray<Item*, 8> m_items;
+	HalfStaticArray<Batch*, 32> m_batches;
+	HalfStaticArray<Batch*, 32> m_freeBatches;
+	HalfStaticArray<Batch*, 32> m_readyBatches;
+	Semaphore m_freeSem;		// released when batch is returned by the requester
+	Semaphore m_readySem;		// released when batch is passed to the requester
+	StatusHolder m_status;
+
+	Coordinator m_coordinator;
+	std::atomic<bool> m_stop;
+	ULONG m_countPP;
+	ULONG m_nextPP;
+	ULONG m_donePP;
+
+	// used by the requester only
+	Batch* m_current;
+	ULONG m_position;
+};
+
+
+TableScanTask::TableScanTask(thread_db* tdbb, MemoryPool* pool, jrd_rel* relation,
+		record_param* rpb, CommitNumber snapshot)
+	: Task(),
+	  m_pool(pool),
+	  m_dbb(tdbb->getDatabase()),
+	  m_relationId(relation->getId()),
+	  m_streamFlags(rpb->rpb_stream_flags & RPB_s_no_data),
+	  m_winFlags(rpb->getWindow(tdbb).win_flags & WIN_large_scan),
+	  m_orgScans(rpb->rpb_org_scans),
+	  m_tpb(*m_pool),
+	  m_items(*m_pool),
+	  m_batches(*m_pool),
+	  m_freeBatches(*m_pool),
+	  m_readyBatches(*m_pool),
+	  m_coordinator(m_pool),
+	  m_stop(false),
+	  m_countPP(0),
+	  m_nextPP(0),
+	  m_donePP(0),
+	  m_current(NULL),
+	  m_position(0)
+{
+	const jrd_tra* const transaction = tdbb->getRequest()->req_transaction;
+
+	// Workers use read only concurrency transactions sharing given snapshot
+
+	m_tpb.add(isc_tpb_version3);
+	m_tpb.add(isc_tpb_concurrency);
+	m_tpb.add(isc_tpb_read);
+
+	if (transaction->tra_flags & TRA_ignore_limbo)
+		m_tpb.add(isc_tpb_ignore_limbo);
+
+	m_tpb.add(isc_tpb_at_snapshot_number);
+	m_tpb.add(sizeof(snapshot));
+
+	for (unsigned i = 0; i < sizeof(snapshot); i++)
+		m_tpb.add(static_cast<UCHAR>(snapshot >> (i * 8)));
+
+	m_countPP = DPM_pointer_pages(tdbb, relation);
+}
+
+TableScanTask::~TableScanTask()
+{
+	for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		delete *p;
+
+	for (Batch** p = m_batches.begin(); p < m_batches.end(); p++)
+		delete *p;
+}
+
+// Start parallel scan of the relation, if it's allowed and makes sense.
+// Return NULL if relation should be scanned by the requester itself.
+TableScanTask* TableScanTask::start(thread_db* tdbb, record_param* rpb)
+{
+	jrd_rel* const relation = rpb->rpb_relation;
+	Database* const dbb = tdbb->getDatabase();
+	Attachment* const attachment = tdbb->getAttachment();
+	Request* const request = tdbb->getRequest();
+	jrd_tra* const transaction = request->req_transaction;
+
+	if (!attachment || attachment->isWorker() || attachment->att_parallel_workers < 2)
+		return NULL;
+
+	// Procedures and triggers may be called for every record of their caller
+	if (request->req_caller)
+		return NULL;
+
+	// Classic in single-user shutdown mode can't create additional worker attachments
+	if (dbb->isShutdown(shut_mode_single) && !(dbb->dbb_flags & DBB_shared))
+		return NULL;
+
+	if (relation->isTemporary() || relation->isVirtual() || relation->isView())
+		return NULL;
+
+	// Records fetched by workers are not positioned on the data pages and
+	// workers don't see changes of the requester's transaction, thus only
+	// read only transactions are handled.
+
+	if (!transaction || (transaction->tra_flags & (TRA_system | TRA_readonly)) != TRA_readonly ||
+		(rpb->rpb_stream_flags & RPB_s_update))
+	{
+		return NULL;
+	}
+
+	CommitNumber snapshot = 0;
+
+	if (!(transaction->tra_flags & TRA_read_committed))
+		snapshot = transaction->tra_snapshot_number;
+	else if (transaction->tra_flags & TRA_read_consistency)
+	{
+		const Request* const snapshotRequest = request->req_snapshot.m_owner;
+		if (snapshotRequest && !(snapshotRequest->req_flags & req_update_conflict))
+			snapshot = snapshotRequest->req_snapshot.m_number;
+	}
+
+	if (!snapshot)
+		return NULL;
+
+	if (DPM_pointer_pages(tdbb, relation) < 2)
+		return NULL;
+
+	AutoPtr<TableScanTask> task(FB_NEW_POOL(*dbb->dbb_permanent)
+		TableScanTask(tdbb, dbb->dbb_permanent, relation, rpb, snapshot));
+
+	const ULONG workers = MIN((ULONG) attachment->att_parallel_workers, task->m_countPP);
+
+	{	// scope
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+
+		for (ULONG i = 0; i < workers; i++)
+		{
+			FbLocalStatus status;
+			StableAttachmentPart* const attStable = WorkerAttachment::getAttachment(&status, dbb);
+			if (!attStable)
+				break;
+
+			task->m_items.add(FB_NEW_POOL(*task->m_pool) Item(task, attStable));
+		}
+
+		if (task->m_items.getCount() < 2)
+			return NULL;
+
+		const ULONG batches = task->m_items.getCount() * SCAN_BATCHES_PER_WORKER;
+
+		for (ULONG i = 0; i < batches; i++)
+		{
+			Batch* const batch = FB_NEW_POOL(*task->m_pool) Batch(*task->m_pool, SCAN_BATCH_SIZE);
+			task->m_batches.add(batch);
+			task->m_freeBatches.add(batch);
+		}
+
+		if (!task->m_coordinator.runAsync(task))
+			return NULL;
+	}
+
+	return task.release();
+}
+
+bool TableScanTask::handler(WorkItem& _item)
+{
+	Item* item = reinterpret_cast<Item*>(&_item);
+
+	ThreadContextHolder tdbb(NULL);
+
+	if (!item->init(tdbb))
+	{
+		setError(tdbb->tdbb_status_vector, true);
+		return false;
+	}
+
+	try
+	{
+		WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+		Database* const dbb = tdbb->getDatabase();
+		jrd_tra* const transaction = item->m_tra;
+		jrd_rel* const relation = MetadataCache::getVersioned<Cached::Relation>(tdbb, m_relationId,
+			CacheFlag::AUTOCREATE);
+
+		record_param rpb;
+		rpb.rpb_relation = relation;
+		rpb.rpb_stream_flags = m_streamFlags;
+		rpb.getWindow(tdbb).win_flags = m_winFlags;
+		rpb.rpb_org_scans = m_orgScans;
+
+		rpb.rpb_number.compose(dbb->dbb_max_records, dbb->dbb_dp_per_pp, 0, 0, item->m_ppSequence);
+		rpb.rpb_number.decrement();
+
+		RecordNumber lastRecNo;
+		lastRecNo.compose(dbb->dbb_max_records, dbb->dbb_dp_per_pp, 0, 0, item->m_ppSequence + 1);
+		lastRecNo.decrement();
+
+		Batch* batch = NULL;
+
+		Cleanup cleanAfterScan([&]
+		{
+			delete rpb.rpb_record;
+
+			if (batch)
+				putReadyBatch(batch);
+		});
+
+		while (!m_stop &&
+			VIO_next_record(tdbb, &rpb, transaction, transaction->tra_pool, DPM_next_pointer_page, &lastRecNo))
+		{
+			if (!batch && !(batch = getFreeBatch(tdbb)))
+				break;
+
+			const Record* const record = (m_streamFlags & RPB_s_no_data) ? NULL : rpb.rpb_record;
+
+			ScanRecord header;
+			header.number = rpb.rpb_number.getValue();
+			header.transaction = rpb.rpb_transaction_nr;
+			header.length = record ? record->getLength() : 0;
+			header.format = record ? record->getFormat()->fmt_version : 0;
+
+			const FB_SIZE_T offset = batch->getCount();
+			UCHAR* const p = batch->getBuffer(offset + SCAN_RECORD_SIZE + FB_ALIGN(header.length, FB_ALIGNMENT)) + offset;
+
+			memcpy(p, &header, sizeof(header));
+			if (record)
+				record->copyDataTo(p + SCAN_RECORD_SIZE);
+
+			if (batch->getCount() >= SCAN_BATCH_SIZE)
+			{
+				putReadyBatch(batch);
+				batch = NULL;
+			}
+
+			JRD_reschedule(tdbb);
+		}
+	}
+	catch (const Exception& ex)
+	{
+		ex.stuffException(tdbb->tdbb_status_vector);
+		setError(tdbb->tdbb_status_vector, true);
+		return false;
+	}
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	m_donePP++;
+	m_readySem.release();
+
+	return true;
+}
+
+bool TableScanTask::getWorkItem(WorkItem** pItem)
+{
+	Item* item = reinterpret_cast<Item*> (*pItem);
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (m_stop)
+		return false;
+
+	if (item == NULL)
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		{
+			if (!(*p)->m_inuse)
+			{
+				(*p)->m_inuse = true;
+				*pItem = item = *p;
+				break;
+			}
+		}
+	}
+
+	if (!item)
+		return false;
+
+	item->m_inuse = (m_nextPP < m_countPP);
+
+	if (item->m_inuse)
+		item->m_ppSequence = m_nextPP++;
+
+	return item->m_inuse;
+}
+
+bool TableScanTask::getResult(IStatus* status)
+{
+	if (status)
+	{
+		status->init();
+		status->setErrors(m_status.getErrors());
+	}
+
+	return m_status.isSuccess();
+}
+
+int TableScanTask::getMaxWorkers()
+{
+	return MIN(m_items.getCount(), m_countPP);
+}
+
+// Worker: get empty batch, wait for the requester to return one if necessary
+TableScanTask::Batch* TableScanTask::getFreeBatch(thread_db* tdbb)
+{
+	while (!m_stop)
+	{
+		{	// scope
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			if (m_freeBatches.hasData())
+				return m_freeBatches.pop();
+		}
+
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+		m_freeSem.tryEnter(1);
+	}
+
+	return NULL;
+}
+
+// Worker: pass batch of records to the requester
+void TableScanTask::putReadyBatch(Batch* batch)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (batch->hasData())
+		m_readyBatches.add(batch);
+	else
+		m_freeBatches.push(batch);
+
+	m_readySem.release();
+}
+
+// Requester: get next batch of records, return NULL when the scan is complete
+TableScanTask::Batch* TableScanTask::getReadyBatch(thread_db* tdbb)
+{
+	while (true)
+	{
+		{	// scope
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			if (m_readyBatches.hasData())
+			{
+				Batch* const batch = m_readyBatches[0];
+				m_readyBatches.remove((FB_SIZE_T) 0);
+				return batch;
+			}
+
+			if (!m_status.isSuccess())
+			{
+				FbLocalStatus status;
+				getResult(&status);
+				status.raise();
+			}
+
+			if (m_stop || m_donePP == m_countPP)
+				return NULL;
+		}
+
+		{	// scope
+			EngineCheckout cout(tdbb, FB_FUNCTION);
+			m_readySem.tryEnter(1);
+		}
+
+		JRD_reschedule(tdbb);
+	}
+}
+
+// Requester: return processed batch to the workers
+void TableScanTask::releaseBatch(Batch* batch)
+{
+	batch->clear();
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	m_freeBatches.push(batch);
+	m_freeSem.release();
+}
+
+bool TableScanTask::getRecord(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
+{
+	while (!m_current || m_position >= m_current->getCount())
+	{
+		if (m_current)
+		{
+			releaseBatch(m_current);
+			m_current = NULL;
+		}
+
+		m_current = getReadyBatch(tdbb);
+		m_position = 0;
+
+		if (!m_current)
+			return false;
+	}
+
+	ScanRecord header;
+	const UCHAR* const p = m_current->begin() + m_position;
+	memcpy(&header, p, sizeof(header));
+	m_position += SCAN_RECORD_SIZE + FB_ALIGN(header.length, FB_ALIGNMENT);
+
+	rpb->rpb_number.setValue(header.number);
+	rpb->rpb_transaction_nr = header.transaction;
+	rpb->rpb_flags = 0;
+	rpb->rpb_page = 0;
+	rpb->rpb_line = 0;
+
+	if (header.length)
+	{
+		rpb->rpb_format_number = header.format;
+
+		Record* const record = VIO_record(tdbb, rpb, NULL, pool);
+		fb_assert(record->getLength() == header.length);
+		record->copyDataFrom(p + SCAN_RECORD_SIZE);
+	}
+
+	tdbb->bumpStats(RecordStatType::SEQ_READS, rpb->rpb_relation->getId());
+	return true;
+}
+
+// Requester: stop the workers and wait for them
+void TableScanTask::stop(thread_db* tdbb)
+{
+	{	// scope
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		m_stop = true;
+	}
+
+	m_freeSem.release(m_items.getCount());
+
+	EngineCheckout cout(tdbb, FB_FUNCTION);
+	m_coordinator.waitAsync();
+}
+
+} // namespace Jrd
+
 // -------------------------------------------
 // Data access: sequential complete table scan
 // -------------------------------------------
 
 FullTableScan::FullTableScan(CompilerScratch* csb, const string& alias,
 							 StreamType stream, Rsc::Rel relation,
-							 const Array<DbKeyRangeNode*>& dbkeyRanges)
+							 const Array<DbKeyRangeNode*>& dbkeyRanges,
+							 InversionNode* blockRange)
 	: RecordStream(csb, stream),
 	  m_alias(csb->csb_pool, alias),
 	  m_relation(relation),
-	  m_dbkeyRanges(csb->csb_pool, dbkeyRanges)
+	  m_dbkeyRanges(csb->csb_pool, dbkeyRanges),
+	  m_blockRange(blockRange)
 {
+	fb_assert(!m_blockRange || (m_dbkeyRanges.isEmpty() && m_blockRange->type == InversionNode::TYPE_INDEX));
+
 	m_impure = csb->allocImpure<Impure>();
 	m_cardinality = csb->csb_rpt[stream].csb_cardinality;
 }
@@ -88,6 +685,25 @@ void FullTableScan::internalOpen(thread_db* tdbb) const
 
 	rpb->rpb_number.setValue(BOF_NUMBER);
 
+	impure->irsb_task = nullptr;
+	impure->irsb_ranges = nullptr;
+	impure->irsb_range = 0;
+
+	if (m_blockRange)
+	{
+		// Read only the ranges of data pages whose summaries match the bounds
+
+		impure->irsb_ranges = FB_NEW_POOL(*tdbb->getDefaultPool())
+			RecordRangeList(*tdbb->getDefaultPool());
+
+		RNG_evaluate(tdbb, m_blockRange->retrieval, *impure->irsb_ranges);
+
+		if (impure->irsb_ranges->hasData())
+			rpb->rpb_number.setValue(impure->irsb_ranges->front().lower - 1);
+	}
+	else if (m_parallel && m_dbkeyRanges.isEmpty())
+		impure->irsb_task = TableScanTask::start(tdbb, rpb);
+
 	if (m_dbkeyRanges.hasData())
 	{
 		impure->irsb_lower.setValid(false);
@@ -123,6 +739,16 @@ void FullTableScan::close(thread_db* tdbb) const
 	{
 		impure->irsb_flags &= ~irsb_open;
 
+		if (impure->irsb_task)
+		{
+			AutoPtr<TableScanTask> task(impure->irsb_task);
+			impure->irsb_task = nullptr;
+			task->stop(tdbb);
+		}
+
+		delete impure->irsb_ranges;
+		impure->irsb_ranges = nullptr;
+
 		record_param* const rpb = &request->req_rpb[m_stream];
 		if ((rpb->getWindow(tdbb).win_flags & WIN_large_scan) &&
 			m_relation()->rel_scan_count)
@@ -146,6 +772,41 @@ bool FullTableScan::internalGetRecord(thread_db* tdbb) const
 		return false;
 	}
 
+	if (impure->irsb_task)
+	{
+		if (impure->irsb_task->getRecord(tdbb, rpb, request->req_pool))
+		{
+			rpb->rpb_number.setValid(true);
+			return true;
+		}
+
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
+	if (const auto ranges = impure->irsb_ranges)
+	{
+		while (impure->irsb_range < ranges->getCount())
+		{
+			const RecordNumber upper((*ranges)[impure->irsb_range].upper);
+
+			if (VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all, &upper))
+			{
+				rpb->rpb_number.setValid(true);
+				return true;
+			}
+
+			// Position prior to the first record of the next range,
+			// the record fetched past the upper bound might be inside it
+
+			if (++impure->irsb_range < ranges->getCount())
+				rpb->rpb_number.setValue((*ranges)[impure->irsb_range].lower - 1);
+		}
+
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
 	const RecordNumber* upper = impure->irsb_upper.isValid() ? &impure->irsb_upper : nullptr;
 
 	if (VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all, upper))
@@ -191,6 +852,19 @@ void FullTableScan::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsig
 	else if (upperBounds)
 		bounds += " (upper bound)";
 
+	if (m_blockRange)
+	{
+		const auto retrieval = m_blockRange->retrieval.getObject();
+
+		QualifiedName indexName;
+		if (retrieval->irb_name && retrieval->irb_name->object.hasData())
+			indexName = *retrieval->irb_name;
+		else
+			indexName.object.printf("<index id %d>", retrieval->irb_index + 1);
+
+		bounds += " (block range index " + printName(tdbb, indexName.toQuotedString()) + ")";
+	}
+
 	planEntry.lines.add().text = "Table " +
 		printName(tdbb, m_relation()->getName().toQuotedString(), m_alias) + " Full Scan" + bounds;
 	printOptInfo(planEntry.lines);
@@ -31,9 +31,14 @@
 #include "../jrd/mov_proto.h"
 #include "../jrd/intl_proto.h"
 #include "../jrd/optimizer/Optimizer.h"
+#include "../jrd/Attachment.h"
+#include "../common/Task.h"
 
 #include "RecordSource.h"
 
+#include <algorithm>
+#include <atomic>
+
 using namespace Firebird;
 using namespace Jrd;
 
@@ -43,9 +48,12 @@ using namespace Jrd;
 // Data access: hash join
 // ----------------------
 
-// NS: FIXME - Why use static hash table here??? Hash table shall support dynamic resizing
+// Minimal size of the hash table, it grows with the number of records
 static constexpr ULONG HASH_SIZE = 1009;
-static constexpr ULONG BUCKET_PREALLOCATE_SIZE = 32;	// 256 bytes per bucket
+// Average number of collisions per slot in the hash table
+static constexpr ULONG HASH_SLOT_COLLISIONS = 4;
+// Minimal number of hashed records worth building the table by parallel workers
+static constexpr ULONG MIN_PARALLEL_HASH_RECORDS = 65536;
 
 unsigned HashJoin::maxCapacity() noexcept
 {
@@ -58,71 +66,193 @@ unsigned HashJoin::maxCapacity() noexcept
 
 class HashJoin::HashTable final : public PermanentStorage
 {
+	struct Entry
+	{
+		ULONG hash;
+		ULONG position;
+	};
+
+	// Collisions of a single stream. Entries of all slots are stored in one array:
+	// once the table is built, they're grouped by slots and ordered by hash inside
+	// every slot, and m_slots holds the index of the first entry of every slot.
+	//
+	// The table is built by partitions, every partition being a contiguous range
+	// of slots. The entries are counted and scattered into partitions by chunks,
+	// then every partition is ordered separately, so all steps but the small
+	// prefix sum between them may be done by parallel workers.
 	class CollisionList
 	{
-		static constexpr FB_SIZE_T INVALID_ITERATOR = FB_SIZE_T(~0);
+	public:
+		CollisionList(MemoryPool& pool)
+			: m_entries(pool), m_slots(pool), m_buffer(pool),
+			  m_offsets(pool), m_starts(pool),
+			  m_tableSize(0), m_partitions(0),
+			  m_iterator(0), m_end(0)
+		{}
 
-		struct Entry
+		ULONG getCount() const noexcept
+		{
+			return (ULONG) m_entries.getCount();
+		}
+
+		void add(ULONG hash, ULONG position)
 		{
-			Entry() noexcept
-				: hash(0), position(0)
-			{}
+			Entry& entry = m_entries.add();
+			entry.hash = hash;
+			entry.position = position;
+		}
+
+		void prepare(ULONG tableSize, ULONG partitions)
+		{
+			m_tableSize = tableSize;
+			m_partitions = partitions;
+
+			m_slots.getBuffer(tableSize + 1);
+			m_buffer.getBuffer(m_entries.getCount());
+
+			// Number of entries of every partition in every chunk
+			ULONG* const offsets = m_offsets.getBuffer(partitions * partitions);
+			memset(offsets, 0, partitions * partitions * sizeof(ULONG));
+
+			m_starts.getBuffer(partitions + 1);
+		}
+
+		// Count entries of the chunk falling into every partition
+		void count(ULONG chunk) noexcept
+		{
+			ULONG* const offsets = m_offsets.begin() + chunk * m_partitions;
+
+			ULONG begin, end;
+			getChunk(chunk, begin, end);
+
+			for (ULONG i = begin; i < end; i++)
+				offsets[getPartition(m_entries[i].hash)]++;
+		}
 
-			Entry(ULONG h, ULONG pos) noexcept
-				: hash(h), position(pos)
-			{}
+		// Turn the counters into the positions of chunks inside partitions
+		void locate() noexcept
+		{
+			ULONG offset = 0;
 
-			static const ULONG generate(const Entry& item) noexcept
+			for (ULONG partition = 0; partition < m_partitions; partition++)
 			{
-				return item.hash;
+				m_starts[partition] = offset;
+
+				for (ULONG chunk = 0; chunk < m_partitions; chunk++)
+				{
+					ULONG& counter = m_offsets[chunk * m_partitions + partition];
+					const ULONG count = counter;
+					counter = offset;
+					offset += count;
+				}
 			}
 
-			ULONG hash;
-			ULONG position;
-		};
+			fb_assert(offset == getCount());
 
-	public:
-		CollisionList(MemoryPool& pool)
-			: m_collisions(pool, BUCKET_PREALLOCATE_SIZE),
-			  m_iterator(INVALID_ITERATOR)
-		{
-			m_collisions.setSortMode(FB_ARRAY_SORT_MANUAL);
+			m_starts[m_partitions] = offset;
+			m_slots[m_tableSize] = offset;
 		}
 
-		void sort()
+		// Move entries of the chunk into their partitions
+		void scatter(ULONG chunk) noexcept
 		{
-			m_collisions.sort();
+			ULONG* const offsets = m_offsets.begin() + chunk * m_partitions;
+
+			ULONG begin, end;
+			getChunk(chunk, begin, end);
+
+			for (ULONG i = begin; i < end; i++)
+			{
+				const Entry& entry = m_entries[i];
+				m_buffer[offsets[getPartition(entry.hash)]++] = entry;
+			}
 		}
 
-		ULONG getCount() const noexcept
+		// Group entries of the partition by slots and order them inside slots.
+		// Only the slots of this partition are touched, the first slot of
+		// the next partition may be changed by another worker at this time.
+		void order(ULONG partition) noexcept
 		{
-			return (ULONG) m_collisions.getCount();
+			ULONG fromSlot, toSlot;
+			getSlots(partition, fromSlot, toSlot);
+
+			const ULONG begin = m_starts[partition];
+			const ULONG end = m_starts[partition + 1];
+
+			ULONG* const slots = m_slots.begin();
+			memset(slots + fromSlot, 0, (toSlot - fromSlot) * sizeof(ULONG));
+
+			for (ULONG i = begin; i < end; i++)
+				slots[m_buffer[i].hash % m_tableSize]++;
+
+			ULONG offset = begin;
+
+			for (ULONG slot = fromSlot; slot < toSlot; slot++)
+			{
+				const ULONG count = slots[slot];
+				slots[slot] = offset;
+				offset += count;
+			}
+
+			for (ULONG i = begin; i < end; i++)
+			{
+				const Entry& entry = m_buffer[i];
+				m_entries[slots[entry.hash % m_tableSize]++] = entry;
+			}
+
+			// Now every slot points to the end of its entries, shift them back
+
+			for (ULONG slot = toSlot; slot > fromSlot + 1; slot--)
+				slots[slot - 1] = slots[slot - 2];
+
+			if (fromSlot < toSlot)
+				slots[fromSlot] = begin;
+
+			for (ULONG slot = fromSlot; slot < toSlot; slot++)
+			{
+				const ULONG last = (slot + 1 < toSlot) ? slots[slot + 1] : end;
+				sort(m_entries.begin() + slots[slot], m_entries.begin() + last);
+			}
 		}
 
-		void add(ULONG hash, ULONG position)
+		void finish()
 		{
-			m_collisions.add(Entry(hash, position));
+			m_buffer.free();
+			m_offsets.free();
+			m_starts.free();
 		}
 
-		bool locate(ULONG hash)
+		bool locate(ULONG slot, ULONG hash) noexcept
 		{
-			if (m_collisions.find(hash, m_iterator))
-				return true;
+			ULONG lo = m_slots[slot];
+			ULONG hi = m_slots[slot + 1];
 
-			m_iterator = INVALID_ITERATOR;
-			return false;
+			while (lo < hi)
+			{
+				const ULONG mid = (lo + hi) / 2;
+
+				if (m_entries[mid].hash < hash)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+
+			m_iterator = lo;
+			m_end = m_slots[slot + 1];
+
+			return (m_iterator < m_end && m_entries[m_iterator].hash == hash);
 		}
 
 		bool iterate(ULONG hash, ULONG& position) noexcept
 		{
-			if (m_iterator >= m_collisions.getCount())
+			if (m_iterator >= m_end)
 				return false;
 
-			const Entry& collision = m_collisions[m_iterator++];
+			const Entry& collision = m_entries[m_iterator++];
 
 			if (hash != collision.hash)
 			{
-				m_iterator = INVALID_ITERATOR;
+				m_iterator = m_end;
 				return false;
 			}
 
@@ -131,22 +261,83 @@ class HashJoin::HashTable final : public PermanentStorage
 		}
 
 	private:
-		SortedArray<Entry, EmptyStorage<Entry>, ULONG, Entry> m_collisions;
-		FB_SIZE_T m_iterator;
+		static void sort(Entry* begin, Entry* end) noexcept
+		{
+			// Most slots hold a few entries, so use insertion sort for them
+
+			if (end - begin <= 16)
+			{
+				for (Entry* i = begin + 1; i < end; i++)
+				{
+					const Entry entry = *i;
+					Entry* j = i;
+
+					for (; j > begin && (j - 1)->hash > entry.hash; j--)
+						*j = *(j - 1);
+
+					*j = entry;
+				}
+			}
+			else
+			{
+				std::sort(begin, end, [](const Entry& a, const Entry& b) {
+					return a.hash < b.hash;
+				});
+			}
+		}
+
+		ULONG getPartitionSize() const noexcept
+		{
+			return (m_tableSize + m_partitions - 1) / m_partitions;
+		}
+
+		ULONG getPartition(ULONG hash) const noexcept
+		{
+			return (hash % m_tableSize) / getPartitionSize();
+		}
+
+		void getSlots(ULONG partition, ULONG& fromSlot, ULONG& toSlot) const noexcept
+		{
+			const ULONG size = getPartitionSize();
+			fromSlot = MIN(partition * size, m_tableSize);
+			toSlot = MIN(fromSlot + size, m_tableSize);
+		}
+
+		void getChunk(ULONG chunk, ULONG& begin, ULONG& end) const noexcept
+		{
+			const ULONG count = getCount();
+			const ULONG size = (count + m_partitions - 1) / m_partitions;
+			begin = MIN(chunk * size, count);
+			end = MIN(begin + size, count);
+		}
+
+		Array<Entry> m_entries;
+		Array<ULONG> m_slots;
+		Array<Entry> m_buffer;		// entries grouped by partitions
+		Array<ULONG> m_offsets;		// position of every chunk inside every partition
+		Array<ULONG> m_starts;		// position of every partition
+		ULONG m_tableSize;
+		ULONG m_partitions;
+		ULONG m_iterator;
+		ULONG m_end;
 	};
 
+	class BuildTask;
+
 public:
-	HashTable(MemoryPool& pool, ULONG streamCount, ULONG tableSize = HASH_SIZE)
+	HashTable(MemoryPool& pool, ULONG streamCount)
 		: PermanentStorage(pool), m_streamCount(streamCount),
-		  m_tableSize(tableSize), m_slot(0)
+		  m_tableSize(0), m_slot(0)
 	{
-		m_collisions = FB_NEW_POOL(pool) CollisionList*[streamCount * tableSize];
-		memset(m_collisions, 0, streamCount * tableSize * sizeof(CollisionList*));
+		m_collisions = FB_NEW_POOL(pool) CollisionList*[streamCount];
+
+		for (ULONG i = 0; i < m_streamCount; i++)
+			m_collisions[i] = FB_NEW_POOL(pool) CollisionList(pool);
 	}
 
 	~HashTable()
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
+		for (ULONG i = 0; i < m_streamCount; i++)
 			delete m_collisions[i];
 
 		delete[] m_collisions;
@@ -154,20 +345,10 @@ public:
 
 	void put(ULONG stream, ULONG hash, ULONG position)
 	{
-		const ULONG slot = hash % m_tableSize;
-
 		fb_assert(stream < m_streamCount);
-		fb_assert(slot < m_tableSize);
+		fb_assert(!m_tableSize);
 
-		CollisionList* collisions = m_collisions[stream * m_tableSize + slot];
-
-		if (!collisions)
-		{
-			collisions = FB_NEW_POOL(getPool()) CollisionList(getPool());
-			m_collisions[stream * m_tableSize + slot] = collisions;
-		}
-
-		collisions->add(hash, position);
+		m_collisions[stream]->add(hash, position);
 	}
 
 	bool setup(ULONG hash)
@@ -176,12 +357,7 @@ public:
 
 		for (ULONG i = 0; i < m_streamCount; i++)
 		{
-			CollisionList* const collisions = m_collisions[i * m_tableSize + slot];
-
-			if (!collisions)
-				return false;
-
-			if (!collisions->locate(hash))
+			if (!m_collisions[i]->locate(slot, hash))
 				return false;
 		}
 
@@ -193,62 +369,190 @@ public:
 	{
 		fb_assert(stream < m_streamCount);
 
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		collisions->locate(hash);
+		m_collisions[stream]->locate(m_slot, hash);
 	}
 
 	bool iterate(ULONG stream, ULONG hash, ULONG& position) noexcept
 	{
 		fb_assert(stream < m_streamCount);
 
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		return collisions->iterate(hash, position);
+		return m_collisions[stream]->iterate(hash, position);
 	}
 
-	void sort()
+	void build(thread_db* tdbb);
+
+private:
+	const ULONG m_streamCount;
+	ULONG m_tableSize;
+	CollisionList** m_collisions;
+	ULONG m_slot;
+};
+
+
+// Builds the hash table by parallel workers. Every step is run for all streams
+// at once, every work item is a chunk or a partition of the single stream.
+
+class HashJoin::HashTable::BuildTask : public Task
+{
+public:
+	enum Step { COUNT, SCATTER, ORDER };
+
+	BuildTask(MemoryPool& pool, HashTable* table, ULONG partitions)
+		: m_items(pool),
+		  m_step(COUNT),
+		  m_nextItem(0)
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
+		for (ULONG stream = 0; stream < table->m_streamCount; stream++)
 		{
-			if (const auto collisions = m_collisions[i])
-				collisions->sort();
+			for (ULONG i = 0; i < partitions; i++)
+			{
+				Item* const item = FB_NEW_POOL(pool) Item(this);
+				item->m_collisions = table->m_collisions[stream];
+				item->m_index = i;
+				m_items.add(item);
+			}
 		}
+	}
 
-#ifdef PRINT_HASH_TABLE
-		FB_UINT64 total = 0;
-		ULONG min = MAX_ULONG, max = 0, count = 0;
+	~BuildTask()
+	{
+		for (auto item : m_items)
+			delete item;
+	}
+
+	void setStep(Step step)
+	{
+		m_step = step;
+		m_nextItem = 0;
+	}
+
+	bool handler(WorkItem& workItem) override
+	{
+		const Item* const item = static_cast<Item*>(&workItem);
 
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
+		switch (m_step)
 		{
-			CollisionList* const collisions = m_collisions[i];
-			if (!collisions)
-				continue;
+			case COUNT:
+				item->m_collisions->count(item->m_index);
+				break;
 
-			const auto cnt = collisions->getCount();
+			case SCATTER:
+				item->m_collisions->scatter(item->m_index);
+				break;
 
-			if (cnt < min)
-				min = cnt;
-			if (cnt > max)
-				max = cnt;
-			total += cnt;
-			count++;
+			case ORDER:
+				item->m_collisions->order(item->m_index);
+				break;
 		}
 
-		if (count)
-		{
-			printf("Hash table size %u, count %u, buckets %u, min %u, max %u, avg %u\n",
-				   m_tableSize, (ULONG) total, count, min, max, (ULONG) (total / count));
-		}
-#endif
+		return true;
+	}
+
+	bool getWorkItem(WorkItem** pItem) override
+	{
+		const ULONG n = m_nextItem++;
+		if (n >= m_items.getCount())
+			return false;
+
+		*pItem = m_items[n];
+		return true;
+	}
+
+	bool getResult(IStatus*) override
+	{
+		return true;
+	}
+
+	int getMaxWorkers() override
+	{
+		return m_items.getCount();
 	}
 
 private:
-	const ULONG m_streamCount;
-	const ULONG m_tableSize;
-	CollisionList** m_collisions;
-	ULONG m_slot;
+	class Item : public Task::WorkItem
+	{
+	public:
+		Item(BuildTask* task)
+			: Task::WorkItem(task)
+		{}
+
+		CollisionList* m_collisions = nullptr;
+		ULONG m_index = 0;
+	};
+
+	HalfStaticArray<Item*, 8> m_items;
+	Step m_step;
+	std::atomic<ULONG> m_nextItem;
 };
 
 
+// Group collisions by slots and order them inside slots, making the table
+// ready for lookups. Table size is chosen depending on the number of records.
+void HashJoin::HashTable::build(thread_db* tdbb)
+{
+	fb_assert(!m_tableSize);
+
+	ULONG maxCount = 0, totalCount = 0;
+
+	for (ULONG i = 0; i < m_streamCount; i++)
+	{
+		const ULONG count = m_collisions[i]->getCount();
+
+		maxCount = MAX(maxCount, count);
+		totalCount += count;
+	}
+
+	m_tableSize = MAX(HASH_SIZE, maxCount / HASH_SLOT_COLLISIONS) | 1;
+
+	// Worker attachments are used by a parallel task already, don't nest
+
+	const Attachment* const att = tdbb->getAttachment();
+	ULONG partitions = (att && !att->isWorker()) ?
+		MIN((ULONG) att->att_parallel_workers, totalCount / MIN_PARALLEL_HASH_RECORDS) : 0;
+	partitions = MAX(partitions, 1);
+
+	for (ULONG i = 0; i < m_streamCount; i++)
+		m_collisions[i]->prepare(m_tableSize, partitions);
+
+	if (partitions == 1)
+	{
+		for (ULONG i = 0; i < m_streamCount; i++)
+		{
+			CollisionList* const collisions = m_collisions[i];
+
+			collisions->count(0);
+			collisions->locate();
+			collisions->scatter(0);
+			collisions->order(0);
+		}
+	}
+	else
+	{
+		BuildTask task(getPool(), this, partitions);
+		Coordinator coord(&getPool());
+
+		coord.runSync(&task);
+
+		for (ULONG i = 0; i < m_streamCount; i++)
+			m_collisions[i]->locate();
+
+		task.setStep(BuildTask::SCATTER);
+		coord.runSync(&task);
+
+		task.setStep(BuildTask::ORDER);
+		coord.runSync(&task);
+	}
+
+	for (ULONG i = 0; i < m_streamCount; i++)
+		m_collisions[i]->finish();
+
+#ifdef PRINT_HASH_TABLE
+	printf("Hash table size %u, streams %u, count %u, max %u, partitions %u\n",
+		   m_tableSize, m_streamCount, totalCount, maxCount, partitions);
+#endif
+}
+
+
 HashJoin::HashJoin(thread_db* tdbb, CompilerScratch* csb, JoinType joinType,
 				   FB_SIZE_T count, RecordSource* const* args, NestValueArray* const* keys,
 				   double selectivity)
@@ -456,7 +760,7 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 					}
 				}
 
-				impure->irsb_hash_table->sort();
+				impure->irsb_hash_table->build(tdbb);
 			}
 
 			// Compute and hash the comparison keys
@@ -25,6 +25,7 @@
 #include "../jrd/btr_proto.h"
 #include "../jrd/cch_proto.h"
 #include "../jrd/cmp_proto.h"
+#include "../jrd/dpm_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/met_proto.h"
 #include "../jrd/vio_proto.h"
@@ -230,6 +231,7 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 		}
 
 		IndexKey recordKey(tdbb, m_relation(tdbb), idx);
+		HalfStaticArray<UCHAR, 128> payload(*tdbb->getDefaultPool());
 
 		// Find the next interesting node. If necessary, skip to the next page.
 		RecordNumber number;
@@ -326,12 +328,35 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 				continue;
 			}
 
+			// Non-key values of the leaf node are needed after the page is released
+			if (m_indexOnly)
+				payload.assign(node.payload, node.payloadLength);
+
 			// reset the current navigational position in the index
 			rpb->rpb_number = number;
 			setPosition(tdbb, impure, rpb, &window, pointer, key);
 
 			CCH_RELEASE(tdbb, &window);
 
+			// If the data page is known to contain only records visible to everybody,
+			// the record is restored from the key and the page is not read at all
+
+			if (m_indexOnly && DPM_all_visible(tdbb, rpb) &&
+				((rpb->rpb_stream_flags & RPB_s_no_data) ||
+					BTR_decode_key(idx, &key, payload.begin(), (USHORT) payload.getCount(),
+						VIO_record(tdbb, rpb, m_format, request->req_pool))))
+			{
+				rpb->rpb_format_number = m_format->fmt_version;
+				rpb->rpb_transaction_nr = 0;
+				rpb->rpb_runtime_flags &= ~RPB_UNDO_FLAGS;
+
+				RBM_SET(tdbb->getDefaultPool(), &impure->irsb_nav_records_visited,
+						rpb->rpb_number.getValue());
+
+				rpb->rpb_number.setValid(true);
+				return true;
+			}
+
 			if (VIO_get(tdbb, rpb, request->req_transaction, request->req_pool))
 			{
 				if (const auto result = recordKey.compose(rpb->rpb_record))
@@ -374,6 +399,18 @@ void IndexTableScan::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level
 	if (!level)
 		plan += "(";
 
+	if (!m_ordered)
+	{
+		string indices;
+		printLegacyInversion(tdbb, m_index, indices);
+		plan += printName(tdbb, m_alias) + " INDEX (" + indices + ")";
+
+		if (!level)
+			plan += ")";
+
+		return;
+	}
+
 	plan += printName(tdbb, m_alias) + " ORDER ";
 	string index;
 	printLegacyInversion(tdbb, m_index, index);
@@ -396,7 +433,8 @@ void IndexTableScan::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsi
 	planEntry.className = "IndexTableScan";
 
 	planEntry.lines.add().text = "Table " +
-		printName(tdbb, m_relation()->getName().toQuotedString(), m_alias) + " Access By ID";
+		printName(tdbb, m_relation()->getName().toQuotedString(), m_alias) +
+		(m_indexOnly ? " Index Only Access" : " Access By ID");
 	printOptInfo(planEntry.lines);
 
 	printInversion(tdbb, m_index, planEntry.lines, true, 1, true);
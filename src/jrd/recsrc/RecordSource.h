@@ -29,6 +29,7 @@
 #include "../common/classes/NestConst.h"
 #include "../jrd/RecordSourceNodes.h"
 #include "../jrd/req.h"
+#include "../jrd/btr.h"
 #include "../jrd/RecordBuffer.h"
 #include "firebird/impl/inf_pub.h"
 #include "../jrd/evl_proto.h"
@@ -52,6 +53,7 @@ namespace Jrd
 	class BaseBufferedStream;
 	class BufferedStream;
 	class PlanEntry;
+	class TableScanTask;
 
 	enum class JoinType { INNER, OUTER, SEMI, ANTI };
 
@@ -145,6 +147,11 @@ namespace Jrd
 		virtual void markRecursive() = 0;
 		virtual void invalidateRecords(Request* request) const = 0;
 
+		// Let the driving table scan of the tree be read by parallel workers.
+		// Record sources which may reopen or reposition their input ignore it.
+		virtual void markParallel()
+		{}
+
 		virtual void findUsedStreams(StreamList& streams, bool expandAll = false) const = 0;
 		virtual bool isDependent(const StreamList& streams) const = 0;
 		virtual void nullRecords(thread_db* tdbb) const = 0;
@@ -235,17 +242,26 @@ namespace Jrd
 		{
 			RecordNumber irsb_lower;
 			RecordNumber irsb_upper;
+			TableScanTask* irsb_task;
+			RecordRangeList* irsb_ranges;
+			FB_SIZE_T irsb_range;
 		};
 
 	public:
 		FullTableScan(CompilerScratch* csb, const Firebird::string& alias,
 					  StreamType stream, Rsc::Rel relation,
-					  const Firebird::Array<DbKeyRangeNode*>& dbkeyRanges);
+					  const Firebird::Array<DbKeyRangeNode*>& dbkeyRanges,
+					  InversionNode* blockRange = nullptr);
 
 		void close(thread_db* tdbb) const override;
 
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		void markParallel() override
+		{
+			m_parallel = true;
+		}
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -255,6 +271,8 @@ namespace Jrd
 		const Firebird::string m_alias;
 		const Rsc::Rel m_relation;
 		Firebird::Array<DbKeyRangeNode*> m_dbkeyRanges;
+		NestConst<InversionNode> const m_blockRange;
+		bool m_parallel = false;
 	};
 
 	class BitmapTableScan final : public RecordStream
@@ -322,6 +340,18 @@ namespace Jrd
 			m_condition = condition;
 		}
 
+		const index_desc* getIndex() const
+		{
+			return &m_index->retrieval->irb_desc;
+		}
+
+		// Unordered index only walk replaces the bitmap scan, it keeps the legacy plan of the latter
+		void setIndexOnly(bool ordered = true)
+		{
+			m_indexOnly = true;
+			m_ordered = ordered;
+		}
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -346,6 +376,8 @@ namespace Jrd
 		NestConst<BoolExprNode> m_condition;
 		const FB_SIZE_T m_length;
 		FB_SIZE_T m_offset;
+		bool m_indexOnly = false;
+		bool m_ordered = true;
 	};
 
 	class ExternalTableScan final : public RecordStream
@@ -594,6 +626,7 @@ namespace Jrd
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
 		void markRecursive() override;
+		void markParallel() override;
 		void invalidateRecords(Request* request) const override;
 
 		void findUsedStreams(StreamList& streams, bool expandAll = false) const override;
@@ -714,6 +747,7 @@ namespace Jrd
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
 		void markRecursive() override;
+		void markParallel() override;
 		void invalidateRecords(Request* request) const override;
 
 		void findUsedStreams(StreamList& streams, bool expandAll = false) const override;
@@ -896,6 +930,7 @@ namespace Jrd
 		WriteLockResult lockRecord(thread_db* tdbb) const override;
 
 		void markRecursive() override;
+		void markParallel() override;
 		void invalidateRecords(Request* request) const override;
 
 		void findUsedStreams(StreamList& streams, bool expandAll = false) const override;
@@ -1314,6 +1349,12 @@ namespace Jrd
 		void close(thread_db* tdbb) const override;
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		void markParallel() override
+		{
+			// Inner streams are reopened for every outer record
+			m_args.front()->markParallel();
+		}
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -1377,6 +1418,11 @@ namespace Jrd
 		void close(thread_db* tdbb) const override;
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		void markParallel() override
+		{
+			m_leader.source->markParallel();
+		}
+
 		static unsigned maxCapacity() noexcept;
 
 	protected:
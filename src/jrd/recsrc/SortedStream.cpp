@@ -165,6 +165,11 @@ void SortedStream::markRecursive()
 	m_next->markRecursive();
 }
 
+void SortedStream::markParallel()
+{
+	m_next->markParallel();
+}
+
 void SortedStream::findUsedStreams(StreamList& streams, bool expandAll) const
 {
 	m_next->findUsedStreams(streams, expandAll);
@@ -390,7 +395,8 @@ void SortedStream::mapData(thread_db* tdbb, Request* request, UCHAR* data) const
 
 			// If transaction ID is present, then fields from this stream are accessed.
 			// So we need to refetch the stream, either immediately or on demand.
-			const auto refetch = (id == ID_TRANS);
+			// Records restored from index keys are stored in the sort as a whole.
+			const auto refetch = (id == ID_TRANS) && !(rpb->rpb_stream_flags & RPB_s_index_only);
 
 			if (refetch && relation &&
 				!relation->getExtFile() &&
@@ -86,6 +86,7 @@ RELATION(nam_i_segments, rel_segments, ODS_8_0, rel_persistent)
 	FIELD(f_seg_statistics, nam_statistics, fld_statistics, 1, ODS_11_0)
 	FIELD(f_seg_schema, nam_sch_name, fld_sch_name, 1, ODS_14_0)
 	FIELD(f_seg_pkg_name, nam_pkg_name, fld_pkg_name, 1, ODS_14_0)
+	FIELD(f_seg_include_flag, nam_include_flag, fld_flag_nullable, 1, ODS_14_0)
 END_RELATION
 
 // Relation 4 (RDB$INDICES)
@@ -109,6 +110,7 @@ RELATION(nam_indices, rel_indices, ODS_8_0, rel_persistent)
 	FIELD(f_idx_foreign_schema, nam_foreign_sch_name, fld_sch_name, 1, ODS_14_0)
 	FIELD(f_idx_format, nam_fmt, fld_format, 1, ODS_14_0)
 	FIELD(f_idx_pkg_name, nam_pkg_name, fld_pkg_name, 1, ODS_14_0)
+	FIELD(f_idx_histogram, nam_histogram, fld_histogram, 1, ODS_14_0)
 END_RELATION
 
 // Relation 5 (RDB$RELATION_FIELDS)
@@ -137,6 +139,7 @@ RELATION(nam_r_fields, rel_rfr, ODS_8_0, rel_persistent)
 	FIELD(f_rfr_schema, nam_sch_name, fld_sch_name, 1, ODS_14_0)
 	FIELD(f_rfr_field_source_schema, nam_field_source_sch_name, fld_sch_name, 1, ODS_14_0)
 	FIELD(f_rfr_pkg_name, nam_pkg_name, fld_pkg_name, 1, ODS_14_0)
+	FIELD(f_rfr_histogram, nam_histogram, fld_histogram, 1, ODS_14_0)
 END_RELATION
 
 // Relation 6 (RDB$RELATIONS)
@@ -542,6 +545,14 @@ RELATION(nam_mon_database, rel_mon_database, ODS_11_1, rel_virtual)
 	FIELD(f_mon_db_na, nam_mon_na, fld_att_id, 0, ODS_13_0)
 	FIELD(f_mon_db_ns, nam_mon_ns, fld_stmt_id, 0, ODS_13_0)
 	FIELD(f_mon_db_repl_mode, nam_mon_repl_mode, fld_repl_mode, 0, ODS_13_0)
+	FIELD(f_mon_db_data_fetches, nam_mon_data_fetches, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_db_data_reads, nam_mon_data_reads, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_db_index_fetches, nam_mon_index_fetches, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_db_index_reads, nam_mon_index_reads, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_db_pointer_fetches, nam_mon_pointer_fetches, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_db_pointer_reads, nam_mon_pointer_reads, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_db_gc_tables, nam_mon_gc_tables, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_db_gc_pages, nam_mon_gc_pages, fld_counter, 0, ODS_14_0)
 END_RELATION
 
 // Relation 34 (MON$ATTACHMENTS)
@@ -333,6 +333,15 @@ void Applier::process(thread_db* tdbb, ULONG length, const UCHAR* data)
 
 	tdbb->tdbb_flags |= TDBB_replicator;
 
+	// Primary compresses blocks fitting its journal segment only,
+	// the segment size is expected to be configured the same way here
+
+	const auto config = dbb->replConfig();
+	const ULONG maxLength = MAX(config ? config->segmentSize : 0, DEFAULT_SEGMENT_SIZE);
+
+	UCharBuffer buffer;
+	data = unpackBlock(length, data, maxLength, buffer);
+
 	BlockReader reader(length, data);
 
 	const auto traNum = reader.getTransactionId();
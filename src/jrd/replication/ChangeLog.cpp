@@ -25,6 +25,7 @@
 #include "../common/classes/auto.h"
 #include "../common/isc_proto.h"
 #include "../common/isc_s_proto.h"
+#include "../common/utils_proto.h"
 #include "../common/os/os_utils.h"
 #include "../common/os/path_utils.h"
 #include "../jrd/jrd.h"
@@ -299,6 +300,16 @@ void ChangeLog::Segment::flush(bool data)
 #endif
 }
 
+int ChangeLog::Segment::duplicateHandle() const
+{
+	const int handle = ::dup(m_handle);
+
+	if (handle < 0)
+		raiseError("Journal file %s duplication failed (error %d)", m_filename.c_str(), ERRNO);
+
+	return handle;
+}
+
 void ChangeLog::Segment::mapHeader()
 {
 #ifdef WIN_NT
@@ -628,47 +639,160 @@ FB_UINT64 ChangeLog::write(ULONG length, const UCHAR* data, bool sync)
 
 	segment->append(length, data);
 
+	const auto writeMark = ++state->writeMark;
+	state->writeBytes += length;
+
 	if (segment->getLength() > m_config->segmentSize)
 	{
 		segment->setState(SEGMENT_STATE_FULL);
 		state->flushMark++;
+
+		// Full segment is flushed, as well as all the previous ones
+
+		state->syncMark = writeMark;
+		state->syncBytes = state->writeBytes;
+
+		logFlushStatistics();
 		m_workingSemaphore.release();
 	}
 
 	if (sync)
+		groupFlush(writeMark);
+
+	return state->sequence;
+}
+
+void ChangeLog::groupFlush(FB_UINT64 writeMark)
+{
+	// Only one writer (the leader) flushes the journal at a time and it does that
+	// without holding the state lock, so other writers may append their blocks
+	// meanwhile. They wait for the leader and then either find their blocks
+	// already flushed or one of them becomes the next leader and flushes
+	// all the blocks appended so far with a single call.
+
+	static const auto process_id = getpid();
+
+	const auto state = m_sharedMemory->getHeader();
+
+	while (state->syncMark < writeMark)
 	{
-		if (m_config->groupFlushDelay)
+		if (state->flushPid && !m_shutdown &&
+			(state->flushPid == process_id || ISC_check_process_existence(state->flushPid)))
 		{
-			const auto flushMark = state->flushMark;
+			LockCheckout checkout(this);
+			Thread::sleep(FLUSH_WAIT_INTERVAL);
+			continue;
+		}
 
-			segment->addRef();
+		state->flushPid = process_id;
 
-			for (ULONG delay = 0; delay < m_config->groupFlushDelay;
-				delay += FLUSH_WAIT_INTERVAL)
-			{
-				if (state->flushMark != flushMark)
-					break;
+		Segment* activeSegment = nullptr;
+
+		try
+		{
+			// Let concurrently committing transactions join the flush
 
+			if (m_config->groupFlushDelay)
+			{
 				LockCheckout checkout(this);
-				Thread::sleep(FLUSH_WAIT_INTERVAL);
+				Thread::sleep(m_config->groupFlushDelay);
 			}
 
-			if (state->flushMark == flushMark)
+			// Blocks written so far are either in the active segment or in the full ones,
+			// the latter being flushed when they're switched
+
+			const auto syncMark = state->writeMark;
+			const auto syncBytes = state->writeBytes;
+
+			if (state->syncMark < syncMark)
 			{
-				segment->flush(true);
+				for (const auto segment : m_segments)
+				{
+					if (segment->getState() == SEGMENT_STATE_USED)
+					{
+						activeSegment = segment;
+						activeSegment->addRef();
+						break;
+					}
+				}
+
+				const auto startCounter = fb_utils::query_performance_counter();
+
+				if (activeSegment && m_shutdown)
+				{
+					activeSegment->flush(true);
+				}
+				else if (activeSegment)
+				{
+					// Flush the duplicated handle, as the segment may be switched
+					// and archived (thus closed) while the lock is released
+
+					const int handle = activeSegment->duplicateHandle();
+
+					{	// scope
+						LockCheckout checkout(this);
+						flushFile(handle);
+						::close(handle);
+					}
+
+					if (activeSegment->getState() == SEGMENT_STATE_USED)
+						activeSegment->flush(false);
+				}
+
+				const auto flushTime = (fb_utils::query_performance_counter() - startCounter) *
+					1000000 / fb_utils::query_performance_frequency();
+
+				if (state->syncMark < syncMark)
+				{
+					state->flushCount++;
+					state->flushBlocks += syncMark - state->syncMark;
+					state->flushBytes += syncBytes - state->syncBytes;
+					state->flushTime += flushTime;
+
+					state->syncMark = syncMark;
+					state->syncBytes = syncBytes;
+				}
+
 				state->flushMark++;
 			}
-
-			segment->release();
 		}
-		else
+		catch (const Exception&)
 		{
-			segment->flush(true);
-			state->flushMark++;
+			if (activeSegment)
+				activeSegment->release();
+
+			state->flushPid = 0;
+			throw;
 		}
+
+		if (activeSegment)
+			activeSegment->release();
+
+		state->flushPid = 0;
+	}
+}
+
+void ChangeLog::logFlushStatistics()
+{
+	const auto state = m_sharedMemory->getHeader();
+
+	if (m_config->verboseLogging && state->flushCount)
+	{
+		string message;
+		message.printf("Segment %" UQUADFORMAT " is synchronously flushed %" UQUADFORMAT " times, "
+			"on average %" UQUADFORMAT " blocks (%" UQUADFORMAT " bytes) in %" UQUADFORMAT " us per flush",
+			state->sequence, state->flushCount,
+			state->flushBlocks / state->flushCount,
+			state->flushBytes / state->flushCount,
+			state->flushTime / state->flushCount);
+
+		logPrimaryVerbose(m_config->dbName, message);
 	}
 
-	return state->sequence;
+	state->flushCount = 0;
+	state->flushBlocks = 0;
+	state->flushBytes = 0;
+	state->flushTime = 0;
 }
 
 bool ChangeLog::archiveExecute(Segment* segment)
@@ -805,6 +929,8 @@ void ChangeLog::switchActiveSegment()
 				segment->setState(SEGMENT_STATE_FULL);
 				state->flushMark++;
 
+				logFlushStatistics();
+
 				if (!m_shutdown)
 					m_workingSemaphore.release();
 			}
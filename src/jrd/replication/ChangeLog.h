@@ -70,6 +70,15 @@ namespace Replication
 			time_t timestamp;			// timestamp of last write
 			ULONG generation;			// segments reload marker
 			ULONG flushMark;			// last flush mark
+			int flushPid;				// process running the group flush, zero if none
+			FB_UINT64 writeMark;		// number of blocks written
+			FB_UINT64 syncMark;			// number of blocks known to be flushed
+			FB_UINT64 writeBytes;		// number of bytes written
+			FB_UINT64 syncBytes;		// number of bytes known to be flushed
+			FB_UINT64 flushCount;		// group flushes since the last report
+			FB_UINT64 flushBlocks;		// blocks flushed by them
+			FB_UINT64 flushBytes;		// bytes flushed by them
+			FB_UINT64 flushTime;		// time spent by them, in microseconds
 			FB_UINT64 sequence;			// sequence number of the last segment
 			ULONG pidLower;				// lower boundary mark in the PID array
 			ULONG pidUpper;				// upper boundary mark in the PID array
@@ -77,7 +86,7 @@ namespace Replication
 		};
 
 		// Shared memory layout format
-		static inline constexpr USHORT STATE_VERSION = 1;
+		static inline constexpr USHORT STATE_VERSION = 2;
 		// Mapping size (not extendable for the time being)
 		static inline constexpr ULONG STATE_MAPPING_SIZE = 64 * 1024;	// 64 KB
 		// Max number of processes accessing the shared state
@@ -177,6 +186,7 @@ namespace Replication
 
 			void truncate();
 			void flush(bool data);
+			int duplicateHandle() const;
 
 			Firebird::PathName getFileName() const;
 
@@ -248,6 +258,9 @@ namespace Replication
 
 		void switchActiveSegment();
 
+		void groupFlush(FB_UINT64 writeMark);
+		void logFlushStatistics();
+
 		const Firebird::string& m_dbId;
 		const Firebird::Guid& m_guid;
 		const Config* const m_config;
@@ -56,12 +56,13 @@ namespace
 	constexpr const char* KEY_SUFFIX_FILE = "file";
 
 	constexpr ULONG DEFAULT_BUFFER_SIZE = 1024 * 1024; 			// 1 MB
-	constexpr ULONG DEFAULT_SEGMENT_SIZE = 16 * 1024 * 1024;	// 16 MB
 	constexpr ULONG DEFAULT_SEGMENT_COUNT = 8;
 	constexpr ULONG DEFAULT_ARCHIVE_TIMEOUT = 60;				// seconds
 	constexpr ULONG DEFAULT_GROUP_FLUSH_DELAY = 0;
 	constexpr ULONG DEFAULT_APPLY_IDLE_TIMEOUT = 10;			// seconds
 	constexpr ULONG DEFAULT_APPLY_ERROR_TIMEOUT = 60;			// seconds
+	constexpr ULONG DEFAULT_APPLY_WORKERS = 1;
+	constexpr ULONG MAX_APPLY_WORKERS = 64;
 	constexpr bool DEFAULT_REPORT_ERRORS = false;
 
 	void parseLong(const string& input, ULONG& output)
@@ -218,6 +219,7 @@ namespace
 Config::Config()
 	: dbName(getPool()),
 	  bufferSize(DEFAULT_BUFFER_SIZE),
+	  compression(false),
 	  includeSchemaFilter(getPool()),
 	  excludeSchemaFilter(getPool()),
 	  includeFilter(getPool()),
@@ -235,6 +237,7 @@ Config::Config()
 	  verboseLogging(false),
 	  applyIdleTimeout(DEFAULT_APPLY_IDLE_TIMEOUT),
 	  applyErrorTimeout(DEFAULT_APPLY_ERROR_TIMEOUT),
+	  applyWorkers(DEFAULT_APPLY_WORKERS),
 	  schemaSearchPath(getPool()),
 	  pluginName(getPool()),
 	  logErrors(true),
@@ -247,6 +250,7 @@ Config::Config()
 Config::Config(const Config& other)
 	: dbName(getPool(), other.dbName),
 	  bufferSize(other.bufferSize),
+	  compression(other.compression),
 	  includeSchemaFilter(getPool(), other.includeSchemaFilter),
 	  excludeSchemaFilter(getPool(), other.excludeSchemaFilter),
 	  includeFilter(getPool(), other.includeFilter),
@@ -264,6 +268,7 @@ Config::Config(const Config& other)
 	  verboseLogging(other.verboseLogging),
 	  applyIdleTimeout(other.applyIdleTimeout),
 	  applyErrorTimeout(other.applyErrorTimeout),
+	  applyWorkers(other.applyWorkers),
 	  schemaSearchPath(getPool(), other.schemaSearchPath),
 	  pluginName(getPool(), other.pluginName),
 	  logErrors(other.logErrors),
@@ -359,6 +364,10 @@ Config* Config::get(const PathName& lookupName)
 				{
 					parseLong(value, config->bufferSize);
 				}
+				else if (key == "compression")
+				{
+					parseBoolean(value, config->compression);
+				}
 				else if (key == "include_schema_filter")
 				{
 					ISC_systemToUtf8(value);
@@ -445,11 +454,15 @@ Config* Config::get(const PathName& lookupName)
 				{
 					parseBoolean(value, config->cascadeReplication);
 				}
+				else if (key == "verbose_logging")
+				{
+					parseBoolean(value, config->verboseLogging);
+				}
 				else if ((key != "journal_source_directory") &&
 						(key != "source_guid") &&
-						(key != "verbose_logging") &&
 						(key != "apply_idle_timeout") &&
-						(key != "apply_error_timeout"))
+						(key != "apply_error_timeout") &&
+						(key != "apply_workers"))
 				{
 					configError(&localStatus, "unknown key",
 					                          exactMatch ? lookupName.c_str() : section.name.c_str(),
@@ -592,6 +605,11 @@ void Config::enumerate(ReplicaList& replicas)
 				{
 					parseLong(value, config->applyErrorTimeout);
 				}
+				else if (key == "apply_workers")
+				{
+					parseLong(value, config->applyWorkers);
+					config->applyWorkers = MIN(config->applyWorkers, MAX_APPLY_WORKERS);
+				}
 				else if (key == "schema_search_path")
 					config->schemaSearchPath = value;
 			}
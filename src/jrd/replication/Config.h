@@ -33,6 +33,8 @@
 
 namespace Replication
 {
+	inline constexpr ULONG DEFAULT_SEGMENT_SIZE = 16 * 1024 * 1024;	// 16 MB
+
 	struct SyncReplica
 	{
 		explicit SyncReplica(MemoryPool& p)
@@ -62,6 +64,7 @@ namespace Replication
 
 		Firebird::PathName dbName;
 		ULONG bufferSize;
+		bool compression;
 		Firebird::string includeSchemaFilter;
 		Firebird::string excludeSchemaFilter;
 		Firebird::string includeFilter;
@@ -80,6 +83,7 @@ namespace Replication
 		bool verboseLogging;
 		ULONG applyIdleTimeout;
 		ULONG applyErrorTimeout;
+		ULONG applyWorkers;
 		Firebird::string schemaSearchPath;
 		Firebird::string pluginName;
 		bool logErrors;
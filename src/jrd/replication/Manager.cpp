@@ -129,7 +129,8 @@ Manager::Manager(const string& dbId,
 	  m_queueSize(0),
 	  m_sequence(0),
 	  m_shutdown(false),
-	  m_signalled(false)
+	  m_signalled(false),
+	  m_packBuffer(getPool())
 {
 	// Startup the journalling
 
@@ -304,6 +305,9 @@ void Manager::flush(UCharBuffer* buffer, bool sync, bool prepare)
 				fb_assert(length);
 				bool hasData = true;
 
+				ULONG packedLength = length;
+				const UCHAR* packedData = nullptr;
+
 				if (m_changeLog)
 				{
 					if (prepareBuffer == buffer)
@@ -319,7 +323,9 @@ void Manager::flush(UCharBuffer* buffer, bool sync, bool prepare)
 
 					if (hasData)
 					{
-						const auto sequence = m_changeLog->write(length, buffer->begin(), sync);
+						packedLength = length;
+						packedData = pack(packedLength, buffer->begin());
+						const auto sequence = m_changeLog->write(packedLength, packedData, sync);
 
 						if (sequence != m_sequence)
 						{
@@ -333,13 +339,20 @@ void Manager::flush(UCharBuffer* buffer, bool sync, bool prepare)
 						const auto block = (Block*) buffer->begin();
 						block->length += sizeof(UCHAR);
 						length += sizeof(UCHAR);
+						packedData = nullptr;
 					}
 				}
 
+				if (m_replicas.hasData() && !packedData)
+				{
+					packedLength = length;
+					packedData = pack(packedLength, buffer->begin());
+				}
+
 				for (auto iter : m_replicas)
 				{
 					if (iter->status.isSuccess())
-						iter->replicator->process(&iter->status, length, buffer->begin());
+						iter->replicator->process(&iter->status, packedLength, packedData);
 				}
 
 				m_queueSize -= length;
@@ -361,6 +374,19 @@ void Manager::flush(UCharBuffer* buffer, bool sync, bool prepare)
 	}
 }
 
+// Compress the block if configured and worth it, return the data to be journalled and sent
+
+const UCHAR* Manager::pack(ULONG& length, const UCHAR* data)
+{
+	if (m_config->compression && m_compressor.pack(length, data, m_config->segmentSize, m_packBuffer))
+	{
+		length = (ULONG) m_packBuffer.getCount();
+		return m_packBuffer.begin();
+	}
+
+	return data;
+}
+
 void Manager::bgWriter()
 {
 	try
@@ -382,13 +408,16 @@ void Manager::bgWriter()
 					const auto length = (ULONG) buffer->getCount();
 					fb_assert(length);
 
+					ULONG packedLength = length;
+					const auto packedData = pack(packedLength, buffer->begin());
+
 					if (m_changeLog)
-						m_changeLog->write(length, buffer->begin(), false);
+						m_changeLog->write(packedLength, packedData, false);
 
 					for (auto iter : m_replicas)
 					{
 						if (iter->status.isSuccess())
-							iter->replicator->process(&iter->status, length, buffer->begin());
+							iter->replicator->process(&iter->status, packedLength, packedData);
 					}
 
 					m_queueSize -= length;
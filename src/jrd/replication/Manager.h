@@ -34,6 +34,7 @@
 
 #include "Config.h"
 #include "ChangeLog.h"
+#include "Utils.h"
 
 namespace Replication
 {
@@ -101,6 +102,7 @@ namespace Replication
 
 	private:
 		void bgWriter();
+		const UCHAR* pack(ULONG& length, const UCHAR* data);
 
 		static THREAD_ENTRY_DECLARE writer_thread(THREAD_ENTRY_PARAM arg)
 		{
@@ -126,6 +128,8 @@ namespace Replication
 		volatile bool m_signalled;
 
 		Firebird::AutoPtr<ChangeLog> m_changeLog;
+		BlockCompressor m_compressor;
+		Firebird::UCharBuffer m_packBuffer;
 		Firebird::RWLock m_lock;
 	};
 }
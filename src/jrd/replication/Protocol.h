@@ -34,6 +34,11 @@ namespace Replication
 	// Global (protocol neutral) flags
 	inline constexpr USHORT BLOCK_BEGIN_TRANS	= 0x0001;
 	inline constexpr USHORT BLOCK_END_TRANS		= 0x0002;
+	// Block data is compressed and prefixed with its original length (ULONG),
+	// the codec is stored in the BLOCK_CODEC_MASK bits
+	inline constexpr USHORT BLOCK_COMPRESSED	= 0x0004;
+	inline constexpr USHORT BLOCK_CODEC_MASK	= 0x0018;
+	inline constexpr USHORT BLOCK_CODEC_ZSTD	= 0x0008;
 
 	struct Block
 	{
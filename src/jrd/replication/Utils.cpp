@@ -22,6 +22,7 @@
 
 #include "firebird.h"
 #include "../common/classes/GenericMap.h"
+#include "../common/classes/init.h"
 #include "../common/config/config_file.h"
 #include "../common/isc_proto.h"
 #include "../common/isc_f_proto.h"
@@ -31,6 +32,7 @@
 #include "../common/os/path_utils.h"
 #include "../jrd/constants.h"
 
+#include "Protocol.h"
 #include "Utils.h"
 
 #ifdef HAVE_UNISTD_H
@@ -71,6 +73,14 @@ namespace
 
 	const char* REPLICATION_LOGFILE = "replication.log";
 
+	// Smaller blocks (e.g. a single commit) are not worth compressing
+	constexpr ULONG MIN_PACKED_LENGTH = 128;
+
+	// Fastest level, as blocks are compressed while transactions commit
+	constexpr int PACKED_LEVEL = 1;
+
+	InitInstance<ZStd> zstd;
+
 	class LogWriter : private GlobalStorage
 	{
 	public:
@@ -271,6 +281,11 @@ namespace Replication
 		logStatus(PRIMARY_SIDE, database, status);
 	}
 
+	void logPrimaryVerbose(const PathName& database, const string& message)
+	{
+		logMessage(PRIMARY_SIDE, VERBOSE_MSG, database, message);
+	}
+
 	void logReplicaError(const PathName& database, const string& message)
 	{
 		logMessage(REPLICA_SIDE, ERROR_MSG, database, message);
@@ -291,4 +306,91 @@ namespace Replication
 		logMessage(REPLICA_SIDE, VERBOSE_MSG, database, message);
 	}
 
+	BlockCompressor::~BlockCompressor()
+	{
+		if (m_cctx)
+			zstd().freeCCtx(m_cctx);
+	}
+
+	bool BlockCompressor::pack(ULONG length, const UCHAR* data, ULONG maxLength, UCharBuffer& output)
+	{
+		const auto header = (const Block*) data;
+		const ULONG dataLength = length - sizeof(Block);
+
+		if (dataLength < MIN_PACKED_LENGTH || dataLength > maxLength ||
+			(header->flags & BLOCK_COMPRESSED) || !zstd())
+		{
+			return false;
+		}
+
+		if (!m_cctx && !(m_cctx = zstd().createCCtx()))
+			return false;
+
+		// Compressed data (with its prefix) must be smaller than the original one
+
+		UCHAR* const ptr = output.getBuffer(length);
+
+		const size_t packedLength = zstd().compressCCtx(m_cctx,
+			ptr + sizeof(Block) + sizeof(ULONG), dataLength - sizeof(ULONG),
+			data + sizeof(Block), dataLength, PACKED_LEVEL);
+
+		if (zstd().isError(packedLength))
+			return false;
+
+		Block packedHeader = *header;
+		packedHeader.flags |= BLOCK_COMPRESSED | BLOCK_CODEC_ZSTD;
+		packedHeader.length = (ULONG) (sizeof(ULONG) + packedLength);
+
+		memcpy(ptr, &packedHeader, sizeof(Block));
+		memcpy(ptr + sizeof(Block), &dataLength, sizeof(ULONG));
+		output.shrink(sizeof(Block) + packedHeader.length);
+
+		return true;
+	}
+
+	const UCHAR* unpackBlock(ULONG& length, const UCHAR* data, ULONG maxLength, UCharBuffer& buffer)
+	{
+		const auto header = (const Block*) data;
+
+		if (!(header->flags & BLOCK_COMPRESSED))
+			return data;
+
+		if (length < sizeof(Block) + sizeof(ULONG) || header->length != length - sizeof(Block))
+			raiseError("Replication block is malformed");
+
+		if ((header->flags & BLOCK_CODEC_MASK) != BLOCK_CODEC_ZSTD)
+			raiseError("Replication block is compressed with unknown codec");
+
+		if (!zstd())
+			raiseError("Replication block is compressed but zstd library is not available");
+
+		ULONG dataLength;
+		memcpy(&dataLength, data + sizeof(Block), sizeof(ULONG));
+
+		if (dataLength > maxLength)
+			raiseError("Replication block is malformed");
+
+		UCHAR* const ptr = buffer.getBuffer(sizeof(Block) + dataLength);
+
+		const auto dctx = zstd().createDCtx();
+		if (!dctx)
+			BadAlloc::raise();
+
+		const size_t result = zstd().decompressDCtx(dctx, ptr + sizeof(Block), dataLength,
+			data + sizeof(Block) + sizeof(ULONG), header->length - sizeof(ULONG));
+
+		zstd().freeDCtx(dctx);
+
+		if (zstd().isError(result) || result != dataLength)
+			raiseError("Replication block decompression failed");
+
+		Block unpackedHeader = *header;
+		unpackedHeader.flags &= ~(BLOCK_COMPRESSED | BLOCK_CODEC_MASK);
+		unpackedHeader.length = dataLength;
+		memcpy(ptr, &unpackedHeader, sizeof(Block));
+
+		length = sizeof(Block) + dataLength;
+		return ptr;
+	}
+
 } // namespace
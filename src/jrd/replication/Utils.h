@@ -24,7 +24,9 @@
 #ifndef JRD_REPLICATION_UTILS_H
 #define JRD_REPLICATION_UTILS_H
 
+#include "../common/classes/array.h"
 #include "../common/classes/fb_string.h"
+#include "../common/classes/zip.h"
 
 #ifdef WIN_NT
 #include <io.h>
@@ -59,6 +61,9 @@ namespace Replication
 	void logPrimaryStatus(const Firebird::PathName& database,
 						  const Firebird::CheckStatusWrapper* status);
 
+	void logPrimaryVerbose(const Firebird::PathName& database,
+						   const Firebird::string& message);
+
 	void logReplicaError(const Firebird::PathName& database,
 						 const Firebird::string& message);
 
@@ -71,6 +76,31 @@ namespace Replication
 	void logReplicaVerbose(const Firebird::PathName& database,
 						   const Firebird::string& message);
 
+	// Compression of the replication blocks, see BLOCK_COMPRESSED
+
+	class BlockCompressor
+	{
+	public:
+		BlockCompressor() = default;
+		~BlockCompressor();
+
+		BlockCompressor(const BlockCompressor&) = delete;
+		BlockCompressor& operator=(const BlockCompressor&) = delete;
+
+		// Compress the block into the buffer. Return false if the block is too small,
+		// its data is longer than maxLength, it's not compressible or zstd is not
+		// available, it's stored as is then.
+		bool pack(ULONG length, const UCHAR* data, ULONG maxLength, Firebird::UCharBuffer& output);
+
+	private:
+		Firebird::ZStd::CCtx* m_cctx = nullptr;
+	};
+
+	// Return the block uncompressed, using the buffer if necessary.
+	// Blocks with data longer than maxLength are considered malformed.
+	const UCHAR* unpackBlock(ULONG& length, const UCHAR* data, ULONG maxLength,
+							 Firebird::UCharBuffer& buffer);
+
 	class AutoFile
 	{
 	public:
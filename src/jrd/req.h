@@ -162,6 +162,7 @@ inline constexpr USHORT RPB_s_no_data		= 0x02;	// nobody is going to access the
 inline constexpr USHORT RPB_s_sweeper		= 0x04;	// garbage collector - skip swept pages
 inline constexpr USHORT RPB_s_unstable		= 0x08;	// don't use undo log, used with unstable explicit cursors
 inline constexpr USHORT RPB_s_skipLocked	= 0x10;	// skip locked record
+inline constexpr USHORT RPB_s_index_only	= 0x20;	// records may be restored from index keys
 
 // Runtime flags
 
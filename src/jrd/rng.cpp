@@ -0,0 +1,930 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		rng.cpp
+ *	DESCRIPTION:	Block range (min/max summary) indices
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+/*
+ * Block range index keeps, for every range of RANGE_DATA_PAGES data pages
+ * of the relation, the lowest and the highest keys ever stored there.
+ * Summaries are only widened, so they stay correct (but less precise) after
+ * records are updated or deleted. Retrieval returns the intervals of record
+ * numbers whose summaries may match the search bounds, the full table scan
+ * visits only them and the boolean re-checks every record read.
+ *
+ * Appending inserts would widen the same last entry again and again, so in
+ * SuperServer the range being filled is marked open on its summary page and
+ * matches any key. Its summary is collected in memory (OpenRangeTable) and
+ * written when the inserts move to the next range, by sweep or at shutdown.
+ * A range left open by a crash stays unbounded until the index is rebuilt.
+ */
+
+#include "firebird.h"
+#include <string.h>
+#include "../jrd/jrd.h"
+#include "../jrd/ods.h"
+#include "../jrd/btr.h"
+#include "../jrd/req.h"
+#include "../jrd/cch.h"
+#include "../jrd/sort.h"
+#include "../jrd/btr_proto.h"
+#include "../jrd/cch_proto.h"
+#include "../jrd/dpm_proto.h"
+#include "../jrd/err_proto.h"
+#include "../jrd/pag_proto.h"
+#include "../jrd/rng_proto.h"
+
+using namespace Jrd;
+using namespace Ods;
+using namespace Firebird;
+
+
+static range_page* allocate_page(thread_db*, WIN*, const range_page*, UCHAR, ULONG);
+static void close_range(thread_db*, USHORT, ULONG, OpenRangeTable::Range*);
+static FB_SIZE_T entry_size(USHORT);
+static ULONG entries_per_page(const Database*, USHORT);
+static range_page* fetch_summary(thread_db*, WIN*, ULONG, USHORT, ULONG*);
+static range_entry* get_entry(range_page*, ULONG);
+static ULONG get_range(const Database*, SINT64);
+static bool insert_open(thread_db*, OpenRangeTable*, USHORT, const index_desc*, ULONG, const temporary_key*);
+static void open_range(thread_db*, USHORT, ULONG, ULONG, OpenRangeTable::Range*);
+static ULONG slots_per_page(const Database*);
+
+
+OpenRangeTable::~OpenRangeTable()
+{
+	decltype(ranges)::Accessor accessor(&ranges);
+
+	for (bool found = accessor.getFirst(); found; found = accessor.getNext())
+		delete accessor.current()->second;
+}
+
+
+int RNG_compare_keys(const UCHAR* key1, USHORT length1, const UCHAR* key2, USHORT length2)
+{
+/**************************************
+ *
+ *	R N G _ c o m p a r e _ k e y s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compare two index keys, the shorter key goes first.
+ *
+ **************************************/
+	const int result = memcmp(key1, key2, MIN(length1, length2));
+
+	if (result)
+		return result;
+
+	return (length1 == length2) ? 0 : (length1 < length2) ? -1 : 1;
+}
+
+
+bool RNG_covers_key(const range_entry* entry, USHORT keyLength, const UCHAR* key, USHORT length)
+{
+/**************************************
+ *
+ *	R N G _ c o v e r s _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check if the range summary already covers the key.
+ *
+ **************************************/
+	if (entry->rne_flags & (rne_unbounded | rne_open))
+		return true;
+
+	if (!(entry->rne_flags & rne_used) || length > keyLength)
+		return false;
+
+	const UCHAR* const low = entry->rne_data;
+	const UCHAR* const high = low + keyLength;
+
+	return RNG_compare_keys(key, length, low, entry->rne_low_length) >= 0 &&
+		RNG_compare_keys(key, length, high, entry->rne_high_length) <= 0;
+}
+
+
+ULONG RNG_create(thread_db* tdbb, IndexCreation& creation)
+{
+/**************************************
+ *
+ *	R N G _ c r e a t e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Build the block range index from the sorted keys.
+ *	Return the number of its root (first directory) page.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	const Database* const dbb = tdbb->getDatabase();
+	CHECK_DBB(dbb);
+
+	jrd_rel* const relation = creation.relation;
+	index_desc* const idx = creation.index;
+
+	const USHORT pageSpaceID = relation->getPages(tdbb)->rel_pg_space_id;
+	const USHORT keyLength = BTR_key_length(tdbb, relation, idx);
+	const FB_SIZE_T entrySize = entry_size(keyLength);
+
+	// Keys come in ascending order, so the first key of every range
+	// is its lowest one and the last key is the highest one
+
+	MemoryPool& pool = *tdbb->getDefaultPool();
+	Array<UCHAR> summaries(pool);
+
+	while (true)
+	{
+		UCHAR* record;
+		creation.sort->get(tdbb, reinterpret_cast<ULONG**>(&record));
+
+		if (!record)
+			break;
+
+		const index_sort_record* const isr = (index_sort_record*) (record + creation.key_length);
+
+		if (isr->isr_flags & ISR_null)
+			continue;
+
+		const ULONG range = get_range(dbb, isr->isr_record_number);
+		const FB_SIZE_T offset = range * entrySize;
+
+		if (summaries.getCount() < offset + entrySize)
+			summaries.grow(offset + entrySize);
+
+		RNG_widen_entry((range_entry*) (summaries.begin() + offset), keyLength,
+			record + creation.nullIndLen, isr->isr_key_length);
+	}
+
+	const ULONG rangeCount = summaries.getCount() / entrySize;
+	const ULONG perPage = entries_per_page(dbb, keyLength);
+	const ULONG perDirectory = slots_per_page(dbb);
+
+	WIN dirWindow(pageSpaceID, -1);
+	WIN window(pageSpaceID, -1);
+	ULONG root = 0;
+
+	// Don't include allocated pages into dirty queue, else user transaction's flash
+	// will wait on latches until we finish
+	tdbb->tdbb_flags |= TDBB_sweeper | TDBB_no_cache_unwind;
+
+	try
+	{
+		range_page* directory = (range_page*) DPM_allocate(tdbb, &dirWindow);
+		directory->rng_header.pag_type = pag_range;
+		directory->rng_relation = relation->getId();
+		directory->rng_id = idx->idx_id;
+		directory->rng_key_length = keyLength;
+		directory->rng_level = 1;
+		root = dirWindow.win_page.getPageNum();
+
+		for (ULONG first = 0, sequence = 0; first < rangeCount; first += perPage, sequence++)
+		{
+			if (directory->rng_count == perDirectory)
+			{
+				range_page* const next = allocate_page(tdbb, &window, directory, 1, directory->rng_sequence + 1);
+
+				directory->rng_next = window.win_page.getPageNum();
+				CCH_precedence(tdbb, &dirWindow, window.win_page);
+				CCH_RELEASE(tdbb, &dirWindow);
+
+				dirWindow = window;
+				window.win_bdb = NULL;
+				directory = next;
+			}
+
+			range_page* const page = allocate_page(tdbb, &window, directory, 0, sequence);
+			directory->rng_data[directory->rng_count++] = window.win_page.getPageNum();
+
+			page->rng_count = (USHORT) MIN(perPage, rangeCount - first);
+			memcpy(get_entry(page, 0), summaries.begin() + first * entrySize, page->rng_count * entrySize);
+
+			CCH_RELEASE(tdbb, &window);
+			CCH_precedence(tdbb, &dirWindow, window.win_page);
+		}
+
+		CCH_RELEASE(tdbb, &dirWindow);
+	}
+	catch (const Exception&)
+	{
+		// CCH_unwind does not release page buffers as we set
+		// TDBB_no_cache_unwind flag, do it now
+		if (window.win_bdb)
+			CCH_RELEASE(tdbb, &window);
+
+		if (dirWindow.win_bdb)
+			CCH_RELEASE(tdbb, &dirWindow);
+
+		tdbb->tdbb_flags &= ~(TDBB_no_cache_unwind | TDBB_sweeper);
+
+		if (root)
+			RNG_delete(tdbb, relation->getId(), idx->idx_id, PageNumber(pageSpaceID, root), PageNumber(pageSpaceID, 0));
+
+		throw;
+	}
+
+	tdbb->tdbb_flags &= ~(TDBB_no_cache_unwind | TDBB_sweeper);
+
+	if (!relation->isTemporary())
+		CCH_flush(tdbb, FLUSH_ALL, 0);
+
+	return root;
+}
+
+
+void RNG_delete(thread_db* tdbb, MetaId rel_id, MetaId idx_id, PageNumber next, PageNumber prior)
+{
+/**************************************
+ *
+ *	R N G _ d e l e t e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Release block range index pages back to free list.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+
+	// Summary of the open range must not be written into the released pages
+
+	if (OpenRangeTable* const table = dbb->dbb_open_ranges)
+	{
+		MutexLockGuard guard(table->mutex, FB_FUNCTION);
+
+		OpenRangeTable::Range** const open = table->ranges.get(next.getPageNum());
+
+		if (open)
+		{
+			delete *open;
+			table->ranges.remove(next.getPageNum());
+		}
+	}
+
+	WIN window(next.getPageSpaceID(), -1);
+	window.win_flags = WIN_large_scan;
+	window.win_scans = 1;
+
+	HalfStaticArray<ULONG, 256> pages(*tdbb->getDefaultPool());
+
+	while (next.getPageNum())
+	{
+		window.win_page = next;
+		const range_page* const directory = (range_page*) CCH_FETCH(tdbb, &window, LCK_write, 0);
+
+		// Stop deleting at damaged pointer, see delete_tree() in btr.cpp
+		if (directory->rng_header.pag_type != pag_range || directory->rng_level != 1 ||
+			directory->rng_id != idx_id || directory->rng_relation != rel_id ||
+			directory->rng_count > slots_per_page(dbb))
+		{
+			CCH_RELEASE(tdbb, &window);
+			return;
+		}
+
+		pages.assign(directory->rng_data, directory->rng_count);
+		next = directory->rng_next;
+
+		CCH_RELEASE_TAIL(tdbb, &window);
+		PAG_release_page(tdbb, window.win_page, prior);
+		prior = window.win_page;
+
+		for (const ULONG* iter = pages.begin(); iter != pages.end(); ++iter)
+		{
+			if (!*iter)
+				continue;
+
+			window.win_page = *iter;
+			const range_page* const page = (range_page*) CCH_FETCH(tdbb, &window, LCK_write, 0);
+
+			if (page->rng_header.pag_type != pag_range || page->rng_level != 0 ||
+				page->rng_id != idx_id || page->rng_relation != rel_id)
+			{
+				CCH_RELEASE(tdbb, &window);
+				continue;
+			}
+
+			CCH_RELEASE_TAIL(tdbb, &window);
+			PAG_release_page(tdbb, window.win_page, prior);
+			prior = window.win_page;
+		}
+	}
+}
+
+
+bool RNG_entry_matches(const range_entry* entry, USHORT keyLength,
+	const temporary_key* lower, const temporary_key* upper)
+{
+/**************************************
+ *
+ *	R N G _ e n t r y _ m a t c h e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check if the range may hold the keys between the bounds.
+ *	Bounds are taken inclusively, the boolean filters the rest.
+ *
+ **************************************/
+	if (entry->rne_flags & (rne_unbounded | rne_open))
+		return true;
+
+	if (!(entry->rne_flags & rne_used))
+		return false;
+
+	const UCHAR* const low = entry->rne_data;
+	const UCHAR* const high = low + keyLength;
+
+	if (lower && RNG_compare_keys(high, entry->rne_high_length, lower->key_data, lower->key_length) < 0)
+		return false;
+
+	if (upper && RNG_compare_keys(low, entry->rne_low_length, upper->key_data, upper->key_length) > 0)
+		return false;
+
+	return true;
+}
+
+
+void RNG_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordRangeList& ranges)
+{
+/**************************************
+ *
+ *	R N G _ e v a l u a t e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return the intervals of record numbers
+ *	which may contain the matching records.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	const Database* const dbb = tdbb->getDatabase();
+
+	ranges.clear();
+
+	temporary_key lowerKey, upperKey;
+	lowerKey.key_flags = 0;
+	lowerKey.key_length = 0;
+	upperKey.key_flags = 0;
+	upperKey.key_length = 0;
+	USHORT forceInclFlag = 0;
+
+	if (!BTR_make_bounds(tdbb, retrieval, nullptr, &lowerKey, &upperKey, forceInclFlag))
+		return;
+
+	const temporary_key* const lower = retrieval->irb_lower_count ? &lowerKey : nullptr;
+	const temporary_key* const upper = retrieval->irb_upper_count ? &upperKey : nullptr;
+
+	// NULL is never equal, less or greater than anything
+	if ((lower && lower->key_nulls) || (upper && upper->key_nulls))
+		return;
+
+	RelationPages* const relPages = retrieval->getPermRelation()->getPages(tdbb);
+	WIN window(relPages->rel_pg_space_id, relPages->rel_index_root);
+
+	const index_root_page* const rpage = BTR_fetch_root(FB_FUNCTION, tdbb, &window);
+
+	index_desc idx;
+	if (!BTR_description(tdbb, retrieval->getPermRelation(), rpage, &idx, retrieval->irb_index))
+	{
+		CCH_RELEASE(tdbb, &window);
+		IBERROR(260);	// msg 260 index unexpectedly deleted
+	}
+
+	// Collect the summary pages first, they never move while the index exists
+
+	HalfStaticArray<ULONG, 256> pages(*tdbb->getDefaultPool());
+
+	const range_page* page = (range_page*) CCH_HANDOFF(tdbb, &window, idx.idx_root, LCK_read, pag_range);
+	const USHORT keyLength = page->rng_key_length;
+
+	while (true)
+	{
+		pages.add(page->rng_data, page->rng_count);
+
+		if (!page->rng_next)
+			break;
+
+		page = (range_page*) CCH_HANDOFF(tdbb, &window, page->rng_next, LCK_read, pag_range);
+	}
+
+	CCH_RELEASE(tdbb, &window);
+
+	const ULONG perPage = entries_per_page(dbb, keyLength);
+	const SINT64 rangeRecords = (SINT64) RANGE_DATA_PAGES * dbb->dbb_max_records;
+
+	window.win_flags = WIN_large_scan;
+	window.win_scans = 1;
+
+	for (const ULONG* iter = pages.begin(); iter != pages.end(); ++iter)
+	{
+		if (!*iter)
+			continue;
+
+		window.win_page = *iter;
+		range_page* const summary = (range_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_range);
+
+		for (ULONG slot = 0; slot < summary->rng_count; slot++)
+		{
+			if (!RNG_entry_matches(get_entry(summary, slot), keyLength, lower, upper))
+				continue;
+
+			const SINT64 first = ((SINT64) summary->rng_sequence * perPage + slot) * rangeRecords;
+
+			if (ranges.hasData() && ranges.back().upper + 1 == first)
+				ranges.back().upper += rangeRecords;
+			else
+			{
+				RecordRange& range = ranges.add();
+				range.lower = first;
+				range.upper = first + rangeRecords - 1;
+			}
+		}
+
+		CCH_RELEASE(tdbb, &window);
+	}
+}
+
+
+void RNG_flush(thread_db* tdbb)
+{
+/**************************************
+ *
+ *	R N G _ f l u s h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write the summaries of the open ranges to their pages.
+ *	Next insert into such a range opens it again.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+
+	OpenRangeTable* const table = dbb->dbb_open_ranges;
+
+	if (!table)
+		return;
+
+	MutexLockGuard guard(table->mutex, FB_FUNCTION);
+
+	decltype(table->ranges)::Accessor accessor(&table->ranges);
+
+	for (bool found = accessor.getFirst(); found; found = accessor.getNext())
+	{
+		OpenRangeTable::Range* const open = accessor.current()->second;
+
+		if (open->state == OpenRangeTable::RANGE_OPEN)
+			close_range(tdbb, DB_PAGE_SPACE, accessor.current()->first, open);
+	}
+}
+
+
+void RNG_insert(thread_db* tdbb, WIN* root_window, index_insertion* insertion)
+{
+/**************************************
+ *
+ *	R N G _ i n s e r t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Widen the summary of the range holding the record
+ *	to cover the inserted key.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+
+	CCH_RELEASE(tdbb, root_window);
+
+	const temporary_key* const key = insertion->iib_key;
+
+	if (key->key_nulls)
+		return;
+
+	const index_desc* const idx = insertion->iib_descriptor;
+	jrd_rel* const relation = insertion->iib_relation;
+	RelationPages* const relPages = relation->getPages(tdbb);
+	const ULONG range = get_range(dbb, insertion->iib_number.getValue());
+
+	// Appending inserts widen the summary of the open range in memory
+
+	if (dbb->dbb_open_ranges && !relation->isTemporary() &&
+		insert_open(tdbb, dbb->dbb_open_ranges, relPages->rel_pg_space_id, idx, range, key))
+	{
+		return;
+	}
+
+	WIN window(relPages->rel_pg_space_id, idx->idx_root);
+	ULONG slot;
+	range_page* page = fetch_summary(tdbb, &window, range, LCK_read, &slot);
+	const USHORT keyLength = page->rng_key_length;
+
+	// Most of keys fall into the existing summary, so check it under read lock first
+
+	if (slot < page->rng_count && RNG_covers_key(get_entry(page, slot), keyLength, key->key_data, key->key_length))
+	{
+		CCH_RELEASE(tdbb, &window);
+		return;
+	}
+
+	CCH_RELEASE(tdbb, &window);
+	page = (range_page*) CCH_FETCH(tdbb, &window, LCK_write, pag_range);
+
+	if (slot >= page->rng_count || !RNG_covers_key(get_entry(page, slot), keyLength, key->key_data, key->key_length))
+	{
+		CCH_MARK(tdbb, &window);
+
+		while (page->rng_count <= slot)
+		{
+			memset(get_entry(page, page->rng_count), 0, entry_size(keyLength));
+			page->rng_count++;
+		}
+
+		RNG_widen_entry(get_entry(page, slot), keyLength, key->key_data, key->key_length);
+	}
+
+	CCH_RELEASE(tdbb, &window);
+}
+
+
+ULONG RNG_summary_pages(thread_db* tdbb, jrd_rel* relation, index_desc* idx, ULONG dataPages)
+{
+/**************************************
+ *
+ *	R N G _ s u m m a r y _ p a g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Estimate the number of pages read by the retrieval
+ *	of the block range index on the given data pages.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	const Database* const dbb = tdbb->getDatabase();
+
+	const ULONG ranges = (dataPages + RANGE_DATA_PAGES - 1) / RANGE_DATA_PAGES;
+	const ULONG perPage = entries_per_page(dbb, BTR_key_length(tdbb, relation, idx));
+	const ULONG summaries = (ranges + perPage - 1) / perPage;
+
+	return summaries + (summaries + slots_per_page(dbb) - 1) / slots_per_page(dbb);
+}
+
+
+bool RNG_widen_entry(range_entry* entry, USHORT keyLength, const UCHAR* key, USHORT length)
+{
+/**************************************
+ *
+ *	R N G _ w i d e n _ e n t r y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Widen the range summary to cover the key.
+ *	Return true if the summary was changed.
+ *
+ **************************************/
+	if (entry->rne_flags & rne_unbounded)
+		return false;
+
+	if (length > keyLength)
+	{
+		entry->rne_flags |= rne_unbounded;
+		return true;
+	}
+
+	UCHAR* const low = entry->rne_data;
+	UCHAR* const high = low + keyLength;
+	bool changed = false;
+
+	if (!(entry->rne_flags & rne_used) || RNG_compare_keys(key, length, low, entry->rne_low_length) < 0)
+	{
+		memcpy(low, key, length);
+		entry->rne_low_length = length;
+		changed = true;
+	}
+
+	if (!(entry->rne_flags & rne_used) || RNG_compare_keys(key, length, high, entry->rne_high_length) > 0)
+	{
+		memcpy(high, key, length);
+		entry->rne_high_length = length;
+		changed = true;
+	}
+
+	entry->rne_flags |= rne_used;
+
+	return changed;
+}
+
+
+static range_page* allocate_page(thread_db* tdbb, WIN* window, const range_page* parent, UCHAR level,
+	ULONG sequence)
+{
+/**************************************
+ *
+ *	a l l o c a t e _ p a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Allocate and format a block range index page.
+ *
+ **************************************/
+	range_page* const page = (range_page*) DPM_allocate(tdbb, window);
+
+	page->rng_header.pag_type = pag_range;
+	page->rng_relation = parent->rng_relation;
+	page->rng_id = parent->rng_id;
+	page->rng_key_length = parent->rng_key_length;
+	page->rng_level = level;
+	page->rng_sequence = sequence;
+
+	return page;
+}
+
+
+static void close_range(thread_db* tdbb, USHORT pageSpaceId, ULONG root, OpenRangeTable::Range* open)
+{
+/**************************************
+ *
+ *	c l o s e _ r a n g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write the summary collected in memory into the
+ *	open range entry and let it match the keys again.
+ *
+ **************************************/
+	fb_assert(open->state == OpenRangeTable::RANGE_OPEN);
+
+	WIN window(pageSpaceId, root);
+	ULONG slot;
+	range_page* const page = fetch_summary(tdbb, &window, open->number, LCK_write, &slot);
+
+	if (slot < page->rng_count && page->rng_key_length == open->keyLength)
+	{
+		range_entry* const entry = get_entry(page, slot);
+		const range_entry* const summary = (range_entry*) open->entry.begin();
+		const USHORT keyLength = open->keyLength;
+
+		CCH_MARK(tdbb, &window);
+
+		if (summary->rne_flags & rne_unbounded)
+			entry->rne_flags |= rne_unbounded;
+		else if (summary->rne_flags & rne_used)
+		{
+			RNG_widen_entry(entry, keyLength, summary->rne_data, summary->rne_low_length);
+			RNG_widen_entry(entry, keyLength, summary->rne_data + keyLength, summary->rne_high_length);
+		}
+
+		entry->rne_flags &= ~rne_open;
+	}
+
+	CCH_RELEASE(tdbb, &window);
+
+	open->state = OpenRangeTable::RANGE_CLOSED;
+}
+
+
+static FB_SIZE_T entry_size(USHORT keyLength)
+{
+	return ROUNDUP(RNE_SIZE + 2 * keyLength, sizeof(USHORT));
+}
+
+
+static ULONG entries_per_page(const Database* dbb, USHORT keyLength)
+{
+	return (dbb->dbb_page_size - RNG_SIZE) / entry_size(keyLength);
+}
+
+
+static range_page* fetch_summary(thread_db* tdbb, WIN* window, ULONG range, USHORT lock, ULONG* slot)
+{
+/**************************************
+ *
+ *	f e t c h _ s u m m a r y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Fetch the summary page of the range starting from the
+ *	root page set in the window, return the entry slot.
+ *
+ **************************************/
+	const Database* const dbb = tdbb->getDatabase();
+	const USHORT pageSpaceId = window->win_page.getPageSpaceID();
+
+	range_page* page = (range_page*) CCH_FETCH(tdbb, window, LCK_read, pag_range);
+
+	const ULONG perPage = entries_per_page(dbb, page->rng_key_length);
+	const ULONG perDirectory = slots_per_page(dbb);
+	const ULONG sequence = range / perPage;
+
+	*slot = range % perPage;
+
+	// Walk the directory chain up to the page pointing to the summary page,
+	// extending the chain if needed. Directory page is relocked for write
+	// and rechecked, as another attachment could extend it meanwhile.
+
+	while (page->rng_sequence < sequence / perDirectory)
+	{
+		if (!page->rng_next)
+		{
+			CCH_RELEASE(tdbb, window);
+			page = (range_page*) CCH_FETCH(tdbb, window, LCK_write, pag_range);
+
+			if (!page->rng_next)
+			{
+				WIN newWindow(pageSpaceId, -1);
+				allocate_page(tdbb, &newWindow, page, 1, page->rng_sequence + 1);
+				CCH_RELEASE(tdbb, &newWindow);
+
+				CCH_precedence(tdbb, window, newWindow.win_page);
+				CCH_MARK(tdbb, window);
+				page->rng_next = newWindow.win_page.getPageNum();
+			}
+		}
+
+		page = (range_page*) CCH_HANDOFF(tdbb, window, page->rng_next, LCK_read, pag_range);
+	}
+
+	const ULONG dirSlot = sequence % perDirectory;
+
+	if (dirSlot >= page->rng_count || !page->rng_data[dirSlot])
+	{
+		CCH_RELEASE(tdbb, window);
+		page = (range_page*) CCH_FETCH(tdbb, window, LCK_write, pag_range);
+
+		if (dirSlot >= page->rng_count || !page->rng_data[dirSlot])
+		{
+			WIN newWindow(pageSpaceId, -1);
+			allocate_page(tdbb, &newWindow, page, 0, sequence);
+			CCH_RELEASE(tdbb, &newWindow);
+
+			CCH_precedence(tdbb, window, newWindow.win_page);
+			CCH_MARK(tdbb, window);
+
+			// Slots of the ranges without records are left empty
+			while (page->rng_count <= dirSlot)
+				page->rng_data[page->rng_count++] = 0;
+
+			page->rng_data[dirSlot] = newWindow.win_page.getPageNum();
+		}
+	}
+
+	return (range_page*) CCH_HANDOFF(tdbb, window, page->rng_data[dirSlot], lock, pag_range);
+}
+
+
+static range_entry* get_entry(range_page* page, ULONG slot)
+{
+	return (range_entry*) ((UCHAR*) page->rng_data + slot * entry_size(page->rng_key_length));
+}
+
+
+static ULONG get_range(const Database* dbb, SINT64 number)
+{
+	// Record number divided by max records per page is the data page sequence
+	return (ULONG) (number / dbb->dbb_max_records / RANGE_DATA_PAGES);
+}
+
+
+static bool insert_open(thread_db* tdbb, OpenRangeTable* table, USHORT pageSpaceId,
+	const index_desc* idx, ULONG range, const temporary_key* key)
+{
+/**************************************
+ *
+ *	i n s e r t _ o p e n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Widen the summary of the open range kept in memory.
+ *	Inserts into the next range close the current one
+ *	and open the next. Return false if the key should
+ *	widen the summary on the page.
+ *
+ **************************************/
+	MutexLockGuard guard(table->mutex, FB_FUNCTION);
+
+	OpenRangeTable::Range* open;
+	OpenRangeTable::Range** const found = table->ranges.get(idx->idx_root);
+
+	if (found)
+	{
+		open = *found;
+
+		if (range < open->number)
+			return false;
+
+		if (range == open->number && open->state != OpenRangeTable::RANGE_CLOSED)
+		{
+			if (open->state == OpenRangeTable::RANGE_OPEN)
+			{
+				RNG_widen_entry((range_entry*) open->entry.begin(), open->keyLength,
+					key->key_data, key->key_length);
+			}
+
+			return true;
+		}
+
+		// Inserts moved to the next range, so the current one is filled up.
+		// The range closed by sweep is opened again.
+		if (open->state == OpenRangeTable::RANGE_OPEN)
+			close_range(tdbb, pageSpaceId, idx->idx_root, open);
+	}
+	else
+	{
+		open = FB_NEW_POOL(table->pool) OpenRangeTable::Range(table->pool);
+		table->ranges.put(idx->idx_root, open);
+	}
+
+	open_range(tdbb, pageSpaceId, idx->idx_root, range, open);
+
+	if (open->state == OpenRangeTable::RANGE_OPEN)
+	{
+		RNG_widen_entry((range_entry*) open->entry.begin(), open->keyLength,
+			key->key_data, key->key_length);
+	}
+
+	return true;
+}
+
+
+static void open_range(thread_db* tdbb, USHORT pageSpaceId, ULONG root, ULONG range,
+	OpenRangeTable::Range* open)
+{
+/**************************************
+ *
+ *	o p e n _ r a n g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Mark the range entry as matching any key while
+ *	its summary is collected in memory. The page is
+ *	written at once, so the mark outlives a crash.
+ *
+ **************************************/
+	WIN window(pageSpaceId, root);
+	ULONG slot;
+	range_page* const page = fetch_summary(tdbb, &window, range, LCK_write, &slot);
+	const USHORT keyLength = page->rng_key_length;
+
+	// Summary of the range left open before is unknown, it stays unbounded
+
+	if (slot < page->rng_count && (get_entry(page, slot)->rne_flags & rne_open))
+		open->state = OpenRangeTable::RANGE_STALE;
+	else
+	{
+		CCH_MARK_MUST_WRITE(tdbb, &window);
+
+		while (page->rng_count <= slot)
+		{
+			memset(get_entry(page, page->rng_count), 0, entry_size(keyLength));
+			page->rng_count++;
+		}
+
+		get_entry(page, slot)->rne_flags |= rne_open;
+		open->state = OpenRangeTable::RANGE_OPEN;
+	}
+
+	CCH_RELEASE(tdbb, &window);
+
+	open->number = range;
+	open->keyLength = keyLength;
+	memset(open->entry.getBuffer(entry_size(keyLength)), 0, entry_size(keyLength));
+}
+
+
+static ULONG slots_per_page(const Database* dbb)
+{
+	return (dbb->dbb_page_size - RNG_SIZE) / sizeof(ULONG);
+}
@@ -0,0 +1,42 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		rng_proto.h
+ *	DESCRIPTION:	Prototype header file for rng.cpp
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ *
+ */
+
+#ifndef JRD_RNG_PROTO_H
+#define JRD_RNG_PROTO_H
+
+#include "../jrd/btr.h"
+#include "../jrd/ods.h"
+
+int		RNG_compare_keys(const UCHAR*, USHORT, const UCHAR*, USHORT);
+bool	RNG_covers_key(const Ods::range_entry*, USHORT, const UCHAR*, USHORT);
+ULONG	RNG_create(Jrd::thread_db*, Jrd::IndexCreation&);
+void	RNG_delete(Jrd::thread_db*, MetaId, MetaId, Jrd::PageNumber, Jrd::PageNumber);
+bool	RNG_entry_matches(const Ods::range_entry*, USHORT, const Jrd::temporary_key*, const Jrd::temporary_key*);
+void	RNG_evaluate(Jrd::thread_db*, const Jrd::IndexRetrieval*, Jrd::RecordRangeList&);
+void	RNG_flush(Jrd::thread_db*);
+void	RNG_insert(Jrd::thread_db*, Jrd::win*, Jrd::index_insertion*);
+ULONG	RNG_summary_pages(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::index_desc*, ULONG);
+bool	RNG_widen_entry(Ods::range_entry*, USHORT, const UCHAR*, USHORT);
+
+#endif // JRD_RNG_PROTO_H
@@ -41,6 +41,8 @@
 #include "../jrd/val.h"
 #include "../jrd/err_proto.h"
 #include "../yvalve/gds_proto.h"
+#include "../common/Task.h"
+#include <atomic>
 
 #ifdef HAVE_SYS_TYPES_H
 #include <sys/types.h>
@@ -79,6 +81,18 @@ using namespace Firebird;
 constexpr ULONG MAX_SORT_BUFFER_SIZE = 1024 * 128;	// 128KB
 constexpr ULONG MIN_RECORDS_TO_ALLOC = 8;
 
+// Minimal number of records in a partition of sort buffer sorted by a parallel worker.
+// Smaller partitions are sorted faster than the workers could be handed them.
+constexpr ULONG MIN_PARALLEL_SORT_RECORDS = 32768;
+
+// Radix sort is used for keys not longer than this number of longwords,
+// partitions with less than RADIX_THRESHOLD records are sorted by quick()
+constexpr ULONG MAX_RADIX_KEY_LONGS = 16;
+constexpr ULONG RADIX_THRESHOLD = 64;
+// Every level of radix sort takes about 3KB of stack, partitions deeper
+// than that are sorted by quick(), as parallel workers have small stacks
+constexpr ULONG MAX_RADIX_DEPTH = 8;
+
 // the size of sr_bckptr (everything before sort_record) in bytes
 #define SIZEOF_SR_BCKPTR offsetof(sr, sr_sort_record)
 // the size of sr_bckptr in # of 32 bit longwords
@@ -147,9 +161,231 @@ namespace
 		*a = *b;
 		*b = temp;
 	}
+
+	// Compare keys the same way as Sort::quick() does
+	inline bool greater(const SORTP* p, const SORTP* q, ULONG length) noexcept
+	{
+		ULONG tl = length - 1;
+		while (tl && *p == *q)
+		{
+			p++;
+			q++;
+			tl--;
+		}
+		return tl && *p > *q;
+	}
 } // namespace
 
 
+namespace Jrd {
+
+// Sorts the buffer of record pointers by a few workers at once. At the first
+// round, every partition of the buffer is copied into the working space,
+// sorted there and its pairs are ordered. At every next round, sorted
+// partitions are merged pairwise, until the single one is left.
+
+class SortBufferTask : public Task
+{
+public:
+	SortBufferTask(MemoryPool& pool, SORTP** pointers, ULONG count, ULONG longs,
+			ULONG keyLongs, SORTP** work, ULONG partitions) :
+		m_items(pool),
+		m_pointers(pointers),
+		m_work(work),
+		m_longs(longs),
+		m_keyLongs(keyLongs),
+		m_itemCount(partitions),
+		m_nextItem(0),
+		m_inWork(true)
+	{
+		// Leave a slot for the guard (high key) after every partition in the working space
+
+		const ULONG size = count / partitions;
+
+		for (ULONG i = 0; i < partitions; i++)
+		{
+			Item* const item = FB_NEW_POOL(pool) Item(this);
+			item->m_a.m_ptr = pointers + i * size;
+			item->m_a.m_count = (i == partitions - 1) ? count - i * size : size;
+			item->m_target = work + i * size + i;
+			m_items.add(item);
+		}
+	}
+
+	~SortBufferTask()
+	{
+		for (auto item : m_items)
+			delete item;
+	}
+
+	bool handler(WorkItem& workItem) override;
+
+	bool getWorkItem(WorkItem** pItem) override
+	{
+		const ULONG n = m_nextItem++;
+		if (n >= m_itemCount)
+			return false;
+
+		*pItem = m_items[n];
+		return true;
+	}
+
+	bool getResult(IStatus*) override
+	{
+		return true;
+	}
+
+	int getMaxWorkers() override
+	{
+		return m_itemCount;
+	}
+
+	bool nextRound();
+	void complete();
+
+private:
+	struct Part
+	{
+		SORTP** m_ptr = nullptr;
+		ULONG m_count = 0;
+	};
+
+	class Item : public Task::WorkItem
+	{
+	public:
+		Item(SortBufferTask* task) :
+			Task::WorkItem(task)
+		{}
+
+		Part m_a, m_b;			// partitions to sort or merge
+		SORTP** m_target = nullptr;
+		bool m_merge = false;
+		bool m_toBuffer = false;	// target is the buffer, not the working space
+	};
+
+	void merge(const Item* item) const noexcept;
+
+	HalfStaticArray<Item*, 8> m_items;
+	SORTP** const m_pointers;
+	SORTP** const m_work;
+	const ULONG m_longs;
+	const ULONG m_keyLongs;
+	ULONG m_itemCount;
+	std::atomic<ULONG> m_nextItem;
+	bool m_inWork;			// last round placed results into the working space
+};
+
+bool SortBufferTask::handler(WorkItem& workItem)
+{
+	const Item* const item = static_cast<Item*>(&workItem);
+
+	if (item->m_merge)
+	{
+		merge(item);
+		return true;
+	}
+
+	SORTP** const target = item->m_target;
+	const ULONG count = item->m_a.m_count;
+
+	memcpy(target, item->m_a.m_ptr, count * sizeof(SORTP*));
+	target[count] = high_key;
+
+	// Source partition in the buffer is not used until the next round,
+	// let radix sort use it as scratch space
+	Sort::sortPointers(target, count, m_longs, m_keyLongs, item->m_a.m_ptr);
+
+	return true;
+}
+
+void SortBufferTask::merge(const Item* item) const noexcept
+{
+	SORTP** a = item->m_a.m_ptr;
+	SORTP** const endA = a + item->m_a.m_count;
+	SORTP** b = item->m_b.m_ptr;
+	SORTP** const endB = b + item->m_b.m_count;
+	SORTP** target = item->m_target;
+
+	while (a < endA || b < endB)
+	{
+		SORTP** next;
+		if (a == endA)
+			next = b++;
+		else if (b == endB || !greater(*a, *b, m_longs))
+			next = a++;
+		else
+			next = b++;
+
+		*target = *next;
+		// Back pointers of records should point into the buffer, not the working space
+		if (item->m_toBuffer)
+			((SORTP***) (*target))[BACK_OFFSET] = target;
+		target++;
+	}
+}
+
+bool SortBufferTask::nextRound()
+{
+	// Collect results of the previous round
+
+	HalfStaticArray<Part, 8> parts;
+	for (ULONG i = 0; i < m_itemCount; i++)
+	{
+		const Item* const item = m_items[i];
+
+		Part part;
+		part.m_ptr = item->m_target;
+		part.m_count = item->m_a.m_count + (item->m_merge ? item->m_b.m_count : 0);
+		parts.add(part);
+	}
+
+	if (parts.getCount() == 1)
+		return false;
+
+	// Merge partitions pairwise into the other space
+
+	const bool toBuffer = m_inWork;
+	SORTP** target = toBuffer ? m_pointers : m_work;
+	m_inWork = !m_inWork;
+
+	m_itemCount = 0;
+	for (FB_SIZE_T i = 0; i < parts.getCount(); i += 2)
+	{
+		Item* const item = m_items[m_itemCount++];
+		item->m_merge = true;
+		item->m_a = parts[i];
+		item->m_b = (i + 1 < parts.getCount()) ? parts[i + 1] : Part();
+		item->m_target = target;
+		item->m_toBuffer = toBuffer;
+
+		target += item->m_a.m_count + item->m_b.m_count;
+	}
+
+	m_nextItem = 0;
+	return true;
+}
+
+void SortBufferTask::complete()
+{
+	if (!m_inWork)
+		return;
+
+	// Sorted pointers are in the working space, move them into the buffer
+
+	const Item* const item = m_items[0];
+	const ULONG count = item->m_a.m_count + item->m_b.m_count;
+
+	for (ULONG i = 0; i < count; i++)
+	{
+		SORTP** const target = m_pointers + i;
+		*target = item->m_target[i];
+		((SORTP***) (*target))[BACK_OFFSET] = target;
+	}
+}
+
+} // namespace Jrd
+
+
 Sort::Sort(Database* dbb,
 		   SortOwner* owner,
 		   ULONG record_length,
@@ -163,7 +399,9 @@ Sort::Sort(Database* dbb,
 	  m_last_record(NULL), m_next_pointer(NULL), m_records(0),
 	  m_runs(NULL), m_merge(NULL), m_free_runs(NULL),
 	  m_flags(0), m_merge_pool(NULL),
-	  m_description(m_owner->getPool(), keys)
+	  m_charged_memory(0), m_coordinator(NULL),
+	  m_description(m_owner->getPool(), keys),
+	  m_radix_work(m_owner->getPool())
 {
 /**************************************
  *
@@ -197,6 +435,16 @@ Sort::Sort(Database* dbb,
 		m_min_alloc_size = record_size * MIN_RECORDS_TO_ALLOC;
 		m_max_alloc_size = MAX(m_min_alloc_size, MAX_SORT_BUFFER_SIZE);
 
+		// Big sort could be done by parallel workers of attachment,
+		// see init() and sortBufferParallel()
+		m_parallel_buffer_size = 0;
+
+		const thread_db* const tdbb = JRD_get_thread_data();
+		const Attachment* const att = tdbb ? tdbb->getAttachment() : nullptr;
+
+		if (att && !att->isWorker() && att->att_parallel_workers > 1)
+			m_parallel_buffer_size = m_max_alloc_size * RUN_GROUP * att->att_parallel_workers;
+
 		m_dup_callback = call_back;
 		m_dup_callback_arg = user_arg;
 		m_max_records = max_records;
@@ -266,6 +514,9 @@ Sort::~Sort()
 	// Release the temporary space
 	delete m_space;
 
+	// Stop the parallel workers
+	delete m_coordinator;
+
 	// If runs are allocated and not in the big block, release them.
 	// Then release the big block.
 
@@ -657,6 +908,12 @@ void Sort::allocateBuffer(MemoryPool& pool)
 
 void Sort::releaseBuffer()
 {
+	if (m_charged_memory)
+	{
+		m_dbb->decTempCacheUsage(m_charged_memory);
+		m_charged_memory = 0;
+	}
+
 	if (m_flags & scb_reuse_buffer)
 	{
 		fb_assert(m_size_memory == MAX_SORT_BUFFER_SIZE);
@@ -1413,6 +1670,40 @@ void Sort::init()
 		{} // no-op
 	}
 
+	// Sort doesn't fit into memory and can use parallel workers. Grow sort
+	// buffer space to let it be split into big enough partitions, so every
+	// run is sorted by a few threads, see sortBufferParallel(). The buffer
+	// is charged against TempCacheLimit as the in-memory runs are, so the
+	// parallel sort doesn't use more memory than the serial one would.
+
+	if (m_runs && m_size_memory < m_parallel_buffer_size)
+	{
+		if (!m_dbb->incTempCacheUsage(m_parallel_buffer_size))
+			m_parallel_buffer_size = 0;
+		else
+		{
+			try
+			{
+				UCHAR* const mem = FB_NEW_POOL(m_owner->getPool()) UCHAR[m_parallel_buffer_size];
+
+				releaseBuffer();
+
+				m_size_memory = m_parallel_buffer_size;
+				m_memory = mem;
+				m_charged_memory = m_parallel_buffer_size;
+
+				m_end_memory = m_memory + m_size_memory;
+				m_first_pointer = (sort_record**) m_memory;
+			}
+			catch (const BadAlloc&)
+			{
+				// don't try again
+				m_dbb->decTempCacheUsage(m_parallel_buffer_size);
+				m_parallel_buffer_size = 0;
+			}
+		}
+	}
+
 	m_next_pointer = m_first_pointer;
 	m_last_record = (SR*) m_end_memory;
 
@@ -1858,6 +2149,128 @@ void Sort::quick(SLONG size, SORTP** pointers, ULONG length) noexcept
 }
 
 
+void Sort::radix(SORTP** pointers, ULONG count, ULONG length,
+				 ULONG digit, ULONG digits, SORTP** work, ULONG depth) noexcept
+{
+/**************************************
+ *
+ * Sort an array of record pointers by the most significant digit
+ * first radix sort. Digits are bytes of key longwords starting from
+ * the most significant one, so the order is the same as longword
+ * compares of quick() give.
+ *
+ * Records are distributed into buckets by the current digit using
+ * the work array of the same size, then every bucket is sorted by
+ * the next digits. Small buckets, buckets of equal keys and buckets
+ * deeper than MAX_RADIX_DEPTH are passed to quick(), element next to
+ * a bucket always has greater key thus it works as a guard record.
+ * As quick() compares the whole records, records with equal keys end
+ * up ordered by their data the same way as without radix sort.
+ *
+ * Back pointers of records are not maintained, caller should take care.
+ *
+ **************************************/
+	while (true)
+	{
+		if (count < RADIX_THRESHOLD || digit >= digits || depth >= MAX_RADIX_DEPTH)
+		{
+			quick(count, pointers, length);
+			return;
+		}
+
+		const ULONG word = digit / sizeof(SORTP);
+		const int shift = 8 * (sizeof(SORTP) - 1 - digit % sizeof(SORTP));
+
+		ULONG counts[256];
+		memset(counts, 0, sizeof(counts));
+
+		for (SORTP** ptr = pointers; ptr < pointers + count; ptr++)
+			counts[((*ptr)[word] >> shift) & 0xFF]++;
+
+		// If all keys have the same digit, go to the next one
+		if (counts[((*pointers)[word] >> shift) & 0xFF] == count)
+		{
+			digit++;
+			continue;
+		}
+
+		SORTP** buckets[256];
+		SORTP** bucket = work;
+		for (int i = 0; i < 256; i++)
+		{
+			buckets[i] = bucket;
+			bucket += counts[i];
+		}
+
+		for (SORTP** ptr = pointers; ptr < pointers + count; ptr++)
+			*buckets[((*ptr)[word] >> shift) & 0xFF]++ = *ptr;
+
+		memcpy(pointers, work, count * sizeof(SORTP*));
+
+		// Sort every bucket by the next digits
+
+		bucket = pointers;
+		for (int i = 0; i < 256; i++)
+		{
+			if (counts[i] > 1)
+				radix(bucket, counts[i], length, digit + 1, digits, work, depth + 1);
+			bucket += counts[i];
+		}
+
+		return;
+	}
+}
+
+
+void Sort::sortPointers(SORTP** pointers, ULONG count, ULONG length,
+						ULONG keyLength, SORTP** work) noexcept
+{
+/**************************************
+ *
+ * Sort an array of record pointers, followed by the guard record
+ * with the greatest possible key. Use radix sort for short keys if
+ * the work array (of count elements) is given, quick sort otherwise.
+ *
+ **************************************/
+	if (work && keyLength <= MAX_RADIX_KEY_LONGS && count >= RADIX_THRESHOLD)
+	{
+		radix(pointers, count, length, 0, keyLength * sizeof(SORTP), work);
+
+		// Records were moved without swap(), make them point to their slots
+		for (SORTP** ptr = pointers; ptr < pointers + count; ptr++)
+			((SORTP***) (*ptr))[BACK_OFFSET] = ptr;
+	}
+	else
+		quick(count, pointers, length);
+
+	orderPairs(pointers, pointers + count, length);
+}
+
+
+void Sort::orderPairs(SORTP** j, SORTP** end, ULONG length) noexcept
+{
+/**************************************
+ *
+ * Quicksort, by design, doesn't order partitions of length 2,
+ * make a pass thru the array of record pointers (up to, but not
+ * including, the guard at the end) to straighten out pairs.
+ *
+ **************************************/
+	// hvlad: don't compare user keys against high_key
+	while (j < end - 1)
+	{
+		SORTP** i = j;
+		j++;
+		if (**i >= **j)
+		{
+			if (greater(*i, *j, length)) {
+				swap(i, j);
+			}
+		}
+	}
+}
+
+
 ULONG Sort::order()
 {
 /**************************************
@@ -2064,29 +2477,20 @@ void Sort::sortBuffer(thread_db* tdbb)
 	SORTP** j = (SORTP**) (m_first_pointer) + 1;
 	const ULONG n = (SORTP**) (m_next_pointer) - j;	// calculate # of records
 
-	quick(n, j, m_longs);
-
-	// Scream through and correct any out of order pairs
-	// hvlad: don't compare user keys against high_key
-	while (j < (SORTP**) m_next_pointer - 1)
+	if (!sortBufferParallel(tdbb, j, n))
 	{
-		SORTP** i = j;
-		j++;
-		if (**i >= **j)
+		SORTP** work = nullptr;
+		if (m_key_length <= MAX_RADIX_KEY_LONGS && n >= RADIX_THRESHOLD)
 		{
-			const SORTP* p = *i;
-			const SORTP* q = *j;
-			ULONG tl = m_longs - 1;
-			while (tl && *p == *q)
+			try
 			{
-				p++;
-				q++;
-				tl--;
-			}
-			if (tl && *p > *q) {
-				swap(i, j);
+				work = m_radix_work.getBuffer(n);
 			}
+			catch (const BadAlloc&)
+			{} // quick sort doesn't need it
 		}
+
+		sortPointers(j, n, m_longs, m_key_length, work);
 	}
 
 	// If duplicate handling hasn't been requested, we're done
@@ -2135,6 +2539,58 @@ void Sort::sortBuffer(thread_db* tdbb)
 }
 
 
+bool Sort::sortBufferParallel(thread_db* tdbb, SORTP** pointers, ULONG count)
+{
+/**************************************
+ *
+ * Sort big buffer of record pointers using parallel workers:
+ * split it into partitions, sort them concurrently and merge
+ * the results. Return false if the buffer should be sorted by
+ * the caller in a single thread.
+ *
+ **************************************/
+	const Attachment* const att = tdbb->getAttachment();
+
+	// Worker attachments are used by a parallel task already, don't nest
+	if (!att || att->isWorker() || att->att_parallel_workers < 2)
+		return false;
+
+	const ULONG partitions = MIN((ULONG) att->att_parallel_workers, count / MIN_PARALLEL_SORT_RECORDS);
+	if (partitions < 2)
+		return false;
+
+	MemoryPool& pool = m_owner->getPool();
+
+	// Working space holds partitions with the guard (high key) after every one of them
+	SORTP** work = nullptr;
+	try
+	{
+		work = FB_NEW_POOL(pool) SORTP*[count + partitions];
+	}
+	catch (const BadAlloc&)
+	{
+		return false;
+	}
+
+	AutoPtr<SORTP*, ArrayDelete> workSpace(work);
+
+	// Keep the worker threads between runs of the same sort
+	if (!m_coordinator)
+		m_coordinator = FB_NEW_POOL(pool) Coordinator(&pool);
+
+	SortBufferTask task(pool, pointers, count, m_longs, m_key_length, work, partitions);
+
+	do
+	{
+		m_coordinator->runSync(&task);
+	} while (task.nextRound());
+
+	task.complete();
+
+	return true;
+}
+
+
 void Sort::sortRunsBySeek(int n)
 {
 /**************************************
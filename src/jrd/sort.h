@@ -29,11 +29,16 @@
 #include "../jrd/TempSpace.h"
 #include "../jrd/align.h"
 
+namespace Firebird {
+class Coordinator;
+}
+
 namespace Jrd {
 
 // Forward declaration
 class Attachment;
 class Sort;
+class SortBufferTask;
 class SortOwner;
 struct merge_control;
 
@@ -276,6 +281,7 @@ inline constexpr int scb_reuse_buffer	= 2;	// reuse buffer if possible
 class Sort
 {
 	friend class PartitionedSort;
+	friend class SortBufferTask;
 public:
 	Sort(Database*, SortOwner*,
 		 ULONG, FB_SIZE_T, FB_SIZE_T, const sort_key_def*,
@@ -291,6 +297,10 @@ public:
 		return m_flags & scb_sorted;
 	}
 
+	// Sort array of pointers to keys of records, see sortBuffer()
+	static void sortPointers(SORTP** pointers, ULONG count, ULONG length,
+		ULONG keyLength, SORTP** work) noexcept;
+
 	static FB_UINT64 readBlock(TempSpace* space, FB_UINT64 seek, UCHAR* address, ULONG length)
 	{
 		const size_t bytes = space->read(seek, address, length);
@@ -319,6 +329,7 @@ private:
 	void orderAndSave(Jrd::thread_db*);
 	void putRun(Jrd::thread_db*);
 	void sortBuffer(Jrd::thread_db*);
+	bool sortBufferParallel(Jrd::thread_db*, SORTP**, ULONG);
 	void sortRunsBySeek(int);
 
 #ifdef DEV_BUILD
@@ -326,6 +337,8 @@ private:
 #endif
 
 	static void quick(SLONG, SORTP**, ULONG) noexcept;
+	static void radix(SORTP**, ULONG, ULONG, ULONG, ULONG, SORTP**, ULONG = 0) noexcept;
+	static void orderPairs(SORTP**, SORTP**, ULONG) noexcept;
 
 	Database* m_dbb;							// Database
 	SortOwner* m_owner;							// Sort owner
@@ -351,8 +364,12 @@ private:
 
 	ULONG m_min_alloc_size;						// MIN and MAX values
 	ULONG m_max_alloc_size;						// for the run buffer size
+	ULONG m_parallel_buffer_size;				// Sort buffer size for parallel sorting, zero if not used
+	ULONG m_charged_memory;						// Part of m_memory charged against the temp cache limit
+	Firebird::Coordinator* m_coordinator;		// Parallel workers reused for every run of the sort
 
 	Firebird::Array<sort_key_def> m_description;
+	Firebird::Array<SORTP*> m_radix_work;		// Work space for radix sort
 };
 
 
@@ -331,6 +331,15 @@ public:
 		// else dbbStat is adjusted from attStat, see Attachment::mergeStats()
 	}
 
+	void bumpStats(const CachePageClass pageClass, bool read)
+	{
+		// Counted per attachment only, the totals are merged on demand
+		attStat->bumpValue(pageClass, read);
+
+		if ((tdbb_flags & TDBB_async) && !attachment)
+			dbbStat->bumpValue(pageClass, read);
+	}
+
 	void bumpStats(const RecordStatType type, SLONG relationId, SINT64 delta = 1)
 	{
 		// We expect that at least attStat is present (not a dummy object)
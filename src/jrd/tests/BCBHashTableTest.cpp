@@ -0,0 +1,181 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include <atomic>
+#include <chrono>
+#include <latch>
+#include <thread>
+#include <vector>
+#include "../jrd/BCBHashTable.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	// Attach thread to the lock-free lists infrastructure, if used
+	class CdsThreadHolder
+	{
+	public:
+		CdsThreadHolder()
+		{
+#ifdef HASH_USE_CDS_LIST
+			if (!cds::threading::Manager::isThreadAttached())
+			{
+				cds::threading::Manager::attachThread();
+				attached = true;
+			}
+#endif
+		}
+
+		~CdsThreadHolder()
+		{
+#ifdef HASH_USE_CDS_LIST
+			if (attached)
+				cds::threading::Manager::detachThread();
+#endif
+		}
+
+	private:
+		bool attached = false;
+	};
+
+	class Buffers
+	{
+	public:
+		Buffers(MemoryPool& pool, BCBHashTable& hashTable, ULONG count)
+		{
+			for (ULONG i = 0; i < count; ++i)
+			{
+				BufferDesc* const bdb = FB_NEW_POOL(pool) BufferDesc(nullptr);
+				const PageNumber page(DB_PAGE_SPACE, i + 1);
+
+				BOOST_REQUIRE(hashTable.emplace(bdb, page, false) == nullptr);
+				bdb->bdb_page = page;
+				bdbs.push_back(bdb);
+			}
+		}
+
+		~Buffers()
+		{
+			for (auto bdb : bdbs)
+				delete bdb;
+		}
+
+		std::vector<BufferDesc*> bdbs;
+	};
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(BCBHashTableSuite)
+BOOST_AUTO_TEST_SUITE(BCBHashTableTests)
+
+
+BOOST_AUTO_TEST_CASE(EmplaceFindRemoveTest)
+{
+	CdsThreadHolder cdsThread;
+	auto& pool = *getDefaultMemoryPool();
+
+	constexpr ULONG BUFFER_COUNT = 100u;
+
+	BCBHashTable hashTable(pool, BUFFER_COUNT / 2);
+	Buffers buffers(pool, hashTable, BUFFER_COUNT);
+
+	for (ULONG i = 0; i < BUFFER_COUNT; ++i)
+		BOOST_TEST(hashTable.find(PageNumber(DB_PAGE_SPACE, i + 1)) == buffers.bdbs[i]);
+
+	BOOST_TEST(hashTable.find(PageNumber(DB_PAGE_SPACE, BUFFER_COUNT + 1)) == nullptr);
+
+	// Page already has a buffer
+	BufferDesc* const first = buffers.bdbs.front();
+	BufferDesc* const last = buffers.bdbs.back();
+	BOOST_TEST(hashTable.emplace(last, first->bdb_page, true) == first);
+
+	// Reassign buffer to another page
+	const PageNumber oldPage = last->bdb_page;
+	const PageNumber newPage(DB_PAGE_SPACE, BUFFER_COUNT * 10);
+
+	BOOST_TEST(hashTable.emplace(last, newPage, true) == nullptr);
+	last->bdb_page = newPage;
+
+	BOOST_TEST(hashTable.find(oldPage) == nullptr);
+	BOOST_TEST(hashTable.find(newPage) == last);
+
+	hashTable.remove(last);
+	BOOST_TEST(hashTable.find(newPage) == nullptr);
+
+	// Resize keeps all buffers
+	hashTable.resize(BUFFER_COUNT * 2);
+
+	for (ULONG i = 0; i < BUFFER_COUNT - 1; ++i)
+		BOOST_TEST(hashTable.find(PageNumber(DB_PAGE_SPACE, i + 1)) == buffers.bdbs[i]);
+
+	hashTable.clear();
+}
+
+
+// Measures scalability of concurrent lookups of cached pages.
+// Run with --log_level=message to see the numbers.
+BOOST_AUTO_TEST_CASE(ConcurrentLookupTest)
+{
+	CdsThreadHolder cdsThread;
+	auto& pool = *getDefaultMemoryPool();
+
+	constexpr ULONG BUFFER_COUNT = 4096u;
+	constexpr unsigned MAX_THREAD_COUNT = 128u;
+	constexpr unsigned LOOKUP_COUNT = 50'000u;
+
+	BCBHashTable hashTable(pool, BUFFER_COUNT);
+	Buffers buffers(pool, hashTable, BUFFER_COUNT);
+
+	for (unsigned threadCount = 1u; threadCount <= MAX_THREAD_COUNT; threadCount *= 2)
+	{
+		std::atomic_uint misses = 0u;
+		std::vector<std::thread> threads;
+		std::latch latch(threadCount + 1);
+
+		for (unsigned threadNum = 0u; threadNum < threadCount; ++threadNum)
+		{
+			threads.emplace_back([&, threadNum]() {
+				CdsThreadHolder cdsThread;
+				unsigned localMisses = 0u;
+				ULONG seed = threadNum + 1;
+
+				latch.arrive_and_wait();
+
+				for (unsigned i = 0u; i < LOOKUP_COUNT; ++i)
+				{
+					seed = seed * 1103515245u + 12345u;
+					const PageNumber page(DB_PAGE_SPACE, (seed >> 8) % BUFFER_COUNT + 1);
+
+					if (!hashTable.find(page))
+						++localMisses;
+				}
+
+				misses += localMisses;
+			});
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		latch.arrive_and_wait();
+
+		for (auto& thread : threads)
+			thread.join();
+
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		const double lookups = double(threadCount) * LOOKUP_COUNT;
+
+		BOOST_TEST_MESSAGE("BCBHashTable: " << threadCount << " thread(s), " <<
+			unsigned(lookups / elapsed.count()) << " lookups/sec");
+
+		BOOST_CHECK_EQUAL(misses.load(), 0u);
+	}
+
+	hashTable.clear();
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()	// BCBHashTableTests
+BOOST_AUTO_TEST_SUITE_END()	// BCBHashTableSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
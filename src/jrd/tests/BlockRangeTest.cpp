@@ -0,0 +1,213 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include <cstring>
+#include <vector>
+#include "../jrd/jrd.h"
+#include "../jrd/btr.h"
+#include "../jrd/ods.h"
+#include "../jrd/rng_proto.h"
+#include "../jrd/optimizer/Optimizer.h"
+
+using namespace Firebird;
+using namespace Jrd;
+using namespace Ods;
+
+
+namespace
+{
+	const USHORT KEY_LENGTH = 8;
+
+	// Summary entry followed by the lowest and the highest keys, see ods.h
+	class TestEntry
+	{
+	public:
+		TestEntry()
+			: buffer(RNE_SIZE + 2 * KEY_LENGTH)
+		{}
+
+		range_entry* operator->()
+		{
+			return get();
+		}
+
+		range_entry* get()
+		{
+			return (range_entry*) buffer.data();
+		}
+
+		bool widen(const char* key)
+		{
+			return RNG_widen_entry(get(), KEY_LENGTH, (const UCHAR*) key, (USHORT) strlen(key));
+		}
+
+		bool covers(const char* key)
+		{
+			return RNG_covers_key(get(), KEY_LENGTH, (const UCHAR*) key, (USHORT) strlen(key));
+		}
+
+		bool matches(const char* lower, const char* upper)
+		{
+			temporary_key lowerKey, upperKey;
+			return RNG_entry_matches(get(), KEY_LENGTH,
+				makeKey(lower, lowerKey), makeKey(upper, upperKey));
+		}
+
+	private:
+		static const temporary_key* makeKey(const char* value, temporary_key& key)
+		{
+			if (!value)
+				return nullptr;
+
+			key.key_flags = 0;
+			key.key_nulls = 0;
+			key.key_length = (USHORT) strlen(value);
+			memcpy(key.key_data, value, key.key_length);
+
+			return &key;
+		}
+
+		std::vector<UCHAR> buffer;
+	};
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(BlockRangeSuite)
+BOOST_AUTO_TEST_SUITE(SummaryTests)
+
+
+BOOST_AUTO_TEST_CASE(CompareKeysTest)
+{
+	BOOST_TEST(RNG_compare_keys((const UCHAR*) "abc", 3, (const UCHAR*) "abc", 3) == 0);
+	BOOST_TEST(RNG_compare_keys((const UCHAR*) "ab", 2, (const UCHAR*) "abc", 3) < 0);
+	BOOST_TEST(RNG_compare_keys((const UCHAR*) "b", 1, (const UCHAR*) "abc", 3) > 0);
+	BOOST_TEST(RNG_compare_keys((const UCHAR*) "", 0, (const UCHAR*) "a", 1) < 0);
+}
+
+
+BOOST_AUTO_TEST_CASE(WidenTest)
+{
+	TestEntry entry;
+
+	// Empty range holds no keys
+	BOOST_TEST(!entry.covers("m"));
+	BOOST_TEST(!entry.matches(nullptr, nullptr));
+
+	BOOST_TEST(entry.widen("m"));
+	BOOST_TEST((entry->rne_flags & rne_used));
+	BOOST_TEST(entry.covers("m"));
+	BOOST_TEST(!entry.covers("l"));
+
+	BOOST_TEST(entry.widen("d"));
+	BOOST_TEST(entry.widen("x"));
+	BOOST_TEST(!entry.widen("k"));
+
+	BOOST_TEST(entry.covers("d"));
+	BOOST_TEST(entry.covers("kk"));
+	BOOST_TEST(entry.covers("x"));
+	BOOST_TEST(!entry.covers("c"));
+	BOOST_TEST(!entry.covers("xa"));
+}
+
+
+BOOST_AUTO_TEST_CASE(UnboundedTest)
+{
+	TestEntry entry;
+	entry.widen("m");
+
+	// Key longer than the reserved length makes the range match anything
+	BOOST_TEST(entry.widen("0123456789"));
+	BOOST_TEST((entry->rne_flags & rne_unbounded));
+	BOOST_TEST(!entry.widen("a"));
+
+	BOOST_TEST(entry.covers("a"));
+	BOOST_TEST(entry.matches("y", "z"));
+}
+
+
+BOOST_AUTO_TEST_CASE(MatchTest)
+{
+	TestEntry entry;
+	entry.widen("d");
+	entry.widen("m");
+
+	BOOST_TEST(entry.matches(nullptr, nullptr));
+
+	// Bounds are inclusive
+	BOOST_TEST(entry.matches("m", nullptr));
+	BOOST_TEST(entry.matches(nullptr, "d"));
+	BOOST_TEST(entry.matches("a", "e"));
+	BOOST_TEST(entry.matches("e", "f"));
+	BOOST_TEST(entry.matches("a", "z"));
+
+	BOOST_TEST(!entry.matches("n", nullptr));
+	BOOST_TEST(!entry.matches(nullptr, "c"));
+	BOOST_TEST(!entry.matches("ma", "z"));
+	BOOST_TEST(!entry.matches("a", "cz"));
+}
+
+
+BOOST_AUTO_TEST_CASE(OpenRangeTest)
+{
+	TestEntry entry;
+	entry.widen("d");
+	entry.widen("m");
+
+	// Open range is summarized in memory, meanwhile it matches any key
+	// and the inserts don't need to widen its entry on the page
+
+	entry->rne_flags |= rne_open;
+
+	BOOST_TEST(entry.covers("z"));
+	BOOST_TEST(entry.matches("x", "z"));
+	BOOST_TEST(entry.matches(nullptr, "a"));
+
+	// Keys collected in memory widen the entry when the range is closed
+
+	entry.widen("b");
+	entry.widen("p");
+	entry->rne_flags &= ~rne_open;
+
+	BOOST_TEST(entry.matches("a", "c"));
+	BOOST_TEST(entry.matches("o", "z"));
+	BOOST_TEST(!entry.matches("q", "z"));
+	BOOST_TEST(!entry.matches(nullptr, "a"));
+
+	// Range without records is open as well
+	TestEntry empty;
+	empty->rne_flags |= rne_open;
+	BOOST_TEST(empty.matches("q", "z"));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()	// SummaryTests
+
+
+BOOST_AUTO_TEST_SUITE(CostTests)
+
+
+BOOST_AUTO_TEST_CASE(BlockRangeCostTest)
+{
+	// Single range is read anyway
+	BOOST_TEST(!Optimizer::isBlockRangeCheaper(RANGE_DATA_PAGES, 1, 0.001));
+	BOOST_TEST(!Optimizer::isBlockRangeCheaper(10, 1, 0.001));
+
+	// At least one range of pages is read, so the table must be large enough
+	BOOST_TEST(!Optimizer::isBlockRangeCheaper(RANGE_DATA_PAGES * 2, 2, 0.001));
+	BOOST_TEST(Optimizer::isBlockRangeCheaper(RANGE_DATA_PAGES * 4, 2, 0.001));
+
+	// Selective conditions skip most of the ranges
+	BOOST_TEST(Optimizer::isBlockRangeCheaper(100000, 10, 0.05));
+	BOOST_TEST(Optimizer::isBlockRangeCheaper(100000, 10, 0.0025));
+
+	// Unselective ones would read the most of the table
+	BOOST_TEST(!Optimizer::isBlockRangeCheaper(100000, 10, 0.5));
+	BOOST_TEST(!Optimizer::isBlockRangeCheaper(100000, 10, 1.0));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()	// CostTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// BlockRangeSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -0,0 +1,100 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/GarbageCollector.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	unsigned countPages(PageBitmap* bm)
+	{
+		unsigned count = 0;
+
+		for (bool found = bm->getFirst(); found; found = bm->getNext())
+			count++;
+
+		return count;
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(GarbageCollectorSuite)
+BOOST_AUTO_TEST_SUITE(GarbageCollectorTests)
+
+
+BOOST_AUTO_TEST_CASE(BacklogTest)
+{
+	GarbageCollector gc(*getDefaultMemoryPool(), nullptr);
+
+	ULONG relations;
+	FB_UINT64 pages;
+
+	gc.getBacklog(relations, pages);
+	BOOST_TEST(relations == 0u);
+	BOOST_TEST(pages == 0u);
+
+	for (ULONG page = 100; page < 103; page++)
+		gc.addPage(1, page, 10);
+
+	for (ULONG page = 200; page < 210; page++)
+		gc.addPage(2, page, 10);
+
+	// The same page is counted once
+	gc.addPage(2, 200, 20);
+
+	gc.getBacklog(relations, pages);
+	BOOST_TEST(relations == 2u);
+	BOOST_TEST(pages == 13u);
+
+	// Pages are not ready while their transactions are not older than the oldest snapshot
+	gc.sweptRelation(10, 1);
+
+	gc.getBacklog(relations, pages);
+	BOOST_TEST(pages == 13u);
+}
+
+
+BOOST_AUTO_TEST_CASE(PriorityTest)
+{
+	GarbageCollector gc(*getDefaultMemoryPool(), nullptr);
+
+	for (ULONG page = 100; page < 103; page++)
+		gc.addPage(1, page, 10);
+
+	for (ULONG page = 200; page < 210; page++)
+		gc.addPage(2, page, 10);
+
+	// The relation with the larger backlog goes first
+
+	USHORT relID = 0;
+	PageBitmap* bm = gc.getPages(100, relID);
+
+	BOOST_TEST_REQUIRE(bm);
+	BOOST_TEST(relID == 2u);
+	BOOST_TEST(countPages(bm) == 10u);
+	delete bm;
+
+	bm = gc.getPages(100, relID);
+
+	BOOST_TEST_REQUIRE(bm);
+	BOOST_TEST(relID == 1u);
+	BOOST_TEST(countPages(bm) == 3u);
+	delete bm;
+
+	BOOST_TEST(!gc.getPages(100, relID));
+
+	ULONG relations;
+	FB_UINT64 pages;
+
+	gc.getBacklog(relations, pages);
+	BOOST_TEST(relations == 0u);
+	BOOST_TEST(pages == 0u);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()	// GarbageCollectorTests
+BOOST_AUTO_TEST_SUITE_END()	// GarbageCollectorSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -0,0 +1,199 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include <string>
+#include "../jrd/IndexHistogram.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	using Bound = IndexHistogram::Bound;
+
+	// Fixed width keys keep the byte order equal to the numeric one
+	std::string makeKey(unsigned value)
+	{
+		char buffer[16];
+		snprintf(buffer, sizeof(buffer), "%08u", value);
+		return buffer;
+	}
+
+	Bound makeBound(const std::string& key)
+	{
+		return Bound(reinterpret_cast<const UCHAR*>(key.data()), static_cast<USHORT>(key.length()));
+	}
+
+	void addKey(IndexHistogram& histogram, const std::string& key)
+	{
+		histogram.add(reinterpret_cast<const UCHAR*>(key.data()), static_cast<USHORT>(key.length()));
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(IndexHistogramSuite)
+BOOST_AUTO_TEST_SUITE(IndexHistogramTests)
+
+
+BOOST_AUTO_TEST_CASE(SamplingTest)
+{
+	IndexHistogram small(*getDefaultMemoryPool());
+
+	for (unsigned i = 0; i < 100; i++)
+		addKey(small, makeKey(i));
+
+	// All keys are kept while the sample is not full
+	BOOST_TEST(small.getKeyCount() == 100u);
+	BOOST_TEST(small.getSampleCount() == 100u);
+	BOOST_TEST(small.countSamples(Bound(), Bound(), false) == 100u);
+
+	IndexHistogram large(*getDefaultMemoryPool());
+
+	for (unsigned i = 0; i < 100000; i++)
+		addKey(large, makeKey(i));
+
+	BOOST_TEST(large.getKeyCount() == 100000u);
+	BOOST_TEST(large.getSampleCount() >= IndexHistogram::MIN_SAMPLES);
+	BOOST_TEST(large.getSampleCount() <= IndexHistogram::MIN_SAMPLES * 2);
+
+	// Samples are spread evenly, so a tenth of the keys gets about a tenth of the samples
+	const std::string lower = makeKey(20000), upper = makeKey(29999);
+	const double share = double(large.countSamples(makeBound(lower), makeBound(upper), false)) /
+		large.getSampleCount();
+
+	BOOST_TEST(share > 0.09);
+	BOOST_TEST(share < 0.11);
+}
+
+
+BOOST_AUTO_TEST_CASE(BoundsTest)
+{
+	IndexHistogram histogram(*getDefaultMemoryPool());
+
+	for (unsigned i = 0; i < 200; i++)
+		addKey(histogram, makeKey(i));
+
+	const std::string k10 = makeKey(10), k19 = makeKey(19), k50 = makeKey(50);
+
+	// Both bounds are inclusive
+	BOOST_TEST(histogram.countSamples(makeBound(k10), makeBound(k19), false) == 10u);
+	BOOST_TEST(histogram.countSamples(makeBound(k50), makeBound(k50), false) == 1u);
+	BOOST_TEST(histogram.countSamples(makeBound(k19), makeBound(k10), false) == 0u);
+
+	// Open bounds
+	BOOST_TEST(histogram.countSamples(Bound(), makeBound(k19), false) == 20u);
+	BOOST_TEST(histogram.countSamples(makeBound(k50), Bound(), false) == 150u);
+
+	// Prefix covers all keys starting with it, 00000100 - 00000199
+	const std::string prefix = "000001";
+	BOOST_TEST(histogram.countSamples(makeBound(prefix), makeBound(prefix), true) == 100u);
+	BOOST_TEST(histogram.countSamples(makeBound(prefix), makeBound(prefix), false) == 0u);
+
+	// Shorter key goes first
+	const std::string shorter = "0000001";
+	BOOST_TEST(histogram.countSamples(Bound(), makeBound(shorter), false) == 10u);
+}
+
+
+BOOST_AUTO_TEST_CASE(SkewTest)
+{
+	IndexHistogram histogram(*getDefaultMemoryPool());
+
+	// Half of the keys have the same value, the rest are unique
+	const std::string frequent = makeKey(500000);
+
+	for (unsigned i = 0; i < 50000; i++)
+		addKey(histogram, makeKey(i));
+
+	for (unsigned i = 0; i < 50000; i++)
+		addKey(histogram, frequent);
+
+	for (unsigned i = 500001; i < 550001; i++)
+		addKey(histogram, makeKey(i));
+
+	const double samples = histogram.getSampleCount();
+	const double frequentShare = histogram.countSamples(makeBound(frequent), makeBound(frequent), false) / samples;
+
+	BOOST_TEST(frequentShare > 0.3);
+	BOOST_TEST(frequentShare < 0.4);
+
+	const std::string rare = makeKey(123);
+	BOOST_TEST(histogram.countSamples(makeBound(rare), makeBound(rare), false) <= 1u);
+}
+
+
+BOOST_AUTO_TEST_CASE(StoreLoadTest)
+{
+	IndexHistogram histogram(*getDefaultMemoryPool());
+	histogram.setRoot(1234);
+	histogram.setKeyType(8);
+
+	for (unsigned i = 0; i < 10000; i++)
+		addKey(histogram, makeKey(i));
+
+	UCharBuffer image;
+	histogram.store(image);
+
+	IndexHistogram loaded(*getDefaultMemoryPool());
+	BOOST_REQUIRE(loaded.load(image.begin(), image.getCount()));
+
+	BOOST_TEST(loaded.getRoot() == 1234u);
+	BOOST_TEST(loaded.getKeyType() == 8u);
+	BOOST_TEST(loaded.getKeyCount() == histogram.getKeyCount());
+	BOOST_TEST(loaded.getSampleCount() == histogram.getSampleCount());
+
+	const std::string lower = makeKey(2000), upper = makeKey(4999);
+	BOOST_TEST(loaded.countSamples(makeBound(lower), makeBound(upper), false) ==
+		histogram.countSamples(makeBound(lower), makeBound(upper), false));
+
+	// Keys keep coming to the loaded histogram at the same interval
+	for (unsigned i = 10000; i < 20000; i++)
+	{
+		addKey(histogram, makeKey(i));
+		addKey(loaded, makeKey(i));
+	}
+
+	UCharBuffer image2;
+	loaded.store(image2);
+	histogram.store(image);
+	BOOST_TEST((image == image2));
+
+	// Damaged images are rejected
+	BOOST_TEST(!loaded.load(image.begin(), image.getCount() - 1));
+	image[0] = 0;
+	BOOST_TEST(!loaded.load(image.begin(), image.getCount()));
+	BOOST_TEST(!loaded.load(image.begin(), 3));
+}
+
+
+BOOST_AUTO_TEST_CASE(SamplerTest)
+{
+	// Keys come in the order of the table, the sampler sorts them
+	IndexHistogram::Sampler sampler(*getDefaultMemoryPool());
+
+	for (unsigned i = 0; i < 100000; i++)
+	{
+		const std::string key = makeKey((i * 7919u) % 100000u);
+		sampler.add(reinterpret_cast<const UCHAR*>(key.data()), static_cast<USHORT>(key.length()));
+	}
+
+	IndexHistogram histogram(*getDefaultMemoryPool());
+	sampler.build(&histogram);
+
+	BOOST_TEST(histogram.getSampleCount() >= IndexHistogram::MIN_SAMPLES);
+	BOOST_TEST(histogram.getSampleCount() <= IndexHistogram::MIN_SAMPLES * 2);
+
+	// The random sample is about as even as the ordered one
+	const std::string lower = makeKey(50000), upper = makeKey(74999);
+	const double share = double(histogram.countSamples(makeBound(lower), makeBound(upper), false)) /
+		histogram.getSampleCount();
+
+	BOOST_TEST(share > 0.18);
+	BOOST_TEST(share < 0.32);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()	// IndexHistogramTests
+BOOST_AUTO_TEST_SUITE_END()	// IndexHistogramSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
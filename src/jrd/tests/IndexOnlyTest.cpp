@@ -0,0 +1,341 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include <cstring>
+#include <vector>
+#include "../jrd/jrd.h"
+#include "../jrd/btr.h"
+#include "../jrd/btr_proto.h"
+#include "../jrd/Record.h"
+#include "../jrd/ods.h"
+#include "../jrd/optimizer/Optimizer.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	typedef std::vector<UCHAR> Bytes;
+
+	// Index keys are built here the way compress() and IndexKey::compose() do it,
+	// every segment is a big-endian number with the sign bit flipped (or complemented
+	// as a whole for the negative doubles) and the trailing zeros chopped off
+
+	Bytes makeSegment(FB_UINT64 value, unsigned size, bool negative = false)
+	{
+		Bytes bytes;
+
+		for (unsigned i = 0; i < size; i++)
+			bytes.push_back(UCHAR(value >> ((size - 1 - i) * 8)));
+
+		if (negative)
+		{
+			for (auto& byte : bytes)
+				byte = ~byte;
+		}
+		else
+			bytes[0] ^= 0x80;
+
+		while (bytes.size() > 1 && !bytes.back())
+			bytes.pop_back();
+
+		return bytes;
+	}
+
+	Bytes numericSegment(double number)
+	{
+		if (number == 0)
+			number = 0;
+
+		FB_UINT64 value;
+		memcpy(&value, &number, sizeof(value));
+
+		return makeSegment(value, sizeof(double), number < 0);
+	}
+
+	Bytes dateSegment(ISC_DATE date)
+	{
+		return makeSegment((ULONG) date, sizeof(ULONG));
+	}
+
+	Bytes timeSegment(ISC_TIME time)
+	{
+		return makeSegment(time, sizeof(ULONG));
+	}
+
+	Bytes timestampSegment(ISC_DATE date, ISC_TIME time)
+	{
+		const SINT64 ticks = NoThrowTimeStamp::SECONDS_PER_DAY * ISC_TIME_SECONDS_PRECISION;
+		return makeSegment((FB_UINT64) (date * ticks + time), sizeof(SINT64));
+	}
+
+	Bytes booleanSegment(bool value)
+	{
+		return makeSegment(value ? 1 : 0, sizeof(UCHAR));
+	}
+
+	// Empty segment stands for NULL
+	void makeKey(const index_desc& idx, const std::vector<Bytes>& segments, temporary_key& key)
+	{
+		key.key_flags = 0;
+		key.key_nulls = 0;
+
+		UCHAR* p = key.key_data;
+
+		if (idx.idx_count == 1)
+		{
+			memcpy(p, segments[0].data(), segments[0].size());
+			key.key_length = (USHORT) segments[0].size();
+			return;
+		}
+
+		int stuffCount = 0;
+
+		for (USHORT n = 0; n < idx.idx_count; n++)
+		{
+			for (; stuffCount; --stuffCount)
+				*p++ = 0;
+
+			for (const auto byte : segments[n])
+			{
+				if (!stuffCount)
+				{
+					*p++ = UCHAR(idx.idx_count - n);
+					stuffCount = Ods::STUFF_COUNT;
+				}
+
+				*p++ = byte;
+				--stuffCount;
+			}
+		}
+
+		key.key_length = (USHORT) (p - key.key_data);
+	}
+
+	// Every field takes 8 bytes after the null flags
+	class TestRecord
+	{
+	public:
+		explicit TestRecord(const std::vector<dsc>& fields)
+			: format(Format::newFormat(*getDefaultMemoryPool(), (int) fields.size()))
+		{
+			for (USHORT i = 0; i < fields.size(); i++)
+			{
+				format->fmt_desc[i] = fields[i];
+				format->fmt_desc[i].dsc_address = (UCHAR*) (IPTR) (FIELD_SIZE * (i + 1));
+			}
+
+			format->fmt_length = FIELD_SIZE * (format->fmt_count + 1);
+			record = FB_NEW_POOL(*getDefaultMemoryPool()) Record(*getDefaultMemoryPool(), format);
+		}
+
+		~TestRecord()
+		{
+			delete record;
+			delete format;
+		}
+
+		template <typename T>
+		T get(USHORT id) const
+		{
+			T value;
+			memcpy(&value, record->getData() + FIELD_SIZE * (id + 1), sizeof(T));
+			return value;
+		}
+
+		static constexpr unsigned FIELD_SIZE = 8;
+
+		Format* format;
+		Record* record;
+	};
+
+	dsc makeField(UCHAR dtype, USHORT length)
+	{
+		dsc desc;
+		desc.clear();
+		desc.dsc_dtype = dtype;
+		desc.dsc_length = length;
+		return desc;
+	}
+
+	index_desc makeIndex(const std::vector<USHORT>& itypes)
+	{
+		index_desc idx;
+		memset(&idx, 0, sizeof(idx));
+		idx.idx_count = (USHORT) itypes.size();
+
+		for (USHORT i = 0; i < idx.idx_count; i++)
+		{
+			idx.idx_rpt[i].idx_field = i;
+			idx.idx_rpt[i].idx_itype = itypes[i];
+		}
+
+		return idx;
+	}
+
+	bool decode(const index_desc& idx, const std::vector<Bytes>& segments, TestRecord& test)
+	{
+		temporary_key key;
+		makeKey(idx, segments, key);
+		return BTR_decode_key(&idx, &key, nullptr, 0, test.record);
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(IndexOnlySuite)
+BOOST_AUTO_TEST_SUITE(DecodeKeyTests)
+
+
+BOOST_AUTO_TEST_CASE(NumericTest)
+{
+	const index_desc idx = makeIndex({idx_numeric});
+
+	for (const SSHORT value : {SSHORT(0), SSHORT(1), SSHORT(-1), SSHORT(MAX_SSHORT), SSHORT(MIN_SSHORT)})
+	{
+		TestRecord test({makeField(dtype_short, sizeof(SSHORT))});
+		BOOST_TEST(decode(idx, {numericSegment(value)}, test));
+		BOOST_TEST(!test.record->isNull(0));
+		BOOST_TEST(test.get<SSHORT>(0) == value);
+	}
+
+	for (const SLONG value : {SLONG(0), SLONG(256), SLONG(-1000000), SLONG(MAX_SLONG), SLONG(MIN_SLONG)})
+	{
+		TestRecord test({makeField(dtype_long, sizeof(SLONG))});
+		BOOST_TEST(decode(idx, {numericSegment(value)}, test));
+		BOOST_TEST(test.get<SLONG>(0) == value);
+	}
+
+	for (const double value : {0.0, -0.0, 0.5, -2.75, 1e300, -1e-300})
+	{
+		TestRecord test({makeField(dtype_double, sizeof(double))});
+		BOOST_TEST(decode(idx, {numericSegment(value)}, test));
+		BOOST_TEST(test.get<double>(0) == value);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(DateTimeTest)
+{
+	for (const ISC_DATE value : {ISC_DATE(0), ISC_DATE(58849), ISC_DATE(-678575), ISC_DATE(2973483)})
+	{
+		TestRecord test({makeField(dtype_sql_date, sizeof(ISC_DATE))});
+		BOOST_TEST(decode(makeIndex({idx_sql_date}), {dateSegment(value)}, test));
+		BOOST_TEST(test.get<ISC_DATE>(0) == value);
+	}
+
+	for (const ISC_TIME value : {ISC_TIME(0), ISC_TIME(1), ISC_TIME(863999999)})
+	{
+		TestRecord test({makeField(dtype_sql_time, sizeof(ISC_TIME))});
+		BOOST_TEST(decode(makeIndex({idx_sql_time}), {timeSegment(value)}, test));
+		BOOST_TEST(test.get<ISC_TIME>(0) == value);
+	}
+
+	const std::pair<ISC_DATE, ISC_TIME> timestamps[] = {
+		{0, 0}, {58849, 432000000}, {-678575, 863999999}, {2973483, 1}
+	};
+
+	for (const auto& value : timestamps)
+	{
+		TestRecord test({makeField(dtype_timestamp, sizeof(ISC_TIMESTAMP))});
+		BOOST_TEST(decode(makeIndex({idx_timestamp}), {timestampSegment(value.first, value.second)}, test));
+
+		const auto timestamp = test.get<ISC_TIMESTAMP>(0);
+		BOOST_TEST(timestamp.timestamp_date == value.first);
+		BOOST_TEST(timestamp.timestamp_time == value.second);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(BooleanTest)
+{
+	for (const bool value : {false, true})
+	{
+		TestRecord test({makeField(dtype_boolean, sizeof(UCHAR))});
+		BOOST_TEST(decode(makeIndex({idx_boolean}), {booleanSegment(value)}, test));
+		BOOST_TEST(test.get<UCHAR>(0) == (value ? 1 : 0));
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(CompoundTest)
+{
+	// Short segments are padded up to STUFF_COUNT bytes before the next one
+	const index_desc idx = makeIndex({idx_boolean, idx_numeric, idx_sql_date, idx_numeric});
+
+	TestRecord test({makeField(dtype_boolean, sizeof(UCHAR)), makeField(dtype_long, sizeof(SLONG)),
+		makeField(dtype_sql_date, sizeof(ISC_DATE)), makeField(dtype_double, sizeof(double))});
+
+	BOOST_TEST(decode(idx,
+		{booleanSegment(true), numericSegment(-12345), dateSegment(58849), numericSegment(0.125)}, test));
+
+	BOOST_TEST(test.get<UCHAR>(0) == 1);
+	BOOST_TEST(test.get<SLONG>(1) == -12345);
+	BOOST_TEST(test.get<ISC_DATE>(2) == 58849);
+	BOOST_TEST(test.get<double>(3) == 0.125);
+
+	for (USHORT i = 0; i < 4; i++)
+		BOOST_TEST(!test.record->isNull(i));
+}
+
+
+BOOST_AUTO_TEST_CASE(NullTest)
+{
+	const index_desc idx = makeIndex({idx_numeric, idx_boolean, idx_sql_time});
+
+	TestRecord test({makeField(dtype_long, sizeof(SLONG)), makeField(dtype_boolean, sizeof(UCHAR)),
+		makeField(dtype_sql_time, sizeof(ISC_TIME))});
+
+	BOOST_TEST(decode(idx, {Bytes(), booleanSegment(false), Bytes()}, test));
+
+	BOOST_TEST(test.record->isNull(0));
+	BOOST_TEST(!test.record->isNull(1));
+	BOOST_TEST(test.get<UCHAR>(1) == 0);
+	BOOST_TEST(test.record->isNull(2));
+}
+
+
+BOOST_AUTO_TEST_CASE(ScaledTest)
+{
+	// Scaled integers are not restored from doubles, the field stays NULL
+	dsc field = makeField(dtype_long, sizeof(SLONG));
+	field.dsc_scale = -2;
+
+	TestRecord test({field});
+	BOOST_TEST(decode(makeIndex({idx_numeric}), {numericSegment(1.25)}, test));
+	BOOST_TEST(test.record->isNull(0));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()	// DecodeKeyTests
+
+
+BOOST_AUTO_TEST_SUITE(CostTests)
+
+
+BOOST_AUTO_TEST_CASE(IndexOnlyCostTest)
+{
+	// Nothing is known to be visible, the bitmap scan is kept
+	BOOST_TEST(!Optimizer::isIndexOnlyCheaper(1000, 100, 0));
+	BOOST_TEST(!Optimizer::isIndexOnlyCheaper(50, 100, 0));
+
+	// Half of the pages isn't enough to pay for the random order of fetches
+	BOOST_TEST(!Optimizer::isIndexOnlyCheaper(50, 100, 50));
+
+	// Mostly visible pages make the walk cheaper for a selective retrieval
+	BOOST_TEST(Optimizer::isIndexOnlyCheaper(50, 100, 95));
+	BOOST_TEST(Optimizer::isIndexOnlyCheaper(100, 100, 100));
+
+	// Many records per page are read by the bitmap scan at once
+	BOOST_TEST(!Optimizer::isIndexOnlyCheaper(10000, 100, 100));
+
+	// Empty relation
+	BOOST_TEST(!Optimizer::isIndexOnlyCheaper(0, 0, 0));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()	// CostTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// IndexOnlySuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
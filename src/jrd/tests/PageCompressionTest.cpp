@@ -0,0 +1,117 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/PageCompression.h"
+#include "../common/classes/array.h"
+#include <string.h>
+
+using namespace Firebird;
+using namespace Jrd;
+using namespace Ods;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(PageCompressionSuite)
+
+
+BOOST_AUTO_TEST_SUITE(PageCompressionTests)
+
+static constexpr ULONG TEST_PAGE_SIZE = 16384;
+
+static void makePage(Array<UCHAR>& buffer, UCHAR type, bool random)
+{
+	UCHAR* const data = buffer.getBuffer(TEST_PAGE_SIZE);
+	memset(data, 0, TEST_PAGE_SIZE);
+
+	const char text[] = "{\"id\": 1, \"name\": \"abc\"}";
+	ULONG seed = 12345;
+
+	for (ULONG i = sizeof(pag); i < TEST_PAGE_SIZE; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		data[i] = random ? (UCHAR) (seed >> 16) : (UCHAR) text[i % (sizeof(text) - 1)];
+	}
+
+	const auto page = reinterpret_cast<pag*>(data);
+	page->pag_type = type;
+	page->pag_flags = 0x01;
+	page->pag_generation = 7;
+	page->pag_scn = 3;
+	page->pag_pageno = 1000;
+}
+
+BOOST_AUTO_TEST_CASE(PackAndUnpackTest)
+{
+	Array<UCHAR> original;
+	makePage(original, pag_data, false);
+	const auto page = reinterpret_cast<const pag*>(original.begin());
+
+	const PageCompression::Image image(page, TEST_PAGE_SIZE, 1);
+
+	if (!image.isPacked())
+	{
+		BOOST_TEST_MESSAGE("libzstd is not available, skipping");
+		return;
+	}
+
+	BOOST_TEST(image.getLength() < TEST_PAGE_SIZE);
+	BOOST_TEST(image.getLength() % PageCompression::SPARSE_BLOCK == 0u);
+
+	// Image on disk: the rest of the page is a hole
+
+	Array<UCHAR> disk;
+	UCHAR* const data = disk.getBuffer(TEST_PAGE_SIZE);
+	memset(data, 0, TEST_PAGE_SIZE);
+	memcpy(data, image.begin(), image.getLength());
+
+	BOOST_TEST(PageCompression::isPacked(reinterpret_cast<const pag*>(data)));
+	BOOST_TEST(!PageCompression::isPacked(page));
+
+	BOOST_TEST(PageCompression::unpack(reinterpret_cast<pag*>(data), TEST_PAGE_SIZE));
+	BOOST_TEST(memcmp(data, original.begin(), TEST_PAGE_SIZE) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(StoreAsIsTest)
+{
+	Array<UCHAR> buffer;
+
+	// Compression is disabled
+	makePage(buffer, pag_data, false);
+	{
+		const PageCompression::Image image(reinterpret_cast<const pag*>(buffer.begin()), TEST_PAGE_SIZE, 0);
+		BOOST_TEST(!image.isPacked());
+		BOOST_TEST(image.begin() == buffer.begin());
+		BOOST_TEST(image.getLength() == TEST_PAGE_SIZE);
+	}
+
+	// Only data and blob pages are compressed
+	makePage(buffer, pag_index, false);
+	{
+		const PageCompression::Image image(reinterpret_cast<const pag*>(buffer.begin()), TEST_PAGE_SIZE, 1);
+		BOOST_TEST(!image.isPacked());
+		BOOST_TEST(image.getLength() == TEST_PAGE_SIZE);
+	}
+
+	// Encrypted pages are not compressible
+	makePage(buffer, pag_blob, false);
+	reinterpret_cast<pag*>(buffer.begin())->pag_flags |= crypted_page;
+	{
+		const PageCompression::Image image(reinterpret_cast<const pag*>(buffer.begin()), TEST_PAGE_SIZE, 1);
+		BOOST_TEST(!image.isPacked());
+	}
+
+	// Page doesn't release a single block of space
+	makePage(buffer, pag_blob, true);
+	{
+		const PageCompression::Image image(reinterpret_cast<const pag*>(buffer.begin()), TEST_PAGE_SIZE, 1);
+		BOOST_TEST(!image.isPacked());
+		BOOST_TEST(image.getLength() == TEST_PAGE_SIZE);
+	}
+
+	// Pages stored as is are left untouched when read
+	BOOST_TEST(PageCompression::unpack(reinterpret_cast<pag*>(buffer.begin()), TEST_PAGE_SIZE));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// PageCompressionTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// PageCompressionSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
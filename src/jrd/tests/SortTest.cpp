@@ -0,0 +1,286 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <vector>
+#include "../jrd/jrd.h"
+#include "../jrd/sort.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	constexpr ULONG BACK_LONGS = offsetof(SR, sr_sort_record) / sizeof(SORTP);
+
+	// Records laid out as the sort buffer does: back pointer followed by the
+	// normalized key and data, and the array of pointers to keys surrounded by guards.
+	class Records
+	{
+	public:
+		using KeyGenerator = std::function<void (SORTP* key)>;
+
+		Records(ULONG count, ULONG keyLongs, const KeyGenerator& generator, ULONG dataLongs = 0)
+			: m_count(count),
+			  m_keyLongs(keyLongs),
+			  m_recordLongs(keyLongs + dataLongs),
+			  m_longs(FB_ALIGN((BACK_LONGS + keyLongs + dataLongs) * sizeof(SORTP), FB_ALIGNMENT) / sizeof(SORTP)),
+			  m_lowKey(m_longs, 0),
+			  m_highKey(m_longs, MAX_ULONG),
+			  m_data((count + 1) * m_longs, 0),	// sort compares one longword past the record
+			  m_pointers(count + 2)
+		{
+			for (ULONG i = 0; i < count; i++)
+				generator(&m_data[i * m_longs + BACK_LONGS]);
+
+			reset();
+		}
+
+		void reset()
+		{
+			m_pointers[0] = m_lowKey.data();
+			m_pointers[m_count + 1] = m_highKey.data();
+
+			for (ULONG i = 0; i < m_count; i++)
+			{
+				SORTP* const key = &m_data[i * m_longs + BACK_LONGS];
+				m_pointers[i + 1] = key;
+				setBackPointer(i + 1);
+			}
+		}
+
+		void sort(bool useRadix)
+		{
+			std::vector<SORTP*> work(m_count);
+			Sort::sortPointers(m_pointers.data() + 1, m_count, m_longs, m_keyLongs,
+				useRadix ? work.data() : nullptr);
+		}
+
+		bool isSorted() const
+		{
+			for (ULONG i = 1; i < m_count; i++)
+			{
+				if (compare(m_pointers[i], m_pointers[i + 1]) > 0)
+					return false;
+			}
+
+			return true;
+		}
+
+		bool hasValidBackPointers() const
+		{
+			for (ULONG i = 1; i <= m_count; i++)
+			{
+				const SR* const record = reinterpret_cast<const SR*>(m_pointers[i] - BACK_LONGS);
+				if (record->sr_bckptr != reinterpret_cast<sort_record* const*>(&m_pointers[i]))
+					return false;
+			}
+
+			return true;
+		}
+
+		// Whole records, not only keys, are at the same places
+		bool isSameOrder(const Records& other) const
+		{
+			for (ULONG i = 1; i <= m_count; i++)
+			{
+				if (memcmp(m_pointers[i], other.m_pointers[i], m_recordLongs * sizeof(SORTP)))
+					return false;
+			}
+
+			return true;
+		}
+
+		int compare(const SORTP* p, const SORTP* q) const
+		{
+			for (ULONG i = 0; i < m_keyLongs; i++)
+			{
+				if (p[i] != q[i])
+					return p[i] < q[i] ? -1 : 1;
+			}
+
+			return 0;
+		}
+
+	private:
+		void setBackPointer(ULONG slot)
+		{
+			SR* const record = reinterpret_cast<SR*>(m_pointers[slot] - BACK_LONGS);
+			record->sr_bckptr = reinterpret_cast<sort_record**>(&m_pointers[slot]);
+		}
+
+		const ULONG m_count;
+		const ULONG m_keyLongs;
+		const ULONG m_recordLongs;
+		const ULONG m_longs;
+		std::vector<SORTP> m_lowKey;
+		std::vector<SORTP> m_highKey;
+		std::vector<SORTP> m_data;
+		std::vector<SORTP*> m_pointers;
+	};
+
+	// Normalized keys, as Sort::diddleKey() makes them comparable by longwords
+
+	Records::KeyGenerator integerKeys(std::mt19937& random)
+	{
+		return [&random](SORTP* key) {
+			const SLONG value = static_cast<SLONG>(random());
+			key[0] = static_cast<ULONG>(value) ^ 0x80000000;
+		};
+	}
+
+	Records::KeyGenerator timestampKeys(std::mt19937& random)
+	{
+		return [&random](SORTP* key) {
+			key[0] = (58000 + random() % 20000) ^ 0x80000000;	// date
+			key[1] = random() % (24 * 3600 * 10000);				// time
+		};
+	}
+
+	// Collation sort keys of words, having long common prefixes
+	Records::KeyGenerator stringKeys(std::mt19937& random, ULONG keyLongs)
+	{
+		return [&random, keyLongs](SORTP* key) {
+			std::vector<UCHAR> bytes(keyLongs * sizeof(SORTP), 0);
+			const ULONG length = 4 + random() % (keyLongs * sizeof(SORTP) - 4);
+
+			for (ULONG i = 0; i < length; i++)
+				bytes[i] = 0x29 + (i < 3 ? random() % 4 : random() % 26);
+
+			for (ULONG i = 0; i < keyLongs; i++)
+			{
+				const UCHAR* const p = &bytes[i * sizeof(SORTP)];
+				key[i] = (ULONG(p[0]) << 24) | (ULONG(p[1]) << 16) | (ULONG(p[2]) << 8) | p[3];
+			}
+		};
+	}
+
+	void checkSort(ULONG count, ULONG keyLongs, const Records::KeyGenerator& generator)
+	{
+		Records radixRecords(count, keyLongs, generator);
+		radixRecords.sort(true);
+
+		BOOST_TEST(radixRecords.isSorted());
+		BOOST_TEST(radixRecords.hasValidBackPointers());
+
+		Records quickRecords(count, keyLongs, generator);
+		quickRecords.sort(false);
+
+		BOOST_TEST(quickRecords.isSorted());
+		BOOST_TEST(quickRecords.hasValidBackPointers());
+	}
+
+	void measureSort(const char* name, ULONG count, ULONG keyLongs, const Records::KeyGenerator& generator)
+	{
+		Records records(count, keyLongs, generator);
+
+		for (const bool useRadix : {false, true})
+		{
+			records.reset();
+
+			const auto start = std::chrono::steady_clock::now();
+			records.sort(useRadix);
+			const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+			BOOST_TEST(records.isSorted());
+
+			BOOST_TEST_MESSAGE("Sort " << name << " keys, " << count << " records, " <<
+				(useRadix ? "radix" : "quick") << ": " << elapsed.count() << " ms");
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(SortSuite)
+BOOST_AUTO_TEST_SUITE(SortTests)
+
+
+BOOST_AUTO_TEST_CASE(SortPointersTest)
+{
+	std::mt19937 random(1);
+
+	for (const ULONG count : {1u, 2u, 3u, 63u, 64u, 65u, 1000u, 10000u})
+	{
+		checkSort(count, 1, integerKeys(random));
+		checkSort(count, 2, timestampKeys(random));
+		checkSort(count, 8, stringKeys(random, 8));
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(SortDuplicatesTest)
+{
+	std::mt19937 random(2);
+
+	// Many equal keys
+	checkSort(10000, 1, [&random](SORTP* key) { key[0] = random() % 10; });
+	checkSort(10000, 2, [&random](SORTP* key) { key[0] = 1; key[1] = random() % 3; });
+
+	// Presorted keys
+	ULONG value = 0;
+	checkSort(10000, 1, [&value](SORTP* key) { key[0] = value++; });
+	checkSort(10000, 1, [&value](SORTP* key) { key[0] = value--; });
+}
+
+
+BOOST_AUTO_TEST_CASE(SortDeepKeysTest)
+{
+	std::mt19937 random(4);
+
+	// Long common prefix takes radix sort deeper than its depth limit
+	checkSort(10000, 16, [&random](SORTP* key) {
+		for (ULONG i = 0; i < 14; i++)
+			key[i] = 0x41414141;
+
+		key[14] = random() % 100;
+		key[15] = random();
+	});
+}
+
+
+BOOST_AUTO_TEST_CASE(SortEqualKeysDataTest)
+{
+	// Records with equal keys are ordered by their data by both kernels
+	const auto generator = [](ULONG& value) {
+		return [&value](SORTP* key) {
+			key[0] = value % 3;
+			key[1] = key[0];
+			key[2] = (value * 7919) % 10007;	// data
+			value++;
+		};
+	};
+
+	ULONG radixValue = 0, quickValue = 0;
+	Records radixRecords(10000, 2, generator(radixValue), 1);
+	Records quickRecords(10000, 2, generator(quickValue), 1);
+
+	radixRecords.sort(true);
+	quickRecords.sort(false);
+
+	BOOST_TEST(radixRecords.isSorted());
+	BOOST_TEST(radixRecords.hasValidBackPointers());
+	BOOST_TEST(radixRecords.isSameOrder(quickRecords));
+}
+
+
+// Compares sorting kernels, it's too heavy for the default run.
+// Run with --run_test=*/SortBenchmarkTest --log_level=message to see the numbers.
+BOOST_AUTO_TEST_CASE(SortBenchmarkTest, *boost::unit_test::disabled())
+{
+	constexpr ULONG RECORD_COUNT = 500'000;
+
+	std::mt19937 random(3);
+
+	measureSort("integer", RECORD_COUNT, 1, integerKeys(random));
+	measureSort("timestamp", RECORD_COUNT, 2, timestampKeys(random));
+	measureSort("string", RECORD_COUNT, 8, stringKeys(random, 8));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()	// SortTests
+BOOST_AUTO_TEST_SUITE_END()	// SortSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -1067,8 +1067,7 @@ void TipCache::updateActiveSnapshots(thread_db* tdbb, ActiveSnapshots* activeSna
 					ThreadStatusGuard temp_status(tdbb);
 					Lock temp_lock(tdbb, sizeof(AttNumber), LCK_attachment);
 					temp_lock.setKey(slot_attachment_id);
-					if ((isAttachmentDead = LCK_lock(tdbb, &temp_lock, LCK_EX, LCK_NO_WAIT)))
-						LCK_release(tdbb, &temp_lock);
+					isAttachmentDead = LCK_probe(tdbb, &temp_lock, LCK_EX);
 					att_states.put(slot_attachment_id, isAttachmentDead);
 				}
 
@@ -58,6 +58,7 @@
 #include "../jrd/mov_proto.h"
 #include "../jrd/pag_proto.h"
 #include "../jrd/rlck_proto.h"
+#include "../jrd/rng_proto.h"
 #include "../jrd/tpc_proto.h"
 #include "../jrd/tra_proto.h"
 #include "../jrd/vio_proto.h"
@@ -1016,13 +1017,12 @@ bool TRA_is_active(thread_db* tdbb, TraNumber number)
 
 	// If we can't get a lock on the transaction, it must be active
 
-	if (!LCK_lock(tdbb, &temp_lock, LCK_read, LCK_NO_WAIT))
+	if (!LCK_probe(tdbb, &temp_lock, LCK_read))
 	{
 		fb_utils::init_status(tdbb->tdbb_status_vector);
 		return true;
 	}
 
-	LCK_release(tdbb, &temp_lock);
 	return false;
 }
 
@@ -1859,6 +1859,9 @@ void TRA_sweep(thread_db* tdbb)
 
 		if (VIO_sweep(tdbb, transaction, &traceSweep))
 		{
+			// Summarize the block ranges being filled, so the scans may skip them
+			RNG_flush(tdbb);
+
 			// At this point, we know that no record versions belonging to dead
 			// transactions remain anymore. However, there may still be limbo
 			// transactions, so we need to find the oldest one between tra_oldest and tra_top.
@@ -149,6 +149,7 @@ IV. PHASES OF VALIDATION
          define pag_blob          8    // Blob data page
          define pag_ids           9    // Gen-ids
          define pag_log           10   // OBSOLETE. Write ahead log page: 4.0 only
+         define pag_range         11   // Block range index page
 
       2. Checksum
 
@@ -645,6 +646,13 @@ static void explain_pp_bits(const UCHAR bits, Firebird::string& names)
 		names.append("secondary");
 	}
 
+	if (bits & ppg_dp_all_visible)
+	{
+		if (!names.empty())
+			names.append(", ");
+		names.append("all visible");
+	}
+
 	if (bits & ppg_dp_empty)
 	{
 		if (!names.empty())
@@ -1766,6 +1774,9 @@ Validation::RTN Validation::walk_data_page(jrd_rel* relation, ULONG page_number,
 	if (dp_flags & dpg_secondary)
 		pp_bits |= ppg_dp_secondary;
 
+	if (dp_flags & dpg_all_visible)
+		pp_bits |= ppg_dp_all_visible;
+
 	if (page->dpg_count == 0)
 		pp_bits |= ppg_dp_empty;
 
@@ -2722,6 +2733,127 @@ Validation::RTN Validation::walk_pointer_page(jrd_rel* relation, ULONG sequence)
 }
 
 
+Validation::RTN Validation::walk_range(jrd_rel* relation, index_root_page* root_page, USHORT id)
+{
+/**************************************
+ *
+ *	w a l k _ r a n g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Walk the directory and summary pages of block range index.
+ *	Check their headers and that every summary has its lowest
+ *	key not greater than the highest one.
+ *
+ *	NOTE: id is the internal index id, errors are reported
+ *	against index id+1 (see walk_index)
+ *
+ **************************************/
+	Database* dbb = vdr_tdbb->getDatabase();
+
+	ULONG next = root_page->irt_rpt[id].getRoot();
+	const ULONG perDirectory = (dbb->dbb_page_size - RNG_SIZE) / sizeof(ULONG);
+	ULONG sequence = 0;
+	USHORT keyLength = 0;
+
+	PageBitmap visited_pages;
+
+	while (next)
+	{
+		WIN window(DB_PAGE_SPACE, -1);
+		range_page* page = nullptr;
+		fetch_page(true, next, pag_range, &window, &page);
+
+		visited_pages.set(next);
+
+		if (page->rng_relation != relation->getId() || page->rng_id != id || page->rng_level != 1 ||
+			page->rng_sequence != sequence || page->rng_count > perDirectory ||
+			(sequence && page->rng_key_length != keyLength))
+		{
+			corrupt(VAL_INDEX_PAGE_CORRUPT, relation, id + 1,
+					next, page->rng_level, 0, __FILE__, __LINE__);
+			release_page(&window);
+			return rtn_corrupt;
+		}
+
+		keyLength = page->rng_key_length;
+		const FB_SIZE_T entrySize = ROUNDUP(RNE_SIZE + 2 * keyLength, sizeof(USHORT));
+		const ULONG perPage = (dbb->dbb_page_size - RNG_SIZE) / entrySize;
+
+		for (USHORT slot = 0; slot < page->rng_count; slot++)
+		{
+			const ULONG number = page->rng_data[slot];
+
+			if (!number)
+				continue;
+
+			WIN summary_window(DB_PAGE_SPACE, -1);
+			range_page* summary = nullptr;
+			fetch_page(true, number, pag_range, &summary_window, &summary);
+
+			if (summary->rng_relation != relation->getId() || summary->rng_id != id ||
+				summary->rng_level != 0 || summary->rng_sequence != sequence * perDirectory + slot ||
+				summary->rng_key_length != keyLength || summary->rng_count > perPage)
+			{
+				corrupt(VAL_INDEX_PAGE_CORRUPT, relation, id + 1,
+						number, summary->rng_level, 0, __FILE__, __LINE__);
+				release_page(&summary_window);
+				continue;
+			}
+
+			const UCHAR* pointer = (UCHAR*) summary->rng_data;
+
+			for (USHORT n = 0; n < summary->rng_count; n++, pointer += entrySize)
+			{
+				const range_entry* const entry = (range_entry*) pointer;
+
+				if ((entry->rne_flags & rne_unbounded) || !(entry->rne_flags & rne_used))
+					continue;
+
+				const UCHAR* const low = entry->rne_data;
+				const UCHAR* const high = low + keyLength;
+				const USHORT low_length = entry->rne_low_length;
+				const USHORT high_length = entry->rne_high_length;
+
+				int result = 0;
+
+				if (low_length <= keyLength && high_length <= keyLength)
+				{
+					result = memcmp(low, high, MIN(low_length, high_length));
+
+					if (!result && low_length > high_length)
+						result = 1;
+				}
+
+				if (low_length > keyLength || high_length > keyLength || result > 0)
+				{
+					corrupt(VAL_INDEX_PAGE_CORRUPT, relation, id + 1,
+							number, summary->rng_level, (ULONG) (pointer - (UCHAR*) summary),
+							__FILE__, __LINE__);
+					break;
+				}
+			}
+
+			release_page(&summary_window);
+		}
+
+		next = page->rng_next;
+		sequence++;
+
+		// check for circular referenes
+		if (next && visited_pages.test(next))
+		{
+			corrupt(VAL_INDEX_CYCLE, relation, id + 1, next);
+			next = 0;
+		}
+		release_page(&window);
+	}
+
+	return rtn_ok;
+}
+
+
 Validation::RTN Validation::walk_record(jrd_rel* relation, const rhd* header, USHORT length,
 	RecordNumber number, bool delta_flag)
 {
@@ -2921,6 +3053,12 @@ void restoreFlags(UCHAR* byte, UCHAR flags, bool empty)
 	else
 		*byte &= ~bit;
 
+	bit = PPG_DP_BIT_MASK(slot, ppg_dp_all_visible);
+	if (flags & dpg_all_visible)
+		*byte |= bit;
+	else
+		*byte &= ~bit;
+
 	bit = PPG_DP_BIT_MASK(slot, ppg_dp_empty);
 	if (empty)
 		*byte |= bit;
@@ -3288,7 +3426,11 @@ Validation::RTN Validation::walk_root(jrd_rel* relation, bool getInfo)
 		}
 
 		output("Index %d (%s)\n", i + 1, index.toQuotedString().c_str());
-		walk_index(relation, page, i);
+
+		if (page->irt_rpt[i].irt_flags & irt_range)
+			walk_range(relation, page, i);
+		else
+			walk_index(relation, page, i);
 	}
 
 	release_page(&window);
@@ -218,6 +218,7 @@ private:
 	RTN walk_index(jrd_rel*, Ods::index_root_page*, USHORT);
 	void walk_pip();
 	RTN walk_pointer_page(jrd_rel*, ULONG);
+	RTN walk_range(jrd_rel*, Ods::index_root_page*, USHORT);
 	RTN walk_record(jrd_rel*, const Ods::rhd*, USHORT, RecordNumber, bool);
 	RTN walk_relation(jrd_rel*);
 	RTN walk_root(jrd_rel*, bool);
@@ -190,55 +190,20 @@ static void verb_post(thread_db*, jrd_tra*, record_param*, Record*);
 namespace Jrd
 {
 
-class SweepTask : public Task
-{
-	struct RelInfo; // forward decl
+// Common part of the tasks handled by the worker attachments. Every work item
+// runs in its own worker attachment and transaction, except the first one that
+// is handled in the attachment and transaction of the task creator.
 
+class WorkerAttachmentTask : public Task
+{
 public:
-	SweepTask(thread_db* tdbb, MemoryPool* pool, TraceSweepEvent* traceSweep) : Task(),
-		m_pool(pool),
-		m_dbb(NULL),
-		m_items(*m_pool),
-		m_stop(false),
-		m_nextRelID(0),
-		m_lastRelID(0),
-		m_relInfo(*m_pool)
-	{
-		m_dbb = tdbb->getDatabase();
-		Attachment* att = tdbb->getAttachment();
-
-		int workers = 1;
-		if (att->att_parallel_workers > 0)
-			workers = att->att_parallel_workers;
-
-		for (int i = 0; i < workers; i++)
-			m_items.add(FB_NEW_POOL(*m_pool) Item(this));
-
-		m_items[0]->m_ownAttach = false;
-		m_items[0]->m_attStable = att->getStable();
-		m_items[0]->m_tra = tdbb->getTransaction();
-
-		m_relInfo.grow(m_items.getCount());
-
-		m_lastRelID = MetadataCache::get(tdbb)->relCount();
-	};
-
-	virtual ~SweepTask()
-	{
-		for (Item** p = m_items.begin(); p < m_items.end(); p++)
-			delete *p;
-	};
-
 	class Item : public Task::WorkItem
 	{
 	public:
-		Item(SweepTask* task) : Task::WorkItem(task),
+		explicit Item(WorkerAttachmentTask* task) : Task::WorkItem(task),
 			m_inuse(false),
 			m_ownAttach(true),
-			m_tra(NULL),
-			m_relInfo(NULL),
-			m_firstPP(0),
-			m_lastPP(0)
+			m_tra(NULL)
 		{}
 
 		virtual ~Item()
@@ -264,19 +229,20 @@ public:
 			WorkerAttachment::releaseAttachment(&status, m_attStable);
 		}
 
-		SweepTask* getSweepTask() const
+		WorkerAttachmentTask* getWorkerTask() const
 		{
-			return reinterpret_cast<SweepTask*> (m_task);
+			return reinterpret_cast<WorkerAttachmentTask*> (m_task);
 		}
 
 		bool init(thread_db* tdbb)
 		{
 			FbStatusVector* status = tdbb->tdbb_status_vector;
+			WorkerAttachmentTask* const task = getWorkerTask();
 
 			Attachment* att = NULL;
 
 			if (m_ownAttach && !m_attStable.hasData())
-				m_attStable = WorkerAttachment::getAttachment(status, getSweepTask()->m_dbb);
+				m_attStable = WorkerAttachment::getAttachment(status, task->m_dbb);
 
 			if (m_attStable)
 				att = m_attStable->getHandle();
@@ -292,19 +258,13 @@ public:
 
 			if (m_ownAttach && !m_tra)
 			{
-				const UCHAR sweep_tpb[] =
-				{
-					isc_tpb_version1, isc_tpb_read,
-					isc_tpb_read_committed, isc_tpb_rec_version
-				};
-
 				try
 				{
 					WorkerContextHolder holder(tdbb, FB_FUNCTION);
-					m_tra = TRA_start(tdbb, sizeof(sweep_tpb), sweep_tpb);
+					m_tra = TRA_start(tdbb, task->m_tpbLength, task->m_tpb);
 					DPM_scan_pages(tdbb);
 				}
-				catch(const Exception& ex)
+				catch (const Exception& ex)
 				{
 					ex.stuffException(tdbb->tdbb_status_vector);
 					return false;
@@ -312,7 +272,7 @@ public:
 			}
 
 			tdbb->setTransaction(m_tra);
-			tdbb->tdbb_flags |= TDBB_sweeper;
+			tdbb->markAsSweeper();
 
 			return true;
 		}
@@ -321,16 +281,23 @@ public:
 		bool m_ownAttach;
 		RefPtr<StableAttachmentPart> m_attStable;
 		jrd_tra* m_tra;
-
-		// part of work: relation, first and last PP's to work on
-		RelInfo* m_relInfo;
-		ULONG m_firstPP;
-		ULONG m_lastPP;
 	};
 
-	bool handler(WorkItem& _item);
+	WorkerAttachmentTask(thread_db* tdbb, MemoryPool* pool, const UCHAR* tpb, USHORT tpbLength) : Task(),
+		m_pool(pool),
+		m_dbb(tdbb->getDatabase()),
+		m_items(*m_pool),
+		m_stop(false),
+		m_tpb(tpb),
+		m_tpbLength(tpbLength)
+	{}
+
+	virtual ~WorkerAttachmentTask()
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			delete *p;
+	}
 
-	bool getWorkItem(WorkItem** pItem);
 	bool getResult(IStatus* status)
 	{
 		if (status)
@@ -347,27 +314,33 @@ public:
 		return m_items.getCount();
 	}
 
-private:
-	// item is handled, get next portion of work and update RelInfo
-	// also, detect if relation is handled completely
-	// return true if there is some more work to do
-	bool updateRelInfo(Item* item)
+protected:
+	// The first item is handled in the context of the task creator
+	void addItem(thread_db* tdbb, Item* item)
 	{
-		RelInfo* relInfo = item->m_relInfo;
-
-		if (relInfo->countPP == 0 || relInfo->nextPP >= relInfo->countPP)
+		if (m_items.isEmpty())
 		{
-			relInfo->workers--;
-			return false;
+			item->m_ownAttach = false;
+			item->m_attStable = tdbb->getAttachment()->getStable();
+			item->m_tra = tdbb->getTransaction();
 		}
 
-		item->m_firstPP = relInfo->nextPP;
-		item->m_lastPP = item->m_firstPP;
-		if (item->m_lastPP >= relInfo->countPP)
-			item->m_lastPP = relInfo->countPP - 1;
-		relInfo->nextPP = item->m_lastPP + 1;
+		m_items.add(item);
+	}
 
-		return true;
+	// m_mutex should be locked by the caller
+	Item* getFreeItem()
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		{
+			if (!(*p)->m_inuse)
+			{
+				(*p)->m_inuse = true;
+				return *p;
+			}
+		}
+
+		return NULL;
 	}
 
 	void setError(IStatus* status, bool stopTask)
@@ -390,6 +363,84 @@ private:
 	StatusHolder m_status;
 	volatile bool m_stop;
 
+private:
+	const UCHAR* const m_tpb;
+	const USHORT m_tpbLength;
+};
+
+
+static const UCHAR sweep_tpb[] =
+{
+	isc_tpb_version1, isc_tpb_read,
+	isc_tpb_read_committed, isc_tpb_rec_version
+};
+
+class SweepTask : public WorkerAttachmentTask
+{
+	struct RelInfo; // forward decl
+
+public:
+	SweepTask(thread_db* tdbb, MemoryPool* pool, TraceSweepEvent* traceSweep) :
+		WorkerAttachmentTask(tdbb, pool, sweep_tpb, sizeof(sweep_tpb)),
+		m_nextRelID(0),
+		m_lastRelID(0),
+		m_relInfo(*m_pool)
+	{
+		Attachment* att = tdbb->getAttachment();
+
+		int workers = 1;
+		if (att->att_parallel_workers > 0)
+			workers = att->att_parallel_workers;
+
+		for (int i = 0; i < workers; i++)
+			addItem(tdbb, FB_NEW_POOL(*m_pool) Item(this));
+
+		m_relInfo.grow(m_items.getCount());
+
+		m_lastRelID = MetadataCache::get(tdbb)->relCount();
+	};
+
+	class Item : public WorkerAttachmentTask::Item
+	{
+	public:
+		Item(SweepTask* task) : WorkerAttachmentTask::Item(task),
+			m_relInfo(NULL),
+			m_firstPP(0),
+			m_lastPP(0)
+		{}
+
+		// part of work: relation, first and last PP's to work on
+		RelInfo* m_relInfo;
+		ULONG m_firstPP;
+		ULONG m_lastPP;
+	};
+
+	bool handler(WorkItem& _item);
+	bool getWorkItem(WorkItem** pItem);
+
+private:
+	// item is handled, get next portion of work and update RelInfo
+	// also, detect if relation is handled completely
+	// return true if there is some more work to do
+	bool updateRelInfo(Item* item)
+	{
+		RelInfo* relInfo = item->m_relInfo;
+
+		if (relInfo->countPP == 0 || relInfo->nextPP >= relInfo->countPP)
+		{
+			relInfo->workers--;
+			return false;
+		}
+
+		item->m_firstPP = relInfo->nextPP;
+		item->m_lastPP = item->m_firstPP;
+		if (item->m_lastPP >= relInfo->countPP)
+			item->m_lastPP = relInfo->countPP - 1;
+		relInfo->nextPP = item->m_lastPP + 1;
+
+		return true;
+	}
+
 	struct RelInfo
 	{
 		RelInfo()
@@ -513,15 +564,7 @@ bool SweepTask::getWorkItem(WorkItem** pItem)
 	Item* item = reinterpret_cast<Item*> (*pItem);
 
 	if (item == NULL)
-	{
-		for (Item** p = m_items.begin(); p < m_items.end(); p++)
-			if (!(*p)->m_inuse)
-			{
-				(*p)->m_inuse = true;
-				*pItem = item = *p;
-				break;
-			}
-	}
+		*pItem = item = static_cast<Item*>(getFreeItem());
 	else if (updateRelInfo(item))
 		return true;
 
@@ -729,14 +772,13 @@ inline bool checkGCActive(thread_db* tdbb, record_param* rpb, int& state)
 
 	ThreadStatusGuard temp_status(tdbb);
 
-	if (!LCK_lock(tdbb, &temp_lock, LCK_SR, LCK_NO_WAIT))
+	if (!LCK_probe(tdbb, &temp_lock, LCK_SR))
 	{
 		rpb->rpb_transaction_nr = LCK_read_data(tdbb, &temp_lock);
 		state = tra_active;
 		return true;
 	}
 
-	LCK_release(tdbb, &temp_lock);
 	rpb->rpb_flags &= ~rpb_gc_active;
 	state = tra_dead;
 	return false;
@@ -5696,6 +5738,231 @@ void VIO_garbage_collect_idx(thread_db* tdbb, jrd_tra* transaction,
 	clearRecordStack(staying);
 }
 
+namespace Jrd {
+
+// Collects garbage on the data pages of one relation taken from the background
+// garbage collector's bitmap, when the relation has a large backlog. Pages are
+// handed out to the workers by small portions, the first work item uses the
+// garbage collector's own attachment and transaction. Pages left unhandled
+// after an error are given back to the garbage collector.
+
+class GarbageCollectTask : public WorkerAttachmentTask
+{
+public:
+	static constexpr FB_SIZE_T PAGES_PER_ITEM = 16;
+
+	GarbageCollectTask(thread_db* tdbb, MemoryPool* pool, USHORT relID, PageBitmap* bitmap) :
+		WorkerAttachmentTask(tdbb, pool, gc_tpb, sizeof(gc_tpb)),
+		m_relID(relID),
+		m_pages(*m_pool),
+		m_returned(*m_pool),
+		m_nextPage(0)
+	{
+		if (bitmap->getFirst())
+		{
+			do {
+				m_pages.add(bitmap->current());
+			} while (bitmap->getNext());
+		}
+
+		Attachment* const att = tdbb->getAttachment();
+
+		ULONG workers = MIN((ULONG) MAX(att->att_parallel_workers, 1),
+			(m_pages.getCount() + PAGES_PER_ITEM - 1) / PAGES_PER_ITEM);
+
+		// Classic in single-user shutdown mode can't create additional worker attachments
+		if (m_dbb->isShutdown(shut_mode_single) && !(m_dbb->dbb_flags & DBB_shared))
+			workers = 1;
+
+		for (ULONG i = 0; i < MAX(workers, 1U); i++)
+			addItem(tdbb, FB_NEW_POOL(*m_pool) Item(this));
+	}
+
+	class Item : public WorkerAttachmentTask::Item
+	{
+	public:
+		Item(GarbageCollectTask* task) : WorkerAttachmentTask::Item(task),
+			m_firstPage(0),
+			m_lastPage(0)
+		{}
+
+		// part of work: positions of the first and next after the last pages in m_pages
+		FB_SIZE_T m_firstPage;
+		FB_SIZE_T m_lastPage;
+	};
+
+	bool handler(WorkItem& _item);
+	bool getWorkItem(WorkItem** pItem);
+
+	// Pages left unhandled after the task was stopped by an error
+	void getUnhandledPages(PageBitmap** bitmap)
+	{
+		for (const Range* range = m_returned.begin(); range < m_returned.end(); range++)
+		{
+			for (FB_SIZE_T i = range->first; i < range->last; i++)
+				PBM_SET(m_pool, bitmap, m_pages[i]);
+		}
+
+		for (FB_SIZE_T i = m_nextPage; i < m_pages.getCount(); i++)
+			PBM_SET(m_pool, bitmap, m_pages[i]);
+	}
+
+private:
+	struct Range
+	{
+		FB_SIZE_T first;
+		FB_SIZE_T last;
+	};
+
+	// Pages of the item that were not handled, let other workers or
+	// the next round of garbage collection handle them
+	void returnPages(FB_SIZE_T first, FB_SIZE_T last)
+	{
+		if (first >= last)
+			return;
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		m_returned.add(Range{first, last});
+	}
+
+	const USHORT m_relID;
+	Array<ULONG> m_pages;		// data page sequences to handle
+	HalfStaticArray<Range, 8> m_returned;
+	FB_SIZE_T m_nextPage;
+};
+
+
+bool GarbageCollectTask::handler(WorkItem& _item)
+{
+	Item* item = reinterpret_cast<Item*>(&_item);
+
+	ThreadContextHolder tdbb(NULL);
+
+	if (!item->init(tdbb))
+	{
+		returnPages(item->m_firstPage, item->m_lastPage);
+		return false;
+	}
+
+	WorkerContextHolder wrkHolder(tdbb, FB_FUNCTION);
+
+	Attachment* const attachment = tdbb->getAttachment();
+	jrd_tra* const transaction = tdbb->getTransaction();
+
+	// Worker attachment collects the garbage itself rather than notifies the
+	// garbage collector about it
+
+	AutoSetRestoreFlag<ULONG> gcFlag(&attachment->att_flags, ATT_garbage_collector, true);
+	AutoSetRestoreFlag<ULONG> notifyFlag(&attachment->att_flags, ATT_notify_gc, false);
+
+	record_param rpb;
+	rpb.rpb_record = NULL;
+	rpb.rpb_stream_flags = RPB_s_no_data | RPB_s_sweeper;
+	rpb.getWindow(tdbb).win_flags = WIN_garbage_collector;
+
+	FB_SIZE_T page = item->m_firstPage;
+
+	try
+	{
+		Database* const dbb = tdbb->getDatabase();
+
+		jrd_rel* const relation =
+			MetadataCache::getVersioned<Cached::Relation>(tdbb, m_relID, CacheFlag::AUTOCREATE);
+
+		if (!relation || getPermanent(relation)->isDropped())
+			m_stop = true;
+		else
+		{
+			GCLock::Shared gcGuard(tdbb, getPermanent(relation));
+
+			if (!gcGuard.gcEnabled())
+				m_stop = true;
+
+			rpb.rpb_relation = relation;
+
+			for (; page < item->m_lastPage && !m_stop; page++)
+			{
+				rpb.rpb_number.setValue(((SINT64) m_pages[page] * dbb->dbb_max_records) - 1);
+				const RecordNumber last(rpb.rpb_number.getValue() + dbb->dbb_max_records);
+
+				// Attempt to garbage collect all records on the data page.
+
+				while (VIO_next_record(tdbb, &rpb, transaction, NULL, DPM_next_data_page))
+				{
+					CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
+
+					if (!(dbb->dbb_flags & DBB_garbage_collector) ||
+						getPermanent(relation)->isDropped() ||
+						getPermanent(relation)->rel_gc_lock.checkDisabled())
+					{
+						m_stop = true;
+						break;
+					}
+
+					JRD_reschedule(tdbb);
+
+					if (rpb.rpb_number >= last)
+						break;
+
+					transaction->tra_oldest = dbb->dbb_oldest_transaction;
+					transaction->tra_oldest_active = dbb->dbb_oldest_snapshot;
+				}
+			}
+
+			if (TipCache* cache = dbb->dbb_tip_cache)
+				cache->updateActiveSnapshots(tdbb, &attachment->att_active_snapshots);
+		}
+
+		delete rpb.rpb_record;
+		return !m_stop;
+	}
+	catch (const Exception& ex)
+	{
+		ex.stuffException(tdbb->tdbb_status_vector);
+		delete rpb.rpb_record;
+		returnPages(page, item->m_lastPage);
+	}
+
+	setError(tdbb->tdbb_status_vector, true);
+	return false;
+}
+
+bool GarbageCollectTask::getWorkItem(WorkItem** pItem)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	Item* item = reinterpret_cast<Item*> (*pItem);
+
+	if (item == NULL)
+		*pItem = item = static_cast<Item*>(getFreeItem());
+
+	if (!item)
+		return false;
+
+	if (!m_stop && m_returned.hasData())
+	{
+		const Range range = m_returned.pop();
+		item->m_firstPage = range.first;
+		item->m_lastPage = range.last;
+		return true;
+	}
+
+	if (m_stop || m_nextPage >= m_pages.getCount())
+	{
+		item->m_inuse = false;
+		return false;
+	}
+
+	item->m_firstPage = m_nextPage;
+	m_nextPage = MIN(m_nextPage + PAGES_PER_ITEM, m_pages.getCount());
+	item->m_lastPage = m_nextPage;
+
+	return true;
+}
+
+} // namespace Jrd
+
+
 void Database::garbage_collector(Database* dbb)
 {
 /**************************************
@@ -5725,6 +5992,7 @@ void Database::garbage_collector(Database* dbb)
 		attachment->att_filename = dbb->dbb_filename;
 		attachment->att_flags |= ATT_garbage_collector;
 		attachment->att_user = &user;
+		attachment->att_parallel_workers = Config::getParallelWorkers();
 
 		BackgroundContextHolder tdbb(dbb, attachment, &status_vector, FB_FUNCTION);
 		Jrd::Attachment::UseCountHolder use(attachment);
@@ -5787,9 +6055,10 @@ void Database::garbage_collector(Database* dbb)
 
 				USHORT relID;
 				PageBitmap* gc_bitmap = NULL;
+				const TraNumber oldest_snapshot = dbb->dbb_oldest_snapshot;
 
 				if ((dbb->dbb_flags & DBB_gc_pending) &&
-					(gc_bitmap = gc->getPages(dbb->dbb_oldest_snapshot, relID)))
+					(gc_bitmap = gc->getPages(oldest_snapshot, relID)))
 				{
 					relation = MetadataCache::getVersioned<Cached::Relation>(tdbb, relID, CacheFlag::AUTOCREATE);
 					if (!relation || getPermanent(relation)->isDropped())
@@ -5799,6 +6068,49 @@ void Database::garbage_collector(Database* dbb)
 						gc->removeRelation(relID);
 					}
 
+					if (gc_bitmap && attachment->att_parallel_workers > 1)
+					{
+						if (!transaction)
+						{
+							transaction = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
+							tdbb->setTransaction(transaction);
+						}
+
+						// Large backlog of the relation is collected by parallel workers
+
+						GarbageCollectTask task(tdbb, dbb->dbb_permanent, relID, gc_bitmap);
+
+						if (task.getMaxWorkers() > 1)
+						{
+							found = flush = true;
+
+							{	// scope
+								EngineCheckout cout(tdbb, FB_FUNCTION);
+
+								Coordinator coord(dbb->dbb_permanent);
+								coord.runSync(&task);
+							}
+
+							FbLocalStatus local_status;
+							if (!task.getResult(&local_status))
+							{
+								iscDbLogStatus(dbb->dbb_filename.c_str(), &local_status);
+
+								// Pages taken from the bitmap but not handled are collected later
+
+								gc_bitmap->clear();
+								task.getUnhandledPages(&gc_bitmap);
+								gc->returnPages(relID, gc_bitmap, oldest_snapshot - 1);
+							}
+
+							delete gc_bitmap;
+							gc_bitmap = NULL;
+
+							if (!(dbb->dbb_flags & DBB_garbage_collector))
+								break;
+						}
+					}
+
 					if (gc_bitmap)
 					{
 						GCLock::Shared gcGuard(tdbb, getPermanent(relation));
@@ -144,9 +144,41 @@ constexpr USHORT HISTORY_BLOCKS	= 256;
 
 constexpr ULONG MAX_TABLE_LENGTH = SLONG_MAX;
 
+// Upper limit of CPU pauses between two attempts to acquire the lock table mutex
+constexpr ULONG MAX_ACQUIRE_BACKOFF = 64;
+
+// Attempts to latch a partition before giving up and acquiring the whole table
+constexpr ULONG PARTITION_SPINS = 100;
+
+// Attempts to latch a partition between checks whether its holder is still alive
+constexpr ULONG PARTITION_PROBE_SPINS = 10000;
+
 // SRQ_ABS_PTR uses this macro.
 #define SRQ_BASE                    ((UCHAR*) m_sharedMemory->getHeader())
 
+static inline void spin_pause()
+{
+/**************************************
+ *
+ *	s p i n _ p a u s e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Tell the CPU we're in a spin loop, so it doesn't speculate
+ *	on the memory being polled and yields to a sibling thread.
+ *
+ **************************************/
+#if defined(WIN_NT)
+	YieldProcessor();
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	__builtin_ia32_pause();
+#elif defined(__GNUC__) && defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+
 static constexpr bool compatibility[LCK_max][LCK_max] =
 {
 /*							Shared	Prot	Shared	Prot
@@ -192,6 +224,7 @@ LockManager::LockManager(const string& id, const Config* conf)
 	const auto minMemory = sizeof(lhb) +
 		FB_ALIGN(sizeof(shb), FB_ALIGNMENT) +
 		sizeof(lhb::lhb_hash[0]) * m_hashSlots +
+		LHP_SIZE * LHB_PARTITIONS + 64 +
 		FB_ALIGN(sizeof(his), FB_ALIGNMENT) * HISTORY_BLOCKS * 2;
 
 	if (m_memorySize < minMemory)
@@ -479,6 +512,15 @@ SRQ_PTR LockManager::enqueue(const Callbacks& callbacks,
 	if (!owner_offset)
 		return 0;
 
+	if (!prior_request)
+	{
+		const SRQ_PTR request_offset = fast_enqueue(series, value, length, type,
+			ast_routine, ast_argument, data, owner_offset);
+
+		if (request_offset)
+			return request_offset;
+	}
+
 	LockTableGuard guard(this, FB_FUNCTION, owner_offset);
 
 	own* owner = (own*) SRQ_ABS_PTR(owner_offset);
@@ -498,23 +540,13 @@ SRQ_PTR LockManager::enqueue(const Callbacks& callbacks,
 
 	// Allocate or reuse a lock request block
 
-	lrq* request;
+	const USHORT hash_slot = get_hash_slot(value, length);
 
-	ASSERT_ACQUIRED;
-	if (SRQ_EMPTY(m_sharedMemory->getHeader()->lhb_free_requests))
-	{
-		if (!(request = (lrq*) alloc(sizeof(lrq), statusVector)))
-			return 0;
+	lrq* request = alloc_request(hash_slot, statusVector);
+	if (!request)
+		return 0;
 
-		owner = (own*) SRQ_ABS_PTR(owner_offset);
-	}
-	else
-	{
-		ASSERT_ACQUIRED;
-		request = (lrq*) ((UCHAR*) SRQ_NEXT(m_sharedMemory->getHeader()->lhb_free_requests) -
-						 offsetof(lrq, lrq_lbl_requests));
-		remove_que(&request->lrq_lbl_requests);
-	}
+	owner = (own*) SRQ_ABS_PTR(owner_offset);
 
 	post_history(his_enq, owner_offset, (SRQ_PTR)0, SRQ_REL_PTR(request), true);
 
@@ -534,8 +566,8 @@ SRQ_PTR LockManager::enqueue(const Callbacks& callbacks,
 
 	// See if the lock already exists
 
-	USHORT hash_slot;
-	lbl* lock = find_lock(series, value, length, &hash_slot);
+	USHORT junk;
+	lbl* lock = find_lock(series, value, length, &junk);
 	if (lock)
 	{
 		if (series < LCK_MAX_SERIES)
@@ -557,7 +589,7 @@ SRQ_PTR LockManager::enqueue(const Callbacks& callbacks,
 
 	// Lock doesn't exist. Allocate lock block and set it up.
 
-	if (!(lock = alloc_lock(length, statusVector)))
+	if (!(lock = alloc_lock(length, hash_slot, statusVector)))
 	{
 		// lock table is exhausted: release request gracefully
 		remove_que(&request->lrq_own_requests);
@@ -583,6 +615,7 @@ SRQ_PTR LockManager::enqueue(const Callbacks& callbacks,
 
 	lock->lbl_flags = 0;
 	lock->lbl_pending_lrq_count = 0;
+	lock->lbl_hash_slot = hash_slot;
 
 	memset(lock->lbl_counts, 0, sizeof(lock->lbl_counts));
 
@@ -728,6 +761,9 @@ bool LockManager::dequeue(const SRQ_PTR request_offset)
  **************************************/
 	LOCK_TRACE(("LM::dequeue (%ld)\n", request_offset));
 
+	if (fast_dequeue(request_offset))
+		return true;
+
 	LockTableGuard guard(this, FB_FUNCTION, DUMMY_OWNER);
 
 	lrq* const request = get_request(request_offset);
@@ -972,6 +1008,59 @@ LOCK_DATA_T LockManager::readData(SRQ_PTR request_offset)
 }
 
 
+bool LockManager::probe(const USHORT series,
+						const UCHAR* value,
+						const USHORT length,
+						UCHAR type,
+						SRQ_PTR owner_offset)
+{
+/**************************************
+ *
+ *	p r o b e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check whether a lock could be granted without waiting.
+ *	This is the same as a no-wait enqueue followed by the
+ *	immediate dequeue, but neither the request nor the lock
+ *	block get allocated. A no-wait request doesn't post the
+ *	blocking ASTs, thus there is nothing else to be done.
+ *
+ **************************************/
+	LOCK_TRACE(("LM::probe (%ld)\n", owner_offset));
+
+	if (!owner_offset)
+		return false;
+
+	LockTableGuard guard(this, FB_FUNCTION, owner_offset);
+
+	const own* const owner = (own*) SRQ_ABS_PTR(owner_offset);
+	if (!owner->own_count)
+		return false;
+
+	++(m_sharedMemory->getHeader()->lhb_enqs);
+
+	if (series < LCK_MAX_SERIES)
+		++(m_sharedMemory->getHeader()->lhb_operations[series]);
+	else
+		++(m_sharedMemory->getHeader()->lhb_operations[0]);
+
+	USHORT junk;
+	const lbl* const lock = find_lock(series, value, length, &junk);
+
+	if (lock && !(compatibility[type][lock->lbl_state] &&
+		(type == LCK_null || lock->lbl_pending_lrq_count == 0)))
+	{
+		++(m_sharedMemory->getHeader()->lhb_denies);
+		return false;
+	}
+
+	++(m_sharedMemory->getHeader()->lhb_deqs);
+	return true;
+}
+
+
 LOCK_DATA_T LockManager::readData2(USHORT series,
 							 const UCHAR* value,
 							 USHORT length,
@@ -1060,10 +1149,14 @@ void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 
 	// Perform a spin wait on the lock table mutex. This should only
 	// be used on SMP machines; it doesn't make much sense otherwise.
+	// The delay between attempts grows exponentially: with many processes
+	// spinning at once, back-to-back attempts keep the mutex cache line
+	// bouncing between CPUs and delay its release by the current holder.
 
 	const ULONG spins_to_try = m_acquireSpins ? m_acquireSpins : 1;
 	bool locked = false;
 	ULONG spins = 0;
+	ULONG backoff = 1;
 	while (spins++ < spins_to_try)
 	{
 		if (m_sharedMemory->mutexTryLock())
@@ -1073,6 +1166,15 @@ void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 		}
 
 		m_blockage = true;
+
+		if (spins < spins_to_try)
+		{
+			for (ULONG i = 0; i < backoff; i++)
+				spin_pause();
+
+			if (backoff < MAX_ACQUIRE_BACKOFF)
+				backoff <<= 1;
+		}
 	}
 
 	// If the spin wait didn't succeed then wait forever
@@ -1105,6 +1207,27 @@ void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 		m_sharedMemory->mutexLock();
 	}
 
+	// Latch all partitions, waiting for the running partition level operations
+	// to finish, and account their statistics
+
+	lhb* const header = m_sharedMemory->getHeader();
+
+	for (USHORT i = 0; i < LHB_PARTITIONS; i++)
+	{
+		lhp* const partition = get_partition(i);
+		latch_partition(partition, true);
+
+		header->lhb_enqs += partition->lhp_enqs;
+		header->lhb_deqs += partition->lhp_deqs;
+		partition->lhp_enqs = partition->lhp_deqs = 0;
+
+		for (USHORT series = 0; series < LCK_MAX_SERIES; series++)
+		{
+			header->lhb_operations[series] += partition->lhp_operations[series];
+			partition->lhp_operations[series] = 0;
+		}
+	}
+
 	++(m_sharedMemory->getHeader()->lhb_acquires);
 	if (m_blockage)
 	{
@@ -1171,24 +1294,16 @@ void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 	{
 		post_history(his_active, owner_offset, prior_active, (SRQ_PTR) 0, false);
 		shb* const recover = (shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary);
-		if (recover->shb_remove_node)
-		{
-			// There was a remove_que operation in progress when the prior_owner died
-			DEBUG_MSG(0, ("Got to the funky shb_remove_node code\n"));
-			remove_que((SRQ) SRQ_ABS_PTR(recover->shb_remove_node));
-		}
-		else if (recover->shb_insert_que && recover->shb_insert_prior)
-		{
-			// There was a insert_que operation in progress when the prior_owner died
-			DEBUG_MSG(0, ("Got to the funky shb_insert_que code\n"));
+		recover_que(recover->shb_remove_node, recover->shb_insert_que, recover->shb_insert_prior);
+	}
 
-			SRQ lock_srq = (SRQ) SRQ_ABS_PTR(recover->shb_insert_que);
-			lock_srq->srq_backward = recover->shb_insert_prior;
-			lock_srq = (SRQ) SRQ_ABS_PTR(recover->shb_insert_prior);
-			lock_srq->srq_forward = recover->shb_insert_que;
-			recover->shb_insert_que = 0;
-			recover->shb_insert_prior = 0;
-		}
+	// Partitions are latched by us now, so the unfinished work found there
+	// was left by a process died while holding the partition
+
+	for (USHORT i = 0; i < LHB_PARTITIONS; i++)
+	{
+		lhp* const partition = get_partition(i);
+		recover_que(partition->lhp_remove_node, partition->lhp_insert_que, partition->lhp_insert_prior);
 	}
 }
 
@@ -1308,7 +1423,7 @@ UCHAR* LockManager::alloc(USHORT size, CheckStatusWrapper* statusVector)
 }
 
 
-lbl* LockManager::alloc_lock(USHORT length, CheckStatusWrapper* statusVector)
+lbl* LockManager::alloc_lock(USHORT length, USHORT hash_slot, CheckStatusWrapper* statusVector)
 {
 /**************************************
  *
@@ -1318,15 +1433,15 @@ lbl* LockManager::alloc_lock(USHORT length, CheckStatusWrapper* statusVector)
  *
  * Functional description
  *	Allocate a lock for a key of a given length.  Look first to see
- *	if a spare of the right size is sitting around.  If not, allocate
- *	one.
+ *	if a spare of the right size is sitting around in the partition
+ *	of the hash slot.  If not, allocate one.
  *
  **************************************/
 	length = FB_ALIGN(length, 8);
 
 	ASSERT_ACQUIRED;
 	srq* lock_srq;
-	SRQ_LOOP(m_sharedMemory->getHeader()->lhb_free_locks, lock_srq)
+	SRQ_LOOP(get_partition(hash_slot)->lhp_free_locks, lock_srq)
 	{
 		lbl* lock = (lbl*) ((UCHAR*) lock_srq - offsetof(lbl, lbl_lhb_hash));
 		// Here we use the "first fit" approach which costs us some memory,
@@ -1358,6 +1473,36 @@ lbl* LockManager::alloc_lock(USHORT length, CheckStatusWrapper* statusVector)
 }
 
 
+lrq* LockManager::alloc_request(USHORT hash_slot, CheckStatusWrapper* statusVector)
+{
+/**************************************
+ *
+ *	a l l o c _ r e q u e s t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Allocate a lock request for a lock of the given hash slot.
+ *	Reuse the one freed in the partition of the slot or any
+ *	other free one, if there's no such.
+ *
+ **************************************/
+	ASSERT_ACQUIRED;
+	srq* free_requests = &get_partition(hash_slot)->lhp_free_requests;
+
+	if (SRQ_EMPTY((*free_requests)))
+		free_requests = &m_sharedMemory->getHeader()->lhb_free_requests;
+
+	if (SRQ_EMPTY((*free_requests)))
+		return (lrq*) alloc(sizeof(lrq), statusVector);
+
+	lrq* const request = (lrq*) ((UCHAR*) SRQ_NEXT((*free_requests)) - offsetof(lrq, lrq_lbl_requests));
+	remove_que(&request->lrq_lbl_requests);
+
+	return request;
+}
+
+
 void LockManager::blocking_action(const Callbacks& callbacks,
 	SRQ_PTR blocking_owner_offset)
 {
@@ -2087,6 +2232,228 @@ void LockManager::debug_delay(ULONG lineno)
 }
 #endif
 
+bool LockManager::fast_dequeue(SRQ_PTR request_offset)
+{
+/**************************************
+ *
+ *	f a s t _ d e q u e u e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Try to release an outstanding lock holding only the partition
+ *	of the lock.  It's possible if there are no pending requests for
+ *	the lock and the request isn't blocking anybody, otherwise
+ *	return false and leave everything as is.
+ *
+ **************************************/
+
+	// Prevent the lock table from being remapped by another thread while we're here
+
+	ReadLockGuard remapGuard(m_remapSync, FB_FUNCTION);
+
+	if (request_offset <= 0 || m_sharedMemory->getHeader()->isDeleted())
+		return false;
+
+	// The request and its lock are known to this process already, so they are mapped
+
+	lrq* const request = (lrq*) SRQ_ABS_PTR(request_offset);
+	if (request->lrq_type != type_lrq || !request->lrq_lock)
+		return false;
+
+	lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	lhp* const partition = get_partition(lock->lbl_hash_slot);
+
+	PartitionGuard guard(this, partition);
+
+	if (!guard.isLatched() || !is_mapped() ||
+		partition->lhp_remove_node || partition->lhp_insert_que)
+	{
+		return false;
+	}
+
+	if (request->lrq_type != type_lrq || lock->lbl_type != type_lbl ||
+		(request->lrq_flags & (LRQ_blocking | LRQ_pending | LRQ_repost)) ||
+		lock->lbl_pending_lrq_count)
+	{
+		return false;
+	}
+
+	own* const owner = (own*) SRQ_ABS_PTR(request->lrq_owner);
+	if (!owner->own_count)
+		return false;
+
+	// The lock is released together with its last request,
+	// but the lock series data queue is global
+
+	const SRQ_PTR lbl_node = SRQ_REL_PTR(&request->lrq_lbl_requests);
+	const bool last_request = (lock->lbl_requests.srq_forward == lbl_node &&
+		lock->lbl_requests.srq_backward == lbl_node);
+
+	if (last_request && !SRQ_EMPTY(lock->lbl_lhb_data))
+		return false;
+
+	++partition->lhp_deqs;
+	++partition->lhp_operations[lock->lbl_series < LCK_MAX_SERIES ? lock->lbl_series : 0];
+
+	remove_que(&request->lrq_lbl_requests, partition->lhp_remove_node);
+
+	latch_owner(owner);
+	remove_que(&request->lrq_own_requests, partition->lhp_remove_node);
+	unlatch_owner(owner);
+
+	request->lrq_type = type_null;
+	request->lrq_ast_routine = NULL;
+	request->lrq_flags &= ~(LRQ_blocking_seen | LRQ_just_granted);
+	insert_tail(&partition->lhp_free_requests, &request->lrq_lbl_requests,
+		partition->lhp_insert_que, partition->lhp_insert_prior);
+
+	if (last_request)
+	{
+		remove_que(&lock->lbl_lhb_hash, partition->lhp_remove_node);
+		lock->lbl_type = type_null;
+		insert_tail(&partition->lhp_free_locks, &lock->lbl_lhb_hash,
+			partition->lhp_insert_que, partition->lhp_insert_prior);
+	}
+	else if (request->lrq_state != LCK_none && !(--lock->lbl_counts[request->lrq_state]))
+		lock->lbl_state = lock_state(lock);
+
+	return true;
+}
+
+
+SRQ_PTR LockManager::fast_enqueue(const USHORT series,
+								  const UCHAR* value,
+								  const USHORT length,
+								  UCHAR type,
+								  lock_ast_t ast_routine,
+								  void* ast_argument,
+								  LOCK_DATA_T data,
+								  SRQ_PTR owner_offset)
+{
+/**************************************
+ *
+ *	f a s t _ e n q u e u e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Try to enqueue on a lock holding only the partition of the lock.
+ *	It's possible if the request is granted immediately, it doesn't
+ *	maintain the lock series data queue and the partition has free
+ *	blocks to reuse.  Otherwise return zero and leave everything as is.
+ *
+ **************************************/
+
+	if (series < LCK_MAX_SERIES && data)
+		return 0;
+
+	// Prevent the lock table from being remapped by another thread while we're here
+
+	ReadLockGuard remapGuard(m_remapSync, FB_FUNCTION);
+
+	if (m_sharedMemory->getHeader()->isDeleted())
+		return 0;
+
+	USHORT hash_slot = get_hash_slot(value, length);
+	lhp* const partition = get_partition(hash_slot);
+
+	PartitionGuard guard(this, partition);
+
+	if (!guard.isLatched() || !is_mapped() ||
+		partition->lhp_remove_node || partition->lhp_insert_que)
+	{
+		return 0;
+	}
+
+	own* const owner = (own*) SRQ_ABS_PTR(owner_offset);
+	if (!owner->own_count || owner->own_waits || SRQ_EMPTY(partition->lhp_free_requests))
+		return 0;
+
+	lbl* lock = find_lock(series, value, length, &hash_slot);
+	const bool new_lock = !lock;
+
+	if (new_lock)
+	{
+		const USHORT size = FB_ALIGN(length, 8);
+
+		srq* lock_srq;
+		SRQ_LOOP(partition->lhp_free_locks, lock_srq)
+		{
+			lbl* const free_lock = (lbl*) ((UCHAR*) lock_srq - offsetof(lbl, lbl_lhb_hash));
+			if (free_lock->lbl_size >= size)
+			{
+				lock = free_lock;
+				break;
+			}
+		}
+
+		if (!lock)
+			return 0;
+	}
+	else if (!compatibility[type][lock->lbl_state] || lock->lbl_pending_lrq_count)
+		return 0;
+
+	++partition->lhp_enqs;
+	++partition->lhp_operations[series < LCK_MAX_SERIES ? series : 0];
+
+	lrq* const request = (lrq*) ((UCHAR*) SRQ_NEXT(partition->lhp_free_requests) -
+		offsetof(lrq, lrq_lbl_requests));
+	remove_que(&request->lrq_lbl_requests, partition->lhp_remove_node);
+
+	request->lrq_type = type_lrq;
+	request->lrq_flags = 0;
+	request->lrq_requested = type;
+	request->lrq_state = LCK_none;
+	request->lrq_data = 0;
+	request->lrq_owner = owner_offset;
+	request->lrq_ast_routine = ast_routine;
+	request->lrq_ast_argument = ast_argument;
+	SRQ_INIT(request->lrq_own_blocks);
+	SRQ_INIT(request->lrq_own_pending);
+
+	if (new_lock)
+	{
+		remove_que(&lock->lbl_lhb_hash, partition->lhp_remove_node);
+
+		lock->lbl_type = type_lbl;
+		lock->lbl_state = LCK_none;
+		fb_assert(series <= MAX_UCHAR);
+		lock->lbl_series = (UCHAR) series;
+		lock->lbl_flags = 0;
+		lock->lbl_pending_lrq_count = 0;
+		lock->lbl_hash_slot = hash_slot;
+		memset(lock->lbl_counts, 0, sizeof(lock->lbl_counts));
+		lock->lbl_length = length;
+		memcpy(lock->lbl_key, value, length);
+		SRQ_INIT(lock->lbl_lhb_data);
+		SRQ_INIT(lock->lbl_requests);
+
+		insert_tail(&m_sharedMemory->getHeader()->lhb_hash[hash_slot], &lock->lbl_lhb_hash,
+			partition->lhp_insert_que, partition->lhp_insert_prior);
+	}
+
+	// Data of the series without the data queue is just kept in the lock
+	if (new_lock || data)
+		lock->lbl_data = data;
+
+	request->lrq_lock = SRQ_REL_PTR(lock);
+	insert_tail(&lock->lbl_requests, &request->lrq_lbl_requests,
+		partition->lhp_insert_que, partition->lhp_insert_prior);
+
+	latch_owner(owner);
+	insert_tail(&owner->own_requests, &request->lrq_own_requests,
+		partition->lhp_insert_que, partition->lhp_insert_prior);
+	unlatch_owner(owner);
+
+	++lock->lbl_counts[type];
+	request->lrq_state = type;
+	lock->lbl_state = lock_state(lock);
+
+	return SRQ_REL_PTR(request);
+}
+
+
 lbl* LockManager::find_lock(USHORT series,
 							const UCHAR* value,
 							USHORT length,
@@ -2106,12 +2473,11 @@ lbl* LockManager::find_lock(USHORT series,
  *
  **************************************/
 
-	// See if the lock already exists
+	// See if the lock already exists. The caller holds either the lock table
+	// or the partition of the hash slot.
 
-	const USHORT hash_slot = *slot =
-		(USHORT) InternalHash::hash(length, value, m_sharedMemory->getHeader()->lhb_hash_slots);
+	const USHORT hash_slot = *slot = get_hash_slot(value, length);
 
-	ASSERT_ACQUIRED;
 	srq* const hash_header = &m_sharedMemory->getHeader()->lhb_hash[hash_slot];
 
 	for (srq* lock_srq = (SRQ) SRQ_ABS_PTR(hash_header->srq_forward);
@@ -2131,6 +2497,42 @@ lbl* LockManager::find_lock(USHORT series,
 }
 
 
+USHORT LockManager::get_hash_slot(const UCHAR* value, USHORT length)
+{
+/**************************************
+ *
+ *	g e t _ h a s h _ s l o t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compute the hash slot of a resource name.
+ *
+ **************************************/
+
+	return (USHORT) InternalHash::hash(length, value, m_sharedMemory->getHeader()->lhb_hash_slots);
+}
+
+
+lhp* LockManager::get_partition(USHORT hash_slot)
+{
+/**************************************
+ *
+ *	g e t _ p a r t i t i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Locate the lock table partition of a hash slot.
+ *
+ **************************************/
+
+	UCHAR* const partitions = (UCHAR*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_partitions);
+
+	return (lhp*) (partitions + (hash_slot % LHB_PARTITIONS) * LHP_SIZE);
+}
+
+
 lrq* LockManager::get_request(SRQ_PTR offset)
 {
 /**************************************
@@ -2291,6 +2693,7 @@ bool LockManager::init_owner_block(CheckStatusWrapper* statusVector, own* owner,
 	owner->own_acquire_time = 0;
 	owner->own_waits = 0;
 	owner->own_ast_count = 0;
+	owner->own_latch.store(0, std::memory_order_relaxed);
 
 	if (m_sharedMemory->eventInit(&owner->own_wakeup) != FB_SUCCESS)
 	{
@@ -2345,7 +2748,6 @@ bool LockManager::initialize(SharedMemoryBase* sm, bool initializeMemory)
 	SRQ_INIT(hdr->lhb_owners);
 	SRQ_INIT(hdr->lhb_free_processes);
 	SRQ_INIT(hdr->lhb_free_owners);
-	SRQ_INIT(hdr->lhb_free_locks);
 	SRQ_INIT(hdr->lhb_free_requests);
 
 	hdr->lhb_hash_slots = m_hashSlots;
@@ -2383,6 +2785,24 @@ bool LockManager::initialize(SharedMemoryBase* sm, bool initializeMemory)
 	secondary_header->shb_insert_que = 0;
 	secondary_header->shb_insert_prior = 0;
 
+	// Allocate the partitions, each in its own cache line
+
+	UCHAR* const partitions = alloc(LHP_SIZE * LHB_PARTITIONS + 64, NULL);
+	if (!partitions)
+	{
+		fb_utils::logAndDie("Fatal lock manager error: lock manager out of room");
+	}
+
+	hdr->lhb_partitions = SRQ_REL_PTR(FB_ALIGN(partitions, 64));
+
+	for (i = 0; i < LHB_PARTITIONS; i++)
+	{
+		lhp* const partition = get_partition(i);
+		memset(partition, 0, sizeof(lhp));
+		SRQ_INIT(partition->lhp_free_locks);
+		SRQ_INIT(partition->lhp_free_requests);
+	}
+
 	// Allocate a sufficiency of history blocks
 
 	his* history = NULL;
@@ -2469,10 +2889,28 @@ void LockManager::insert_tail(SRQ lock_srq, SRQ node)
  **************************************/
 	ASSERT_ACQUIRED;
 	shb* const recover = (shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary);
+	insert_tail(lock_srq, node, recover->shb_insert_que, recover->shb_insert_prior);
+}
+
+
+void LockManager::insert_tail(SRQ lock_srq, SRQ node, SRQ_PTR& insert_que, SRQ_PTR& insert_prior)
+{
+/**************************************
+ *
+ *	i n s e r t _ t a i l
+ *
+ **************************************
+ *
+ * Functional description
+ *	Insert a node at the tail of a lock_srq, keeping the recovery
+ *	information in the given place: the secondary header block when
+ *	the lock table is acquired or the partition holding the lock_srq.
+ *
+ **************************************/
 	DEBUG_DELAY;
-	recover->shb_insert_que = SRQ_REL_PTR(lock_srq);
+	insert_que = SRQ_REL_PTR(lock_srq);
 	DEBUG_DELAY;
-	recover->shb_insert_prior = lock_srq->srq_backward;
+	insert_prior = lock_srq->srq_backward;
 	DEBUG_DELAY;
 
 	node->srq_forward = SRQ_REL_PTR(lock_srq);
@@ -2487,13 +2925,107 @@ void LockManager::insert_tail(SRQ lock_srq, SRQ node)
 	lock_srq->srq_backward = SRQ_REL_PTR(node);
 	DEBUG_DELAY;
 
-	recover->shb_insert_que = 0;
+	insert_que = 0;
 	DEBUG_DELAY;
-	recover->shb_insert_prior = 0;
+	insert_prior = 0;
 	DEBUG_DELAY;
 }
 
 
+bool LockManager::is_mapped()
+{
+/**************************************
+ *
+ *	i s _ m a p p e d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check whether the whole lock table is mapped by this process.
+ *	If not, the table must be acquired to remap it.
+ *
+ **************************************/
+#ifdef USE_SHMEM_EXT
+	return m_sharedMemory->getHeader()->lhb_length <= getTotalMapped();
+#else
+	return m_sharedMemory->getHeader()->lhb_length <= m_sharedMemory->sh_mem_length_mapped;
+#endif
+}
+
+
+bool LockManager::latch_partition(lhp* partition, bool wait)
+{
+/**************************************
+ *
+ *	l a t c h _ p a r t i t i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Latch a lock table partition.  If we're not asked to wait,
+ *	give up after a few attempts, the caller is expected to
+ *	acquire the whole lock table then.  Otherwise wait until
+ *	the partition is released or its holder is found dead.
+ *
+ **************************************/
+	ULONG spins = 0;
+	ULONG backoff = 1;
+
+	while (true)
+	{
+		int holder = 0;
+		if (partition->lhp_latch.compare_exchange_weak(holder, PID, std::memory_order_acquire))
+			return true;
+
+		if (++spins >= PARTITION_SPINS)
+		{
+			if (!wait)
+				return false;
+
+			if (spins % PARTITION_PROBE_SPINS == 0 && holder && holder != PID &&
+				!ISC_check_process_existence(holder) &&
+				partition->lhp_latch.compare_exchange_strong(holder, PID, std::memory_order_acquire))
+			{
+				// The holder died, its unfinished work is recovered by acquire_shmem()
+				return true;
+			}
+
+			Thread::yield();
+			continue;
+		}
+
+		for (ULONG i = 0; i < backoff; i++)
+			spin_pause();
+
+		if (backoff < MAX_ACQUIRE_BACKOFF)
+			backoff <<= 1;
+	}
+}
+
+
+void LockManager::latch_owner(own* owner)
+{
+/**************************************
+ *
+ *	l a t c h _ o w n e r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Latch the queue of owner requests.  Threads of the owner process
+ *	may work with different partitions at once, while the owner queue
+ *	is shared by them.  Acquiring the lock table excludes them all.
+ *
+ **************************************/
+	int expected = 0;
+	while (!owner->own_latch.compare_exchange_weak(expected, 1, std::memory_order_acquire))
+	{
+		expected = 0;
+		spin_pause();
+	}
+}
+
+
 bool LockManager::internal_convert(const Callbacks& callbacks,
 								   CheckStatusWrapper* statusVector,
 								   SRQ_PTR request_offset,
@@ -3046,8 +3578,26 @@ void LockManager::remove_que(SRQ node)
  **************************************/
 	ASSERT_ACQUIRED;
 	shb* recover = (shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary);
+	remove_que(node, recover->shb_remove_node);
+}
+
+
+void LockManager::remove_que(SRQ node, SRQ_PTR& remove_node)
+{
+/**************************************
+ *
+ *	r e m o v e _ q u e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Remove a node from a self-relative lock_srq, keeping the recovery
+ *	information in the given place: the secondary header block when
+ *	the lock table is acquired or the partition holding the node.
+ *
+ **************************************/
 	DEBUG_DELAY;
-	recover->shb_remove_node = SRQ_REL_PTR(node);
+	remove_node = SRQ_REL_PTR(node);
 	DEBUG_DELAY;
 
 	SRQ lock_srq = (SRQ) SRQ_ABS_PTR(node->srq_forward);
@@ -3072,7 +3622,7 @@ void LockManager::remove_que(SRQ node)
 	lock_srq->srq_forward = node->srq_forward;
 
 	DEBUG_DELAY;
-	recover->shb_remove_node = 0;
+	remove_node = 0;
 	DEBUG_DELAY;
 
 	// To prevent trying to remove this entry a second time, which could occur
@@ -3085,6 +3635,40 @@ void LockManager::remove_que(SRQ node)
 }
 
 
+void LockManager::recover_que(SRQ_PTR& remove_node, SRQ_PTR& insert_que, SRQ_PTR& insert_prior)
+{
+/**************************************
+ *
+ *	r e c o v e r _ q u e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Finish the queue operation left unfinished by a died process.
+ *	A removal is completed, while an insertion is undone.
+ *
+ **************************************/
+	if (remove_node)
+	{
+		// There was a remove_que operation in progress when the prior_owner died
+		DEBUG_MSG(0, ("Got to the funky shb_remove_node code\n"));
+		remove_que((SRQ) SRQ_ABS_PTR(remove_node), remove_node);
+	}
+	else if (insert_que && insert_prior)
+	{
+		// There was a insert_que operation in progress when the prior_owner died
+		DEBUG_MSG(0, ("Got to the funky shb_insert_que code\n"));
+
+		SRQ lock_srq = (SRQ) SRQ_ABS_PTR(insert_que);
+		lock_srq->srq_backward = insert_prior;
+		lock_srq = (SRQ) SRQ_ABS_PTR(insert_prior);
+		lock_srq->srq_forward = insert_que;
+		insert_que = 0;
+		insert_prior = 0;
+	}
+}
+
+
 void LockManager::release_shmem(SRQ_PTR owner_offset)
 {
 /**************************************
@@ -3119,6 +3703,9 @@ void LockManager::release_shmem(SRQ_PTR owner_offset)
 
 	m_sharedMemory->getHeader()->lhb_active_owner = 0;
 
+	for (USHORT i = 0; i < LHB_PARTITIONS; i++)
+		unlatch_partition(get_partition(i));
+
 	m_sharedMemory->mutexUnlock();
 
 	DEBUG_DELAY;
@@ -3145,9 +3732,11 @@ void LockManager::release_request(lrq* request)
 	remove_que(&request->lrq_lbl_requests);
 	remove_que(&request->lrq_own_requests);
 
-	request->lrq_type = type_null;
-	insert_tail(&m_sharedMemory->getHeader()->lhb_free_requests, &request->lrq_lbl_requests);
 	lbl* const lock = (lbl*) SRQ_ABS_PTR(request->lrq_lock);
+	lhp* const partition = get_partition(lock->lbl_hash_slot);
+
+	request->lrq_type = type_null;
+	insert_tail(&partition->lhp_free_requests, &request->lrq_lbl_requests);
 
 	// If the request is marked as blocking, clean it up
 
@@ -3179,7 +3768,7 @@ void LockManager::release_request(lrq* request)
 		remove_que(&lock->lbl_lhb_data);
 		lock->lbl_type = type_null;
 
-		insert_tail(&m_sharedMemory->getHeader()->lhb_free_locks, &lock->lbl_lhb_hash);
+		insert_tail(&partition->lhp_free_locks, &lock->lbl_lhb_hash);
 		return;
 	}
 
@@ -3264,6 +3853,38 @@ constexpr USHORT EXPECT_freed = 1;
 constexpr USHORT RECURSE_yes = 0;
 constexpr USHORT RECURSE_not = 1;
 
+void LockManager::unlatch_owner(own* owner)
+{
+/**************************************
+ *
+ *	u n l a t c h _ o w n e r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Release the queue of owner requests.
+ *
+ **************************************/
+	owner->own_latch.store(0, std::memory_order_release);
+}
+
+
+void LockManager::unlatch_partition(lhp* partition)
+{
+/**************************************
+ *
+ *	u n l a t c h _ p a r t i t i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Release a lock table partition.
+ *
+ **************************************/
+	partition->lhp_latch.store(0, std::memory_order_release);
+}
+
+
 void LockManager::validate_history(const SRQ_PTR history_header)
 {
 /**************************************
@@ -3342,14 +3963,31 @@ void LockManager::validate_lhb(const lhb* alhb)
 		validate_owner(SRQ_REL_PTR(owner), EXPECT_freed);
 	}
 
-	SRQ_LOOP(alhb->lhb_free_locks, lock_srq)
+	for (USHORT i = 0; i < LHB_PARTITIONS; i++)
 	{
-		// Validate that the next backpointer points back to us
-		const srq* const que_next = SRQ_NEXT((*lock_srq));
-		CHECK(que_next->srq_backward == SRQ_REL_PTR(lock_srq));
+		const lhp* const partition = get_partition(i);
+
+		CHECK(!partition->lhp_remove_node && !partition->lhp_insert_que);
+
+		SRQ_LOOP(partition->lhp_free_locks, lock_srq)
+		{
+			// Validate that the next backpointer points back to us
+			const srq* const que_next = SRQ_NEXT((*lock_srq));
+			CHECK(que_next->srq_backward == SRQ_REL_PTR(lock_srq));
 
-		const lbl* const lock = (lbl*) ((UCHAR*) lock_srq - offsetof(lbl, lbl_lhb_hash));
-		validate_lock(SRQ_REL_PTR(lock), EXPECT_freed, (SRQ_PTR) 0);
+			const lbl* const lock = (lbl*) ((UCHAR*) lock_srq - offsetof(lbl, lbl_lhb_hash));
+			validate_lock(SRQ_REL_PTR(lock), EXPECT_freed, (SRQ_PTR) 0);
+		}
+
+		SRQ_LOOP(partition->lhp_free_requests, lock_srq)
+		{
+			// Validate that the next backpointer points back to us
+			const srq* const que_next = SRQ_NEXT((*lock_srq));
+			CHECK(que_next->srq_backward == SRQ_REL_PTR(lock_srq));
+
+			const lrq* const request = (lrq*) ((UCHAR*) lock_srq - offsetof(lrq, lrq_lbl_requests));
+			validate_request(SRQ_REL_PTR(request), EXPECT_freed, RECURSE_not);
+		}
 	}
 
 	SRQ_LOOP(alhb->lhb_free_requests, lock_srq)
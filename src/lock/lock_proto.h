@@ -31,6 +31,7 @@
 
 #include <stdio.h>
 #include <sys/types.h>
+#include <atomic>
 
 #include "../common/classes/semaphore.h"
 #include "../common/classes/rwlock.h"
@@ -93,7 +94,7 @@ inline constexpr UCHAR type_lpr		= 7;
 
 // Version number of the lock table.
 // Must be increased every time the shmem layout is changed.
-inline constexpr USHORT BASE_LHB_VERSION = 20;
+inline constexpr USHORT BASE_LHB_VERSION = 21;
 inline constexpr USHORT PLATFORM_LHB_VERSION = 128;	// 64-bit target
 
 #if SIZEOF_VOID_P == 8
@@ -109,13 +110,13 @@ struct lhb : public Firebird::MemoryHeader
 {
 	USHORT lhb_type;				// memory tag - always type_lhb
 	SRQ_PTR lhb_secondary;			// Secondary lock header block
+	SRQ_PTR lhb_partitions;			// Lock table partitions
 	SRQ_PTR lhb_active_owner;		// Active owner, if any
 	srq lhb_owners;					// Que of active owners
 	srq lhb_processes;				// Que of active processes
 	srq lhb_free_processes;			// Free process blocks
 	srq lhb_free_owners;			// Free owner blocks
-	srq lhb_free_locks;				// Free lock blocks
-	srq lhb_free_requests;			// Free lock requests
+	srq lhb_free_requests;			// Free lock requests not bound to a partition
 	ULONG lhb_length;				// Size of lock table
 	ULONG lhb_used;					// Bytes of lock table in use
 	USHORT lhb_hash_slots;			// Number of hash slots allocated
@@ -158,6 +159,30 @@ struct shb
 	SRQ_PTR shb_insert_prior;		// Prior of inserting queue
 };
 
+// Lock table partition. The hash slots are spread between the partitions
+// (slot % LHB_PARTITIONS) and every partition guards the locks of its slots
+// and the requests for them. Enqueues and dequeues which neither wait nor
+// affect other owners latch only the partition of the lock. Acquiring the
+// whole lock table latches all partitions.
+
+inline constexpr USHORT LHB_PARTITIONS = 16;
+
+struct lhp
+{
+	std::atomic<int> lhp_latch;		// Process holding the partition, 0 if free
+	SRQ_PTR lhp_remove_node;		// Node removing itself
+	SRQ_PTR lhp_insert_que;			// Queue inserting into
+	SRQ_PTR lhp_insert_prior;		// Prior of inserting queue
+	srq lhp_free_locks;				// Free lock blocks
+	srq lhp_free_requests;			// Free lock requests
+	FB_UINT64 lhp_enqs;				// Operations not yet added to the lhb counters
+	FB_UINT64 lhp_deqs;
+	FB_UINT64 lhp_operations[LCK_MAX_SERIES];
+};
+
+// Partitions are placed in separate cache lines
+inline constexpr ULONG LHP_SIZE = FB_ALIGN(sizeof(lhp), 64);
+
 // Lock block
 
 struct lbl
@@ -173,6 +198,7 @@ struct lbl
 	UCHAR lbl_series;				// Lock series
 	UCHAR lbl_flags;				// Unused. Misc flags
 	USHORT lbl_pending_lrq_count;	// count of lbl_requests with LRQ_pending
+	USHORT lbl_hash_slot;			// Hash slot, defines the partition
 	USHORT lbl_counts[LCK_max];		// Counts of granted locks
 	UCHAR lbl_key[1];				// Key value
 };
@@ -239,6 +265,7 @@ struct own
 	USHORT own_ast_count;			// Number of ASTs being delivered
 	Firebird::event_t own_wakeup;	// Wakeup event block
 	USHORT own_flags;				// Misc stuff
+	std::atomic<int> own_latch;		// Guards own_requests while the lock table isn't acquired
 };
 
 // Flags in own_flags
@@ -351,6 +378,34 @@ private:
 		SRQ_PTR m_owner;
 	};
 
+	// Latches the lock table partition if it's not busy
+	class PartitionGuard
+	{
+	public:
+		PartitionGuard(LockManager* lm, lhp* partition)
+			: m_lm(lm), m_partition(lm->latch_partition(partition, false) ? partition : NULL)
+		{}
+
+		~PartitionGuard()
+		{
+			if (m_partition)
+				m_lm->unlatch_partition(m_partition);
+		}
+
+		bool isLatched() const
+		{
+			return m_partition != NULL;
+		}
+
+	private:
+		// Forbid copying
+		PartitionGuard(const PartitionGuard&);
+		PartitionGuard& operator=(const PartitionGuard&);
+
+		LockManager* m_lm;
+		lhp* const m_partition;
+	};
+
 	class LockTableCheckout
 	{
 	public:
@@ -412,6 +467,7 @@ public:
 	bool convert(const Callbacks&, Firebird::CheckStatusWrapper*, SRQ_PTR, UCHAR, SSHORT, lock_ast_t, void*);
 	UCHAR downgrade(const Callbacks&, Firebird::CheckStatusWrapper*, const SRQ_PTR);
 	bool dequeue(const SRQ_PTR);
+	bool probe(const USHORT, const UCHAR*, const USHORT, UCHAR, SRQ_PTR);
 
 	void repost(const Callbacks&, lock_ast_t, void*, SRQ_PTR);
 	bool cancelWait(SRQ_PTR);
@@ -426,7 +482,8 @@ public:
 private:
 	void acquire_shmem(SRQ_PTR);
 	UCHAR* alloc(USHORT, Firebird::CheckStatusWrapper*);
-	lbl* alloc_lock(USHORT, Firebird::CheckStatusWrapper*);
+	lbl* alloc_lock(USHORT, USHORT, Firebird::CheckStatusWrapper*);
+	lrq* alloc_request(USHORT, Firebird::CheckStatusWrapper*);
 	void blocking_action(const Callbacks&, SRQ_PTR);
 	void blocking_action_thread();
 	void bug(Firebird::CheckStatusWrapper*, const TEXT*);
@@ -437,13 +494,22 @@ private:
 	lrq* deadlock_scan(own*, lrq*);
 	lrq* deadlock_walk(lrq*, bool*);
 	void debug_delay(ULONG);
+	bool fast_dequeue(SRQ_PTR);
+	SRQ_PTR fast_enqueue(const USHORT, const UCHAR*, const USHORT, UCHAR, lock_ast_t, void*,
+		LOCK_DATA_T, SRQ_PTR);
 	lbl* find_lock(USHORT, const UCHAR*, USHORT, USHORT*);
+	USHORT get_hash_slot(const UCHAR*, USHORT);
+	lhp* get_partition(USHORT);
 	lrq* get_request(SRQ_PTR);
 	void grant(lrq*, lbl*);
 	bool grant_or_que(const Callbacks&, lrq*, lbl*, SSHORT);
 	bool init_owner_block(Firebird::CheckStatusWrapper*, own*, UCHAR, LOCK_OWNER_T);
 	void insert_data_que(lbl*);
 	void insert_tail(SRQ, SRQ);
+	void insert_tail(SRQ, SRQ, SRQ_PTR&, SRQ_PTR&);
+	bool is_mapped();
+	bool latch_partition(lhp*, bool);
+	static void latch_owner(own*);
 	bool internal_convert(const Callbacks&, Firebird::CheckStatusWrapper*, SRQ_PTR, UCHAR, SSHORT,
 		lock_ast_t, void*);
 	void internal_dequeue(SRQ_PTR);
@@ -456,10 +522,14 @@ private:
 	void purge_owner(SRQ_PTR, own*);
 	void purge_process(prc*);
 	void remap_local_owners();
+	void recover_que(SRQ_PTR&, SRQ_PTR&, SRQ_PTR&);
 	void remove_que(SRQ);
+	void remove_que(SRQ, SRQ_PTR&);
 	void release_shmem(SRQ_PTR);
 	void release_request(lrq*);
 	bool signal_owner(const Callbacks&, own*);
+	void unlatch_partition(lhp*);
+	static void unlatch_owner(own*);
 
 	void validate_history(const SRQ_PTR history_header);
 	void validate_lhb(const lhb*);
@@ -843,11 +843,26 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 			offsetof(own, own_lhb_owners), preOwn);
 	prt_que(outfile, LOCK_header, "\tFree owners",
 			&LOCK_header->lhb_free_owners, offsetof(own, own_lhb_owners));
-	prt_que(outfile, LOCK_header, "\tFree locks",
-			&LOCK_header->lhb_free_locks, offsetof(lbl, lbl_lhb_hash));
 	prt_que(outfile, LOCK_header, "\tFree requests",
 			&LOCK_header->lhb_free_requests, offsetof(lrq, lrq_lbl_requests));
 
+	SLONG free_locks = 0, free_requests = 0;
+	const UCHAR* const partitions = (const UCHAR*) SRQ_ABS_PTR(LOCK_header->lhb_partitions);
+
+	for (USHORT n = 0; n < LHB_PARTITIONS; n++)
+	{
+		const lhp* const partition = (const lhp*) (partitions + n * LHP_SIZE);
+
+		const srq* que_inst;
+		SRQ_LOOP(partition->lhp_free_locks, que_inst)
+			++free_locks;
+		SRQ_LOOP(partition->lhp_free_requests, que_inst)
+			++free_requests;
+	}
+
+	FPRINTF(outfile, "\tPartitions: %d, free locks: %" SLONGFORMAT", free requests: %" SLONGFORMAT"\n",
+			LHB_PARTITIONS, free_locks, free_requests);
+
 	FPRINTF(outfile, "\n");
 
 	// Print known owners
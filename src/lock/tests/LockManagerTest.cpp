@@ -16,6 +16,11 @@
 #include "../lock/lock_proto.h"
 #include "../jrd/lck.h"
 
+#ifndef WIN_NT
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 using namespace Firebird;
 using namespace Jrd;
 
@@ -72,6 +77,63 @@ static std::string getUniqueId()
 }
 
 
+#ifndef WIN_NT
+namespace
+{
+	struct ThroughputResult
+	{
+		unsigned lockSuccess = 0;
+		FB_UINT64 acquires = 0;
+		FB_UINT64 acquireBlocks = 0;
+	};
+
+	// Runs in a child process, as a Classic server process does: attaches to the lock table
+	// shared with other processes, waits for the start signal and then locks and unlocks
+	// its own keys, so processes compete for the lock table only, not for the locks.
+	ThroughputResult runLockWorkload(const string& lockManagerId, const Config& config,
+		unsigned processNum, unsigned keyCount, unsigned iterationCount, int startPipe)
+	{
+		LockManagerTestCallbacks callbacks;
+		auto lockManager = std::make_unique<LockManager>(lockManagerId, &config);
+
+		FbLocalStatus statusVector;
+		SLONG ownerHandle = 0;
+
+		lockManager->initializeOwner(&statusVector, processNum + 1, LCK_OWNER_attachment, &ownerHandle);
+
+		char dummy;
+		while (read(startPipe, &dummy, sizeof(dummy)) < 0 && errno == EINTR)
+			;
+
+		ThroughputResult result;
+
+		for (unsigned i = 0; i < iterationCount; ++i)
+		{
+			const unsigned key[] = {processNum, i % keyCount};
+
+			const auto lockId = lockManager->enqueue(callbacks, &statusVector, 0,
+				LCK_tra, (const UCHAR*) key, sizeof(key), LCK_EX, nullptr, nullptr, 0, LCK_WAIT, ownerHandle);
+
+			if (lockId)
+			{
+				++result.lockSuccess;
+				lockManager->dequeue(lockId);
+			}
+		}
+
+		const auto header = lockManager->m_sharedMemory->getHeader();
+		result.acquires = header->lhb_acquires;
+		result.acquireBlocks = header->lhb_acquire_blocks;
+
+		lockManager->shutdownOwner(callbacks, &ownerHandle);
+		lockManager.reset();
+
+		return result;
+	}
+}
+#endif
+
+
 BOOST_AUTO_TEST_SUITE(EngineSuite)
 BOOST_AUTO_TEST_SUITE(LockManagerSuite)
 BOOST_AUTO_TEST_SUITE(LockManagerTests)
@@ -231,6 +293,61 @@ BOOST_AUTO_TEST_CASE(LockUnlockNoWaitTest)
 }
 
 
+BOOST_AUTO_TEST_CASE(ProbeTest)
+{
+	ConfigFile configFile(ConfigFile::USE_TEXT, "\n");
+	Config config(configFile);
+
+	LockManagerTestCallbacks callbacks;
+	const string lockManagerId(getUniqueId().c_str());
+	auto lockManager = std::make_unique<LockManager>(lockManagerId, &config);
+
+	const UCHAR LOCK_KEY[] = {'1'};
+	const UCHAR OTHER_KEY[] = {'2'};
+
+	FbLocalStatus statusVector;
+	SLONG holderHandle = 0;
+	SLONG proberHandle = 0;
+
+	lockManager->initializeOwner(&statusVector, 1, LCK_OWNER_attachment, &holderHandle);
+	lockManager->initializeOwner(&statusVector, 2, LCK_OWNER_attachment, &proberHandle);
+
+	const auto probe = [&](const UCHAR* key, UCHAR type) {
+		return lockManager->probe(LCK_tra, key, 1, type, proberHandle);
+	};
+
+	BOOST_CHECK(probe(LOCK_KEY, LCK_EX));
+
+	auto lockId = lockManager->enqueue(callbacks, &statusVector, 0,
+		LCK_tra, LOCK_KEY, sizeof(LOCK_KEY), LCK_SR, nullptr, nullptr, 0, LCK_NO_WAIT, holderHandle);
+	BOOST_REQUIRE(lockId != 0);
+
+	BOOST_CHECK(probe(LOCK_KEY, LCK_SR));
+	BOOST_CHECK(!probe(LOCK_KEY, LCK_EX));
+	BOOST_CHECK(probe(OTHER_KEY, LCK_EX));
+
+	BOOST_REQUIRE(lockManager->convert(callbacks, &statusVector, lockId, LCK_EX, LCK_NO_WAIT, nullptr, nullptr));
+
+	BOOST_CHECK(probe(LOCK_KEY, LCK_null));
+	BOOST_CHECK(!probe(LOCK_KEY, LCK_SR));
+
+	lockManager->dequeue(lockId);
+
+	BOOST_CHECK(probe(LOCK_KEY, LCK_EX));
+
+	// Probing doesn't leave the lock behind
+	lockId = lockManager->enqueue(callbacks, &statusVector, 0,
+		LCK_tra, LOCK_KEY, sizeof(LOCK_KEY), LCK_EX, nullptr, nullptr, 0, LCK_NO_WAIT, holderHandle);
+	BOOST_CHECK(lockId != 0);
+	lockManager->dequeue(lockId);
+
+	lockManager->shutdownOwner(callbacks, &proberHandle);
+	lockManager->shutdownOwner(callbacks, &holderHandle);
+
+	lockManager.reset();
+}
+
+
 BOOST_AUTO_TEST_CASE(LockUnlockAstTest)
 {
 	struct LocalLock;
@@ -369,6 +486,101 @@ BOOST_AUTO_TEST_CASE(LockUnlockAstTest)
 }
 
 
+#ifndef WIN_NT
+// Benchmark of the lock table throughput of concurrent processes, it's too heavy for the default run.
+// Run with --run_test=*/LockThroughputMultiProcessTest --log_level=message to see the numbers.
+BOOST_AUTO_TEST_CASE(LockThroughputMultiProcessTest, *boost::unit_test::disabled())
+{
+	constexpr unsigned KEY_COUNT = 64u;
+	constexpr unsigned ITERATION_COUNT = 20'000u;
+
+	ConfigFile configFile(ConfigFile::USE_TEXT, "\n");
+	Config config(configFile);
+
+	for (const unsigned processCount : {1u, 4u, 16u})
+	{
+		const string lockManagerId(getUniqueId().c_str());
+
+		int startPipe[2];
+		int resultPipe[2];
+		BOOST_REQUIRE(pipe(startPipe) == 0);
+		BOOST_REQUIRE(pipe(resultPipe) == 0);
+
+		std::vector<pid_t> children;
+
+		for (unsigned processNum = 0u; processNum < processCount; ++processNum)
+		{
+			const pid_t pid = fork();
+			BOOST_REQUIRE(pid >= 0);
+
+			if (pid == 0)
+			{
+				close(startPipe[1]);
+				close(resultPipe[0]);
+
+				int rc = 1;
+
+				try
+				{
+					const auto result = runLockWorkload(lockManagerId, config,
+						processNum, KEY_COUNT, ITERATION_COUNT, startPipe[0]);
+
+					if (write(resultPipe[1], &result, sizeof(result)) == sizeof(result))
+						rc = 0;
+				}
+				catch (...)
+				{
+				}
+
+				_exit(rc);
+			}
+
+			children.push_back(pid);
+		}
+
+		close(startPipe[0]);
+		close(resultPipe[1]);
+
+		// Let the children attach to the lock table before starting the clock
+		std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+		const auto start = std::chrono::steady_clock::now();
+		close(startPipe[1]);
+
+		unsigned lockSuccess = 0u;
+		FB_UINT64 acquires = 0u;
+		FB_UINT64 acquireBlocks = 0u;
+		ThroughputResult result;
+
+		while (read(resultPipe[0], &result, sizeof(result)) == sizeof(result))
+		{
+			lockSuccess += result.lockSuccess;
+
+			// Counters are kept in the shared lock table, the latest reader has seen them all
+			acquires = MAX(acquires, result.acquires);
+			acquireBlocks = MAX(acquireBlocks, result.acquireBlocks);
+		}
+
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		close(resultPipe[0]);
+
+		for (const auto pid : children)
+		{
+			int status = 0;
+			BOOST_REQUIRE(waitpid(pid, &status, 0) == pid);
+			BOOST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+		}
+
+		BOOST_CHECK_EQUAL(lockSuccess, processCount * ITERATION_COUNT);
+
+		BOOST_TEST_MESSAGE("Lock table, " << processCount << " processes: " <<
+			unsigned(lockSuccess / elapsed.count()) << " lock/unlock per second, " <<
+			acquireBlocks << " of " << acquires << " acquires blocked");
+	}
+}
+#endif
+
+
 BOOST_AUTO_TEST_SUITE_END()	// LockManagerTests
 BOOST_AUTO_TEST_SUITE_END()	// LockManagerSuite
 BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -1136,6 +1136,7 @@ static void disconnect(rem_port*, bool rmRef = true);
 static void enqueue_receive(rem_port*, t_rmtque_fn, Rdb*, void*, Rrq::rrq_repeat*);
 static void dequeue_receive(rem_port*);
 static THREAD_ENTRY_DECLARE event_thread(THREAD_ENTRY_PARAM);
+static USHORT fetch_window(rem_port*, Rsr*);
 static Rvnt* find_event(rem_port*, SLONG);
 static bool get_new_dpb(ClumpletWriter&, const ParametersSet&, bool);
 static void info(CheckStatusWrapper*, Rdb*, P_OP, USHORT, USHORT, USHORT,
@@ -5123,10 +5124,7 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 		if (statement->rsr_select_format)
 		{
 			if (operation == fetch_next || operation == fetch_prior)
-			{
-				sqldata->p_sqldata_messages = REMOTE_compute_batch_size(
-					port, 0, op_fetch_response, statement->rsr_select_format);
-			}
+				sqldata->p_sqldata_messages = fetch_window(port, statement);
 
 			// Reorder data when the local buffer is half empty
 
@@ -5222,6 +5220,7 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 	}
 
 	statement->rsr_msgs_waiting--;
+	statement->rsr_fetch_rows++;
 
 	message = statement->rsr_message;
 	statement->rsr_message = message->msg_next;
@@ -8274,6 +8273,25 @@ static void batch_dsql_fetch(rem_port*	port,
 			break;
 		}
 
+		// The first row of the last asked batch. When fetch is waiting for it,
+		// it arrives a round trip after the batch was asked.
+
+		if (statement->rsr_flags.test(Rsr::FETCH_RTT) && statement->rsr_batch_count == 1)
+		{
+			if (!statement->rsr_msgs_waiting && !clear_queue)
+			{
+				const SINT64 rtt = fb_utils::query_performance_counter() - statement->rsr_fetch_sent;
+
+				statement->rsr_fetch_rtt = statement->rsr_fetch_rtt ?
+					(statement->rsr_fetch_rtt * 3 + rtt) / 4 : rtt;
+
+				if (statement->rsr_fetch_rows)
+					statement->rsr_flags.set(Rsr::FETCH_STALL);
+			}
+
+			statement->rsr_flags.clear(Rsr::FETCH_RTT);
+		}
+
 		statement->rsr_msgs_waiting++;
 		statement->rsr_rows_pending--;
 
@@ -8651,6 +8669,67 @@ static THREAD_ENTRY_DECLARE event_thread(THREAD_ENTRY_PARAM arg)
 }
 
 
+static USHORT fetch_window(rem_port* port, Rsr* statement)
+{
+/**************************************
+ *
+ *	f e t c h _ w i n d o w
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compute the number of rows to ask for in the next
+ *	batch of FETCH NEXT or FETCH PRIOR. Unless FetchBatchBuffer
+ *	is set, it depends on the message size only. Otherwise the
+ *	batch grows or shrinks to cover the rows consumed by the
+ *	application during the round trip of the previous batch,
+ *	not exceeding the configured size.
+ *
+ **************************************/
+	const rem_fmt* const format = statement->rsr_select_format;
+	const USHORT messages = REMOTE_compute_batch_size(port, 0, op_fetch_response, format);
+
+	const ULONG budget = port->getPortConfig()->getFetchBatchBuffer();
+
+	if (!budget)
+		return messages;
+
+	const ULONG limit = MAX(MIN(budget / format->fmt_length, MAX_USHORT), MIN_ROWS_PER_BATCH);
+	const SINT64 now = fb_utils::query_performance_counter();
+
+	ULONG window = statement->rsr_fetch_window;
+
+	if (!window)
+		window = messages;
+	else if (statement->rsr_fetch_rtt && now > statement->rsr_fetch_sent)
+	{
+		// Next batch is asked when half of the rows are left, so the window should hold
+		// the rows consumed during two round trips, and twice as much to absorb the jitter
+
+		const double consumed = (double) statement->rsr_fetch_rows * statement->rsr_fetch_rtt /
+			(now - statement->rsr_fetch_sent);
+		const ULONG target = (ULONG) MIN(consumed * 4, (double) limit);
+
+		if (statement->rsr_flags.test(Rsr::FETCH_STALL))
+			window = MAX(window * 2, target);
+		else if (target > window)
+			window = MIN(window * 2, target);
+		else if (target < window / 4)
+			window /= 2;
+	}
+
+	window = MAX(MIN(window, limit), MIN_ROWS_PER_BATCH);
+
+	statement->rsr_fetch_window = (USHORT) window;
+	statement->rsr_fetch_rows = 0;
+	statement->rsr_fetch_sent = now;
+	statement->rsr_flags.set(Rsr::FETCH_RTT);
+	statement->rsr_flags.clear(Rsr::FETCH_STALL);
+
+	return statement->rsr_fetch_window;
+}
+
+
 static Rvnt* find_event( rem_port* port, SLONG id)
 {
 /*************************************
@@ -8852,7 +8931,7 @@ static void authReceiveResponse(bool havePacket, ClntAuthBlock& cBlock, rem_port
 				n->cstr_length, n->cstr_address, n->cstr_address ? n->cstr_address[0] : 0));
 			if (packet->p_acpd.p_acpt_type & pflag_compress)
 			{
-				port->initCompression();
+				port->initCompression(packet->p_acpd.p_acpt_type & pflag_compress_zstd);
 				port->port_flags |= PORT_compressed;
 			}
 			packet->p_acpd.p_acpt_type &= ptype_MASK;
@@ -95,6 +95,10 @@
 #include <sys/select.h>
 #endif
 
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
 #endif // !WIN_NT
 
 constexpr int INET_RETRY_CALL = 5;
@@ -389,6 +393,11 @@ public:
 #endif
 	}
 
+	void set(const rem_port* port)
+	{
+		set(port->port_handle);
+	}
+
 	void set(SOCKET handle)
 	{
 #ifdef HAVE_POLL
@@ -501,6 +510,355 @@ private:
 #endif
 };
 
+#ifdef HAVE_SYS_EPOLL_H
+
+// Multiplexer of the server ports based on epoll. Unlike the poll() based one,
+// ports are registered when they're accepted and unregistered when they're
+// disconnected, and only the ports reported by epoll_wait() are checked after
+// the wait, so the cost of the wakeup doesn't depend on the number of idle
+// connections.
+
+class EpollSelect
+{
+private:
+	static constexpr int MAX_EVENTS = 256;
+
+	struct Entry
+	{
+		SOCKET handle;
+		rem_port* port;		// referenced while registered
+		ULONG wait;			// number of the wait the port is registered before
+	};
+
+	struct Queued
+	{
+		SOCKET handle;
+		bool ready;			// has something to read
+	};
+
+	class EntryToHandle
+	{
+	public:
+		static SOCKET generate(const Entry& e) { return e.handle; };
+	};
+
+public:
+	explicit EpollSelect(MemoryPool& pool)
+		: slct_time(0), slct_count(0), slct_epoll(-1), slct_wait(0), slct_next(0),
+		  slct_entries(pool), slct_queue(pool), slct_failed(pool), slct_released(pool)
+	{ }
+
+	~EpollSelect()
+	{
+		for (auto& entry : slct_entries)
+			unref(entry.port);
+
+		releasePorts();
+
+		if (slct_epoll >= 0)
+			close(slct_epoll);
+	}
+
+	// Register the port to wait for. Assume port_mutex is locked.
+	void add(rem_port* port)
+	{
+		const SOCKET handle = port->port_handle;
+
+		if (handle == INVALID_SOCKET)
+			return;
+
+		FB_SIZE_T pos;
+		bool registered;
+
+		if (slct_entries.find(handle, pos))
+		{
+			// Socket was closed by force_close() and its descriptor is reused
+
+			Entry& entry = slct_entries[pos];
+			slct_released.add(entry.port);
+			entry.port = port;
+			entry.wait = slct_wait;
+
+			registered = control(EPOLL_CTL_ADD, handle) || (errno == EEXIST && control(EPOLL_CTL_MOD, handle));
+		}
+		else
+		{
+			slct_entries.insert(pos, Entry{handle, port, slct_wait});
+			registered = control(EPOLL_CTL_ADD, handle);
+		}
+
+		port->addRef();
+
+		// Port that can't be waited for is broken and returned as ready after the next wait,
+		// so its error is detected by read
+
+		if (!registered)
+		{
+			gds__log("INET/select_add: can't register socket %" HANDLEFORMAT ", errno = %d", handle, errno);
+			shutdown(handle, 2);
+			slct_failed.add(handle);
+		}
+	}
+
+	// Unregister the port. Assume port_mutex is locked.
+	void remove(rem_port* port)
+	{
+		FB_SIZE_T pos;
+
+		if (port->port_handle != INVALID_SOCKET)
+		{
+			if (!slct_entries.find(port->port_handle, pos) || slct_entries[pos].port != port)
+				return;
+		}
+		else
+		{
+			// Socket is closed already, it's removed from the epoll set by the kernel
+
+			for (pos = 0; pos < slct_entries.getCount(); pos++)
+			{
+				if (slct_entries[pos].port == port)
+					break;
+			}
+
+			if (pos == slct_entries.getCount())
+				return;
+		}
+
+		unregister(pos);
+	}
+
+	// Prepare the wait: register or unregister the listening port, expire keepalive
+	// timers and queue the ports needing the keepalive packet. Return false if there
+	// are no ports to wait for. Assume port_mutex is locked.
+	bool prepare(rem_port* main_port, bool listen, time_t delta)
+	{
+		clear();
+		releasePorts();
+
+		if (!listen || main_port->port_state != rem_port::PENDING)
+			remove(main_port);
+		else if (!isRegistered(main_port))
+			add(main_port);
+
+		slct_wait++;
+
+		// Ports broken without disconnect are not waited for. Only the leading ones
+		// are unregistered here, it's enough to know if there's something to wait for.
+
+		while (slct_entries.hasData() && slct_entries[0].port->port_state != rem_port::PENDING)
+			unregister(0);
+
+		while (slct_failed.hasData())
+		{
+			const SOCKET handle = slct_failed.pop();
+
+			FB_SIZE_T pos;
+			if (slct_entries.find(handle, pos))
+			{
+				slct_entries[pos].wait = 0;
+				slct_queue.add(Queued{handle, true});
+			}
+		}
+
+		// Keepalive timers are counted in seconds, so the ports are walked
+		// at most once per second rather than on every wakeup
+
+		if (delta)
+		{
+			for (auto& entry : slct_entries)
+			{
+				rem_port* const port = entry.port;
+
+				if (port->port_state == rem_port::PENDING && port->port_dummy_packet_interval)
+				{
+					port->port_dummy_timeout -= delta;
+
+					if (port->port_dummy_timeout < 0)
+						slct_queue.add(Queued{entry.handle, false});
+				}
+			}
+		}
+
+		return slct_entries.hasData();
+	}
+
+	void checkStart(RemPortPtr& /*port*/)
+	{
+		slct_next = 0;
+	}
+
+	// get port to check for readiness
+	// assume port_mutex is locked
+	Select::HandleState checkNext(RemPortPtr& port)
+	{
+#ifdef WIRE_COMPRESS_SUPPORT
+		if (slct_zport)
+		{
+			if (slct_zport->port_z_data &&
+				(slct_zport->port_state != rem_port::DISCONNECTED))
+			{
+				port = slct_zport;
+				slct_zport = nullptr;	// Will be set again by select_multi() if needed
+				return Select::SEL_READY;
+			}
+
+			slct_zport = nullptr;
+		}
+#endif
+
+		while (slct_next < slct_queue.getCount())
+		{
+			const Queued& queued = slct_queue[slct_next++];
+
+			// Skip the ports unregistered after the wait, and the ports registered
+			// after it began, as the event may belong to the former socket
+
+			FB_SIZE_T pos;
+			if (!slct_entries.find(queued.handle, pos) || slct_entries[pos].wait == slct_wait)
+				continue;
+
+			port = slct_entries[pos].port;
+
+			if (port->port_state == rem_port::DISCONNECTED)
+				return Select::SEL_DISCONNECTED;
+
+			if (port->port_state != rem_port::PENDING)
+			{
+				// Broken port is not waited for anymore
+				unregister(pos);
+				continue;
+			}
+
+#ifdef WIRE_COMPRESS_SUPPORT
+			if (port->port_z_data)
+				return Select::SEL_READY;
+#endif
+
+			if (port->port_handle == INVALID_SOCKET)
+				return port->port_flags & PORT_disconnect ? Select::SEL_DISCONNECTED : Select::SEL_BAD;
+
+			return queued.ready ? Select::SEL_READY : Select::SEL_NO_DATA;
+		}
+
+		port = nullptr;
+		return Select::SEL_NO_DATA;
+	}
+
+	void setZDataPort(RemPortPtr& port)
+	{
+#ifdef WIRE_COMPRESS_SUPPORT
+		slct_zport = port;
+#endif
+	}
+
+	void clear()
+	{
+		slct_count = 0;
+		slct_queue.clear();
+		slct_next = 0;
+#ifdef WIRE_COMPRESS_SUPPORT
+		slct_zport = nullptr;
+#endif
+	}
+
+	void select(timeval* timeout)
+	{
+		if (slct_epoll < 0)
+		{
+			slct_count = slct_queue.getCount();
+			return;
+		}
+
+		// Don't wait if some ports should be checked anyway
+
+		const int milliseconds = slct_queue.hasData() ? 0 :
+			timeout ? timeout->tv_sec * 1000 + timeout->tv_usec / 1000 : -1;
+
+		epoll_event events[MAX_EVENTS];
+		const int count = epoll_wait(slct_epoll, events, MAX_EVENTS, milliseconds);
+
+		if (count < 0)
+		{
+			slct_count = -1;
+			return;
+		}
+
+		for (int i = 0; i < count; i++)
+			slct_queue.add(Queued{events[i].data.fd, true});
+
+		slct_count = slct_queue.getCount();
+	}
+
+	int getCount() noexcept
+	{
+		return slct_count;
+	}
+
+	time_t	slct_time;
+
+private:
+	bool isRegistered(const rem_port* port) const
+	{
+		FB_SIZE_T pos;
+		return port->port_handle != INVALID_SOCKET &&
+			slct_entries.find(port->port_handle, pos) && slct_entries[pos].port == port;
+	}
+
+	bool control(int operation, SOCKET handle)
+	{
+		if (slct_epoll < 0)
+		{
+			slct_epoll = epoll_create1(EPOLL_CLOEXEC);
+			if (slct_epoll < 0)
+				return false;
+		}
+
+		// Level triggered, as the port is read by one packet at a time
+		epoll_event event {};
+		event.events = EPOLLIN;
+		event.data.fd = handle;
+
+		return epoll_ctl(slct_epoll, operation, handle, &event) == 0;
+	}
+
+	void unregister(FB_SIZE_T pos)
+	{
+		control(EPOLL_CTL_DEL, slct_entries[pos].handle);	// may be closed already
+
+		// The caller may hold the last reference, so release it later
+		slct_released.add(slct_entries[pos].port);
+		slct_entries.remove(pos);
+	}
+
+	void releasePorts()
+	{
+		while (slct_released.hasData())
+			unref(slct_released.pop());
+	}
+
+	static void unref(rem_port* port)
+	{
+		RemPortPtr ref(REF_NO_INCR, port);
+	}
+
+	int		slct_count;
+	int		slct_epoll;
+	ULONG	slct_wait;			// number of the current wait
+	FB_SIZE_T slct_next;		// next queued port to check
+	SortedArray<Entry, EmptyStorage<Entry>, SOCKET, EntryToHandle> slct_entries;
+	Array<Queued> slct_queue;	// ports to check after the wait
+	Array<SOCKET> slct_failed;	// ports failed to register
+	Array<rem_port*> slct_released;	// ports unregistered but still referenced
+#ifdef WIRE_COMPRESS_SUPPORT
+	RemPortPtr slct_zport;	// port with some compressed data remaining in the buffer
+#endif
+};
+
+typedef EpollSelect PortSelect;
+#else
+typedef Select PortSelect;
+#endif // HAVE_SYS_EPOLL_H
+
 static bool		accept_connection(rem_port*, const P_CNCT*);
 #ifdef HAVE_SETITIMER
 static void		alarm_handler(int);
@@ -564,10 +922,11 @@ static bool		packet_receive2(rem_port*, UCHAR*, SSHORT, SSHORT*);
 static bool		packet_send(rem_port*, const SCHAR*, SSHORT);
 static rem_port*		receive(rem_port*, PACKET *);
 static rem_port*		select_accept(rem_port*);
+static void		select_add(rem_port*);
 
-static void		select_port(rem_port*, Select*, RemPortPtr&);
+static void		select_port(rem_port*, PortSelect*, RemPortPtr&);
 static bool		select_multi(rem_port*, UCHAR* buffer, SSHORT bufsize, SSHORT* length, RemPortPtr&);
-static bool		select_wait(rem_port*, Select*);
+static bool		select_wait(rem_port*, PortSelect*);
 static int		send_full(rem_port*, PACKET *);
 static int		send_partial(rem_port*, PACKET *);
 
@@ -616,7 +975,7 @@ ULONG INET_remote_buffer;
 static GlobalPtr<Mutex> init_mutex;
 static volatile bool INET_initialized = false;
 static volatile bool INET_shutting_down = false;
-static GlobalPtr<Select> INET_select;
+static GlobalPtr<PortSelect> INET_select;
 static rem_port* inet_async_receive = NULL;
 
 
@@ -697,6 +1056,9 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 	// Should compression be tried?
 
 	const bool compression = config && (*config)->getWireCompression();
+	const bool offerZstd = compression &&
+		NoCaseString((*config)->getWireCompressionType()) == WireCompressionZstd &&
+		rem_port::checkCompression(true);
 
 	// Establish connection to server
 	// If we want user verification, we can't speak anything less than version 7
@@ -730,6 +1092,9 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 			rem_port::checkCompression())
 		{
 			cnct->p_cnct_versions[i].p_cnct_max_type |= pflag_compress;
+
+			if (offerZstd)
+				cnct->p_cnct_versions[i].p_cnct_max_type |= pflag_compress_zstd;
 		}
 	}
 
@@ -842,6 +1207,7 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 	}
 
 	const bool compress = accept->p_acpt_type & pflag_compress;
+	const bool zstd = accept->p_acpt_type & pflag_compress_zstd;
 	accept->p_acpt_type &= ptype_MASK;
 
 	if (accept->p_acpt_type != ptype_out_of_band) {
@@ -854,7 +1220,7 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 
 	if (compress)
 	{
-		port->initCompression();
+		port->initCompression(zstd);
 		port->port_flags |= PORT_compressed;
 	}
 
@@ -1535,6 +1901,7 @@ static rem_port* aux_connect(rem_port* port, PACKET* packet)
 		port->port_flags |= PORT_async;
 
 		get_peer_info(port);
+		select_add(port);
 
 		return port;
 	}
@@ -1785,6 +2152,10 @@ static void disconnect(rem_port* port)
 	// also select_wait() function.
 	const bool delayClose = (port->port_server_flags && port->port_parent);
 
+#ifdef HAVE_SYS_EPOLL_H
+	INET_select->remove(port);
+#endif
+
 	// If this is a sub-port, unlink it from its parent
 	port->unlinkParent();
 
@@ -2184,10 +2555,37 @@ static rem_port* select_accept( rem_port* main_port)
 		return port;
 	}
 
+	select_add(port);
+
 	return 0;
 }
 
-static void select_port(rem_port* main_port, Select* selct, RemPortPtr& port)
+
+static void select_add(rem_port* port)
+{
+/**************************************
+ *
+ *	s e l e c t _ a d d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Register the connected port of the multi-client
+ *	server to be waited for by select_wait.
+ *
+ **************************************/
+#ifdef HAVE_SYS_EPOLL_H
+	if (port->port_parent && (port->port_parent->port_server_flags & SRVR_multi_client))
+	{
+		MutexLockGuard guard(port_mutex, FB_FUNCTION);
+
+		if (port->port_state == rem_port::PENDING)
+			INET_select->add(port);
+	}
+#endif
+}
+
+static void select_port(rem_port* main_port, PortSelect* selct, RemPortPtr& port)
 {
 /**************************************
  *
@@ -2237,7 +2635,7 @@ static void select_port(rem_port* main_port, Select* selct, RemPortPtr& port)
 	}
 }
 
-static bool select_wait( rem_port* main_port, Select* selct)
+static bool select_wait( rem_port* main_port, PortSelect* selct)
 {
 /**************************************
  *
@@ -2251,7 +2649,9 @@ static bool select_wait( rem_port* main_port, Select* selct)
  *	to read from them.
  *
  **************************************/
+#ifndef HAVE_SYS_EPOLL_H
 	bool checkPorts = false;
+#endif
 
 	for (;;)
 	{
@@ -2282,6 +2682,11 @@ static bool select_wait( rem_port* main_port, Select* selct)
 				SOCLOSE(s);
 			}
 
+#ifdef HAVE_SYS_EPOLL_H
+			// Ports are registered when connected, so they're not walked here
+			// if process is shuting down - don't listen on main port
+			found = selct->prepare(main_port, !INET_shutting_down, delta_time);
+#else
 			for (rem_port* port = main_port; port; port = port->port_next)
 			{
 				if (port->port_state == rem_port::PENDING &&
@@ -2322,7 +2727,7 @@ static bool select_wait( rem_port* main_port, Select* selct)
 								selct->clear();
 								if (!badSocket)
 								{
-									selct->set(port->port_handle);
+									selct->set(port);
 								}
 								return true;
 							}
@@ -2332,12 +2737,13 @@ static bool select_wait( rem_port* main_port, Select* selct)
 					// if process is shuting down - don't listen on main port
 					if (!INET_shutting_down || port != main_port)
 					{
-						selct->set(port->port_handle);
+						selct->set(port);
 						found = true;
 					}
 				}
 			}
 			checkPorts = false;
+#endif
 		} // port_mutex scope
 
 		if (!found)
@@ -2379,6 +2785,7 @@ static bool select_wait( rem_port* main_port, Select* selct)
 				// bit as this value is undefined on some platforms (eg. HP-UX),
 				// when the select call times out. Once these bits are cleared
 				// they can be used in select_port()
+#ifndef HAVE_SYS_EPOLL_H
 				if (selct->getCount() == 0)
 				{
 					MutexLockGuard guard(port_mutex, FB_FUNCTION);
@@ -2387,15 +2794,18 @@ static bool select_wait( rem_port* main_port, Select* selct)
 						selct->unset(port->port_handle);
 					}
 				}
+#endif
 				return true;
 			}
 			if (INTERRUPT_ERROR(inetErrNo))
 				continue;
+#ifndef HAVE_SYS_EPOLL_H
 			if (inetErrNo == NOTASOCKET)
 			{
 				checkPorts = true;
 				break;
 			}
+#endif
 
 			gds__log("INET/select_wait: select failed, errno = %d", inetErrNo);
 			return false;
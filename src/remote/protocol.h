@@ -154,6 +154,7 @@ inline constexpr USHORT ptype_MASK			= 0xFF;	// Mask - up to 255 types of protoc
 // upper byte is used for protocol flags
 inline constexpr USHORT pflag_compress		= 0x100;	// Turn on compression if possible
 inline constexpr USHORT pflag_win_sspi_nego	= 0x200;	// Win_SSPI supports Negotiate security package
+inline constexpr USHORT pflag_compress_zstd	= 0x400;	// Compress by Zstandard rather than zlib
 
 // Generic object id
 
@@ -563,6 +563,8 @@ void REMOTE_reset_statement(Rsr* statement) noexcept
 	statement->rsr_msgs_waiting = 0;
 	statement->rsr_reorder_level = 0;
 	statement->rsr_batch_count = 0;
+	statement->rsr_fetch_rows = 0;
+	statement->rsr_flags.clear(Rsr::FETCH_RTT | Rsr::FETCH_STALL);
 
 	// only one entry
 
@@ -1531,6 +1533,7 @@ void rem_port::versionInfo(string& version) const
 
 #ifdef WIRE_COMPRESS_SUPPORT
 static InitInstance<ZLib> zlib;
+static InitInstance<ZStd> zstd;
 #endif // WIRE_COMPRESS_SUPPORT
 
 rem_port::~rem_port()
@@ -1560,7 +1563,12 @@ rem_port::~rem_port()
 #endif
 
 #ifdef WIRE_COMPRESS_SUPPORT
-	if (port_compressed)
+	if (port_zstd_send)
+	{
+		zstd().freeCCtx(port_zstd_send);
+		zstd().freeDCtx(port_zstd_recv);
+	}
+	else if (port_compressed)
 	{
 		zlib().deflateEnd(&port_send_stream);
 		zlib().inflateEnd(&port_recv_stream);
@@ -1568,6 +1576,99 @@ rem_port::~rem_port()
 #endif
 }
 
+#ifdef WIRE_COMPRESS_SUPPORT
+static bool zstdInflate(rem_port* port, PacketReceive* packet_receive, UCHAR* buffer,
+	SSHORT buffer_length, SSHORT* length)
+{
+	ZStd::InBuffer& in = port->port_zstd_in;
+	ZStd::OutBuffer out = {buffer, (size_t) buffer_length, 0};
+
+	for (;;)
+	{
+		// Decompressor may hold some output even if all input is consumed
+
+		if (in.pos < in.size || port->port_z_data)
+		{
+			const size_t ret = zstd().decompressStream(port->port_zstd_recv, &out, &in);
+
+			if (zstd().isError(ret))
+			{
+				port->port_z_data = false;
+				return false;
+			}
+
+			if (out.pos)
+				break;
+
+			if (port->port_z_data)		// Was called from select_multi() but nothing decompressed
+			{
+				port->port_z_data = false;
+				return false;
+			}
+		}
+
+		UCHAR* compressed = &port->port_compressed[REM_RECV_OFFSET(port->port_buff_size)];
+		const size_t rest = in.size - in.pos;
+
+		if (rest && in.src != compressed + in.pos)
+			memmove(compressed, static_cast<const UCHAR*>(in.src) + in.pos, rest);
+
+		in.src = compressed;
+		in.size = rest;
+		in.pos = 0;
+
+		SSHORT l = (SSHORT) (port->port_buff_size - rest);
+		if ((!packet_receive(port, compressed + rest, l, &l)) || (l <= 0))
+		{
+			port->port_z_data = false;
+			return false;
+		}
+
+		in.size += l;
+	}
+
+	*length = (SSHORT) out.pos;
+	port->port_z_data = (in.pos < in.size || out.pos == out.size);
+
+	port->bumpLogBytes(rem_port::RECEIVE, *length);
+	return true;
+}
+
+static bool zstdDeflate(RemoteXdr* xdrs, PacketSend* packet_send, bool flush)
+{
+	rem_port* port = xdrs->x_public;
+	ZStd::InBuffer in = {xdrs->x_base, (size_t) (xdrs->x_private - xdrs->x_base), 0};
+	ZStd::OutBuffer& out = port->port_zstd_out;
+
+	bool expectMoreOut = flush;
+
+	while (in.pos < in.size || expectMoreOut)
+	{
+		const size_t ret = zstd().compressStream2(port->port_zstd_send, &out, &in,
+			flush ? ZStd::FLUSH : ZStd::CONTINUE);
+
+		if (zstd().isError(ret))
+			return false;
+
+		// When flushing, non-zero means there is more compressed data to get
+		expectMoreOut = flush && ret;
+
+		if (out.pos && (flush || out.pos == out.size))
+		{
+			if (!packet_send(port, static_cast<SCHAR*>(out.dst), (SSHORT) out.pos))
+				return false;
+
+			out.pos = 0;
+		}
+	}
+
+	xdrs->x_private = xdrs->x_base;
+	xdrs->x_handy = port->port_buff_size;
+
+	return true;
+}
+#endif // WIRE_COMPRESS_SUPPORT
+
 bool REMOTE_inflate(rem_port* port, PacketReceive* packet_receive, UCHAR* buffer,
 	SSHORT buffer_length, SSHORT* length)
 {
@@ -1580,6 +1681,9 @@ bool REMOTE_inflate(rem_port* port, PacketReceive* packet_receive, UCHAR* buffer
 		return ret;
 	}
 
+	if (port->port_zstd_recv)
+		return zstdInflate(port, packet_receive, buffer, buffer_length, length);
+
 	z_stream& strm = port->port_recv_stream;
 	strm.avail_out = buffer_length;
 	strm.next_out = buffer;
@@ -1669,6 +1773,9 @@ bool REMOTE_deflate(RemoteXdr* xdrs, ProtoWrite* proto_write, PacketSend* packet
 	if (!(port->port_compressed && (port->port_flags & PORT_compressed)))
 		return proto_write(xdrs);
 
+	if (port->port_zstd_send)
+		return zstdDeflate(xdrs, packet_send, flush);
+
 	z_stream& strm = port->port_send_stream;
 	strm.avail_in = xdrs->x_private - xdrs->x_base;
 	strm.next_in = (Bytef*) xdrs->x_base;
@@ -1736,24 +1843,58 @@ bool REMOTE_deflate(RemoteXdr* xdrs, ProtoWrite* proto_write, PacketSend* packet
 #endif
 }
 
-bool rem_port::checkCompression()
+bool rem_port::checkCompression(bool useZstd)
 {
 #ifdef WIRE_COMPRESS_SUPPORT
-	return zlib();
+	return useZstd ? zstd() : zlib();
 #else
 	return false;
 #endif
 }
 
-void rem_port::initCompression()
+void rem_port::initCompression(bool useZstd)
 {
 #ifdef WIRE_COMPRESS_SUPPORT
-	if (port_protocol >= PROTOCOL_VERSION13 && !port_compressed && zlib())
+	const int level = getPortConfig()->getWireCompressionLevel();
+
+	if (useZstd && port_protocol >= PROTOCOL_VERSION13 && !port_compressed && zstd())
+	{
+		port_compressed.reset(FB_NEW_POOL(getPool()) UCHAR[port_buff_size * 2]);
+		memset(port_compressed, 0, port_buff_size * 2);
+
+		port_zstd_send = zstd().createCCtx();
+		port_zstd_recv = zstd().createDCtx();
+
+		if (!port_zstd_send || !port_zstd_recv ||
+			(level && zstd().isError(zstd().CCtx_setParameter(port_zstd_send, ZStd::COMPRESSION_LEVEL, level))))
+		{
+			if (port_zstd_send)
+				zstd().freeCCtx(port_zstd_send);
+			if (port_zstd_recv)
+				zstd().freeDCtx(port_zstd_recv);
+
+			port_zstd_send = nullptr;
+			port_zstd_recv = nullptr;
+			port_compressed.reset();
+
+			(Arg::Gds(isc_deflate_init) << Arg::Num(0)).raise();
+		}
+
+		port_zstd_out.dst = &port_compressed[REM_SEND_OFFSET(port_buff_size)];
+		port_zstd_out.size = port_buff_size;
+		port_zstd_out.pos = 0;
+
+		port_zstd_in.src = &port_compressed[REM_RECV_OFFSET(port_buff_size)];
+		port_zstd_in.size = 0;
+		port_zstd_in.pos = 0;
+	}
+	else if (port_protocol >= PROTOCOL_VERSION13 && !port_compressed && zlib())
 	{
 		port_send_stream.zalloc = ZLib::allocFunc;
 		port_send_stream.zfree = ZLib::freeFunc;
 		port_send_stream.opaque = Z_NULL;
-		int ret = zlib().deflateInit(&port_send_stream, Z_DEFAULT_COMPRESSION);
+		int ret = zlib().deflateInit(&port_send_stream,
+			(level > 0 && level <= Z_BEST_COMPRESSION) ? level : Z_DEFAULT_COMPRESSION);
 		if (ret != Z_OK)
 			(Arg::Gds(isc_deflate_init) << Arg::Num(ret)).raise();
 		port_send_stream.next_out = NULL;
@@ -705,6 +705,11 @@ struct Rsr : public Firebird::GlobalStorage, public TypedHandle<rem_type_rsr>
 	SLONG			rsr_fetch_position;		// and position
 	unsigned int	rsr_inline_blob_size;	// max size of blob that can be transferred inline
 
+	USHORT			rsr_fetch_window;		// Rows asked in the last adaptive batch
+	ULONG			rsr_fetch_rows;			// Rows returned since the last batch was asked
+	SINT64			rsr_fetch_sent;			// When the last batch was asked
+	SINT64			rsr_fetch_rtt;			// Time till the first row of the batch arrives
+
 	struct BatchStream
 	{
 		BatchStream()
@@ -743,7 +748,9 @@ public:
 		DEFER_EXECUTE = 32,	// op_execute can be deferred
 		PAST_EOF = 64,		// EOF was returned by fetch from this statement
 		BOF_SET = 128,		// Beginning-of-stream
-		PAST_BOF = 256		// BOF was returned by fetch from this statement
+		PAST_BOF = 256,		// BOF was returned by fetch from this statement
+		FETCH_RTT = 512,	// Round trip of the last batch is not measured yet
+		FETCH_STALL = 1024	// Fetch had to wait for the rows of the batch
 	};
 
 	static constexpr auto STREAM_END = (BOF_SET | EOF_SET);
@@ -758,7 +765,8 @@ public:
 		rsr_rows_pending(0), rsr_msgs_waiting(0), rsr_reorder_level(0), rsr_batch_count(0),
 		rsr_cursor_name(getPool()), rsr_delayed_format(false), rsr_timeout(0), rsr_self(NULL),
 		rsr_batch_size(0), rsr_batch_flags(0), rsr_batch_ics(NULL),
-		rsr_fetch_operation(fetch_next), rsr_fetch_position(0), rsr_inline_blob_size(0)
+		rsr_fetch_operation(fetch_next), rsr_fetch_position(0), rsr_inline_blob_size(0),
+		rsr_fetch_window(0), rsr_fetch_rows(0), rsr_fetch_sent(0), rsr_fetch_rtt(0)
 	{ }
 
 	~Rsr()
@@ -1489,6 +1497,10 @@ public:
 
 #ifdef WIRE_COMPRESS_SUPPORT
 	z_stream port_send_stream, port_recv_stream;
+	Firebird::ZStd::CCtx* port_zstd_send = nullptr;	// set when zstd is used instead of zlib
+	Firebird::ZStd::DCtx* port_zstd_recv = nullptr;
+	Firebird::ZStd::OutBuffer port_zstd_out = {};		// pending compressed data to send
+	Firebird::ZStd::InBuffer port_zstd_in = {};		// received data to decompress
 	UCharArrayAutoPtr	port_compressed;
 #endif
 
@@ -1549,8 +1561,8 @@ private:
 	friend class Firebird::RefPtr<rem_port>;
 
 public:
-	void initCompression();
-	static bool checkCompression();
+	void initCompression(bool zstd);
+	static bool checkCompression(bool zstd = false);
 	void linkParent(rem_port* const parent);
 	void unlinkParent() noexcept;
 	Firebird::RefPtr<const Firebird::Config> getPortConfig();
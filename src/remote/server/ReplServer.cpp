@@ -32,6 +32,9 @@
 #include "../common/os/path_utils.h"
 #include "../common/isc_proto.h"
 #include "../common/classes/ClumpletWriter.h"
+#include "../common/classes/condition.h"
+#include "../common/classes/GenericMap.h"
+#include "../common/classes/objects_array.h"
 #include "../common/ThreadStart.h"
 #include "../common/utils_proto.h"
 #include "../common/classes/ParsedList.h"
@@ -46,6 +49,7 @@
 #include <sys/stat.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <time.h>
 
 #ifdef HAVE_SYS_FILE_H
 #include <sys/file.h>
@@ -336,6 +340,786 @@ namespace
 #endif
 	};
 
+	// Walks the replication block to find the tables and sequences it changes, as required
+	// to apply it in parallel with other blocks. Returns false if the block has to be applied
+	// exclusively: it contains DDL or cannot be parsed (then the replica reports the error).
+	// The offset of the trailing commit operation, if any, is returned in commitOffset.
+
+	class BlockScanner
+	{
+	public:
+		BlockScanner(MemoryPool& pool, ULONG length, const UCHAR* data)
+			: m_header((const Block*) data),
+			  m_start(data),
+			  m_data(data + sizeof(Block)),
+			  m_end(data + length),
+			  m_atoms(pool)
+		{}
+
+		bool scan(SortedObjectsArray<string>& resources, ULONG& commitOffset)
+		{
+			commitOffset = 0;
+
+			if (m_header->protocol != PROTOCOL_CURRENT_VERSION ||
+				m_data + m_header->length != m_end)
+			{
+				return false;
+			}
+
+			try
+			{
+				while (m_data < m_end)
+				{
+					const ULONG offset = (ULONG) (m_data - m_start);
+					const auto op = getByte();
+
+					commitOffset = 0;
+
+					switch (op)
+					{
+					case opStartTransaction:
+					case opPrepareTransaction:
+					case opRollbackTransaction:
+					case opCleanupTransaction:
+					case opStartSavepoint:
+					case opReleaseSavepoint:
+					case opRollbackSavepoint:
+						break;
+
+					case opCommitTransaction:
+						commitOffset = offset;
+						break;
+
+					case opInsertRecord:
+					case opDeleteRecord:
+						addResource(resources, "T");
+						getBinary(getInt32());
+						break;
+
+					case opUpdateRecord:
+						addResource(resources, "T");
+						getBinary(getInt32());
+						getBinary(getInt32());
+						break;
+
+					case opStoreBlob:
+						getInt32();
+						getInt32();
+						do {
+							const ULONG length = (USHORT) getInt16();
+							if (!length)
+								break;
+							getBinary(length);
+						} while (m_data < m_end);
+						break;
+
+					case opSetSequence:
+						addResource(resources, "S");
+						getBinary(sizeof(SINT64));
+						break;
+
+					case opDefineAtom:
+						{
+							const auto length = getByte();
+							const auto ptr = getBinary(length);
+							m_atoms.add(string((const char*) ptr, length));
+						}
+						break;
+
+					default:
+						return false;
+					}
+				}
+			}
+			catch (const Exception&)
+			{
+				return false;
+			}
+
+			return true;
+		}
+
+	private:
+		const Block* const m_header;
+		const UCHAR* const m_start;
+		const UCHAR* m_data;
+		const UCHAR* const m_end;
+		ObjectsArray<string> m_atoms;
+
+		UCHAR getByte()
+		{
+			return *getBinary(sizeof(UCHAR));
+		}
+
+		SSHORT getInt16()
+		{
+			SSHORT value;
+			memcpy(&value, getBinary(sizeof(SSHORT)), sizeof(SSHORT));
+			return value;
+		}
+
+		SLONG getInt32()
+		{
+			SLONG value;
+			memcpy(&value, getBinary(sizeof(SLONG)), sizeof(SLONG));
+			return value;
+		}
+
+		const UCHAR* getBinary(ULONG length)
+		{
+			if ((ULONG) (m_end - m_data) < length)
+				raiseError("Replication block is malformed");
+
+			const auto ptr = m_data;
+			m_data += length;
+			return ptr;
+		}
+
+		const string& getAtom()
+		{
+			const auto pos = getInt32();
+
+			if (pos < 0 || pos >= (SLONG) m_atoms.getCount())
+				raiseError("Replication block is malformed");
+
+			return m_atoms[pos];
+		}
+
+		void addResource(SortedObjectsArray<string>& resources, const char* type)
+		{
+			string name(type);
+			name += ':';
+			name += getAtom();	// schema
+			name += '.';
+			name += getAtom();	// object
+
+			if (!resources.exist(name))
+				resources.add(name);
+		}
+	};
+
+	// Applies the replication blocks using multiple attachments (workers) to the replica.
+	//
+	// Every transaction is applied by the worker assigned to it when its first block is
+	// dispatched. Blocks changing the same tables or sequences as some transaction did before
+	// are applied after the preceding blocks of that transaction, and commits are applied
+	// in the journal order, so the replica never shows a state that did not exist on the
+	// primary. Tables linked by foreign keys are treated as changed together, so a parent
+	// row is never deleted (or a child row stored) before the preceding changes of the
+	// linked table are applied. Blocks that cannot be tracked this way, i.e. DDL and cleanup
+	// of all transactions, are applied when all workers are idle.
+
+	class ParallelApplier : public GlobalStorage
+	{
+		static constexpr FB_SIZE_T MAX_QUEUE_DEPTH = 64;	// blocks per worker
+
+		struct Job
+		{
+			explicit Job(MemoryPool& pool)
+				: data(pool), waitFor(pool)
+			{}
+
+			FB_UINT64 ticket = 0;
+			FB_UINT64 sequence = 0;
+			ULONG offset = 0;
+			Array<UCHAR> data;
+			// tickets to be applied by other workers before this job
+			HalfStaticArray<FB_UINT64, 16> waitFor;
+		};
+
+		struct Access
+		{
+			unsigned worker = 0;
+			FB_UINT64 ticket = 0;
+		};
+
+		struct Transaction
+		{
+			explicit Transaction(MemoryPool& pool)
+				: resources(pool)
+			{}
+
+			unsigned worker = 0;
+			SortedObjectsArray<string> resources;
+		};
+
+		typedef GenericMap<Pair<NonPooled<TraNumber, Transaction*> > > TransactionMap;
+		typedef GenericMap<Pair<Left<string, Access> > > ResourceMap;
+		typedef GenericMap<Pair<Left<string, SortedObjectsArray<string>*> > > LinkMap;
+
+	public:
+		struct Worker
+		{
+			explicit Worker(MemoryPool& pool)
+				: queue(pool)
+			{}
+
+			ParallelApplier* applier = nullptr;
+			IAttachment* attachment = nullptr;
+			IReplicator* replicator = nullptr;
+			Thread thread;
+			Array<Job*> queue;
+			FB_UINT64 doneTicket = 0;
+		};
+
+		ParallelApplier(IAttachment* metadata, ULONG maxBlockLength)
+			: m_workers(getPool()), m_transactions(getPool()), m_resources(getPool()),
+			  m_links(getPool()), m_exclusive(getPool()), m_metadata(metadata),
+			  m_maxBlockLength(maxBlockLength)
+		{}
+
+		~ParallelApplier()
+		{
+			{	// scope
+				MutexLockGuard guard(m_mutex, FB_FUNCTION);
+				m_stop = true;
+				m_condition.notifyAll();
+			}
+
+			for (const auto worker : m_workers)
+				worker->thread.waitForCompletion();
+
+			FbLocalStatus localStatus;
+
+			for (const auto worker : m_workers)
+			{
+				if (worker->replicator)
+					worker->replicator->close(&localStatus);
+
+				if (worker->attachment)
+					worker->attachment->detach(&localStatus);
+
+				while (worker->queue.hasData())
+					delete worker->queue.pop();
+
+				delete worker;
+			}
+
+			forgetTransactions();
+			forgetLinks();
+		}
+
+		Worker* addWorker()
+		{
+			const auto worker = FB_NEW_POOL(getPool()) Worker(getPool());
+			worker->applier = this;
+			m_workers.add(worker);
+			return worker;
+		}
+
+		void start()
+		{
+			for (const auto worker : m_workers)
+				Thread::start(applyThread, worker, THREAD_medium, &worker->thread);
+		}
+
+		unsigned getWorkerCount() const
+		{
+			return m_workers.getCount();
+		}
+
+		void dispatch(FB_UINT64 sequence, ULONG offset, ULONG length, const UCHAR* data);
+
+		void drain()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			while (!isIdleLocked())
+				m_condition.wait(m_mutex);
+
+			// Everything dispatched is applied, so nothing to wait for anymore
+			m_resources.clear();
+			m_lastCommit = Access();
+		}
+
+		bool isIdle()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			return isIdleLocked();
+		}
+
+		bool getError(FB_UINT64& sequence, ULONG& offset, Arg::StatusVector& error)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			if (!m_failed)
+				return false;
+
+			sequence = m_errorSequence;
+			offset = m_errorOffset;
+			error.assign(m_error);
+			return true;
+		}
+
+		// Maximum count of the queued blocks since the previous call
+		unsigned resetMaxQueueDepth()
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			const auto depth = m_maxQueueDepth;
+			m_maxQueueDepth = 0;
+			return depth;
+		}
+
+	private:
+		Array<Worker*> m_workers;
+		TransactionMap m_transactions;
+		ResourceMap m_resources;
+		LinkMap m_links;
+		bool m_linksLoaded = false;
+		Access m_lastCommit;
+		SortedArray<TraNumber> m_exclusive;
+		IAttachment* const m_metadata;
+		const ULONG m_maxBlockLength;
+		unsigned m_nextWorker = 0;
+		FB_UINT64 m_lastTicket = 0;
+		unsigned m_maxQueueDepth = 0;
+		Mutex m_mutex;
+		Condition m_condition;
+		bool m_stop = false;
+		bool m_failed = false;
+		Arg::StatusVector m_error;
+		FB_UINT64 m_errorSequence = 0;
+		ULONG m_errorOffset = 0;
+
+		static THREAD_ENTRY_DECLARE applyThread(THREAD_ENTRY_PARAM arg)
+		{
+			const auto worker = static_cast<Worker*>(arg);
+			worker->applier->apply(worker);
+			return 0;
+		}
+
+		void apply(Worker* worker);
+
+		bool isIdleLocked() const
+		{
+			for (const auto worker : m_workers)
+			{
+				if (worker->queue.hasData())
+					return false;
+			}
+
+			return true;
+		}
+
+		bool isReady(const Job* job) const
+		{
+			if (m_failed)
+				return true;
+
+			for (FB_SIZE_T i = 0; i < job->waitFor.getCount(); i++)
+			{
+				if (m_workers[i]->doneTicket < job->waitFor[i])
+					return false;
+			}
+
+			return true;
+		}
+
+		Job* makeJob(FB_UINT64 sequence, ULONG offset)
+		{
+			const auto job = FB_NEW_POOL(getPool()) Job(getPool());
+			job->sequence = sequence;
+			job->offset = offset;
+			job->waitFor.resize(m_workers.getCount());
+			memset(job->waitFor.begin(), 0, job->waitFor.getCount() * sizeof(FB_UINT64));
+			return job;
+		}
+
+		void addDependency(Job* job, unsigned worker, const Access& access)
+		{
+			if (access.ticket && access.worker != worker)
+				job->waitFor[access.worker] = MAX(job->waitFor[access.worker], access.ticket);
+		}
+
+		void enqueue(unsigned number, Job* job)
+		{
+			const auto worker = m_workers[number];
+
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			while (!m_failed && worker->queue.getCount() >= MAX_QUEUE_DEPTH)
+				m_condition.wait(m_mutex);
+
+			if (m_failed)
+			{
+				// Nothing is applied after error, it will be reported by the caller
+				delete job;
+				return;
+			}
+
+			job->ticket = ++m_lastTicket;
+			worker->queue.add(job);
+
+			unsigned depth = 0;
+			for (const auto w : m_workers)
+				depth += w->queue.getCount();
+
+			m_maxQueueDepth = MAX(m_maxQueueDepth, depth);
+
+			m_condition.notifyAll();
+		}
+
+		Transaction* getTransaction(TraNumber traNumber)
+		{
+			if (const auto transaction = m_transactions.get(traNumber))
+				return *transaction;
+
+			// Assign the new transaction to the least loaded worker
+
+			unsigned number = m_nextWorker;
+
+			{	// scope
+				MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+				for (unsigned i = 1; i < m_workers.getCount(); i++)
+				{
+					const auto next = (m_nextWorker + i) % m_workers.getCount();
+
+					if (m_workers[next]->queue.getCount() < m_workers[number]->queue.getCount())
+						number = next;
+				}
+			}
+
+			m_nextWorker = (number + 1) % m_workers.getCount();
+
+			const auto transaction = FB_NEW_POOL(getPool()) Transaction(getPool());
+			transaction->worker = number;
+			m_transactions.put(traNumber, transaction);
+
+			return transaction;
+		}
+
+		void addResources(Transaction* transaction, const SortedObjectsArray<string>& resources)
+		{
+			for (const auto& resource : resources)
+			{
+				if (!transaction->resources.exist(resource))
+					transaction->resources.add(resource);
+			}
+		}
+
+		void forgetTransaction(TraNumber traNumber)
+		{
+			Transaction* transaction = nullptr;
+			if (m_transactions.get(traNumber, transaction))
+			{
+				m_transactions.remove(traNumber);
+				delete transaction;
+			}
+		}
+
+		void forgetTransactions()
+		{
+			for (auto& item : m_transactions)
+				delete item.second;
+
+			m_transactions.clear();
+		}
+
+		void loadLinks();
+		void addLinks(SortedObjectsArray<string>& resources);
+
+		void forgetLinks()
+		{
+			for (auto& item : m_links)
+				delete item.second;
+
+			m_links.clear();
+			m_linksLoaded = false;
+		}
+	};
+
+	// Read the foreign keys of the replica, every table is linked to the tables
+	// it references and the tables referencing it
+
+	void ParallelApplier::loadLinks()
+	{
+		forgetLinks();
+
+		const char* sql =
+			"select trim(trailing from fk.rdb$schema_name), trim(trailing from fk.rdb$relation_name),\n"
+			"       trim(trailing from pk.rdb$schema_name), trim(trailing from pk.rdb$relation_name)\n"
+			"  from system.rdb$ref_constraints ref\n"
+			"  join system.rdb$relation_constraints fk\n"
+			"    on fk.rdb$schema_name = ref.rdb$schema_name and\n"
+			"       fk.rdb$constraint_name = ref.rdb$constraint_name\n"
+			"  join system.rdb$relation_constraints pk\n"
+			"    on pk.rdb$schema_name = ref.rdb$const_schema_name_uq and\n"
+			"       pk.rdb$constraint_name = ref.rdb$const_name_uq";
+
+		FbLocalStatus localStatus;
+
+		RefPtr<ITransaction> transaction(REF_NO_INCR,
+			m_metadata->startTransaction(&localStatus, 0, NULL));
+		localStatus.check();
+
+		FB_MESSAGE(Result, CheckStatusWrapper,
+			(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), fkSchema)
+			(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), fkTable)
+			(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), pkSchema)
+			(FB_VARCHAR(MAX_SQL_IDENTIFIER_LEN), pkTable)
+		) result(&localStatus, fb_get_master_interface());
+
+		RefPtr<IResultSet> cursor(REF_NO_INCR,
+			m_metadata->openCursor(&localStatus, transaction, 0, sql, SQL_DIALECT_V6,
+								   NULL, NULL, result.getMetadata(), NULL, 0));
+		localStatus.check();
+
+		const auto link = [this](const string& from, const string& to)
+		{
+			SortedObjectsArray<string>* tables = nullptr;
+
+			if (!m_links.get(from, tables))
+			{
+				tables = FB_NEW_POOL(getPool()) SortedObjectsArray<string>(getPool());
+				m_links.put(from, tables);
+			}
+
+			if (from != to && !tables->exist(to))
+				tables->add(to);
+		};
+
+		while (cursor->fetchNext(&localStatus, result.getData()) == IStatus::RESULT_OK)
+		{
+			const string child = "T:" + string(result->fkSchema.str, result->fkSchema.length) +
+				"." + string(result->fkTable.str, result->fkTable.length);
+			const string parent = "T:" + string(result->pkSchema.str, result->pkSchema.length) +
+				"." + string(result->pkTable.str, result->pkTable.length);
+
+			link(child, parent);
+			link(parent, child);
+		}
+
+		localStatus.check();
+
+		cursor->close(&localStatus);
+		localStatus.check();
+		cursor = nullptr;
+
+		transaction->commit(&localStatus);
+		localStatus.check();
+		transaction = nullptr;
+
+		m_linksLoaded = true;
+	}
+
+	// Add the tables linked by foreign keys to the changed ones. Either of two transactions
+	// changing a parent and its child may fail if applied out of order, e.g. a parent row
+	// deleted before its children deleted by the preceding transaction.
+
+	void ParallelApplier::addLinks(SortedObjectsArray<string>& resources)
+	{
+		if (!m_linksLoaded)
+			loadLinks();
+
+		HalfStaticArray<const string*, 8> linked;
+
+		for (const auto& resource : resources)
+		{
+			if (const auto tables = m_links.get(resource))
+			{
+				for (const auto& table : **tables)
+					linked.add(&table);
+			}
+		}
+
+		for (const auto table : linked)
+		{
+			if (!resources.exist(*table))
+				resources.add(*table);
+		}
+	}
+
+	void ParallelApplier::dispatch(FB_UINT64 sequence, ULONG offset, ULONG length, const UCHAR* data)
+	{
+		// Blocks are scanned and split, so they're passed to the workers uncompressed
+		UCharBuffer buffer(getPool());
+		data = unpackBlock(length, data, m_maxBlockLength, buffer);
+
+		const Block* const header = (const Block*) data;
+		const auto traNumber = header->traNumber;
+		const bool endTrans = (header->flags & BLOCK_END_TRANS);
+
+		SortedObjectsArray<string> resources(getPool());
+		ULONG commitOffset = 0;
+
+		const bool tracked = traNumber &&
+			BlockScanner(getPool(), length, data).scan(resources, commitOffset);
+
+		if (!tracked || m_exclusive.hasData())
+		{
+			// DDL may change the foreign keys, re-read them for the next tracked block
+			forgetLinks();
+
+			// Apply the block exclusively. A transaction running DDL stays exclusive
+			// until it ends, as its uncommitted changes may affect any table.
+
+			drain();
+
+			if (traNumber)
+			{
+				const auto transaction = getTransaction(traNumber);
+
+				FB_SIZE_T pos;
+				const bool exclusive = m_exclusive.find(traNumber, pos);
+
+				if (endTrans)
+				{
+					if (exclusive)
+						m_exclusive.remove(pos);
+				}
+				else if (!tracked && !exclusive)
+					m_exclusive.insert(pos, traNumber);
+
+				addResources(transaction, resources);
+
+				const auto job = makeJob(sequence, offset);
+				job->data.assign(data, length);
+				enqueue(transaction->worker, job);
+
+				if (endTrans)
+					forgetTransaction(traNumber);
+			}
+			else
+			{
+				// Cleanup of all transactions is done by every worker
+
+				for (unsigned i = 0; i < m_workers.getCount(); i++)
+				{
+					if (endTrans || !i)
+					{
+						const auto job = makeJob(sequence, offset);
+						job->data.assign(data, length);
+						enqueue(i, job);
+					}
+				}
+
+				if (endTrans)
+				{
+					forgetTransactions();
+					m_exclusive.clear();
+				}
+			}
+
+			drain();
+			return;
+		}
+
+		addLinks(resources);
+
+		const auto transaction = getTransaction(traNumber);
+		const auto number = transaction->worker;
+
+		addResources(transaction, resources);
+
+		// Wait for the blocks of other transactions which changed the same objects
+
+		auto job = makeJob(sequence, offset);
+
+		for (const auto& resource : transaction->resources)
+		{
+			if (const auto access = m_resources.get(resource))
+				addDependency(job, number, *access);
+		}
+
+		// Split off the commit to be ordered with the commits of other workers
+
+		Job* commitJob = nullptr;
+
+		if (endTrans && commitOffset)
+		{
+			commitJob = makeJob(sequence, offset);
+			commitJob->waitFor.assign(job->waitFor);
+			addDependency(commitJob, number, m_lastCommit);
+
+			Block commitHeader = *header;
+			commitHeader.flags = BLOCK_END_TRANS;
+			commitHeader.length = length - commitOffset;
+
+			commitJob->data.assign((const UCHAR*) &commitHeader, sizeof(Block));
+			commitJob->data.add(data + commitOffset, length - commitOffset);
+
+			if (commitOffset > sizeof(Block))
+			{
+				Block bodyHeader = *header;
+				bodyHeader.flags &= ~BLOCK_END_TRANS;
+				bodyHeader.length = commitOffset - sizeof(Block);
+
+				job->data.assign((const UCHAR*) &bodyHeader, sizeof(Block));
+				job->data.add(data + sizeof(Block), commitOffset - sizeof(Block));
+			}
+			else
+			{
+				delete job;
+				job = nullptr;
+			}
+		}
+		else
+			job->data.assign(data, length);
+
+		if (job)
+			enqueue(number, job);
+
+		if (commitJob)
+			enqueue(number, commitJob);
+
+		// Remember the last block affecting every object changed by this transaction
+
+		Access access;
+		access.worker = number;
+		access.ticket = m_lastTicket;
+
+		for (const auto& resource : transaction->resources)
+			m_resources.put(resource, access);
+
+		if (commitJob)
+			m_lastCommit = access;
+
+		if (endTrans)
+			forgetTransaction(traNumber);
+	}
+
+	void ParallelApplier::apply(Worker* worker)
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		while (true)
+		{
+			while (!m_stop && (worker->queue.isEmpty() || !isReady(worker->queue.front())))
+				m_condition.wait(m_mutex);
+
+			if (m_stop)
+				break;
+
+			const auto job = worker->queue.front();
+
+			if (!m_failed)
+			{
+				FbLocalStatus localStatus;
+
+				{	// scope
+					MutexUnlockGuard cout(m_mutex, FB_FUNCTION);
+					worker->replicator->process(&localStatus, job->data.getCount(), job->data.begin());
+				}
+
+				if (!localStatus.isSuccess() && !m_failed)
+				{
+					m_failed = true;
+					m_error.assign(Arg::StatusVector(localStatus->getErrors()));
+					m_errorSequence = job->sequence;
+					m_errorOffset = job->offset;
+				}
+			}
+
+			worker->queue.remove((FB_SIZE_T) 0);
+			worker->doneTicket = job->ticket;
+			delete job;
+
+			m_condition.notifyAll();
+		}
+	}
+
 	class Target : public GlobalStorage
 	{
 	public:
@@ -367,28 +1151,10 @@ namespace
 			if (m_connected)
 				return m_sequence;
 
-			ClumpletWriter dpb(ClumpletReader::dpbList, MAX_DPB_SIZE);
-
-			dpb.insertByte(isc_dpb_no_db_triggers, 1);
-			dpb.insertString(isc_dpb_user_name, DBA_USER_NAME);
-			dpb.insertString(isc_dpb_config, ParsedList::getNonLoopbackProviders(m_config->dbName));
-
-			if (m_config->schemaSearchPath.hasData())
-				dpb.insertString(isc_dpb_search_path, m_config->schemaSearchPath.c_str());
-
 #ifndef NO_DATABASE
-			DispatcherPtr provider;
-			FbLocalStatus localStatus;
-
-			const auto att =
-				provider->attachDatabase(&localStatus, m_config->dbName.c_str(),
-										 dpb.getBufferLength(), dpb.getBuffer());
-			localStatus.check();
-			m_attachment = att;
+			attachReplica(m_attachment, m_replicator);
 
-			const auto repl = m_attachment->createReplicator(&localStatus);
-			localStatus.check();
-			m_replicator = repl;
+			FbLocalStatus localStatus;
 
 			fb_assert(!m_sequence);
 
@@ -408,6 +1174,21 @@ namespace
 			localStatus.check();
 
 			m_sequence = result->sequence;
+
+			if (m_config->applyWorkers > 1)
+			{
+				// Primary compresses blocks fitting its journal segment only
+				m_parallel = FB_NEW ParallelApplier(m_attachment,
+					MAX(m_config->segmentSize, DEFAULT_SEGMENT_SIZE));
+
+				for (ULONG i = 0; i < m_config->applyWorkers; i++)
+				{
+					const auto worker = m_parallel->addWorker();
+					attachReplica(worker->attachment, worker->replicator);
+				}
+
+				m_parallel->start();
+			}
 #endif
 			m_connected = true;
 
@@ -416,6 +1197,8 @@ namespace
 
 		void shutdown()
 		{
+			m_parallel.reset();
+
 			FbLocalStatus localStatus;
 			if (m_replicator)
 			{
@@ -438,12 +1221,114 @@ namespace
 #else
 			fb_assert(m_replicator);
 
+			if (m_parallel)
+			{
+				m_parallel->dispatch(sequence, offset, length, data);
+				checkParallel();
+				return;
+			}
+
 			FbLocalStatus localStatus;
 			m_replicator->process(&localStatus, length, data);
 			checkCompletion(localStatus, sequence, offset);
 #endif
 		}
 
+		// Wait until the blocks dispatched to the parallel workers are applied
+
+		void drain()
+		{
+			if (m_parallel)
+			{
+				m_parallel->drain();
+				checkParallel();
+			}
+		}
+
+		// Check whether everything replicated so far is already applied
+
+		bool isIdle()
+		{
+			return !m_parallel || m_parallel->isIdle();
+		}
+
+		unsigned getWorkerCount() const
+		{
+			return m_parallel ? m_parallel->getWorkerCount() : 1;
+		}
+
+		unsigned resetMaxQueueDepth()
+		{
+			return m_parallel ? m_parallel->resetMaxQueueDepth() : 0;
+		}
+
+		// Publish the apply metrics as session context variables of the replica attachment,
+		// so they're visible through MON$CONTEXT_VARIABLES of the replica database
+
+		void publishMetrics(unsigned lag, unsigned queueDepth)
+		{
+#ifndef NO_DATABASE
+			fb_assert(m_attachment);
+
+			const char* sql =
+				"execute block (lag integer = ?, depth integer = ?, workers integer = ?)\n"
+				"as\n"
+				"  declare dummy integer;\n"
+				"begin\n"
+				"  dummy = rdb$set_context('USER_SESSION', 'REPLICATION_LAG', lag);\n"
+				"  dummy = rdb$set_context('USER_SESSION', 'REPLICATION_QUEUE_DEPTH', depth);\n"
+				"  dummy = rdb$set_context('USER_SESSION', 'REPLICATION_APPLY_WORKERS', workers);\n"
+				"end";
+
+			FbLocalStatus localStatus;
+
+			FB_MESSAGE(Params, CheckStatusWrapper,
+				(FB_INTEGER, lag)
+				(FB_INTEGER, depth)
+				(FB_INTEGER, workers)
+			) params(&localStatus, fb_get_master_interface());
+
+			params->lag = (SLONG) lag;
+			params->depth = (SLONG) queueDepth;
+			params->workers = (SLONG) getWorkerCount();
+
+			// Metrics are not worth breaking the replication, so errors are only logged
+
+			try
+			{
+				RefPtr<ITransaction> transaction(REF_NO_INCR,
+					m_attachment->startTransaction(&localStatus, 0, NULL));
+				localStatus.check();
+
+				m_attachment->execute(&localStatus, transaction, 0, sql, SQL_DIALECT_V6,
+									  params.getMetadata(), params.getData(), NULL, NULL);
+				localStatus.check();
+
+				transaction->commit(&localStatus);
+				localStatus.check();
+				transaction = nullptr;
+			}
+			catch (const Exception& ex)
+			{
+				FbLocalStatus status;
+				ex.stuffException(&status);
+
+				string message;
+				char temp[BUFFER_LARGE];
+				const ISC_STATUS* statusPtr = status->getErrors();
+
+				while (fb_interpret(temp, sizeof(temp), &statusPtr))
+				{
+					if (message.hasData())
+						message += "\n\t";
+					message += temp;
+				}
+
+				verbose("Failed to publish the replication metrics: %s", message.c_str());
+			}
+#endif
+		}
+
 		bool isShutdown() const
 		{
 			return (m_attachment == nullptr);
@@ -473,6 +1358,24 @@ namespace
 			}
 		}
 
+		void checkParallel()
+		{
+			FB_UINT64 sequence;
+			ULONG offset;
+			Arg::StatusVector error;
+
+			if (m_parallel->getError(sequence, offset, error))
+			{
+				m_errorSequence = sequence;
+				m_errorOffset = offset;
+				error.raise();
+			}
+
+			m_lastError.clear();
+			m_errorSequence = 0;
+			m_errorOffset = 0;
+		}
+
 		void checkCompletion(const FbLocalStatus& status, FB_UINT64 sequence, ULONG offset)
 		{
 			if (!status.isSuccess())
@@ -506,19 +1409,45 @@ namespace
 		AutoPtr<const Replication::Config> m_config;
 		IAttachment* m_attachment;
 		IReplicator* m_replicator;
+		AutoPtr<ParallelApplier> m_parallel;
 		FB_UINT64 m_sequence;
 		bool m_connected;
 		string m_lastError;
 		FB_UINT64 m_errorSequence;
 		ULONG m_errorOffset;
+
+		void attachReplica(IAttachment*& attachment, IReplicator*& replicator)
+		{
+			ClumpletWriter dpb(ClumpletReader::dpbList, MAX_DPB_SIZE);
+
+			dpb.insertByte(isc_dpb_no_db_triggers, 1);
+			dpb.insertString(isc_dpb_user_name, DBA_USER_NAME);
+			dpb.insertString(isc_dpb_config, ParsedList::getNonLoopbackProviders(m_config->dbName));
+
+			if (m_config->schemaSearchPath.hasData())
+				dpb.insertString(isc_dpb_search_path, m_config->schemaSearchPath.c_str());
+
+			DispatcherPtr provider;
+			FbLocalStatus localStatus;
+
+			const auto att =
+				provider->attachDatabase(&localStatus, m_config->dbName.c_str(),
+										 dpb.getBufferLength(), dpb.getBuffer());
+			localStatus.check();
+			attachment = att;
+
+			const auto repl = attachment->createReplicator(&localStatus);
+			localStatus.check();
+			replicator = repl;
+		}
 	};
 
 	typedef Array<Target*> TargetList;
 
 	struct Segment
 	{
-		explicit Segment(MemoryPool& pool, const PathName& fname, const SegmentHeader& hdr)
-			: filename(pool, fname)
+		explicit Segment(MemoryPool& pool, const PathName& fname, const SegmentHeader& hdr, time_t mtime)
+			: filename(pool, fname), modified(mtime)
 		{
 			memcpy(&header, &hdr, sizeof(SegmentHeader));
 		}
@@ -545,6 +1474,7 @@ namespace
 
 		const PathName filename;
 		SegmentHeader header;
+		const time_t modified;
 	};
 
 	typedef SortedArray<Segment*, EmptyStorage<Segment*>, FB_UINT64, Segment> ProcessQueue;
@@ -733,7 +1663,7 @@ namespace
 				if (header.hdr_state != SEGMENT_STATE_ARCH)
 					continue;
 */
-				queue.add(FB_NEW_POOL(pool) Segment(pool, filename, header));
+				queue.add(FB_NEW_POOL(pool) Segment(pool, filename, header, stats.st_mtime));
 			}
 
 			if (queue.isEmpty())
@@ -917,15 +1847,21 @@ namespace
 
 					totalLength += length;
 
-					control.savePartial(sequence, totalLength, transactions);
+					// With parallel workers, the position can be saved only when
+					// all the preceding blocks are applied
+
+					if (target->isIdle())
+						control.savePartial(sequence, totalLength, transactions);
 				}
 
+				target->drain();
+
 				control.saveComplete(sequence, transactions);
 
 				file.release();
 
 				const TimeStamp finishTime(TimeStamp::getCurrentTimeStamp());
-				const string interval = formatInterval(startTime, finishTime);
+				string interval = formatInterval(startTime, finishTime);
 
 				oldest = findOldest(transactions);
 				oldest_sequence = oldest ? oldest->sequence : 0;
@@ -946,6 +1882,27 @@ namespace
 					extra = "deleting";
 				}
 
+				if (action == REPLICATE)
+				{
+					// Lag is the age of the latest change in the segment when it's applied
+					const auto lag = (unsigned) MAX(time(NULL) - segment->modified, (time_t) 0);
+					const auto queueDepth = target->resetMaxQueueDepth();
+
+					target->publishMetrics(lag, queueDepth);
+
+					string stats;
+					stats.printf(" (lag %us", lag);
+					interval += stats;
+
+					if (const auto workers = target->getWorkerCount(); workers > 1)
+					{
+						stats.printf(", %u workers, max queue depth %u", workers, queueDepth);
+						interval += stats;
+					}
+
+					interval += ")";
+				}
+
 				target->verbose("Segment %" UQUADFORMAT " (%u bytes) is %s in %s, %s",
 								sequence, totalLength, actionName.c_str(), interval.c_str(), extra.c_str());
 
@@ -798,7 +798,7 @@ public:
 				}
 
 				if (send->p_acpt.p_acpt_type & pflag_compress)
-					authPort->initCompression();
+					authPort->initCompression(send->p_acpt.p_acpt_type & pflag_compress_zstd);
 				authPort->send(send);
 				if (send->p_acpt.p_acpt_type & pflag_compress)
 					authPort->port_flags |= PORT_compressed;
@@ -2010,6 +2010,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 	USHORT version = 0;
 	USHORT type = 0;
 	bool compress = false;
+	bool zstd = false;
 	bool accepted = false;
 	USHORT weight = 0;
 	const p_cnct::p_cnct_repeat* protocol = connect->p_cnct_versions;
@@ -2030,6 +2031,8 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 			architecture = protocol->p_cnct_architecture;
 			type = MIN(protocol->p_cnct_max_type & ptype_MASK, ptype_lazy_send);
 			compress = protocol->p_cnct_max_type & pflag_compress;
+			zstd = compress && (protocol->p_cnct_max_type & pflag_compress_zstd) &&
+				rem_port::checkCompression(true);
 		}
 	}
 
@@ -2038,7 +2041,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 
 	send->p_acpd.p_acpt_version = port->port_protocol = version;
 	send->p_acpd.p_acpt_architecture = architecture;
-	send->p_acpd.p_acpt_type = type | (compress ? pflag_compress : 0);
+	send->p_acpd.p_acpt_type = type | (compress ? pflag_compress : 0) | (zstd ? pflag_compress_zstd : 0);
 #ifdef TRUSTED_AUTH
 	send->p_acpd.p_acpt_type |= pflag_win_sspi_nego;
 #endif
@@ -2046,7 +2049,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 
 	send->p_acpt.p_acpt_version = port->port_protocol = version;
 	send->p_acpt.p_acpt_architecture = architecture;
-	send->p_acpt.p_acpt_type = type | (compress ? pflag_compress : 0);
+	send->p_acpt.p_acpt_type = type | (compress ? pflag_compress : 0) | (zstd ? pflag_compress_zstd : 0);
 
 	// modify the version string to reflect the chosen protocol
 	string buffer;
@@ -2240,7 +2243,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 
 	send->p_operation = returnData ? op_accept_data : op_accept;
 	if (send->p_acpt.p_acpt_type & pflag_compress)
-		port->initCompression();
+		port->initCompression(send->p_acpt.p_acpt_type & pflag_compress_zstd);
 	port->send(send);
 	if (send->p_acpt.p_acpt_type & pflag_compress)
 		port->port_flags |= PORT_compressed;
@@ -2269,7 +2272,7 @@ void ConnectAuth::accept(PACKET* send, Auth::WriterImplementation*)
 		authPort->extractNewKeys(s);
 		send->p_acpd.p_acpt_authenticated = 1;
 		if (send->p_acpt.p_acpt_type & pflag_compress)
-			authPort->initCompression();
+			authPort->initCompression(send->p_acpt.p_acpt_type & pflag_compress_zstd);
 		authPort->send(send);
 		if (send->p_acpt.p_acpt_type & pflag_compress)
 			authPort->port_flags |= PORT_compressed;
@@ -4210,6 +4213,8 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, bool scroll)
 	// Check to see if any messages are already sitting around
 
 	const FB_UINT64 org_packets = this->port_snd_packets;
+	const FB_UINT64 org_bytes = this->port_snd_bytes;
+	const ULONG max_bytes = getPortConfig()->getFetchBatchBuffer();
 
 	USHORT count = 0;
 	bool success = true;
@@ -4332,12 +4337,19 @@ ISC_STATUS rem_port::fetch(P_SQLDATA * sqldata, PACKET* sendL, bool scroll)
 
 		message->msg_address = NULL;
 
-		// If we've hit maximum prefetch size, break out of loop
+		// If we've hit maximum prefetch size, break out of loop. It's limited by
+		// FetchBatchBuffer bytes if set, or by the number of packets otherwise.
 
-		const USHORT packets = this->port_snd_packets - org_packets;
-
-		if (packets >= MAX_PACKETS_PER_BATCH && count >= MIN_ROWS_PER_BATCH)
-			break;
+		if (count >= MIN_ROWS_PER_BATCH)
+		{
+			if (max_bytes)
+			{
+				if (this->port_snd_bytes - org_bytes >= max_bytes)
+					break;
+			}
+			else if (this->port_snd_packets - org_packets >= MAX_PACKETS_PER_BATCH)
+				break;
+		}
 	}
 
 	response->p_sqldata_status = success ? 0 : 100;
@@ -0,0 +1,186 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/classes/array.h"
+#include "../common/classes/fb_string.h"
+#include "../remote/protocol.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#ifndef WIN_NT
+#include <errno.h>
+#include <netdb.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#endif
+
+using namespace Firebird;
+
+
+BOOST_AUTO_TEST_SUITE(RemoteSuite)
+BOOST_AUTO_TEST_SUITE(ServerConnectionsSuite)
+
+#ifndef WIN_NT
+namespace
+{
+	void putLong(UCharBuffer& buffer, ULONG value)
+	{
+		const UCHAR bytes[] = {(UCHAR) (value >> 24), (UCHAR) (value >> 16), (UCHAR) (value >> 8), (UCHAR) value};
+		buffer.add(bytes, sizeof(bytes));
+	}
+
+	void putString(UCharBuffer& buffer, const char* value)
+	{
+		const ULONG length = (ULONG) strlen(value);
+		putLong(buffer, length);
+		buffer.add(reinterpret_cast<const UCHAR*>(value), length);
+
+		while (buffer.getCount() % 4)
+			buffer.add(0);
+	}
+
+	// op_connect without protocols, the server rejects it right after it's read
+	void makeConnect(UCharBuffer& buffer)
+	{
+		putLong(buffer, op_connect);
+		putLong(buffer, op_attach);
+		putLong(buffer, CONNECT_VERSION3);
+		putLong(buffer, arch_generic);
+		putString(buffer, "employee");
+		putLong(buffer, 0);
+		putString(buffer, "");
+	}
+
+	int openSocket(const addrinfo* address)
+	{
+		const int handle = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+		if (handle < 0)
+			return -1;
+
+		if (connect(handle, address->ai_addr, address->ai_addrlen) != 0)
+		{
+			const int error = errno;
+			close(handle);
+			errno = error;
+			return -1;
+		}
+
+		const int optval = 1;
+		setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+
+		return handle;
+	}
+
+	// Connect, send op_connect and wait for op_reject
+	bool handshake(const addrinfo* address, const UCharBuffer& packet)
+	{
+		const int handle = openSocket(address);
+		if (handle < 0)
+			return false;
+
+		bool result = false;
+		UCHAR reply[4];
+
+		if (send(handle, packet.begin(), packet.getCount(), MSG_NOSIGNAL) == (ssize_t) packet.getCount() &&
+			recv(handle, reply, sizeof(reply), MSG_WAITALL) == sizeof(reply))
+		{
+			const ULONG op = (ULONG(reply[0]) << 24) | (ULONG(reply[1]) << 16) | (ULONG(reply[2]) << 8) | reply[3];
+			result = (op == op_reject);
+		}
+
+		close(handle);
+		return result;
+	}
+
+	boost::test_tools::assertion_result serverGiven(boost::unit_test::test_unit_id)
+	{
+		return getenv("FB_TEST_SERVER") != nullptr;
+	}
+}
+
+// Benchmark of the multi-client server wakeups with many idle connections open. It needs
+// a running server and enough file descriptors on both sides (ulimit -n), so it's skipped
+// unless FB_TEST_SERVER=host[:port] is set. Run with --log_level=message to see the numbers.
+BOOST_AUTO_TEST_CASE(ServerConnectionsTest, *boost::unit_test::precondition(serverGiven))
+{
+	constexpr unsigned HANDSHAKE_COUNT = 1'000u;
+
+	string host(getenv("FB_TEST_SERVER"));
+	string service("3050");
+
+	const auto pos = host.find(':');
+	if (pos != string::npos)
+	{
+		service = host.substr(pos + 1);
+		host.resize(pos);
+	}
+
+	addrinfo hints {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	addrinfo* address = nullptr;
+	BOOST_REQUIRE(getaddrinfo(host.c_str(), service.c_str(), &hints, &address) == 0);
+
+	rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+	{
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+
+	UCharBuffer packet;
+	makeConnect(packet);
+
+	std::vector<int> idle;
+
+	for (const unsigned idleCount : {0u, 10'000u, 50'000u})
+	{
+		while (idle.size() < idleCount)
+		{
+			const int handle = openSocket(address);
+
+			if (handle < 0)
+			{
+				BOOST_TEST_MESSAGE("can't open more connections, errno = " << errno);
+				break;
+			}
+
+			idle.push_back(handle);
+		}
+
+		std::vector<double> latencies;
+		latencies.reserve(HANDSHAKE_COUNT);
+
+		for (unsigned i = 0u; i < HANDSHAKE_COUNT; ++i)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			BOOST_REQUIRE(handshake(address, packet));
+			const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+			latencies.push_back(elapsed.count());
+		}
+
+		std::sort(latencies.begin(), latencies.end());
+
+		BOOST_TEST_MESSAGE("idle connections: " << idle.size() <<
+			", handshake median: " << latencies[latencies.size() / 2] << " us" <<
+			", p99: " << latencies[latencies.size() * 99 / 100] << " us");
+
+		if (idle.size() < idleCount)
+			break;
+	}
+
+	for (const int handle : idle)
+		close(handle);
+
+	freeaddrinfo(address);
+}
+#endif // WIN_NT
+
+BOOST_AUTO_TEST_SUITE_END()	// ServerConnectionsSuite
+BOOST_AUTO_TEST_SUITE_END()	// RemoteSuite
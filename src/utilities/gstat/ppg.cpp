@@ -157,6 +157,13 @@ void PPG_print_header(const header_page* header, bool nocreation, Firebird::Util
 			uSvc->printf(false, "read only");
 		}
 
+		if (flags & hdr_page_compression)
+		{
+			if (count++)
+				uSvc->printf(false, ", ");
+			uSvc->printf(false, "page compression");
+		}
+
 		if (shutMode)
 		{
 			if (count++)